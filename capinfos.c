@@ -69,6 +69,7 @@
 #endif
 
 #include <wsutil/report_message.h>
+#include <wsutil/clopts_common.h>
 #include <wsutil/str_util.h>
 #include <wsutil/to_str.h>
 #include <wsutil/file_util.h>
@@ -91,6 +92,18 @@
 
 static bool stop_after_failure;
 
+/*
+ * Number of files to process concurrently (-j). Reports are still
+ * printed one file at a time, in command line order.
+ */
+static int num_jobs = 1;
+
+/*
+ * Number of threads to use to find the records in a file, for file
+ * types that support that; -j with a single file.
+ */
+static unsigned index_threads = 1;
+
 /*
  * table report variables
  */
@@ -147,16 +160,13 @@ static bool cap_file_hashes    = true;  /* Calculate file hashes */
 #define HASH_STR_SIZE (65) /* Max hash size * 2 + '\0' */
 #define HASH_BUF_SIZE (1024 * 1024)
 
-
-static char file_sha256[HASH_STR_SIZE];
-static char file_sha1[HASH_STR_SIZE];
-
-static char  *hash_buf;
-static gcry_md_hd_t hd;
-
-static unsigned int num_ipv4_addresses;
-static unsigned int num_ipv6_addresses;
-static unsigned int num_decryption_secrets;
+/*
+ * Counted by the wiretap callbacks while a file is read; thread-local
+ * because files may be read on several threads with -j.
+ */
+static WS_THREAD_LOCAL unsigned int num_ipv4_addresses;
+static WS_THREAD_LOCAL unsigned int num_ipv6_addresses;
+static WS_THREAD_LOCAL unsigned int num_decryption_secrets;
 
 /*
  * If we have at least two packets with time stamps, and they're not in
@@ -217,6 +227,12 @@ typedef struct _capture_info {
     GArray               *interface_packet_counts;  /* array of per_packet interface_id counts; one entry per file IDB */
     uint32_t              pkt_interface_id_unknown; /* counts if packet interface_id didn't match a known one */
     GArray               *idb_info_strings;         /* array of IDB info strings */
+
+    char                  file_sha256[HASH_STR_SIZE];
+    char                  file_sha1[HASH_STR_SIZE];
+    unsigned int          num_ipv4_addresses;
+    unsigned int          num_ipv6_addresses;
+    unsigned int          num_decryption_secrets;
 } capture_info;
 
 static char *decimal_point;
@@ -591,8 +607,8 @@ print_stats(const char *filename, capture_info *cf_info)
         }
     }
     if (cap_file_hashes) {
-        printf     ("SHA256:              %s\n", file_sha256);
-        printf     ("SHA1:                %s\n", file_sha1);
+        printf     ("SHA256:              %s\n", cf_info->file_sha256);
+        printf     ("SHA1:                %s\n", cf_info->file_sha1);
     }
     if (cap_order)          printf     ("Strict time order:   %s\n", order_string(cf_info->order));
 
@@ -656,14 +672,14 @@ print_stats(const char *filename, capture_info *cf_info)
         }
 
         if (cap_file_nrb) {
-            if (num_ipv4_addresses != 0)
-                printf   ("Number of resolved IPv4 addresses in file: %u\n", num_ipv4_addresses);
-            if (num_ipv6_addresses != 0)
-                printf   ("Number of resolved IPv6 addresses in file: %u\n", num_ipv6_addresses);
+            if (cf_info->num_ipv4_addresses != 0)
+                printf   ("Number of resolved IPv4 addresses in file: %u\n", cf_info->num_ipv4_addresses);
+            if (cf_info->num_ipv6_addresses != 0)
+                printf   ("Number of resolved IPv6 addresses in file: %u\n", cf_info->num_ipv6_addresses);
         }
         if (cap_file_dsb) {
-            if (num_decryption_secrets != 0)
-                printf   ("Number of decryption secrets in file: %u\n", num_decryption_secrets);
+            if (cf_info->num_decryption_secrets != 0)
+                printf   ("Number of decryption secrets in file: %u\n", cf_info->num_decryption_secrets);
         }
     }
 }
@@ -898,12 +914,12 @@ print_stats_table(const char *filename, capture_info *cf_info)
     if (cap_file_hashes) {
         putsep();
         putquote();
-        printf("%s", file_sha256);
+        printf("%s", cf_info->file_sha256);
         putquote();
 
         putsep();
         putquote();
-        printf("%s", file_sha1);
+        printf("%s", cf_info->file_sha1);
         putquote();
     }
 
@@ -1054,31 +1070,48 @@ hash_to_str(const unsigned char *hash, size_t length, char *str)
 }
 
 static void
-calculate_hashes(const char *filename)
+calculate_hashes(const char *filename, capture_info *cf_info)
 {
     FILE  *fh;
     size_t hash_bytes;
+    char  *hash_buf;
+    gcry_md_hd_t hd = NULL;
 
-    (void) g_strlcpy(file_sha256, "<unknown>", HASH_STR_SIZE);
-    (void) g_strlcpy(file_sha1, "<unknown>", HASH_STR_SIZE);
+    (void) g_strlcpy(cf_info->file_sha256, "<unknown>", HASH_STR_SIZE);
+    (void) g_strlcpy(cf_info->file_sha1, "<unknown>", HASH_STR_SIZE);
 
     if (cap_file_hashes) {
+        /* Use a handle and buffer per call, so that files can be hashed concurrently. */
+        gcry_md_open(&hd, GCRY_MD_SHA256, 0);
+        if (hd)
+            gcry_md_enable(hd, GCRY_MD_SHA1);
         fh = ws_fopen(filename, "rb");
         if (fh && hd) {
+            hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
             while((hash_bytes = fread(hash_buf, 1, HASH_BUF_SIZE, fh)) > 0) {
                 gcry_md_write(hd, hash_buf, hash_bytes);
             }
+            g_free(hash_buf);
             gcry_md_final(hd);
-            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA256), HASH_SIZE_SHA256, file_sha256);
-            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, file_sha1);
+            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA256), HASH_SIZE_SHA256, cf_info->file_sha256);
+            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, cf_info->file_sha1);
         }
         if (fh) fclose(fh);
-        if (hd) gcry_md_reset(hd);
+        gcry_md_close(hd);
     }
 }
 
+/*
+ * Read a capture file and gather its statistics into cf_info. Nothing is
+ * written to stdout here, so this can run on a worker thread; on success
+ * the file is left open for report_cap_file().
+ *
+ * Returns 0 on success, 1 if the file was read only in part (after a short
+ * read) and 2 if it couldn't be read at all, in which case there is nothing
+ * to report.
+ */
 static int
-process_cap_file(const char *filename, bool need_separator)
+scan_cap_file(const char *filename, capture_info *cf_info)
 {
     int                   status = 0;
     int                   err;
@@ -1092,7 +1125,6 @@ process_cap_file(const char *filename, bool need_separator)
     uint32_t              snaplen_max_inferred =          0;
     wtap_rec              rec;
     Buffer                buf;
-    capture_info          cf_info;
     bool                  have_times = true;
     nstime_t              start_time;
     int                   start_time_tsprec;
@@ -1106,9 +1138,14 @@ process_cap_file(const char *filename, bool need_separator)
     wtapng_iface_descriptions_t *idb_info;
 
     pkt_cmt *pc = NULL, *prev = NULL;
-
-    cf_info.wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, false);
-    if (!cf_info.wth) {
+    GArray               *index = NULL;
+    unsigned              index_pos = 0;
+    int                   index_err = 0;
+    char                 *index_err_info = NULL;
+
+    /* Indexing the records needs random access to the file. */
+    cf_info->wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, index_threads > 1);
+    if (!cf_info->wth) {
         cfile_open_failure_message(filename, err, err_info);
         return 2;
     }
@@ -1118,11 +1155,7 @@ process_cap_file(const char *filename, bool need_separator)
      * bother calculating them for files that are not known capture types
      * where we wouldn't print them anyway.
      */
-    calculate_hashes(filename);
-
-    if (need_separator && long_report) {
-        printf("\n");
-    }
+    calculate_hashes(filename, cf_info);
 
     nstime_set_zero(&start_time);
     start_time_tsprec = WTAP_TSPREC_UNKNOWN;
@@ -1131,17 +1164,17 @@ process_cap_file(const char *filename, bool need_separator)
     nstime_set_zero(&cur_time);
     nstime_set_zero(&prev_time);
 
-    cf_info.encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
+    cf_info->encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
 
-    idb_info = wtap_file_get_idb_info(cf_info.wth);
+    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
     ws_assert(idb_info->interface_data != NULL);
 
-    cf_info.pkt_cmts = NULL;
-    cf_info.num_interfaces = idb_info->interface_data->len;
-    cf_info.interface_packet_counts  = g_array_sized_new(false, true, sizeof(uint32_t), cf_info.num_interfaces);
-    g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
-    cf_info.pkt_interface_id_unknown = 0;
+    cf_info->pkt_cmts = NULL;
+    cf_info->num_interfaces = idb_info->interface_data->len;
+    cf_info->interface_packet_counts  = g_array_sized_new(false, true, sizeof(uint32_t), cf_info->num_interfaces);
+    g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
+    cf_info->pkt_interface_id_unknown = 0;
 
     g_free(idb_info);
     idb_info = NULL;
@@ -1153,14 +1186,46 @@ process_cap_file(const char *filename, bool need_separator)
 
     /* Register callbacks for new name<->address maps from the file and
        decryption secrets from the file. */
-    wtap_set_cb_new_ipv4(cf_info.wth, count_ipv4_address);
-    wtap_set_cb_new_ipv6(cf_info.wth, count_ipv6_address);
-    wtap_set_cb_new_secrets(cf_info.wth, count_decryption_secret);
+    wtap_set_cb_new_ipv4(cf_info->wth, count_ipv4_address);
+    wtap_set_cb_new_ipv6(cf_info->wth, count_ipv6_address);
+    wtap_set_cb_new_secrets(cf_info->wth, count_decryption_secret);
+
+    /* We only look at the record metadata, never at the packet data. */
+    wtap_set_skip_packet_data(cf_info->wth, true);
+
+    /*
+     * If we can, find the records' metadata with several threads;
+     * anything that isn't indexed is read below.
+     */
+    if (index_threads > 1)
+        index = wtap_index_records(cf_info->wth, index_threads, &index_err, &index_err_info);
 
     /* Tally up data that we need to parse through the file to find */
     wtap_rec_init(&rec);
     ws_buffer_init(&buf, 1514);
-    while (wtap_read(cf_info.wth, &rec, &buf, &err, &err_info, &data_offset))  {
+    for (;;) {
+        if (index != NULL && index_pos < index->len) {
+            const wtap_record_index_entry *entry = &g_array_index(index, wtap_record_index_entry, index_pos++);
+
+            rec.rec_type = entry->rec_type;
+            rec.presence_flags = entry->presence_flags;
+            rec.ts = entry->ts;
+            rec.tsprec = entry->tsprec;
+            rec.section_number = entry->section_number;
+            rec.rec_header.packet_header.pkt_encap = entry->pkt_encap;
+            rec.rec_header.packet_header.caplen = entry->caplen;
+            rec.rec_header.packet_header.len = entry->len;
+            rec.rec_header.packet_header.interface_id = entry->interface_id;
+            rec.block = wtap_block_ref(entry->block);
+        } else if (index_err != 0) {
+            /* We got an error while indexing; report it. */
+            err = index_err;
+            err_info = index_err_info;
+            break;
+        } else if (!wtap_read(cf_info->wth, &rec, &buf, &err, &err_info, &data_offset)) {
+            break;
+        }
+
         if (rec.presence_flags & WTAP_HAS_TS) {
             prev_time = cur_time;
             cur_time = rec.ts;
@@ -1202,7 +1267,7 @@ process_cap_file(const char *filename, bool need_separator)
                 pc->next = NULL;
 
                 if (prev == NULL)
-                  cf_info.pkt_cmts = pc;
+                  cf_info->pkt_cmts = pc;
                 else
                   prev->next = pc;
 
@@ -1223,7 +1288,7 @@ process_cap_file(const char *filename, bool need_separator)
 
             if ((rec.rec_header.packet_header.pkt_encap > 0) &&
                     (rec.rec_header.packet_header.pkt_encap < WTAP_NUM_ENCAP_TYPES)) {
-                cf_info.encap_counts[rec.rec_header.packet_header.pkt_encap] += 1;
+                cf_info->encap_counts[rec.rec_header.packet_header.pkt_encap] += 1;
             } else {
                 fprintf(stderr, "capinfos: Unknown packet encapsulation %d in frame %u of file \"%s\"\n",
                         rec.rec_header.packet_header.pkt_encap, packet, filename);
@@ -1231,45 +1296,47 @@ process_cap_file(const char *filename, bool need_separator)
 
             /* Packet interface_id info */
             if (rec.presence_flags & WTAP_HAS_INTERFACE_ID) {
-                /* cf_info.num_interfaces is size, not index, so it's one more than max index */
-                if (rec.rec_header.packet_header.interface_id >= cf_info.num_interfaces) {
+                /* cf_info->num_interfaces is size, not index, so it's one more than max index */
+                if (rec.rec_header.packet_header.interface_id >= cf_info->num_interfaces) {
                     /*
                      * OK, re-fetch the number of interfaces, as there might have
                      * been an interface that was in the middle of packets, and
                      * grow the array to be big enough for the new number of
                      * interfaces.
                      */
-                    idb_info = wtap_file_get_idb_info(cf_info.wth);
+                    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
-                    cf_info.num_interfaces = idb_info->interface_data->len;
-                    g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
+                    cf_info->num_interfaces = idb_info->interface_data->len;
+                    g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
 
                     g_free(idb_info);
                     idb_info = NULL;
                 }
-                if (rec.rec_header.packet_header.interface_id < cf_info.num_interfaces) {
-                    g_array_index(cf_info.interface_packet_counts, guint32,
+                if (rec.rec_header.packet_header.interface_id < cf_info->num_interfaces) {
+                    g_array_index(cf_info->interface_packet_counts, guint32,
                             rec.rec_header.packet_header.interface_id) += 1;
                 }
                 else {
-                    cf_info.pkt_interface_id_unknown += 1;
+                    cf_info->pkt_interface_id_unknown += 1;
                 }
             }
             else {
                 /* it's for interface_id 0 */
-                if (cf_info.num_interfaces != 0) {
-                    g_array_index(cf_info.interface_packet_counts, guint32, 0) += 1;
+                if (cf_info->num_interfaces != 0) {
+                    g_array_index(cf_info->interface_packet_counts, guint32, 0) += 1;
                 }
                 else {
-                    cf_info.pkt_interface_id_unknown += 1;
+                    cf_info->pkt_interface_id_unknown += 1;
                 }
             }
         }
 
         wtap_rec_reset(&rec);
-    } /* while */
+    } /* for */
     wtap_rec_cleanup(&rec);
     ws_buffer_free(&buf);
+    if (index != NULL)
+        g_array_free(index, true);
 
     /*
      * Get IDB info strings.
@@ -1278,14 +1345,14 @@ process_cap_file(const char *filename, bool need_separator)
      * we get, for example, a count of the number of statistics entries
      * for each interface as of the *end* of the file.
      */
-    idb_info = wtap_file_get_idb_info(cf_info.wth);
+    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
-    cf_info.idb_info_strings = g_array_sized_new(false, false, sizeof(char*), cf_info.num_interfaces);
-    cf_info.num_interfaces = idb_info->interface_data->len;
-    for (i = 0; i < cf_info.num_interfaces; i++) {
+    cf_info->idb_info_strings = g_array_sized_new(false, false, sizeof(char*), cf_info->num_interfaces);
+    cf_info->num_interfaces = idb_info->interface_data->len;
+    for (i = 0; i < cf_info->num_interfaces; i++) {
         const wtap_block_t if_descr = g_array_index(idb_info->interface_data, wtap_block_t, i);
         char *s = wtap_get_debug_if_descr(if_descr, 21, "\n");
-        g_array_append_val(cf_info.idb_info_strings, s);
+        g_array_append_val(cf_info->idb_info_strings, s);
     }
 
     g_free(idb_info);
@@ -1302,94 +1369,228 @@ process_cap_file(const char *filename, bool need_separator)
             fprintf(stderr,
                     "  (will continue anyway, checksums might be incorrect)\n");
         } else {
-            cleanup_capture_info(&cf_info);
-            wtap_close(cf_info.wth);
+            cleanup_capture_info(cf_info);
+            wtap_close(cf_info->wth);
             return 2;
         }
     }
 
     /* File size */
-    size = wtap_file_size(cf_info.wth, &err);
+    size = wtap_file_size(cf_info->wth, &err);
     if (size == -1) {
         fprintf(stderr,
                 "capinfos: Can't get size of \"%s\": %s.\n",
                 filename, g_strerror(err));
-        cleanup_capture_info(&cf_info);
-        wtap_close(cf_info.wth);
+        cleanup_capture_info(cf_info);
+        wtap_close(cf_info->wth);
         return 2;
     }
 
-    cf_info.filesize = size;
+    cf_info->filesize = size;
 
     /* File Type */
-    cf_info.file_type = wtap_file_type_subtype(cf_info.wth);
-    cf_info.compression_type = wtap_get_compression_type(cf_info.wth);
+    cf_info->file_type = wtap_file_type_subtype(cf_info->wth);
+    cf_info->compression_type = wtap_get_compression_type(cf_info->wth);
 
     /* File Encapsulation */
-    cf_info.file_encap = wtap_file_encap(cf_info.wth);
+    cf_info->file_encap = wtap_file_encap(cf_info->wth);
 
-    cf_info.file_tsprec = wtap_file_tsprec(cf_info.wth);
+    cf_info->file_tsprec = wtap_file_tsprec(cf_info->wth);
 
     /* Packet size limit (snaplen) */
-    cf_info.snaplen = wtap_snapshot_length(cf_info.wth);
-    if (cf_info.snaplen > 0)
-        cf_info.snap_set = true;
+    cf_info->snaplen = wtap_snapshot_length(cf_info->wth);
+    if (cf_info->snaplen > 0)
+        cf_info->snap_set = true;
     else
-        cf_info.snap_set = false;
+        cf_info->snap_set = false;
 
-    cf_info.snaplen_min_inferred = snaplen_min_inferred;
-    cf_info.snaplen_max_inferred = snaplen_max_inferred;
+    cf_info->snaplen_min_inferred = snaplen_min_inferred;
+    cf_info->snaplen_max_inferred = snaplen_max_inferred;
 
     /* # of packets */
-    cf_info.packet_count = packet;
+    cf_info->packet_count = packet;
 
     /* File Times */
-    cf_info.times_known = have_times;
-    cf_info.start_time = start_time;
-    cf_info.start_time_tsprec = start_time_tsprec;
-    cf_info.stop_time = stop_time;
-    cf_info.stop_time_tsprec = stop_time_tsprec;
-    nstime_delta(&cf_info.duration, &stop_time, &start_time);
+    cf_info->times_known = have_times;
+    cf_info->start_time = start_time;
+    cf_info->start_time_tsprec = start_time_tsprec;
+    cf_info->stop_time = stop_time;
+    cf_info->stop_time_tsprec = stop_time_tsprec;
+    nstime_delta(&cf_info->duration, &stop_time, &start_time);
     /* Duration precision is the higher of the start and stop time precisions. */
-    if (cf_info.stop_time_tsprec > cf_info.start_time_tsprec)
-        cf_info.duration_tsprec = cf_info.stop_time_tsprec;
+    if (cf_info->stop_time_tsprec > cf_info->start_time_tsprec)
+        cf_info->duration_tsprec = cf_info->stop_time_tsprec;
     else
-        cf_info.duration_tsprec = cf_info.start_time_tsprec;
-    cf_info.know_order = know_order;
-    cf_info.order = order;
+        cf_info->duration_tsprec = cf_info->start_time_tsprec;
+    cf_info->know_order = know_order;
+    cf_info->order = order;
 
     /* Number of packet bytes */
-    cf_info.packet_bytes = bytes;
+    cf_info->packet_bytes = bytes;
 
-    cf_info.data_rate   = 0.0;
-    cf_info.packet_rate = 0.0;
-    cf_info.packet_size = 0.0;
+    cf_info->data_rate   = 0.0;
+    cf_info->packet_rate = 0.0;
+    cf_info->packet_size = 0.0;
 
     if (packet > 0) {
         double delta_time = nstime_to_sec(&stop_time) - nstime_to_sec(&start_time);
         if (delta_time > 0.0) {
-            cf_info.data_rate   = (double)bytes  / delta_time; /* Data rate per second */
-            cf_info.packet_rate = (double)packet / delta_time; /* packet rate per second */
+            cf_info->data_rate   = (double)bytes  / delta_time; /* Data rate per second */
+            cf_info->packet_rate = (double)packet / delta_time; /* packet rate per second */
         }
-        cf_info.packet_size = (double)bytes / packet;                  /* Avg packet size      */
+        cf_info->packet_size = (double)bytes / packet;                  /* Avg packet size      */
+    }
+
+    cf_info->num_ipv4_addresses = num_ipv4_addresses;
+    cf_info->num_ipv6_addresses = num_ipv6_addresses;
+    cf_info->num_decryption_secrets = num_decryption_secrets;
+
+    return status;
+}
+
+/*
+ * Print the report for a file scanned by scan_cap_file(), and release it.
+ */
+static void
+report_cap_file(const char *filename, capture_info *cf_info, bool need_separator)
+{
+    if (need_separator && long_report) {
+        printf("\n");
     }
 
     if (!long_report && table_report_header) {
-      print_stats_table_header(&cf_info);
+      print_stats_table_header(cf_info);
     }
 
     if (long_report) {
-        print_stats(filename, &cf_info);
+        print_stats(filename, cf_info);
     } else {
-        print_stats_table(filename, &cf_info);
+        print_stats_table(filename, cf_info);
     }
 
-    cleanup_capture_info(&cf_info);
-    wtap_close(cf_info.wth);
+    cleanup_capture_info(cf_info);
+    wtap_close(cf_info->wth);
+}
+
+static int
+process_cap_file(const char *filename, bool need_separator)
+{
+    capture_info cf_info;
+    int          status;
 
+    status = scan_cap_file(filename, &cf_info);
+    if (status != 2) {
+        report_cap_file(filename, &cf_info, need_separator);
+    }
     return status;
 }
 
+typedef struct {
+    const char   *filename;
+    capture_info  cf_info;
+    int           status;
+    bool          done;
+} capinfos_job_t;
+
+typedef struct {
+    GThreadPool  *pool;
+    GMutex        mutex;
+    GCond         cond;
+} capinfos_jobs_t;
+
+static void
+capinfos_job_callback(void *data, void *user_data)
+{
+    capinfos_job_t *job = (capinfos_job_t *)data;
+    capinfos_jobs_t *jobs = (capinfos_jobs_t *)user_data;
+    int status;
+
+    status = scan_cap_file(job->filename, &job->cf_info);
+
+    g_mutex_lock(&jobs->mutex);
+    job->status = status;
+    job->done = true;
+    g_cond_broadcast(&jobs->cond);
+    g_mutex_unlock(&jobs->mutex);
+}
+
+/*
+ * Scan files with up to num_jobs worker threads and report them in order.
+ * At most twice as many files as there are workers are kept open, so a
+ * slow file early on the command line doesn't leave every other file
+ * open while it is waiting to be reported.
+ *
+ * Returns the overall error status as in the sequential loop in main().
+ */
+static int
+process_cap_files_parallel(char **filenames, int num_files)
+{
+    capinfos_jobs_t jobs;
+    capinfos_job_t *job_list;
+    bool need_separator = false;
+    int overall_error_status = 0;
+    int max_queued = num_jobs * 2;
+    int next_queued;
+    int i;
+
+    job_list = g_new0(capinfos_job_t, num_files);
+    g_mutex_init(&jobs.mutex);
+    g_cond_init(&jobs.cond);
+    jobs.pool = g_thread_pool_new(capinfos_job_callback, &jobs, num_jobs, false, NULL);
+
+    for (next_queued = 0; next_queued < num_files && next_queued < max_queued; next_queued++) {
+        job_list[next_queued].filename = filenames[next_queued];
+        g_thread_pool_push(jobs.pool, &job_list[next_queued], NULL);
+    }
+
+    for (i = 0; i < num_files; i++) {
+        capinfos_job_t *job = &job_list[i];
+
+        g_mutex_lock(&jobs.mutex);
+        while (!job->done) {
+            g_cond_wait(&jobs.cond, &jobs.mutex);
+        }
+        g_mutex_unlock(&jobs.mutex);
+
+        if (next_queued < num_files) {
+            job_list[next_queued].filename = filenames[next_queued];
+            g_thread_pool_push(jobs.pool, &job_list[next_queued], NULL);
+            next_queued++;
+        }
+
+        if (job->status != 2) {
+            report_cap_file(job->filename, &job->cf_info, need_separator);
+            /* See the sequential loop in main(). */
+            need_separator = true;
+        }
+        if (job->status) {
+            overall_error_status = job->status;
+            if (stop_after_failure) {
+                i++;
+                break;
+            }
+        }
+    }
+
+    /*
+     * Drop the files that were not started yet, wait for the running ones
+     * and release whatever was scanned but won't be reported.
+     */
+    g_thread_pool_free(jobs.pool, true, true);
+    for (; i < next_queued; i++) {
+        if (job_list[i].done && job_list[i].status != 2) {
+            cleanup_capture_info(&job_list[i].cf_info);
+            wtap_close(job_list[i].cf_info.wth);
+        }
+    }
+
+    g_cond_clear(&jobs.cond);
+    g_mutex_clear(&jobs.mutex);
+    g_free(job_list);
+
+    return overall_error_status;
+}
+
 static void
 print_usage(FILE *output)
 {
@@ -1449,6 +1650,8 @@ print_usage(FILE *output)
     fprintf(output, "  -h, --help               display this help and exit\n");
     fprintf(output, "  -v, --version            display version info and exit\n");
     fprintf(output, "  -C cancel processing if file open fails (default is to continue)\n");
+    fprintf(output, "  -j <jobs> process up to <jobs> files concurrently, or scan a single\n");
+    fprintf(output, "            pcapng file with up to <jobs> threads (default is 1)\n");
     fprintf(output, "  -A generate all infos (default)\n");
     fprintf(output, "  -K disable displaying the capture comment\n");
     fprintf(output, "  -P disable displaying individual packet comments\n");
@@ -1560,7 +1763,7 @@ main(int argc, char *argv[])
     wtap_init(true);
 
     /* Process the options */
-    while ((opt = ws_getopt_long(argc, argv, "abcdehiklmnopqrstuvxyzABCDEFHIKLMNPQRST", long_options, NULL)) !=-1) {
+    while ((opt = ws_getopt_long(argc, argv, "abcdehij:klmnopqrstuvxyzABCDEFHIKLMNPQRST", long_options, NULL)) !=-1) {
 
         switch (opt) {
 
@@ -1733,6 +1936,10 @@ main(int argc, char *argv[])
                 field_separator = ' ';
                 break;
 
+            case 'j':
+                num_jobs = get_positive_int(ws_optarg, "number of jobs");
+                break;
+
             case 'h':
                 show_help_header("Print various information (infos) about capture files.");
                 print_usage(stdout);
@@ -1760,15 +1967,18 @@ main(int argc, char *argv[])
 
     if (cap_file_hashes) {
         gcry_check_version(NULL);
-        gcry_md_open(&hd, GCRY_MD_SHA256, 0);
-        if (hd)
-            gcry_md_enable(hd, GCRY_MD_SHA1);
-
-        hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
     }
 
     overall_error_status = 0;
 
+    if (num_jobs > 1 && (argc - ws_optind) > 1) {
+        overall_error_status = process_cap_files_parallel(&argv[ws_optind], argc - ws_optind);
+        goto exit;
+    }
+
+    /* With only one file, use the threads to scan it instead. */
+    index_threads = (unsigned)num_jobs;
+
     for (opt = ws_optind; opt < argc; opt++) {
 
         status = process_cap_file(argv[opt], need_separator);
@@ -1789,8 +1999,6 @@ main(int argc, char *argv[])
     }
 
 exit:
-    g_free(hash_buf);
-    gcry_md_close(hd);
     wtap_cleanup();
     free_progdirs();
     return overall_error_status;
@@ -56,6 +56,40 @@ static bool filters_enabled = true;
  */
 static bool tmp_colors_set;
 
+/* The compiled filters of the enabled entries in color_filter_list,
+ * applied together so that fields they share are read only once.
+ * Rebuilt on the next packet after the list changes. */
+static dfilter_group_t *color_filter_group;
+static GPtrArray *color_filter_group_entries;
+
+static void
+color_filters_group_invalidate(void)
+{
+    dfilter_group_free(color_filter_group);
+    color_filter_group = NULL;
+    if (color_filter_group_entries) {
+        g_ptr_array_free(color_filter_group_entries, true);
+        color_filter_group_entries = NULL;
+    }
+}
+
+static void
+color_filters_group_build(void)
+{
+    GSList         *curr;
+    color_filter_t *colorf;
+
+    color_filter_group = dfilter_group_new();
+    color_filter_group_entries = g_ptr_array_new();
+    for (curr = color_filter_list; curr != NULL; curr = g_slist_next(curr)) {
+        colorf = (color_filter_t *)curr->data;
+        if ((!colorf->disabled) && (colorf->c_colorfilter != NULL)) {
+            dfilter_group_add(color_filter_group, colorf->c_colorfilter);
+            g_ptr_array_add(color_filter_group_entries, colorf);
+        }
+    }
+}
+
 /* Create a new filter */
 color_filter_t *
 color_filter_new(const char *name,          /* The name of the filter to create */
@@ -187,6 +221,7 @@ color_filters_set_tmp(uint8_t filt_nr, const char *filter, bool disabled, char *
                 g_free(name);
                 return false;
             } else {
+                color_filters_group_invalidate();
                 g_free(colorf->filter_text);
                 dfilter_free(colorf->c_colorfilter);
                 colorf->filter_text = g_strdup(tmpfilter);
@@ -351,6 +386,7 @@ bool
 color_filters_init(char** err_msg, color_filter_add_cb_func add_cb)
 {
     /* delete all currently existing filters */
+    color_filters_group_invalidate();
     color_filter_list_delete(&color_filter_list);
 
     /* now try to construct the filters list */
@@ -360,6 +396,8 @@ color_filters_init(char** err_msg, color_filter_add_cb_func add_cb)
 bool
 color_filters_reload(char** err_msg, color_filter_add_cb_func add_cb)
 {
+    color_filters_group_invalidate();
+
     /* "move" old entries to the deleted list
      * we must keep them until the dissection no longer needs them */
     color_filter_deleted_list = g_slist_concat(color_filter_deleted_list, color_filter_list);
@@ -458,6 +496,8 @@ color_filters_apply(GSList *tmp_cfl, GSList *edit_cfl, char** err_msg)
 
     *err_msg = NULL;
 
+    color_filters_group_invalidate();
+
     /* "move" old entries to the deleted list
      * we must keep them until the dissection no longer needs them */
     color_filter_deleted_list = g_slist_concat(color_filter_deleted_list, color_filter_list);
@@ -569,21 +609,16 @@ color_filters_use_proto(int proto_id)
 const color_filter_t *
 color_filters_colorize_packet(epan_dissect_t *edt)
 {
-    GSList         *curr;
-    color_filter_t *colorf;
+    int match;
 
     /* If we have color filters, "search" for the matching one. */
     if ((edt->tree != NULL) && (color_filters_used())) {
-        curr = color_filter_list;
-
-        while(curr != NULL) {
-            colorf = (color_filter_t *)curr->data;
-            if ( (!colorf->disabled) &&
-                 (colorf->c_colorfilter != NULL) &&
-                 dfilter_apply_edt(colorf->c_colorfilter, edt)) {
-                return colorf;
-            }
-            curr = g_slist_next(curr);
+        if (color_filter_group == NULL) {
+            color_filters_group_build();
+        }
+        match = dfilter_group_apply_first(color_filter_group, edt);
+        if (match >= 0) {
+            return (color_filter_t *)g_ptr_array_index(color_filter_group_entries, match);
         }
     }
 
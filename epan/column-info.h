@@ -43,6 +43,22 @@ typedef struct {
   int                  field_id;       /**< ID for a single field expression, or 0 */
 } col_custom_t;
 
+/** Kind of value col_fill_in() has stored for a column instead of
+ * formatting it; it's formatted by col_format_pending() when the column
+ * is read.
+ */
+typedef enum {
+  COL_PENDING_NONE,         /**< col_data is up to date */
+  COL_PENDING_ADDR,         /**< Address in pending_addr */
+  COL_PENDING_PORT,         /**< Port in pending_port */
+  COL_PENDING_FRAME_DATA    /**< Field of the frame_data in pending_fd */
+} col_pending_t;
+
+/** Longest address that is kept for lazy formatting; longer ones are
+ * formatted right away.
+ */
+#define COL_PENDING_ADDR_LEN 32
+
 /** Individual column info */
 typedef struct {
   int                 col_fmt;              /**< Format of column */
@@ -57,6 +73,14 @@ typedef struct {
   int                 col_fence;            /**< Stuff in column buffer before this index is immutable */
   bool                writable;             /**< writable or not */
   int                 hf_id;
+  col_pending_t       pending;              /**< Value waiting to be formatted into col_data */
+  address             pending_addr;         /**< Address to format; its data is in pending_addr_data */
+  uint8_t             pending_addr_data[COL_PENDING_ADDR_LEN];
+  port_type           pending_ptype;        /**< Port type of pending_port */
+  uint32_t            pending_port;         /**< Port to format */
+  bool                pending_is_src;       /**< pending_addr or pending_port is a source */
+  bool                pending_res;          /**< Resolve pending_addr or pending_port */
+  const frame_data   *pending_fd;           /**< Frame to format the column from */
 } col_item_t;
 
 /** Column info */
@@ -90,9 +114,16 @@ extern void col_init(column_info *cinfo, const struct epan_session *epan);
 WS_DLL_PUBLIC void col_fill_in_frame_data(const frame_data *fd, column_info *cinfo, const int col, bool const fill_col_exprs);
 
 /** Fill in all (non-custom) columns of the given packet.
+ * Unless fill_col_exprs is set, address, port and frame_data based
+ * columns only store their value; it's formatted when the column is
+ * read with get_column_text().
  */
 WS_DLL_PUBLIC void col_fill_in(packet_info *pinfo, const bool fill_col_exprs, const bool fill_fd_colums);
 
+/** Format the value col_fill_in() stored for a column, if any.
+ */
+extern void col_format_pending(column_info *cinfo, const int col);
+
 /** Fill in columns if we got an error reading the packet.
  * We set most columns to "???", and set the Info column to an error
  * message.
@@ -155,6 +155,7 @@ col_init(column_info *cinfo, const struct epan_session *epan)
     col_item->col_data = col_item->col_buf;
     col_item->col_fence = 0;
     col_item->writable = true;
+    col_item->pending = COL_PENDING_NONE;
     cinfo->col_expr.col_expr[i] = "";
     cinfo->col_expr.col_expr_val[i][0] = '\0';
   }
@@ -265,6 +266,7 @@ col_get_text(column_info *cinfo, const int el)
   for (i = cinfo->col_first[el]; i <= cinfo->col_last[el]; i++) {
     col_item = &cinfo->columns[i];
     if (col_item->fmt_matx[el]) {
+      col_format_pending(cinfo, i);
       text = (col_item->col_data);
     }
   }
@@ -1670,16 +1672,11 @@ col_set_time(column_info *cinfo, const int el, const nstime_t *ts, const char *f
 }
 
 static void
-col_set_addr(packet_info *pinfo, const int col, const address *addr, const bool is_src,
-             const bool fill_col_exprs, const bool res)
+col_format_addr(column_info *cinfo, const int col, const address *addr, const bool is_src,
+                const bool fill_col_exprs, const bool res)
 {
   const char *name;
-  col_item_t* col_item = &pinfo->cinfo->columns[col];
-
-  if (addr->type == AT_NONE) {
-    /* No address, nothing to do */
-    return;
-  }
+  col_item_t* col_item = &cinfo->columns[col];
 
   if (res && (name = address_to_name(addr)) != NULL)
     col_item->col_data = name;
@@ -1691,100 +1688,133 @@ col_set_addr(packet_info *pinfo, const int col, const address *addr, const bool
   if (!fill_col_exprs)
     return;
 
-  pinfo->cinfo->col_expr.col_expr[col] = address_type_column_filter_string(addr, is_src);
+  cinfo->col_expr.col_expr[col] = address_type_column_filter_string(addr, is_src);
   /* For address types that have a filter, create a string */
-  if (strlen(pinfo->cinfo->col_expr.col_expr[col]) > 0) {
-    address_to_str_buf(addr, pinfo->cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
+  if (strlen(cinfo->col_expr.col_expr[col]) > 0) {
+    address_to_str_buf(addr, cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
   } else {
     /* For address types that don't, use the internal column FT_STRING hfi */
-    pinfo->cinfo->col_expr.col_expr[col] = proto_registrar_get_nth(col_item->hf_id)->abbrev;
-    (void) g_strlcpy(pinfo->cinfo->col_expr.col_expr_val[col], pinfo->cinfo->columns[col].col_data, COL_MAX_LEN);
+    cinfo->col_expr.col_expr[col] = proto_registrar_get_nth(col_item->hf_id)->abbrev;
+    (void) g_strlcpy(cinfo->col_expr.col_expr_val[col], cinfo->columns[col].col_data, COL_MAX_LEN);
   }
 }
 
-/* ------------------------ */
 static void
-col_set_port(packet_info *pinfo, const int col, const bool is_res, const bool is_src, const bool fill_col_exprs _U_)
+col_set_addr(packet_info *pinfo, const int col, const address *addr, const bool is_src,
+             const bool fill_col_exprs, const bool res)
 {
-  uint32_t port;
   col_item_t* col_item = &pinfo->cinfo->columns[col];
 
-  if (is_src)
-    port = pinfo->srcport;
-  else
-    port = pinfo->destport;
+  if (addr->type == AT_NONE) {
+    /* No address, nothing to do */
+    return;
+  }
 
-  /* TODO: Use fill_col_exprs */
+  /*
+   * Unless the filter expression is wanted now, keep a copy of the
+   * address and only format it if the column is read.
+   */
+  if (!fill_col_exprs && addr->len <= COL_PENDING_ADDR_LEN) {
+    if (addr->len > 0)
+      memcpy(col_item->pending_addr_data, addr->data, addr->len);
+    set_address(&col_item->pending_addr, addr->type, addr->len,
+                addr->len > 0 ? col_item->pending_addr_data : NULL);
+    col_item->pending_is_src = is_src;
+    col_item->pending_res = res;
+    col_item->pending = COL_PENDING_ADDR;
+    return;
+  }
+
+  col_item->pending = COL_PENDING_NONE;
+  col_format_addr(pinfo->cinfo, col, addr, is_src, fill_col_exprs, res);
+}
 
-  switch (pinfo->ptype) {
+/* ------------------------ */
+static void
+col_format_port(column_info *cinfo, const int col, const port_type ptype, const uint32_t port,
+                const bool is_res, const bool is_src)
+{
+  col_item_t* col_item = &cinfo->columns[col];
+  char *name;
+
+  switch (ptype) {
   case PT_SCTP:
-    if (is_res)
-      (void) g_strlcpy(col_item->col_buf, sctp_port_to_display(pinfo->pool, port), COL_MAX_LEN);
-    else
+    if (is_res) {
+      name = sctp_port_to_display(NULL, port);
+      (void) g_strlcpy(col_item->col_buf, name, COL_MAX_LEN);
+      wmem_free(NULL, name);
+    } else {
       guint32_to_str_buf(port, col_item->col_buf, COL_MAX_LEN);
+    }
     break;
 
   case PT_TCP:
-    guint32_to_str_buf(port, pinfo->cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
-    if (is_res)
-      (void) g_strlcpy(col_item->col_buf, tcp_port_to_display(pinfo->pool, port), COL_MAX_LEN);
-    else
-      (void) g_strlcpy(col_item->col_buf, pinfo->cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
+    guint32_to_str_buf(port, cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
+    if (is_res) {
+      name = tcp_port_to_display(NULL, port);
+      (void) g_strlcpy(col_item->col_buf, name, COL_MAX_LEN);
+      wmem_free(NULL, name);
+    } else {
+      (void) g_strlcpy(col_item->col_buf, cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
+    }
     if (is_src)
-      pinfo->cinfo->col_expr.col_expr[col] = "tcp.srcport";
+      cinfo->col_expr.col_expr[col] = "tcp.srcport";
     else
-      pinfo->cinfo->col_expr.col_expr[col] = "tcp.dstport";
+      cinfo->col_expr.col_expr[col] = "tcp.dstport";
     break;
 
   case PT_UDP:
-    guint32_to_str_buf(port, pinfo->cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
-    if (is_res)
-      (void) g_strlcpy(col_item->col_buf, udp_port_to_display(pinfo->pool, port), COL_MAX_LEN);
-    else
-      (void) g_strlcpy(col_item->col_buf, pinfo->cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
+    guint32_to_str_buf(port, cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
+    if (is_res) {
+      name = udp_port_to_display(NULL, port);
+      (void) g_strlcpy(col_item->col_buf, name, COL_MAX_LEN);
+      wmem_free(NULL, name);
+    } else {
+      (void) g_strlcpy(col_item->col_buf, cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
+    }
     if (is_src)
-      pinfo->cinfo->col_expr.col_expr[col] = "udp.srcport";
+      cinfo->col_expr.col_expr[col] = "udp.srcport";
     else
-      pinfo->cinfo->col_expr.col_expr[col] = "udp.dstport";
+      cinfo->col_expr.col_expr[col] = "udp.dstport";
     break;
 
   case PT_DDP:
     if (is_src)
-      pinfo->cinfo->col_expr.col_expr[col] = "ddp.src_socket";
+      cinfo->col_expr.col_expr[col] = "ddp.src_socket";
     else
-      pinfo->cinfo->col_expr.col_expr[col] = "ddp.dst_socket";
-    guint32_to_str_buf(port, pinfo->cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
-    (void) g_strlcpy(col_item->col_buf, pinfo->cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
+      cinfo->col_expr.col_expr[col] = "ddp.dst_socket";
+    guint32_to_str_buf(port, cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
+    (void) g_strlcpy(col_item->col_buf, cinfo->col_expr.col_expr_val[col], COL_MAX_LEN);
     break;
 
   case PT_IPX:
     /* XXX - resolve IPX socket numbers */
     snprintf(col_item->col_buf, COL_MAX_LEN, "0x%04x", port);
-    (void) g_strlcpy(pinfo->cinfo->col_expr.col_expr_val[col], col_item->col_buf,COL_MAX_LEN);
+    (void) g_strlcpy(cinfo->col_expr.col_expr_val[col], col_item->col_buf,COL_MAX_LEN);
     if (is_src)
-      pinfo->cinfo->col_expr.col_expr[col] = "ipx.src.socket";
+      cinfo->col_expr.col_expr[col] = "ipx.src.socket";
     else
-      pinfo->cinfo->col_expr.col_expr[col] = "ipx.dst.socket";
+      cinfo->col_expr.col_expr[col] = "ipx.dst.socket";
     break;
 
   case PT_IDP:
     /* XXX - resolve IDP socket numbers */
     snprintf(col_item->col_buf, COL_MAX_LEN, "0x%04x", port);
-    (void) g_strlcpy(pinfo->cinfo->col_expr.col_expr_val[col], col_item->col_buf,COL_MAX_LEN);
+    (void) g_strlcpy(cinfo->col_expr.col_expr_val[col], col_item->col_buf,COL_MAX_LEN);
     if (is_src)
-      pinfo->cinfo->col_expr.col_expr[col] = "idp.src.socket";
+      cinfo->col_expr.col_expr[col] = "idp.src.socket";
     else
-      pinfo->cinfo->col_expr.col_expr[col] = "idp.dst.socket";
+      cinfo->col_expr.col_expr[col] = "idp.dst.socket";
     break;
 
   case PT_USB:
     /* XXX - resolve USB endpoint numbers */
     snprintf(col_item->col_buf, COL_MAX_LEN, "0x%08x", port);
-    (void) g_strlcpy(pinfo->cinfo->col_expr.col_expr_val[col], col_item->col_buf,COL_MAX_LEN);
+    (void) g_strlcpy(cinfo->col_expr.col_expr_val[col], col_item->col_buf,COL_MAX_LEN);
     if (is_src)
-      pinfo->cinfo->col_expr.col_expr[col] = "usb.src.endpoint";
+      cinfo->col_expr.col_expr[col] = "usb.src.endpoint";
     else
-      pinfo->cinfo->col_expr.col_expr[col] = "usb.dst.endpoint";
+      cinfo->col_expr.col_expr[col] = "usb.dst.endpoint";
     break;
 
   default:
@@ -1793,6 +1823,29 @@ col_set_port(packet_info *pinfo, const int col, const bool is_res, const bool is
   col_item->col_data = col_item->col_buf;
 }
 
+static void
+col_set_port(packet_info *pinfo, const int col, const bool is_res, const bool is_src, const bool fill_col_exprs)
+{
+  col_item_t* col_item = &pinfo->cinfo->columns[col];
+
+  col_item->pending_ptype = pinfo->ptype;
+  col_item->pending_port = is_src ? pinfo->srcport : pinfo->destport;
+  col_item->pending_is_src = is_src;
+  col_item->pending_res = is_res;
+
+  /*
+   * The port's filter expression is always filled in along with
+   * the text, so we can only put off formatting if it isn't wanted.
+   */
+  if (!fill_col_exprs) {
+    col_item->pending = COL_PENDING_PORT;
+    return;
+  }
+
+  col_item->pending = COL_PENDING_NONE;
+  col_format_port(pinfo->cinfo, col, col_item->pending_ptype, col_item->pending_port, is_res, is_src);
+}
+
 bool
 col_based_on_frame_data(column_info *cinfo, const int col)
 {
@@ -1825,6 +1878,8 @@ col_fill_in_frame_data(const frame_data *fd, column_info *cinfo, const int col,
 {
   col_item_t* col_item = &cinfo->columns[col];
 
+  col_item->pending = COL_PENDING_NONE;
+
   switch (col_item->col_fmt) {
   case COL_NUMBER:
     guint32_to_str_buf(fd->num, col_item->col_buf, COL_MAX_LEN);
@@ -1906,8 +1961,14 @@ col_fill_in(packet_info *pinfo, const bool fill_col_exprs, const bool fill_fd_co
   for (i = 0; i < pinfo->cinfo->num_cols; i++) {
     col_item = &pinfo->cinfo->columns[i];
     if (col_based_on_frame_data(pinfo->cinfo, i)) {
-      if (fill_fd_colums)
-        col_fill_in_frame_data(pinfo->fd, pinfo->cinfo, i, fill_col_exprs);
+      if (fill_fd_colums) {
+        if (fill_col_exprs) {
+          col_fill_in_frame_data(pinfo->fd, pinfo->cinfo, i, fill_col_exprs);
+        } else {
+          col_item->pending_fd = pinfo->fd;
+          col_item->pending = COL_PENDING_FRAME_DATA;
+        }
+      }
     } else {
       switch (col_item->col_fmt) {
       case COL_DEF_SRC:
@@ -2007,6 +2068,32 @@ col_fill_in(packet_info *pinfo, const bool fill_col_exprs, const bool fill_fd_co
   }
 }
 
+void
+col_format_pending(column_info *cinfo, const int col)
+{
+  col_item_t* col_item = &cinfo->columns[col];
+
+  switch (col_item->pending) {
+  case COL_PENDING_NONE:
+    return;
+
+  case COL_PENDING_ADDR:
+    col_format_addr(cinfo, col, &col_item->pending_addr, col_item->pending_is_src,
+                    false, col_item->pending_res);
+    break;
+
+  case COL_PENDING_PORT:
+    col_format_port(cinfo, col, col_item->pending_ptype, col_item->pending_port,
+                    col_item->pending_res, col_item->pending_is_src);
+    break;
+
+  case COL_PENDING_FRAME_DATA:
+    col_fill_in_frame_data(col_item->pending_fd, cinfo, col, false);
+    break;
+  }
+  col_item->pending = COL_PENDING_NONE;
+}
+
 /*
  * Fill in columns if we got an error reading the packet.
  * We set most columns to "???", fill in columns that don't need data read
@@ -2023,6 +2110,7 @@ col_fill_in_error(column_info *cinfo, frame_data *fdata, const bool fill_col_exp
 
   for (i = 0; i < cinfo->num_cols; i++) {
     col_item = &cinfo->columns[i];
+    col_item->pending = COL_PENDING_NONE;
     if (col_based_on_frame_data(cinfo, i)) {
       if (fill_fd_colums)
         col_fill_in_frame_data(fdata, cinfo, i, fill_col_exprs);
@@ -2087,7 +2175,8 @@ col_dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
     proto_item_set_hidden(ti);
     col_tree = proto_item_add_subtree(ti, ett_cols);
     for (int i = 0; i < cinfo->num_cols; ++i) {
-      if (cinfo->columns[i].hf_id != -1) {
+      /* Only format the columns that are wanted, e.g. by a filter or -e. */
+      if (cinfo->columns[i].hf_id != -1 && proto_field_is_referenced(col_tree, cinfo->columns[i].hf_id)) {
         if (cinfo->columns[i].col_fmt == COL_CUSTOM) {
           ti = proto_tree_add_string_format(col_tree, cinfo->columns[i].hf_id, tvb, 0, 0, get_column_text(cinfo, i), "%s: %s", get_column_title(i), get_column_text(cinfo, i));
         } else {
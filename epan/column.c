@@ -1021,6 +1021,8 @@ get_column_text(column_info *cinfo, const int col)
   ws_assert(cinfo);
   ws_assert(col < cinfo->num_cols);
 
+  col_format_pending(cinfo, col);
+
   if (!get_column_resolved(col) && cinfo->col_expr.col_expr_val[col]) {
       /* Use the unresolved value in col_expr_val */
       return cinfo->col_expr.col_expr_val[col];
@@ -1077,6 +1079,7 @@ col_finalize(column_info *cinfo)
     col_item->fmt_matx = g_new0(bool, NUM_COL_FMTS);
     get_column_format_matches(col_item->fmt_matx, col_item->col_fmt);
     col_item->col_data = NULL;
+    col_item->pending = COL_PENDING_NONE;
 
     if (col_item->col_fmt == COL_INFO) {
       col_item->col_buf = g_new(char, COL_MAX_INFO_LEN);
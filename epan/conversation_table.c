@@ -320,6 +320,166 @@ void reset_hostlist_table_data(conv_hash_t *ch)
     reset_endpoint_table_data(ch);
 }
 
+void *split_conversation_table_data(void *tapdata)
+{
+    conv_hash_t *ch = (conv_hash_t *)tapdata;
+    conv_hash_t *partial = g_new0(conv_hash_t, 1);
+
+    partial->user_data = ch->user_data;
+    partial->flags = ch->flags;
+    return partial;
+}
+
+void merge_conversation_table_data(void *tapdata, void *partial_tapdata)
+{
+    conv_hash_t *ch = (conv_hash_t *)tapdata;
+    conv_hash_t *partial = (conv_hash_t *)partial_tapdata;
+
+    if (partial->conv_array != NULL) {
+        for (guint i = 0; i < partial->conv_array->len; i++) {
+            conv_item_t *part_item = &g_array_index(partial->conv_array, conv_item_t, i);
+            conv_item_t *conv_item;
+            guint prev_len = ch->conv_array ? ch->conv_array->len : 0;
+
+            /* Look the conversation up (or add it) without counting anything. */
+            ch->flags = TL_DISPLAY_FILTER_IGNORED;
+            conv_item = add_conversation_table_data_with_conv_id(ch,
+                    &part_item->src_address, &part_item->dst_address,
+                    part_item->src_port, part_item->dst_port, part_item->conv_id,
+                    0, 0, NULL, NULL, part_item->dissector_info, part_item->ctype);
+
+            if (ch->conv_array->len > prev_len) {
+                /* New here; take it over as it is, but keep the addresses
+                 * the hash table key points to. */
+                address src_address = conv_item->src_address;
+                address dst_address = conv_item->dst_address;
+
+                free_address(&part_item->src_address);
+                free_address(&part_item->dst_address);
+                *conv_item = *part_item;
+                conv_item->src_address = src_address;
+                conv_item->dst_address = dst_address;
+                continue;
+            }
+
+            if (addresses_equal(&part_item->src_address, &conv_item->src_address) &&
+                part_item->src_port == conv_item->src_port) {
+                conv_item->rx_frames += part_item->rx_frames;
+                conv_item->tx_frames += part_item->tx_frames;
+                conv_item->rx_bytes += part_item->rx_bytes;
+                conv_item->tx_bytes += part_item->tx_bytes;
+                conv_item->rx_frames_total += part_item->rx_frames_total;
+                conv_item->tx_frames_total += part_item->tx_frames_total;
+                conv_item->rx_bytes_total += part_item->rx_bytes_total;
+                conv_item->tx_bytes_total += part_item->tx_bytes_total;
+            } else {
+                /* Same conversation, seen from the other end first. */
+                conv_item->rx_frames += part_item->tx_frames;
+                conv_item->tx_frames += part_item->rx_frames;
+                conv_item->rx_bytes += part_item->tx_bytes;
+                conv_item->tx_bytes += part_item->rx_bytes;
+                conv_item->rx_frames_total += part_item->tx_frames_total;
+                conv_item->tx_frames_total += part_item->rx_frames_total;
+                conv_item->rx_bytes_total += part_item->tx_bytes_total;
+                conv_item->tx_bytes_total += part_item->rx_bytes_total;
+            }
+
+            if (!nstime_is_unset(&part_item->start_time)) {
+                if (nstime_is_unset(&conv_item->start_time) ||
+                    nstime_cmp(&part_item->start_time, &conv_item->start_time) < 0) {
+                    conv_item->start_time = part_item->start_time;
+                    conv_item->start_abs_time = part_item->start_abs_time;
+                }
+                if (nstime_is_unset(&conv_item->stop_time) ||
+                    nstime_cmp(&part_item->stop_time, &conv_item->stop_time) > 0) {
+                    conv_item->stop_time = part_item->stop_time;
+                }
+            }
+            conv_item->filtered = conv_item->filtered && part_item->filtered;
+            /* Later parts have the more recent flow count. */
+            conv_item->ext_tcp = part_item->ext_tcp;
+            free_address(&part_item->src_address);
+            free_address(&part_item->dst_address);
+        }
+
+        /* The addresses now belong to ch, or were freed above. */
+        g_array_free(partial->conv_array, TRUE);
+        partial->conv_array = NULL;
+        ch->flags = partial->flags;
+    }
+
+    if (partial->hashtable != NULL) {
+        g_hash_table_destroy(partial->hashtable);
+    }
+    g_free(partial);
+}
+
+void *split_endpoint_table_data(void *tapdata)
+{
+    return split_conversation_table_data(tapdata);
+}
+
+void merge_endpoint_table_data(void *tapdata, void *partial_tapdata)
+{
+    conv_hash_t *ch = (conv_hash_t *)tapdata;
+    conv_hash_t *partial = (conv_hash_t *)partial_tapdata;
+
+    if (partial->conv_array != NULL) {
+        for (guint i = 0; i < partial->conv_array->len; i++) {
+            endpoint_item_t *part_item = &g_array_index(partial->conv_array, endpoint_item_t, i);
+            endpoint_item_t *endpoint_item = NULL;
+            address myaddress;
+
+            if (ch->hashtable != NULL) {
+                endpoint_key_t existing_key;
+                gpointer endpoint_idx_hash_val;
+
+                copy_address_shallow(&existing_key.myaddress, &part_item->myaddress);
+                existing_key.port = part_item->port;
+                if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &endpoint_idx_hash_val)) {
+                    endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, GPOINTER_TO_UINT(endpoint_idx_hash_val));
+                }
+            }
+
+            if (endpoint_item == NULL) {
+                /* New here; add it without counting anything and then
+                 * take it over as it is. */
+                ch->flags = TL_DISPLAY_FILTER_IGNORED;
+                add_endpoint_table_data(ch, &part_item->myaddress, part_item->port, TRUE, 0, 0,
+                        part_item->dissector_info, part_item->etype);
+                endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, ch->conv_array->len - 1);
+                myaddress = endpoint_item->myaddress;
+                free_address(&part_item->myaddress);
+                *endpoint_item = *part_item;
+                endpoint_item->myaddress = myaddress;
+                continue;
+            }
+
+            endpoint_item->rx_frames += part_item->rx_frames;
+            endpoint_item->tx_frames += part_item->tx_frames;
+            endpoint_item->rx_bytes += part_item->rx_bytes;
+            endpoint_item->tx_bytes += part_item->tx_bytes;
+            endpoint_item->rx_frames_total += part_item->rx_frames_total;
+            endpoint_item->tx_frames_total += part_item->tx_frames_total;
+            endpoint_item->rx_bytes_total += part_item->rx_bytes_total;
+            endpoint_item->tx_bytes_total += part_item->tx_bytes_total;
+            endpoint_item->modified = TRUE;
+            endpoint_item->filtered = endpoint_item->filtered && part_item->filtered;
+            free_address(&part_item->myaddress);
+        }
+
+        /* The addresses now belong to ch, or were freed above. */
+        g_array_free(partial->conv_array, TRUE);
+        partial->conv_array = NULL;
+        ch->flags = partial->flags;
+    }
+
+    if (partial->hashtable != NULL) {
+        g_hash_table_destroy(partial->hashtable);
+    }
+    g_free(partial);
+}
+
 char *get_conversation_address(wmem_allocator_t *allocator, address *addr, gboolean resolve_names)
 {
     if (resolve_names) {
@@ -270,6 +270,40 @@ WS_DLL_PUBLIC void reset_endpoint_table_data(conv_hash_t *ch);
 G_DEPRECATED_FOR(reset_endpoint_table_data)
 WS_DLL_PUBLIC void reset_hostlist_table_data(conv_hash_t *ch);
 
+/** Create an empty conversation table with the same settings, for use
+ * as a tap_split_cb with set_tap_listener_merge().
+ *
+ * @param tapdata the conv_hash_t given to register_tap_listener
+ * @return a new conv_hash_t
+ */
+WS_DLL_PUBLIC void *split_conversation_table_data(void *tapdata);
+
+/** Add the conversations in a table created by
+ * split_conversation_table_data() to the original table and free it.
+ * For use as a tap_merge_cb with set_tap_listener_merge().
+ *
+ * @param tapdata the conv_hash_t given to register_tap_listener
+ * @param partial_tapdata the table to merge and free
+ */
+WS_DLL_PUBLIC void merge_conversation_table_data(void *tapdata, void *partial_tapdata);
+
+/** Create an empty endpoint table with the same settings, for use
+ * as a tap_split_cb with set_tap_listener_merge().
+ *
+ * @param tapdata the conv_hash_t given to register_tap_listener
+ * @return a new conv_hash_t
+ */
+WS_DLL_PUBLIC void *split_endpoint_table_data(void *tapdata);
+
+/** Add the endpoints in a table created by split_endpoint_table_data()
+ * to the original table and free it. For use as a tap_merge_cb with
+ * set_tap_listener_merge().
+ *
+ * @param tapdata the conv_hash_t given to register_tap_listener
+ * @param partial_tapdata the table to merge and free
+ */
+WS_DLL_PUBLIC void merge_endpoint_table_data(void *tapdata, void *partial_tapdata);
+
 /** Initialize dissector conversation for stats and (possibly) GUI.
  *
  * @param opt_arg filter string to compare with dissector
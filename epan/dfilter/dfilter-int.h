@@ -47,6 +47,9 @@ struct epan_dfilter {
 	/* Used to pass arguments to functions. List of Lists (list of registers). */
 	GSList		*function_stack;
 	GSList		*set_stack;
+	/* Fields already read from the tree by other filters in the same
+	 * dfilter_group_t (hfinfo -> GPtrArray of fvalues), or NULL. */
+	GHashTable	*shared_reads;
 };
 
 typedef struct {
@@ -702,6 +702,123 @@ dfilter_apply_full(dfilter_t *df, proto_tree *tree, GPtrArray **fvals)
 	return dfvm_apply_full(df, tree, fvals);
 }
 
+#define GROUP_RESULT_UNKNOWN	-1
+
+struct epan_dfilter_group {
+	GPtrArray	*filters;	/* dfilter_t *, not owned */
+	GArray		*same_as;	/* Index of the first filter with the same text */
+	GArray		*results;	/* int8_t: GROUP_RESULT_UNKNOWN, 0 or 1 */
+	GHashTable	*reads;		/* Fields read for the current packet */
+};
+
+dfilter_group_t *
+dfilter_group_new(void)
+{
+	dfilter_group_t *group = g_new(dfilter_group_t, 1);
+
+	group->filters = g_ptr_array_new();
+	group->same_as = g_array_new(false, false, sizeof(unsigned));
+	group->results = g_array_new(false, false, sizeof(int8_t));
+	group->reads = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+					NULL, (GDestroyNotify)g_ptr_array_unref);
+	return group;
+}
+
+void
+dfilter_group_free(dfilter_group_t *group)
+{
+	if (!group)
+		return;
+
+	g_ptr_array_free(group->filters, true);
+	g_array_free(group->same_as, true);
+	g_array_free(group->results, true);
+	g_hash_table_destroy(group->reads);
+	g_free(group);
+}
+
+unsigned
+dfilter_group_add(dfilter_group_t *group, dfilter_t *df)
+{
+	unsigned idx = group->filters->len;
+	unsigned same_as = idx;
+	int8_t unknown = GROUP_RESULT_UNKNOWN;
+	dfilter_t *other;
+
+	if (df->expanded_text) {
+		for (unsigned i = 0; i < group->filters->len; i++) {
+			other = g_ptr_array_index(group->filters, i);
+			if (other->expanded_text &&
+					strcmp(other->expanded_text, df->expanded_text) == 0) {
+				same_as = i;
+				break;
+			}
+		}
+	}
+
+	g_ptr_array_add(group->filters, df);
+	g_array_append_val(group->same_as, same_as);
+	g_array_append_val(group->results, unknown);
+	return idx;
+}
+
+unsigned
+dfilter_group_size(const dfilter_group_t *group)
+{
+	return group->filters->len;
+}
+
+bool
+dfilter_group_test(dfilter_group_t *group, unsigned idx, epan_dissect_t *edt)
+{
+	dfilter_t *df;
+	int8_t *result;
+
+	ws_assert(idx < group->filters->len);
+
+	idx = g_array_index(group->same_as, unsigned, idx);
+	result = &g_array_index(group->results, int8_t, idx);
+	if (*result == GROUP_RESULT_UNKNOWN) {
+		df = g_ptr_array_index(group->filters, idx);
+		df->shared_reads = group->reads;
+		*result = dfvm_apply(df, edt->tree);
+		df->shared_reads = NULL;
+	}
+	return *result;
+}
+
+void
+dfilter_group_reset(dfilter_group_t *group)
+{
+	if (group->results->len > 0)
+		memset(group->results->data, GROUP_RESULT_UNKNOWN, group->results->len);
+	g_hash_table_remove_all(group->reads);
+}
+
+void
+dfilter_group_apply(dfilter_group_t *group, epan_dissect_t *edt, bool *results)
+{
+	for (unsigned i = 0; i < group->filters->len; i++) {
+		results[i] = dfilter_group_test(group, i, edt);
+	}
+	dfilter_group_reset(group);
+}
+
+int
+dfilter_group_apply_first(dfilter_group_t *group, epan_dissect_t *edt)
+{
+	int match = -1;
+
+	for (unsigned i = 0; i < group->filters->len; i++) {
+		if (dfilter_group_test(group, i, edt)) {
+			match = i;
+			break;
+		}
+	}
+	dfilter_group_reset(group);
+	return match;
+}
+
 void
 dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree)
 {
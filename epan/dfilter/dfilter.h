@@ -131,6 +131,54 @@ dfilter_apply(dfilter_t *df, proto_tree *tree);
 bool
 dfilter_apply_full(dfilter_t *df, proto_tree *tree, GPtrArray **fvals);
 
+/* A group of compiled dfilters that are applied to the same packets,
+ * e.g. the coloring rules. A field that several of the filters use is
+ * read from the tree only once per packet, and filters with the same
+ * text are only evaluated once. The group doesn't own the filters. */
+typedef struct epan_dfilter_group dfilter_group_t;
+
+WS_DLL_PUBLIC
+dfilter_group_t *
+dfilter_group_new(void);
+
+WS_DLL_PUBLIC
+void
+dfilter_group_free(dfilter_group_t *group);
+
+/* Add a filter to the group. Returns its index in the group. */
+WS_DLL_PUBLIC
+unsigned
+dfilter_group_add(dfilter_group_t *group, dfilter_t *df);
+
+WS_DLL_PUBLIC
+unsigned
+dfilter_group_size(const dfilter_group_t *group);
+
+/* Apply one filter of the group to the current packet. The result, and
+ * the fields read to get it, are kept for the other filters of the
+ * group until dfilter_group_reset() is called. */
+WS_DLL_PUBLIC
+bool
+dfilter_group_test(dfilter_group_t *group, unsigned idx, struct epan_dissect *edt);
+
+/* Forget the results and fields of the current packet. Must be
+ * called before the tree is freed. */
+WS_DLL_PUBLIC
+void
+dfilter_group_reset(dfilter_group_t *group);
+
+/* Apply all filters of the group, storing one result per filter
+ * in results. */
+WS_DLL_PUBLIC
+void
+dfilter_group_apply(dfilter_group_t *group, struct epan_dissect *edt, bool *results);
+
+/* Apply the filters of the group in order until one matches.
+ * Returns the index of that filter, or -1 if none matches. */
+WS_DLL_PUBLIC
+int
+dfilter_group_apply_first(dfilter_group_t *group, struct epan_dissect *edt);
+
 /* Prime a proto_tree using the fields/protocols used in a dfilter. */
 void
 dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree);
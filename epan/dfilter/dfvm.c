@@ -913,6 +913,16 @@ read_tree(dfilter_t *df, proto_tree *tree,
 		return !df_cell_is_empty(rp);
 	}
 
+	/* Already loaded by another filter in the same group? Only whole
+	 * fields are shared; layer ranges and raw bytes are read each time. */
+	if (df->shared_reads && !raw && !range) {
+		GPtrArray *fvals = g_hash_table_lookup(df->shared_reads, arg1->value.hfinfo);
+		if (fvals) {
+			rp->array = g_ptr_array_ref(fvals);
+			return !df_cell_is_empty(rp);
+		}
+	}
+
 	if (raw) {
 		df_cell_init(rp, true);
 	}
@@ -926,6 +936,10 @@ read_tree(dfilter_t *df, proto_tree *tree,
 		hfinfo = hfinfo->same_name_next;
 	}
 
+	if (df->shared_reads && !raw && !range) {
+		g_hash_table_insert(df->shared_reads, arg1->value.hfinfo, df_cell_ref(rp));
+	}
+
 	return !df_cell_is_empty(rp);
 }
 
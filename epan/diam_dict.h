@@ -70,4 +70,11 @@ extern void ddict_print(FILE* fh, ddict_t* d);
 extern ddict_t* ddict_scan(const char* directory, const char* filename, int dbg);
 extern void ddict_free(ddict_t* d);
 
+/*
+ * Like ddict_scan(), but keeps a binary copy of the dictionary in
+ * "cache_path" and loads it from there when no file of the dictionary
+ * directory changed. A NULL cache_path just scans the dictionary.
+ */
+extern ddict_t* ddict_load(const char* directory, const char* filename, const char* cache_path, int dbg);
+
 #endif
@@ -73,7 +73,7 @@ void proto_register_lppe(void) {
   register_dissector("lppe", dissect_OMA_LPPe_MessageExtension_PDU, proto_lppe);
 
   /* Register fields and subtrees */
-  proto_register_field_array(proto_lppe, hf, array_length(hf));
+  proto_register_field_array_lazy(proto_lppe, hf, array_length(hf));
   proto_register_subtree_array(ett, array_length(ett));
 
 
@@ -36,6 +36,8 @@
 
 #include "config.h"
 
+#include <errno.h>
+
 #include <epan/packet.h>
 #include <epan/exceptions.h>
 #include <epan/prefs.h>
@@ -135,8 +137,21 @@ struct _diam_avp_t {
 #define VND_AVP_VS(v)      ((value_string *)(void *)(wmem_array_get_raw((v)->vs_avps)))
 #define VND_AVP_VS_LEN(v)  (wmem_array_get_count((v)->vs_avps))
 
+/*
+ * AVPs are looked up for every AVP of every message, so they are kept in
+ * an open-addressed table keyed by code and vendor. It is sized to at
+ * least twice the number of AVPs in the dictionary when the dictionary is
+ * loaded and is never modified afterwards.
+ */
+typedef struct _diam_avp_slot_t {
+	guint32 code;
+	guint32 vendor;
+	diam_avp_t *avp;
+} diam_avp_slot_t;
+
 typedef struct _diam_dictionary_t {
-	wmem_tree_t *avps;
+	diam_avp_slot_t *avps;
+	guint32 avps_mask;
 	wmem_tree_t *vnds;
 	value_string_ext *applications;
 	value_string *commands;
@@ -187,7 +202,7 @@ static diam_vnd_t unknown_vendor = { 0xffffffff, NULL, NULL };
 static diam_vnd_t no_vnd = { 0, NULL, NULL };
 static diam_avp_t unknown_avp = {0, &unknown_vendor, simple_avp, -1, -1, NULL };
 static const value_string *cmd_vs;
-static diam_dictionary_t dictionary = { NULL, NULL, NULL, NULL };
+static diam_dictionary_t dictionary = { NULL, 0, NULL, NULL, NULL };
 static struct _build_dict build_dict;
 static const value_string *vnd_short_vs;
 static dissector_handle_t data_handle;
@@ -782,6 +797,50 @@ call_avp_subdissector(guint32 vendorid, guint32 code, tvbuff_t *subtvb, packet_i
 	ENDTRY;
 }
 
+static inline guint32
+diam_avp_hash(guint32 code, guint32 vendor)
+{
+	guint32 h = (code * 0x9e3779b1U) ^ (vendor * 0x85ebca6bU);
+
+	return h ^ (h >> 16);
+}
+
+static diam_avp_t *
+diam_avp_lookup(guint32 code, guint32 vendor)
+{
+	guint32 i;
+
+	if (!dictionary.avps)
+		return NULL;
+
+	for (i = diam_avp_hash(code, vendor) & dictionary.avps_mask;
+	     dictionary.avps[i].avp;
+	     i = (i + 1) & dictionary.avps_mask) {
+		if (dictionary.avps[i].code == code && dictionary.avps[i].vendor == vendor)
+			return dictionary.avps[i].avp;
+	}
+
+	return NULL;
+}
+
+/* A later definition of the same AVP replaces the earlier one. */
+static void
+diam_avp_insert(guint32 code, guint32 vendor, diam_avp_t *avp)
+{
+	guint32 i;
+
+	for (i = diam_avp_hash(code, vendor) & dictionary.avps_mask;
+	     dictionary.avps[i].avp;
+	     i = (i + 1) & dictionary.avps_mask) {
+		if (dictionary.avps[i].code == code && dictionary.avps[i].vendor == vendor)
+			break;
+	}
+
+	dictionary.avps[i].code = code;
+	dictionary.avps[i].vendor = vendor;
+	dictionary.avps[i].avp = avp;
+}
+
 /* Dissect an AVP at offset */
 static int
 dissect_diameter_avp(diam_ctx_t *c, tvbuff_t *tvb, int offset, diam_sub_dis_t *diam_sub_dis_inf, gboolean update_col_info)
@@ -792,7 +851,6 @@ dissect_diameter_avp(diam_ctx_t *c, tvbuff_t *tvb, int offset, diam_sub_dis_t *d
 	guint32 flags_bits_idx = (len & 0xE0000000) >> 29;
 	guint32 flags_bits     = (len & 0xFF000000) >> 24;
 	guint32 vendorid       = vendor_flag ? tvb_get_ntohl(tvb,offset+8) : 0 ;
-	wmem_tree_key_t k[3];
 	diam_avp_t *a;
 	proto_item *pi, *avp_item;
 	proto_tree *avp_tree, *save_tree;
@@ -802,16 +860,7 @@ dissect_diameter_avp(diam_ctx_t *c, tvbuff_t *tvb, int offset, diam_sub_dis_t *d
 	const char *avp_str = NULL;
 	guint8 pad_len;
 
-	k[0].length = 1;
-	k[0].key = &code;
-
-	k[1].length = 1;
-	k[1].key = &vendorid;
-
-	k[2].length = 0;
-	k[2].key = NULL;
-
-	a = (diam_avp_t *)wmem_tree_lookup32_array(dictionary.avps,k);
+	a = diam_avp_lookup(code, vendorid);
 
 	len &= 0x00ffffff;
 	pad_len =  (len % 4) ? 4 - (len % 4) : 0 ;
@@ -2094,7 +2143,11 @@ dictionary_load(void)
 	ddict_avp_t *a;
 	gboolean do_debug_parser = getenv("WIRESHARK_DEBUG_DIAM_DICT_PARSER") ? TRUE : FALSE;
 	gboolean do_dump_dict = getenv("WIRESHARK_DUMP_DIAM_DICT") ? TRUE : FALSE;
+	gboolean do_cache_dict = getenv("WIRESHARK_DIAM_DICT_NO_CACHE") ? FALSE : TRUE;
 	char *dir;
+	char *cache_path = NULL;
+	char *cache_dir;
+	guint32 avps_size;
 	const avp_type_t *type;
 	const avp_type_t *octetstring = &basic_types[0];
 	diam_avp_t *avp;
@@ -2110,7 +2163,6 @@ dictionary_load(void)
 	build_dict.avps = g_hash_table_new(strcase_hash,strcase_equal);
 
 	dictionary.vnds = wmem_tree_new(wmem_epan_scope());
-	dictionary.avps = wmem_tree_new(wmem_epan_scope());
 
 	unknown_vendor.vs_avps = wmem_array_new(wmem_epan_scope(), sizeof(value_string));
 	wmem_array_set_null_terminator(unknown_vendor.vs_avps);
@@ -2129,8 +2181,22 @@ dictionary_load(void)
 
 	/* load the dictionary */
 	dir = wmem_strdup_printf(NULL, "%s" G_DIR_SEPARATOR_S "diameter" G_DIR_SEPARATOR_S, get_datafile_dir());
-	d = ddict_scan(dir,"dictionary.xml",do_debug_parser);
+	if (do_cache_dict) {
+		/*
+		 * The cache goes in the personal configuration directory (not
+		 * the profile's), but we don't create that just for the cache.
+		 */
+		cache_path = get_persconffile_path("diameter_dictionary.cache", FALSE);
+		cache_dir = g_path_get_dirname(cache_path);
+		if (test_for_directory(cache_dir) != EISDIR) {
+			g_free(cache_path);
+			cache_path = NULL;
+		}
+		g_free(cache_dir);
+	}
+	d = ddict_load(dir,"dictionary.xml",cache_path,do_debug_parser);
 	wmem_free(NULL, dir);
+	g_free(cache_path);
 	if (d == NULL) {
 		g_hash_table_destroy(vendors);
 		g_array_free(vnd_shrt_arr, TRUE);
@@ -2140,6 +2206,13 @@ dictionary_load(void)
 
 	if (do_dump_dict) ddict_print(stdout, d);
 
+	/* Size the AVP table for a load factor of at most one half */
+	for (avps_size = 0, a = d->avps; a; a = a->next)
+		avps_size++;
+	avps_size = 1U << g_bit_storage(MAX(16, 2 * avps_size) - 1);
+	dictionary.avps = wmem_alloc0_array(wmem_epan_scope(), diam_avp_slot_t, avps_size);
+	dictionary.avps_mask = avps_size - 1;
+
 	/* populate the types */
 	for (t = d->typedefns; t; t = t->next) {
 		const avp_type_t *parent = NULL;
@@ -2315,18 +2388,7 @@ dictionary_load(void)
 		if (avp != NULL) {
 			g_hash_table_insert(build_dict.avps, a->name, avp);
 
-			{
-				wmem_tree_key_t k[3];
-
-				k[0].length = 1;
-				k[0].key	= &(a->code);
-				k[1].length = 1;
-				k[1].key	= &(vnd->code);
-				k[2].length = 0;
-				k[2].key	= NULL;
-
-				wmem_tree_insert32_array(dictionary.avps,k,avp);
-			}
+			diam_avp_insert(a->code, vnd->code, avp);
 		}
 	}
 	g_hash_table_destroy(build_dict.types);
@@ -1550,31 +1550,76 @@ qname_labels_count(const gchar* name, gint name_len)
     return labels;
 }
 
+/* Names already decoded in the DNS message being dissected, so that names
+ * repeated in the answer, authority and additional sections (nearly always
+ * through compression pointers) are only expanded once.  Only filled in and
+ * used for names without a max_len limit.
+ */
+typedef struct {
+  const gchar *name;
+  gint         name_len;
+  int          len;             /* bytes the name takes at this offset */
+  int          pointers;        /* compression pointers followed to expand it */
+} dns_cached_name_t;
+
+typedef struct {
+  tvbuff_t    *tvb;
+  int          dns_data_offset;
+  wmem_map_t  *names;           /* offset -> dns_cached_name_t */
+} dns_name_cache_t;
+
+#define DNS_NAME_CACHE_KEY 0
+
+/* Set WIRESHARK_DNS_NO_NAME_CACHE to expand every name in full, e.g. to
+ * check that the cache doesn't change what's displayed. */
+static gboolean dns_name_cache_enabled = TRUE;
+
 /* This function returns the number of bytes consumed and the expanded string
  * in *name.
  * The string is allocated with wmem_packet_scope scope and does not need to be freed.
  * it will be automatically freed when the packet has been dissected.
+ * If cache is not NULL, names found there are not expanded again, and the
+ * name (along with the names starting at each of its labels) is added to it.
  */
 static int
-expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
-    const gchar **name, gint* name_len)
+expand_dns_name(dns_name_cache_t *cache, tvbuff_t *tvb, int offset, int max_len,
+    int dns_data_offset, const gchar **name, gint* name_len)
 {
   int     start_offset    = offset;
+  gchar   buf[MAX_DNAME_LEN];
   gchar  *np;
   int     len             = -1;
   int     pointers_count  = 0;
   int     component_len;
   int     indir_offset;
   int     maxname;
+  int     copy_len;
+  int     label_offset[MAX_DNAME_LEN / 2];
+  int     label_pos[MAX_DNAME_LEN / 2];
+  int     num_labels      = 0;
+  gchar  *result;
+  dns_cached_name_t *cached;
 
   const int min_len = 1;        /* Minimum length of encoded name (for root) */
         /* If we're about to return a value (probably negative) which is less
          * than the minimum length, we're looking at bad data and we're liable
          * to put the dissector into a loop.  Instead we throw an exception */
 
+  if (max_len) {
+    /* A truncated name must still throw where it would have */
+    cache = NULL;
+  }
+  if (cache) {
+    cached = (dns_cached_name_t *)wmem_map_lookup(cache->names, GINT_TO_POINTER(offset));
+    if (cached) {
+      *name = cached->name;
+      *name_len = cached->name_len;
+      return cached->len;
+    }
+  }
+
   maxname = MAX_DNAME_LEN;
-  np=(gchar *)wmem_alloc(wmem_packet_scope(), maxname);
-  *name=np;
+  np = buf;
   (*name_len) = 0;
 
   for (;;) {
@@ -1590,7 +1635,7 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
 
       case 0x00:
         /* Label */
-        if (np != *name) {
+        if (np != buf) {
           /* Not the first component - put in a '.'. */
           if (maxname > 0) {
             *np++ = '.';
@@ -1601,22 +1646,29 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
         else {
           maxname--;
         }
-        while (component_len > 0) {
-          if (max_len && offset - start_offset > max_len - 1) {
-            THROW(ReportedBoundsError);
-          }
-          if (maxname > 0) {
-            *np++ = tvb_get_guint8(tvb, offset);
-            (*name_len)++;
-            maxname--;
-          }
-          component_len--;
-          offset++;
+        if (len < 0 && num_labels < (int)G_N_ELEMENTS(label_offset)) {
+          /* Where the name from this label on starts, for the cache */
+          label_offset[num_labels] = offset - 1;
+          label_pos[num_labels] = (int)(np - buf);
+          num_labels++;
+        }
+        if (max_len && offset + component_len - start_offset > max_len) {
+          THROW(ReportedBoundsError);
         }
+        copy_len = MIN(component_len, MAX(maxname, 0));
+        if (copy_len > 0) {
+          tvb_memcpy(tvb, np, offset, copy_len);
+          np += copy_len;
+          (*name_len) += copy_len;
+          maxname -= copy_len;
+        }
+        offset += component_len;
         break;
 
       case 0x40:
         /* Extended label (RFC 2673) */
+        /* Not worth caching; names using these are practically unheard of */
+        cache = NULL;
         switch (component_len & 0x3f) {
 
           case 0x01:
@@ -1714,37 +1766,85 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
         }
 
         offset = indir_offset;
+        if (cache) {
+          /* The rest of the name may have been expanded already; use it
+             if it fits, otherwise carry on and let the name be truncated
+             the same way it would have been. */
+          cached = (dns_cached_name_t *)wmem_map_lookup(cache->names, GINT_TO_POINTER(indir_offset));
+          if (cached && pointers_count + cached->pointers > MAX_DNAME_LEN) {
+            /* Following the rest would take us over the loop limit */
+            cached = NULL;
+          }
+          if (cached && cached->name_len == 0) {
+            goto done;
+          }
+          if (cached && cached->name_len + 1 < maxname) {
+            if (np != buf) {
+              *np++ = '.';
+              (*name_len)++;
+            }
+            maxname--;
+            memcpy(np, cached->name, cached->name_len);
+            np += cached->name_len;
+            (*name_len) += cached->name_len;
+            maxname -= cached->name_len;
+            goto done;
+          }
+        }
         break;   /* now continue processing from there */
     }
   }
 
-  // Do we have space for the terminating 0?
-  if (maxname > 0) {
-    *np = '\0';
+done:
+  /* If "len" is negative, we haven't seen a pointer, and thus haven't
+     set the length, so set it. */
+  if (len < 0) {
+    len = offset - start_offset;
   }
-  else {
+
+  // Do we have space for the terminating 0?
+  if (maxname <= 0) {
     *name="<Name too long>";
     *name_len = (guint)strlen(*name);
+    return len;
   }
 
-  /* If "len" is negative, we haven't seen a pointer, and thus haven't
-     set the length, so set it. */
-  if (len < 0) {
-    len = offset - start_offset;
+  *np = '\0';
+  result = (gchar *)wmem_memdup(wmem_packet_scope(), buf, (np - buf) + 1);
+  *name = result;
+
+  if (cache) {
+    int i;
+
+    for (i = 0; i < num_labels; i++) {
+      cached = wmem_new(wmem_packet_scope(), dns_cached_name_t);
+      cached->name = result + label_pos[i];
+      cached->name_len = *name_len - label_pos[i];
+      cached->len = len - (label_offset[i] - start_offset);
+      cached->pointers = pointers_count;
+      wmem_map_insert(cache->names, GINT_TO_POINTER(label_offset[i]), cached);
+    }
+    if (num_labels == 0 || label_offset[0] != start_offset) {
+      /* The root, or a name that is just a pointer */
+      cached = wmem_new(wmem_packet_scope(), dns_cached_name_t);
+      cached->name = result;
+      cached->name_len = *name_len;
+      cached->len = len;
+      cached->pointers = pointers_count;
+      wmem_map_insert(cache->names, GINT_TO_POINTER(start_offset), cached);
+    }
   }
 
   return len;
 }
 
-/* return the bytes in the tvb consumed by the function. The converted string (that
-   can contain null bytes, is written in name and its length in name_len. */
-int
-get_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
-    const gchar **name, gint* name_len)
+static int
+get_dns_name_internal(dns_name_cache_t *cache, tvbuff_t *tvb, int offset, int max_len,
+    int dns_data_offset, const gchar **name, gint* name_len)
 {
   int len;
 
-  len = expand_dns_name(tvb, offset, max_len, dns_data_offset, name, name_len);
+  len = expand_dns_name(cache, tvb, offset, max_len, dns_data_offset, name, name_len);
 
   /* Zero-length name means "root server" */
   if (**name == '\0' && len <= MIN_DNAME_LEN) {
@@ -1760,13 +1860,37 @@ get_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
   return len;
 }
 
+/* return the bytes in the tvb consumed by the function. The converted string (that
+   can contain null bytes, is written in name and its length in name_len. */
+int
+get_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
+    const gchar **name, gint* name_len)
+{
+  return get_dns_name_internal(NULL, tvb, offset, max_len, dns_data_offset, name, name_len);
+}
+
+/* get_dns_name() for names in the DNS message being dissected, using its name cache */
+static int
+get_dns_name_cached(packet_info *pinfo, tvbuff_t *tvb, int offset, int max_len,
+    int dns_data_offset, const gchar **name, gint* name_len)
+{
+  dns_name_cache_t *cache;
+
+  cache = (dns_name_cache_t *)p_get_proto_data(pinfo->pool, pinfo, proto_dns, DNS_NAME_CACHE_KEY);
+  if (cache && (cache->tvb != tvb || cache->dns_data_offset != dns_data_offset)) {
+    cache = NULL;
+  }
+
+  return get_dns_name_internal(cache, tvb, offset, max_len, dns_data_offset, name, name_len);
+}
+
 static int
-get_dns_name_type_class(tvbuff_t *tvb, int offset, int dns_data_offset,
+get_dns_name_type_class(packet_info *pinfo, tvbuff_t *tvb, int offset, int dns_data_offset,
     const gchar **name, int *name_len, guint16 *type, guint16 *dns_class)
 {
   int start_offset = offset;
 
-  offset += get_dns_name(tvb, offset, 0, dns_data_offset, name, name_len);
+  offset += get_dns_name_cached(pinfo, tvb, offset, 0, dns_data_offset, name, name_len);
 
   *type = tvb_get_ntohs(tvb, offset);
   offset += 2;
@@ -1852,7 +1976,7 @@ dissect_dns_query(tvbuff_t *tvb, int offset, int dns_data_offset,
 
   data_start = offset;
 
-  used_bytes = get_dns_name_type_class(tvb, offset, dns_data_offset, &name, &name_len,
+  used_bytes = get_dns_name_type_class(pinfo, tvb, offset, dns_data_offset, &name, &name_len,
     &type, &dns_class);
 
   if (is_mdns) {
@@ -2333,7 +2457,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
   data_start = data_offset = offsetx;
   cur_offset = offsetx;
 
-  used_bytes = get_dns_name_type_class(tvb, offsetx, dns_data_offset, &name, &name_len,
+  used_bytes = get_dns_name_type_class(pinfo, tvb, offsetx, dns_data_offset, &name, &name_len,
                                 &dns_type, &dns_class);
 
   /* The offset if the total used bytes minus 2 bytes for qtype and 2 bytes for qclass */
@@ -2427,7 +2551,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
           int domain_name_len;
           guint32 ch_addr;
 
-          used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &domain_name, &domain_name_len);
+          used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &domain_name, &domain_name_len);
           name_out = format_text(pinfo->pool, (const guchar*)domain_name, domain_name_len);
           col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
           proto_item_append_text(trr, ", domain/addr %s", name_out);
@@ -2457,7 +2581,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       const gchar *ns_name;
       int ns_name_len;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &ns_name, &ns_name_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &ns_name, &ns_name_len);
       name_out = format_text(pinfo->pool, (const guchar*)ns_name, ns_name_len);
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
       proto_item_append_text(trr, ", ns %s", name_out);
@@ -2473,7 +2597,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
 
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &hostname_str, &hostname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &hostname_str, &hostname_len);
       name_out = format_text(pinfo->pool, (const guchar*)hostname_str, hostname_len);
       proto_tree_add_string(rr_tree, hf_dns_md, tvb, cur_offset, used_bytes, name_out);
     }
@@ -2486,7 +2610,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
 
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &hostname_str, &hostname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &hostname_str, &hostname_len);
       name_out = format_text(pinfo->pool, (const guchar*)hostname_str, hostname_len);
       proto_tree_add_string(rr_tree, hf_dns_mf, tvb, cur_offset, used_bytes, name_out);
     }
@@ -2497,7 +2621,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       const gchar *cname;
       int cname_len;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &cname, &cname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &cname, &cname_len);
       name_out = format_text(pinfo->pool, (const guchar*)cname, cname_len);
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
       proto_item_append_text(trr, ", cname %s", name_out);
@@ -2514,14 +2638,14 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       int           rname_len;
       proto_item   *ti_soa;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &mname, &mname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &mname, &mname_len);
       name_out = format_text(pinfo->pool, (const guchar*)mname, mname_len);
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
       proto_item_append_text(trr, ", mname %s", name_out);
       proto_tree_add_string(rr_tree, hf_dns_soa_mname, tvb, cur_offset, used_bytes, name_out);
       cur_offset += used_bytes;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &rname, &rname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &rname, &rname_len);
       name_out = format_text(pinfo->pool, (const guchar*)rname, rname_len);
       proto_tree_add_string(rr_tree, hf_dns_soa_rname, tvb, cur_offset, used_bytes, name_out);
       cur_offset += used_bytes;
@@ -2553,7 +2677,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
 
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &hostname_str, &hostname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &hostname_str, &hostname_len);
       name_out = format_text(pinfo->pool, (const guchar*)hostname_str, hostname_len);
       proto_tree_add_string(rr_tree, hf_dns_mb, tvb, cur_offset, used_bytes, name_out);
     }
@@ -2566,7 +2690,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
 
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &hostname_str, &hostname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &hostname_str, &hostname_len);
       name_out = format_text(pinfo->pool, (const guchar*)hostname_str, hostname_len);
       proto_tree_add_string(rr_tree, hf_dns_mg, tvb, cur_offset, used_bytes, name_out);
     }
@@ -2579,7 +2703,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
 
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &hostname_str, &hostname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &hostname_str, &hostname_len);
       name_out = format_text(pinfo->pool, (const guchar*)hostname_str, hostname_len);
       proto_tree_add_string(rr_tree, hf_dns_mr, tvb, cur_offset, used_bytes, name_out);
     }
@@ -2662,7 +2786,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       const gchar  *pname;
       int           pname_len;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &pname, &pname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &pname, &pname_len);
       name_out = format_text(pinfo->pool, (const guchar*)pname, pname_len);
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
       proto_item_append_text(trr, ", %s", name_out);
@@ -2744,12 +2868,12 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
 
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &rmailbx_str, &rmailbx_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &rmailbx_str, &rmailbx_len);
       name_out = format_text(pinfo->pool, (const guchar*)rmailbx_str, rmailbx_len);
       proto_tree_add_string(rr_tree, hf_dns_minfo_r_mailbox, tvb, cur_offset, used_bytes, name_out);
       cur_offset += used_bytes;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &emailbx_str, &emailbx_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &emailbx_str, &emailbx_len);
       name_out = format_text(pinfo->pool, (const guchar*)emailbx_str, emailbx_len);
       proto_tree_add_string(rr_tree, hf_dns_minfo_e_mailbox, tvb, cur_offset, used_bytes, name_out);
     }
@@ -2763,7 +2887,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
 
       preference = tvb_get_ntohs(tvb, cur_offset);
 
-      used_bytes = get_dns_name(tvb, cur_offset + 2, 0, dns_data_offset, &mx_name, &mx_name_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset + 2, 0, dns_data_offset, &mx_name, &mx_name_len);
       name_out = format_text(pinfo->pool, (const guchar*)mx_name, mx_name_len);
       col_append_fstr(pinfo->cinfo, COL_INFO, " %u %s", preference, name_out);
       proto_item_append_text(trr, ", preference %u, mx %s",
@@ -2810,12 +2934,12 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
 
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &mbox_dname, &mbox_dname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &mbox_dname, &mbox_dname_len);
       name_out = format_text(pinfo->pool, (const guchar*)mbox_dname, mbox_dname_len);
       proto_tree_add_string(rr_tree, hf_dns_rp_mailbox, tvb, cur_offset, used_bytes, name_out);
       cur_offset += used_bytes;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &txt_dname, &txt_dname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &txt_dname, &txt_dname_len);
       name_out = format_text(pinfo->pool, (const guchar*)txt_dname, txt_dname_len);
       proto_tree_add_string(rr_tree, hf_dns_rp_txt_rr, tvb, cur_offset, used_bytes, name_out);
     }
@@ -2828,7 +2952,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
 
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
 
-      used_bytes = get_dns_name(tvb, cur_offset + 2, 0, dns_data_offset, &host_name, &host_name_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset + 2, 0, dns_data_offset, &host_name, &host_name_len);
       name_out = format_text(pinfo->pool, (const guchar*)host_name, host_name_len);
 
       proto_tree_add_item(rr_tree, hf_dns_afsdb_subtype, tvb, cur_offset, 2, ENC_BIG_ENDIAN);
@@ -2886,7 +3010,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
 
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
 
-      used_bytes = get_dns_name(tvb, cur_offset + 2, 0, dns_data_offset, &host_name, &host_name_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset + 2, 0, dns_data_offset, &host_name, &host_name_len);
       name_out = format_text(pinfo->pool, (const guchar*)host_name, host_name_len);
 
       proto_tree_add_item(rr_tree, hf_dns_rt_preference, tvb, cur_offset, 2, ENC_BIG_ENDIAN);
@@ -2910,7 +3034,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
 
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &nsap_ptr_owner, &nsap_ptr_owner_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &nsap_ptr_owner, &nsap_ptr_owner_len);
       name_out = format_text(pinfo->pool, (const guchar*)nsap_ptr_owner, nsap_ptr_owner_len);
       proto_tree_add_string(rr_tree, hf_dns_nsap_ptr_owner, tvb, cur_offset, used_bytes, name_out);
     }
@@ -2973,12 +3097,12 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       proto_tree_add_item(rr_tree, hf_dns_px_preference, tvb, cur_offset, 2, ENC_BIG_ENDIAN);
       cur_offset += 2;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &px_map822_dnsname, &px_map822_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &px_map822_dnsname, &px_map822_len);
       name_out = format_text(pinfo->pool, (const guchar*)px_map822_dnsname, px_map822_len);
       proto_tree_add_string(rr_tree, hf_dns_px_map822, tvb, cur_offset, used_bytes, name_out);
       cur_offset += used_bytes;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &px_mapx400_dnsname, &px_mapx400_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &px_mapx400_dnsname, &px_mapx400_len);
       name_out = format_text(pinfo->pool, (const guchar*)px_mapx400_dnsname, px_mapx400_len);
       proto_tree_add_string(rr_tree, hf_dns_px_mapx400, tvb, cur_offset, used_bytes, name_out);
       /*cur_offset += used_bytes;*/
@@ -3077,8 +3201,8 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       const gchar  *next_domain_name;
       int           next_domain_name_len;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset,
-                                &next_domain_name, &next_domain_name_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset,
+                                       &next_domain_name, &next_domain_name_len);
       name_out = format_text(pinfo->pool, (const guchar*)next_domain_name, next_domain_name_len);
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
       proto_item_append_text(trr, ", next domain name %s", name_out);
@@ -3109,7 +3233,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       port = tvb_get_ntohs(tvb, cur_offset);
       cur_offset += 2;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &target, &target_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &target, &target_len);
       name_out = format_text(pinfo->pool, (const guchar*)target, target_len);
 
       proto_tree_add_string(rr_tree, hf_dns_srv_target, tvb, cur_offset, used_bytes, name_out);
@@ -3166,7 +3290,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       offset += regex_len;
 
       /* Replacement */
-      used_bytes = get_dns_name(tvb, offset, 0, dns_data_offset, &replacement, &replacement_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, offset, 0, dns_data_offset, &replacement, &replacement_len);
       name_out = format_text(pinfo->pool, (const guchar*)replacement, replacement_len);
       ti_len = proto_tree_add_uint(rr_tree, hf_dns_naptr_replacement_length, tvb, offset, 0, replacement_len);
       proto_item_set_generated(ti_len);
@@ -3185,7 +3309,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       const gchar  *kx_name;
       int           kx_name_len;
 
-      used_bytes = get_dns_name(tvb, cur_offset + 2, 0, dns_data_offset, &kx_name, &kx_name_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset + 2, 0, dns_data_offset, &kx_name, &kx_name_len);
       name_out = format_text(pinfo->pool, (const guchar*)kx_name, kx_name_len);
       col_append_fstr(pinfo->cinfo, COL_INFO, " %u %s", tvb_get_ntohs(tvb, cur_offset), name_out);
       proto_item_append_text(trr, ", preference %u, kx %s",
@@ -3244,8 +3368,8 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       }
 
       if (pre_len > 0) {
-        used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset,
-                                  &pname, &pname_len);
+        used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset,
+                                         &pname, &pname_len);
       } else {
         pname = "";
         pname_len = 0;
@@ -3279,8 +3403,8 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       const gchar  *dname;
       int           dname_len;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset,
-                               &dname, &dname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset,
+                                      &dname, &dname_len);
       name_out = format_text(pinfo->pool, (const guchar*)dname, dname_len);
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
       proto_item_append_text(trr, ", dname %s", name_out);
@@ -3464,8 +3588,8 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
             const gchar  *dname;
             int           dname_len;
 
-            used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset,
-                                    &dname, &dname_len);
+            used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset,
+                                           &dname, &dname_len);
             name_out = format_text(wmem_packet_scope(), (const guchar*)dname, dname_len);
             proto_tree_add_string(rropt_tree, hf_dns_opt_agent_domain, tvb, cur_offset, used_bytes, name_out);
 
@@ -3616,7 +3740,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
 
         case 3:
         {
-          used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &gw, &gw_name_len);
+          used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &gw, &gw_name_len);
           name_out = format_text(pinfo->pool, (const guchar*)gw, gw_name_len);
           proto_tree_add_string(rr_tree, hf_dns_ipseckey_gateway_dns, tvb, cur_offset, used_bytes, name_out);
 
@@ -3673,7 +3797,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       cur_offset += 2;
       rr_len     -= 2;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &signer_name, &signer_name_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &signer_name, &signer_name_len);
       name_out = format_text(pinfo->pool, (const guchar*)signer_name, signer_name_len);
       proto_tree_add_string(rr_tree, hf_dns_rrsig_signers_name, tvb, cur_offset, used_bytes, name_out);
       cur_offset += used_bytes;
@@ -3691,8 +3815,8 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       const gchar  *next_domain_name;
       int           next_domain_name_len;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset,
-                                          &next_domain_name, &next_domain_name_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset,
+                                                 &next_domain_name, &next_domain_name_len);
       name_out = format_text(pinfo->pool, (const guchar*)next_domain_name, next_domain_name_len);
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
       proto_item_append_text(trr, ", next domain name %s", name_out);
@@ -3881,7 +4005,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       rr_len     -= pk_len;
 
       while (rr_len > 1) {
-        used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &rend_server_dns_name, &rendezvous_len);
+        used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &rend_server_dns_name, &rendezvous_len);
         name_out = format_text(pinfo->pool, (const guchar*)rend_server_dns_name, rendezvous_len);
         proto_tree_add_string(rr_tree, hf_dns_hip_rendezvous_server, tvb, cur_offset, used_bytes, name_out);
         cur_offset += used_bytes;
@@ -3944,7 +4068,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       proto_tree_add_item_ret_uint(rr_tree, hf_dns_svcb_priority, tvb, cur_offset, 2, ENC_BIG_ENDIAN, &priority);
       cur_offset += 2;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &target, &target_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &target, &target_len);
       name_out = format_text(pinfo->pool, (const guchar*)target, target_len);
 
       proto_tree_add_string(rr_tree, hf_dns_svcb_target, tvb, cur_offset, used_bytes, name_out);
@@ -4090,7 +4214,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       proto_tree_add_item(rr_tree, hf_dns_ilnp_locatorfqdn_preference, tvb, cur_offset, 2, ENC_BIG_ENDIAN);
       cur_offset += 2;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &lp_str, &lp_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &lp_str, &lp_len);
       name_out = format_text(pinfo->pool, (const guchar*)lp_str, lp_len);
       proto_tree_add_string(rr_tree, hf_dns_ilnp_locatorfqdn, tvb, cur_offset, used_bytes, name_out);
       /*cur_offset += used_bytes;*/
@@ -4120,7 +4244,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       proto_tree *key_tree;
       proto_item *key_item;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &tkey_algname, &tkey_algname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &tkey_algname, &tkey_algname_len);
       name_out = format_text(pinfo->pool, (const guchar*)tkey_algname, tkey_algname_len);
       proto_tree_add_string(rr_tree, hf_dns_tkey_algo_name, tvb, cur_offset, used_bytes, name_out);
       cur_offset += used_bytes;
@@ -4202,7 +4326,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       int           tsig_algname_len;
       proto_item    *ti;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &tsig_algname, &tsig_algname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &tsig_algname, &tsig_algname_len);
       name_out = format_text(pinfo->pool, (const guchar*)tsig_algname, tsig_algname_len);
       proto_tree_add_string(rr_tree, hf_dns_tsig_algorithm_name, tvb, cur_offset, used_bytes, name_out);
       cur_offset += used_bytes;
@@ -4371,7 +4495,7 @@ dissect_dns_answer(tvbuff_t *tvb, int offsetx, int dns_data_offset,
       proto_tree_add_item(rr_tree, hf_dns_winsr_cache_timeout, tvb, cur_offset, 4, ENC_BIG_ENDIAN);
       cur_offset += 4;
 
-      used_bytes = get_dns_name(tvb, cur_offset, 0, dns_data_offset, &dname, &dname_len);
+      used_bytes = get_dns_name_cached(pinfo, tvb, cur_offset, 0, dns_data_offset, &dname, &dname_len);
       name_out = format_text(pinfo->pool, (const guchar*)dname, dname_len);
       proto_tree_add_string(rr_tree, hf_dns_winsr_name_result_domain, tvb, cur_offset, used_bytes, name_out);
       col_append_fstr(pinfo->cinfo, COL_INFO, " %s", name_out);
@@ -4560,9 +4684,19 @@ dissect_dns_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree,
   int                name_len;
   nstime_t           delta = NSTIME_INIT_ZERO;
   gboolean           is_multiple_responds = FALSE;
+  dns_name_cache_t  *name_cache;
 
   dns_data_offset = offset;
 
+  /* A fresh name cache for each message; there can be several per packet */
+  if (dns_name_cache_enabled) {
+    name_cache = wmem_new(pinfo->pool, dns_name_cache_t);
+    name_cache->tvb = tvb;
+    name_cache->dns_data_offset = dns_data_offset;
+    name_cache->names = wmem_map_new(pinfo->pool, g_direct_hash, g_direct_equal);
+    p_set_proto_data(pinfo->pool, pinfo, proto_dns, DNS_NAME_CACHE_KEY, name_cache);
+  }
+
   col_clear(pinfo->cinfo, COL_INFO);
 
   /* To do: check for errs, etc. */
@@ -4925,6 +5059,13 @@ dissect_dns_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree,
   if (pinfo->flags.in_error_pkt) {
     return;
   }
+  if (!have_tap_listener(dns_tap)) {
+    /* Nobody to hand them to; skip formatting the query name etc. */
+    dns_qr_r_ra_ttl_index = 0;
+    dns_qr_r_ru_ttl_index = 0;
+    dns_qr_r_rd_ttl_index = 0;
+    return;
+  }
   if (is_mdns) {
     /* TODO */
   } else if (is_llmnr) {
@@ -4935,7 +5076,7 @@ dissect_dns_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree,
     dns_stats->packet_opcode = opcode;
     dns_stats->packet_qr = flags >> 15;
     if (quest > 0) {
-      get_dns_name_type_class(tvb, offset + DNS_HDRLEN, dns_data_offset, &name, &name_len, &qtype, &qclass);
+      get_dns_name_type_class(pinfo, tvb, offset + DNS_HDRLEN, dns_data_offset, &name, &name_len, &qtype, &qclass);
       dns_stats->packet_qtype = qtype;
       dns_stats->packet_qclass = qclass;
     }
@@ -7934,6 +8075,8 @@ proto_register_dns(void)
   doq_handle = register_dissector("dns.doq", dissect_dns_doq, proto_dns);
 
   dns_tap = register_tap("dns");
+
+  dns_name_cache_enabled = g_getenv("WIRESHARK_DNS_NO_NAME_CACHE") == NULL;
 }
 
 /*
@@ -17895,7 +17895,7 @@ void proto_register_e1ap(void) {
   /* Register protocol */
   proto_e1ap = proto_register_protocol(PNAME, PSNAME, PFNAME);
   /* Register fields and subtrees */
-  proto_register_field_array(proto_e1ap, hf, array_length(hf));
+  proto_register_field_array_lazy(proto_e1ap, hf, array_length(hf));
   proto_register_subtree_array(ett, array_length(ett));
 
   /* Register dissector */
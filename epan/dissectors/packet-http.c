@@ -37,6 +37,8 @@
 #include <epan/exceptions.h>
 #include <epan/show_exception.h>
 #include <glib.h>
+#include <wsutil/pint.h>
+#include <wsutil/wslog.h>
 #include "packet-http.h"
 #include "packet-http2.h"
 #include "packet-tcp.h"
@@ -4445,6 +4447,89 @@ static void reinit_http(void) {
 	range_foreach(http_tls_range, range_add_http_tls_callback, NULL);
 }
 
+/*
+ * Store for decompressed HTTP/2 and HTTP/3 header fields. Header compression
+ * lets a client repeat a large header field for a couple of bytes, so the
+ * same field is interned once per capture file instead of being kept for
+ * every header block that references it.
+ */
+static wmem_map_t *http_header_store;
+
+static struct {
+	guint64 fields;		/* fields looked up */
+	guint64 unique;		/* fields stored */
+	guint64 stored_bytes;	/* bytes stored */
+	guint64 saved_bytes;	/* bytes not stored thanks to deduplication */
+} http_header_store_stats;
+
+static size_t
+http_header_store_pstr_length(gconstpointer vv)
+{
+	const guint8 *v = (const guint8 *)vv;
+	guint32 namelen, valuelen;
+
+	namelen = pntoh32(v);
+	valuelen = pntoh32(v + sizeof(namelen) + namelen);
+
+	return namelen + valuelen + sizeof(namelen) + sizeof(valuelen);
+}
+
+static guint
+http_header_store_hash(gconstpointer key)
+{
+	return wmem_strong_hash((const guint8 *)key, http_header_store_pstr_length(key));
+}
+
+static gboolean
+http_header_store_equal(gconstpointer lhs, gconstpointer rhs)
+{
+	size_t alen = http_header_store_pstr_length(lhs);
+	size_t blen = http_header_store_pstr_length(rhs);
+
+	return alen == blen && memcmp(lhs, rhs, alen) == 0;
+}
+
+const guint8 *
+http_header_store_intern(packet_info *pinfo, const guint8 *name, guint32 name_len,
+			 const guint8 *value, guint32 value_len, guint32 *pstr_len)
+{
+	guint32 len = 4 + name_len + 4 + value_len;
+	guint8 *pstr, *cached_pstr;
+
+	pstr = (guint8 *)wmem_alloc(pinfo->pool, len);
+	phton32(&pstr[0], name_len);
+	memcpy(&pstr[4], name, name_len);
+	phton32(&pstr[4 + name_len], value_len);
+	memcpy(&pstr[4 + name_len + 4], value, value_len);
+
+	http_header_store_stats.fields++;
+	cached_pstr = (guint8 *)wmem_map_lookup(http_header_store, pstr);
+	if (cached_pstr) {
+		http_header_store_stats.saved_bytes += len;
+	} else {
+		cached_pstr = (guint8 *)wmem_memdup(wmem_file_scope(), pstr, len);
+		wmem_map_insert(http_header_store, cached_pstr, cached_pstr);
+		http_header_store_stats.unique++;
+		http_header_store_stats.stored_bytes += len;
+	}
+	wmem_free(pinfo->pool, pstr);
+
+	*pstr_len = len;
+	return cached_pstr;
+}
+
+static void
+http_header_store_cleanup(void)
+{
+	if (http_header_store_stats.fields) {
+		ws_debug("header store: %" PRIu64 " fields, %" PRIu64 " unique, "
+		    "%" PRIu64 " bytes stored, %" PRIu64 " bytes deduplicated",
+		    http_header_store_stats.fields, http_header_store_stats.unique,
+		    http_header_store_stats.stored_bytes, http_header_store_stats.saved_bytes);
+	}
+	memset(&http_header_store_stats, 0, sizeof(http_header_store_stats));
+}
+
 void
 proto_register_http(void)
 {
@@ -4777,6 +4862,10 @@ proto_register_http(void)
 
 	reassembly_table_register(&http_streaming_reassembly_table, &addresses_ports_reassembly_table_functions);
 
+	http_header_store = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
+	    http_header_store_hash, http_header_store_equal);
+	register_cleanup_routine(http_header_store_cleanup);
+
 	http_module = prefs_register_protocol(proto_http, reinit_http);
 	prefs_register_bool_preference(http_module, "desegment_headers",
 	    "Reassemble HTTP headers spanning multiple TCP segments",
@@ -25,6 +25,17 @@ void http_tcp_port_add(guint32 port);
 WS_DLL_PUBLIC
 void http_add_path_components_to_tree(tvbuff_t* tvb, packet_info* pinfo _U_, proto_item* item, int offset, int length);
 
+/**
+ * Returns the interned form of a decompressed header field, shared by the
+ * HTTP/2 (HPACK) and HTTP/3 (QPACK) dissectors. The result is laid out as
+ * "name length (uint32, network order), name, value length, value", lives
+ * in file scope and is the same pointer for every identical field seen in
+ * the capture file. Its size is returned in "pstr_len".
+ */
+extern const guint8 *
+http_header_store_intern(packet_info *pinfo, const guint8 *name, guint32 name_len,
+			 const guint8 *value, guint32 value_len, guint32 *pstr_len);
+
 /* Used for HTTP statistics */
 typedef struct _http_info_value_t {
 	guint32 framenum;
@@ -124,8 +124,8 @@ typedef struct {
     gint length;
     union {
         struct {
-            /* header data */
-            char *data;
+            /* header data, interned in the HTTP header store */
+            const char *data;
             /* length of data */
             guint datalen;
             /* name index or name/value index if type is one of
@@ -547,17 +547,6 @@ static const fragment_items http2_body_fragment_items = {
     &hf_http2_body_reassembled_data,
     "Body fragments"
 };
-
-/* Due to HPACK compression, we may get lots of relatively large
-   header fields (e.g., 4KiB).  Allocating each of them requires lots
-   of memory.  The maximum compression is achieved in HPACK by
-   referencing header field stored in dynamic table by one or two
-   bytes.  We reduce memory usage by caching header field in this
-   wmem_map_t to reuse its memory region when we see the same header
-   field next time. */
-static wmem_map_t *http2_hdrcache_map;
-/* Header name_length + name + value_length + value */
-static char *http2_header_pstr;
 #endif
 
 #ifdef HAVE_NGHTTP2
@@ -1362,8 +1351,6 @@ static bool
 hd_inflate_del_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_, void *user_data)
 {
     nghttp2_hd_inflate_del((nghttp2_hd_inflater*)user_data);
-    http2_hdrcache_map = NULL;
-    http2_header_pstr = NULL;
 
     return FALSE;
 }
@@ -1754,32 +1741,6 @@ process_http2_header_repr_info(wmem_array_t *headers,
     return start;
 }
 
-static size_t http2_hdrcache_length(gconstpointer vv)
-{
-    const guint8 *v = (const guint8 *)vv;
-    guint32 namelen, valuelen;
-
-    namelen = pntoh32(v);
-    valuelen = pntoh32(v + sizeof(namelen) + namelen);
-
-    return namelen + valuelen + sizeof(namelen) + sizeof(valuelen);
-}
-
-static guint http2_hdrcache_hash(gconstpointer key)
-{
-    return wmem_strong_hash((const guint8 *)key, http2_hdrcache_length(key));
-}
-
-static gboolean http2_hdrcache_equal(gconstpointer lhs, gconstpointer rhs)
-{
-    const guint8 *a = (const guint8 *)lhs;
-    const guint8 *b = (const guint8 *)rhs;
-    size_t alen = http2_hdrcache_length(a);
-    size_t blen = http2_hdrcache_length(b);
-
-    return alen == blen && memcmp(a, b, alen) == 0;
-}
-
 /* If we are in a HEADERS or PUSH_PROMISE context, return the stream id
  * the headers describe. (For PUSH_PROMISE or CONTIUATIONs thereof, this
  * is the promised stream id.) Otherwise return 0.
@@ -2061,10 +2022,6 @@ inflate_http2_header_block(tvbuff_t *tvb, packet_info *pinfo, guint offset, prot
     http2_header_stream_info_t* header_stream_info;
     gchar *header_unescaped = NULL;
 
-    if (!http2_hdrcache_map) {
-        http2_hdrcache_map = wmem_map_new(wmem_file_scope(), http2_hdrcache_hash, http2_hdrcache_equal);
-    }
-
     header_data = (http2_header_data_t*)p_get_proto_data(wmem_file_scope(), pinfo, proto_http2, PROTO_DATA_KEY_HEADER);
     header_list = header_data->header_list;
 
@@ -2114,10 +2071,8 @@ inflate_http2_header_block(tvbuff_t *tvb, packet_info *pinfo, guint offset, prot
             rv -= process_http2_header_repr_info(headers, header_repr_info, headbuf - rv, rv);
 
             if(inflate_flags & NGHTTP2_HD_INFLATE_EMIT) {
-                char *cached_pstr;
-                guint32 len;
                 guint datalen = (guint)(4 + nv.namelen + 4 + nv.valuelen);
-                http2_header_t *out;
+                http2_header_t out;
 
                 if (decompressed_bytes + datalen >= MAX_HTTP2_HEADER_SIZE) {
                     header_data->header_size_reached = decompressed_bytes;
@@ -2125,44 +2080,18 @@ inflate_http2_header_block(tvbuff_t *tvb, packet_info *pinfo, guint offset, prot
                     break;
                 }
 
-                out = wmem_new(wmem_file_scope(), http2_header_t);
-
-                out->type = header_repr_info->type;
-                out->length = rv;
-                out->table.data.idx = header_repr_info->integer;
-
-                out->table.data.datalen = datalen;
+                out.type = header_repr_info->type;
+                out.length = rv;
+                out.table.data.idx = header_repr_info->integer;
                 decompressed_bytes += datalen;
 
-                /* Prepare buffer... with the following format
-                   name length (uint32)
-                   name (string)
-                   value length (uint32)
-                   value (string)
-                */
-                http2_header_pstr = (char *)wmem_realloc(wmem_file_scope(), http2_header_pstr, out->table.data.datalen);
-
-                /* nv.namelen and nv.valuelen are of size_t.  In order
-                   to get length in 4 bytes, we have to copy it to
-                   guint32. */
-                len = (guint32)nv.namelen;
-                phton32(&http2_header_pstr[0], len);
-                memcpy(&http2_header_pstr[4], nv.name, nv.namelen);
-
-                len = (guint32)nv.valuelen;
-                phton32(&http2_header_pstr[4 + nv.namelen], len);
-                memcpy(&http2_header_pstr[4 + nv.namelen + 4], nv.value, nv.valuelen);
-
-                cached_pstr = (char *)wmem_map_lookup(http2_hdrcache_map, http2_header_pstr);
-                if (cached_pstr) {
-                    out->table.data.data = cached_pstr;
-                } else {
-                    wmem_map_insert(http2_hdrcache_map, http2_header_pstr, http2_header_pstr);
-                    out->table.data.data = http2_header_pstr;
-                    http2_header_pstr = NULL;
-                }
+                /* nv.namelen and nv.valuelen are of size_t, but are
+                   bounded by MAX_HTTP2_HEADER_SIZE. */
+                out.table.data.data = (const char *)http_header_store_intern(pinfo,
+                        nv.name, (guint32)nv.namelen, nv.value, (guint32)nv.valuelen,
+                        &out.table.data.datalen);
 
-                wmem_array_append(headers, out, 1);
+                wmem_array_append(headers, &out, 1);
 
                 reset_http2_header_repr_info(header_repr_info);
             }
@@ -3289,7 +3218,7 @@ get_real_header_value(packet_info* pinfo, const gchar* name, gboolean the_other_
     guint32 name_len;
     guint32 value_len;
     http2_header_t *hdr;
-    gchar* data;
+    const gchar* data;
 
     conversation_t* conversation = find_or_create_conversation(pinfo);
     header_stream_info = get_header_stream_info(pinfo, get_http2_session(pinfo, conversation), the_other_direction);
@@ -3318,7 +3247,7 @@ get_real_header_value(packet_info* pinfo, const gchar* name, gboolean the_other_
                    value length (uint32)
                    value (string)
             */
-            data = (gchar*) hdr->table.data.data;
+            data = hdr->table.data.data;
             name_len = pntoh32(data);
             if (strlen(name) == name_len && strncmp(data + 4, name, name_len) == 0) {
                 value_len = pntoh32(data + 4 + name_len);
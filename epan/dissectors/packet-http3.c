@@ -363,23 +363,13 @@ static http3_session_info_t *http3_session_lookup_or_create(packet_info *pinfo);
 #define QPACK_MAX_DTABLE_SIZE   65536   /**< Max size of the QPACK dynamic table. */
 #define QPACK_MAX_BLOCKED       512     /**< Upper limit on number of streams blocked on QPACK updates. */
 
-/**
- *  Decompressed header field definition.
- *  Header field definitions are cached separately,
- *  to preserve memory.
- */
-typedef struct _http3_header_field_def {
-    const guint8 *name;
-    guint         name_len;
-} http3_header_field_def_t;
-
 /**
  * HTTP3 header field.
  *
  * The header field contains two sections:
  * - encoded points to the location of the encoded field in the *original* packet TVB.
- * - decoded points to the formatted header string, which is allocated in a cache map,
- *   to conserve memory.
+ * - decoded points to the formatted header string, which is interned in the
+ *   HTTP header store shared with HTTP/2, to conserve memory.
  * The decoded fields are used to create an auxiliary TVB which will
  * be used for dissection of decoded header values.
  */
@@ -392,7 +382,6 @@ typedef struct _http3_header_field {
         const guint8 *pstr;
         guint         pstr_len;
     } decoded;
-    http3_header_field_def_t *def;
 } http3_header_field_t;
 
 /**
@@ -470,10 +459,6 @@ typedef struct _http3_qpack_encoder_state {
  */
 typedef struct _http3_file_local_ctx {
     wmem_map_t *conn_info_map;
-#ifdef HAVE_NGHTTP3
-    wmem_map_t *hdr_cache_map;
-    wmem_map_t *hdr_def_cache_map;
-#endif
 } http3_file_local_ctx;
 
 /**
@@ -488,17 +473,6 @@ static http3_file_local_ctx *http3_get_file_local_ctx(void);
 
 #define HTTP3_CONN_INFO_MAP http3_get_file_local_ctx()->conn_info_map
 
-#ifdef HAVE_NGHTTP3
-#define HTTP3_HEADER_CACHE http3_get_file_local_ctx()->hdr_cache_map
-#define HTTP3_HEADER_NAME_CACHE http3_get_file_local_ctx()->hdr_def_cache_map
-
-/* This global carries header name_length + name + value_length + value.
- * It is allocated with file scoped memory, and then either placed in the
- * cache map or, if it matches something already in the cache map, the
- * memory is reallocated for the next header encountered. */
-static char *http3_header_pstr;
-#endif
-
 /**
  * Check whether the argument represents a reserved code point,
  * for Stream Type, Frame Type, Error Code, etc.
@@ -587,11 +561,6 @@ static bool
 qpack_decoder_del_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_, void *user_data)
 {
     nghttp3_qpack_decoder_del((nghttp3_qpack_decoder *)user_data);
-    /* If we have a decoder, then we might have set http3_header_pstr to
-     * point to file scoped memory. Make sure we set it to NULL when leaving
-     * wmem_file_scope.
-     */
-    http3_header_pstr = NULL;
     return FALSE;
 }
 
@@ -982,16 +951,13 @@ dissect_http3_headers(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, guint
              * Check whether the decoder has emitted header data.
              */
             if (flags & NGHTTP3_QPACK_DECODE_FLAG_EMIT) {
-                http3_header_field_t        *out;
-                http3_header_field_def_t    *def;
-                char                        *cached_pstr;
+                http3_header_field_t        out = { 0 };
                 nghttp3_vec                 name_vec;
                 nghttp3_vec                 value_vec;
                 guint32                     name_len;
                 guint8                      *name;
                 guint32                     value_len;
                 guint8                      *value;
-                guint32                     pstr_len;
 
                 ws_noisy("Emit nread=%d flags=%" PRIu8 "", nread, flags);
 
@@ -1008,54 +974,10 @@ dissect_http3_headers(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, guint
 
                 ws_debug("HTTP header: %.*s: %.*s", name_len, name, value_len, value);
 
-                pstr_len          = (name_len + value_len + 4 + 4);
-                http3_header_pstr = (char *)wmem_realloc(wmem_file_scope(), http3_header_pstr, pstr_len);
-                phton32(&http3_header_pstr[0], name_len);
-                memcpy(&http3_header_pstr[4], name, name_len);
-                phton32(&http3_header_pstr[4 + name_len], value_len);
-                memcpy(&http3_header_pstr[4 + name_len + 4], value, value_len);
-
-                /* Lookup a field definition, or create one if needed */
-                def = (http3_header_field_def_t *)wmem_map_lookup(HTTP3_HEADER_NAME_CACHE, http3_header_pstr);
-                if (def == NULL) {
-                    char *def_name = NULL;
-                    def_name       = (char *)wmem_realloc(wmem_file_scope(), def_name, name_len + 1);
-                    memcpy(def_name, name, name_len);
-
-                    def           = wmem_new0(wmem_file_scope(), http3_header_field_def_t);
-                    def->name_len = name_len;
-                    def->name     = (const char *)def_name;
-
-                    wmem_map_insert(HTTP3_HEADER_NAME_CACHE, http3_header_pstr, def);
-                    /* XXX: keys are not copied in wmem_maps, so once we use
-                     * http3_header_pstr, we should set it to NULL so that
-                     * the memory pointed to won't be realloc'ed. However,
-                     * we'll do that in the other map below, as we only insert
-                     * into these maps at the same time, we are guaranteed
-                     * that we will be setting it to NULL below. This is
-                     * fragile and should be replaced with a single map.
-                     * I also don't see the point of this map considering
-                     * that the name and name_len are contained within the
-                     * pstr value and can (and are) parsed from it; this
-                     * map doesn't seem to be used currently.
-                     */
-                }
-
-                /* Create an output field and add it to the headers array */
-                out      = wmem_new0(wmem_file_scope(), http3_header_field_t);
-                out->def = def;
-
-                cached_pstr = (char *)wmem_map_lookup(HTTP3_HEADER_CACHE, http3_header_pstr);
-                if (cached_pstr) {
-                    out->decoded.pstr = cached_pstr;
-                } else {
-                    out->decoded.pstr = http3_header_pstr;
-                    wmem_map_insert(HTTP3_HEADER_CACHE, http3_header_pstr, http3_header_pstr);
-                    http3_header_pstr = NULL;
-                }
-                out->decoded.pstr_len = pstr_len;
-
-                wmem_array_append(header_data->header_fields, out, 1);
+                /* Add the interned field to the headers array */
+                out.decoded.pstr = http_header_store_intern(pinfo, name, name_len, value, value_len,
+                                                            &out.decoded.pstr_len);
+                wmem_array_append(header_data->header_fields, &out, 1);
 
                 /*
                  * Decrease the reference counts on the NGHTTP3 nv structure to avoid
@@ -2722,73 +2644,6 @@ http3_conn_info_equal(gconstpointer lhs, gconstpointer rhs)
     return alen == blen && memcmp(&a->cid[0], &b->cid[0], alen) == 0;
 }
 
-#ifdef HAVE_NGHTTP3
-/* Due to QPACK compression, we may get lots of relatively large
-   header decoded_header_fields (e.g., 4KiB).  Allocating each of them requires lots
-   of memory.  The maximum compression is achieved in QPACK by
-   referencing header field stored in dynamic table by one or two
-   bytes.  We reduce memory usage by caching header field in this
-   wmem_map_t to reuse its memory region when we see the same header
-   field next time. */
-
-static size_t
-http3_hdrcache_length(gconstpointer vv)
-{
-    const guint8 *v = (const guint8 *)vv;
-    guint32       namelen, valuelen;
-
-    namelen  = pntoh32(v);
-    valuelen = pntoh32(v + sizeof(namelen) + namelen);
-
-    return namelen + sizeof(namelen) + valuelen + sizeof(valuelen);
-}
-
-static guint
-http3_hdrcache_hash(gconstpointer key)
-{
-    return wmem_strong_hash((const guint8 *)key, http3_hdrcache_length(key));
-}
-
-static gboolean
-http3_hdrcache_equal(gconstpointer lhs, gconstpointer rhs)
-{
-    const guint8 *a    = (const guint8 *)lhs;
-    const guint8 *b    = (const guint8 *)rhs;
-    size_t        alen = http3_hdrcache_length(a);
-    size_t        blen = http3_hdrcache_length(b);
-
-    return alen == blen && memcmp(a, b, alen) == 0;
-}
-
-static size_t
-http3_hdrdefcache_length(gconstpointer vv)
-{
-    const guint8 *v = (const guint8 *)vv;
-    guint32       namelen;
-
-    namelen = pntoh32(v);
-
-    return namelen + sizeof(namelen);
-}
-
-static guint
-http3_hdrdefcache_hash(gconstpointer key)
-{
-    return wmem_strong_hash((const guint8 *)key, http3_hdrdefcache_length(key));
-}
-
-static gboolean
-http3_hdrdefcache_equal(gconstpointer lhs, gconstpointer rhs)
-{
-    const guint8 *a    = (const guint8 *)lhs;
-    const guint8 *b    = (const guint8 *)rhs;
-    size_t        alen = http3_hdrdefcache_length(a);
-    size_t        blen = http3_hdrdefcache_length(b);
-
-    return alen == blen && memcmp(a, b, alen) == 0;
-}
-#endif
-
 /* Deallocation callback */
 static bool
 http3_file_local_ctx_del_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_, void *user_data _U_)
@@ -2808,12 +2663,6 @@ http3_get_file_local_ctx(void)
         g_http3_file_local_ctx = wmem_new(wmem_file_scope(), http3_file_local_ctx);
         g_http3_file_local_ctx->conn_info_map =
             wmem_map_new(wmem_file_scope(), http3_conn_info_hash, http3_conn_info_equal);
-#ifdef HAVE_NGHTTP3
-        g_http3_file_local_ctx->hdr_cache_map =
-            wmem_map_new(wmem_file_scope(), http3_hdrcache_hash, http3_hdrcache_equal);
-        g_http3_file_local_ctx->hdr_def_cache_map =
-            wmem_map_new(wmem_file_scope(), http3_hdrdefcache_hash, http3_hdrdefcache_equal);
-#endif
         wmem_register_callback(wmem_file_scope(), http3_file_local_ctx_del_cb, NULL);
     }
 
@@ -1551,6 +1551,7 @@ static guint32 dissect_ies(tvbuff_t *tvb, packet_info *pinfo, guint32 offset,
 
         /* if the representation of the item has already been set, use that;
            else we have to allocate a block to put the text into */
+        proto_item_render_label(ie_finfo);
         if (ie_finfo && ie_finfo->rep != NULL)
           proto_item_set_text(ti, "Information Element: %s",
                               ie_finfo->rep->representation);
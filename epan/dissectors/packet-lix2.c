@@ -24510,7 +24510,7 @@ void proto_register_lix2(void) {
   proto_lix2 = proto_register_protocol(PNAME, PSNAME, PFNAME);
 
   /* Register fields and subtrees */
-  proto_register_field_array(proto_lix2, hf, array_length(hf));
+  proto_register_field_array_lazy(proto_lix2, hf, array_length(hf));
   proto_register_subtree_array(ett, array_length(ett));
 
   lix2_handle = register_dissector("xiri", dissect_XIRIPayload_PDU, proto_lix2);
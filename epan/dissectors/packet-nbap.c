@@ -70569,7 +70569,7 @@ void proto_register_nbap(void)
   /* Register protocol */
   proto_nbap = proto_register_protocol(PNAME, PSNAME, PFNAME);
   /* Register fields and subtrees */
-  proto_register_field_array(proto_nbap, hf, array_length(hf));
+  proto_register_field_array_lazy(proto_nbap, hf, array_length(hf));
   proto_register_subtree_array(ett, array_length(ett));
   expert_nbap = expert_register_protocol(proto_nbap);
   expert_register_field_array(expert_nbap, ei, array_length(ei));
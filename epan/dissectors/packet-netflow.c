@@ -134,7 +134,9 @@
 #include <epan/addr_resolv.h>
 #include <epan/conversation.h>
 #include <epan/proto_data.h>
+#include <epan/tap.h>
 #include <wsutil/str_util.h>
+#include "packet-netflow.h"
 #include "packet-tcp.h"
 #include "packet-udp.h"
 #include "packet-ntp.h"
@@ -315,6 +317,18 @@ typedef enum {
 #define TF_NUM 2
 #define TF_NUM_EXT TF_NO_VENDOR_INFO+1   /* includes vendor fields */
 
+/* Record fields the "netflow" tap picks out of each data record */
+typedef enum {
+    FK_SRC_ADDR=0,
+    FK_DST_ADDR,
+    FK_SRC_PORT,
+    FK_DST_PORT,
+    FK_PROTOCOL,
+    FK_BYTES,
+    FK_PACKETS,
+    FK_NUM
+} v9_v10_flow_key_t;
+
 typedef struct _v9_v10_tmplt {
     /* For linking back to show where fields were defined */
     guint32  template_frame_number;
@@ -327,6 +341,12 @@ typedef struct _v9_v10_tmplt {
     guint    length;
     guint16  field_count[TF_NUM];                /* 0:scopes; 1:entries  */
     v9_v10_tmplt_entry_t *fields_p[TF_NUM_EXT];  /* 0:scopes; 1:entries; n:vendor_entries  */
+    /* Decode plan, filled in by v9_v10_tmplt_compile() when the template is cached */
+    gboolean fixed_length;                      /* no variable length fields; records are 'length' bytes */
+    gboolean plain;                             /* without a tree, records need nothing but skipping */
+    gboolean flow_keyed;                        /* data (not options) records with an address or port */
+    gint     flow_key_offset[FK_NUM];           /* offset within a record, -1 if not at a fixed offset */
+    guint16  flow_key_length[FK_NUM];
 } v9_v10_tmplt_t;
 
 
@@ -334,6 +354,12 @@ typedef struct _v9_v10_tmplt {
 /* Confusingly, for key, fill in only relevant parts of v9_v10_tmplt_entry_t... */
 wmem_map_t *v9_v10_tmplt_table;
 
+/* Last template found by v9_v10_tmplt_lookup(); exporters tend to send  */
+/* long runs of data sets for the same template.                          */
+static v9_v10_tmplt_t *v9_v10_tmplt_last;
+
+static int netflow_tap;
+
 
 static const value_string v9_v10_template_types[] = {
     {   1, "BYTES" },
@@ -4155,6 +4181,7 @@ typedef struct _hdrinfo_t {
     guint8  vspec;
     guint32 src_id;            /* SourceID in NetFlow V9, Observation Domain ID in IPFIX */
     time_t  export_time_secs;  /* secs since epoch */
+    wmem_array_t *flow_records; /* netflow_flow_record_t for the tap, NULL if nobody listens */
 } hdrinfo_t;
 
 typedef int     dissect_pdu_t(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, int offset,
@@ -4198,6 +4225,9 @@ static int      flow_process_sizecount(proto_tree *pdutree, tvbuff_t *tvb,
                                        int offset);
 
 static v9_v10_tmplt_t *v9_v10_tmplt_build_key(v9_v10_tmplt_t *tmplt_p, packet_info *pinfo, guint32 src_id, guint16 tmplt_id);
+static v9_v10_tmplt_t *v9_v10_tmplt_lookup(packet_info *pinfo, guint32 src_id, guint16 tmplt_id);
+static void     v9_v10_tmplt_compile(v9_v10_tmplt_t *tmplt_p, gboolean options);
+static void     v9_v10_tap_add_record(tvbuff_t *tvb, int offset, v9_v10_tmplt_t *tmplt_p, hdrinfo_t *hdrinfo_p);
 
 
 static int
@@ -4421,6 +4451,10 @@ dissect_netflow(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data
 
     hdrinfo.vspec = ver;
     hdrinfo.src_id = 0;
+    hdrinfo.flow_records = NULL;
+    if (((ver == 9) || (ver == 10)) && have_tap_listener(netflow_tap)) {
+        hdrinfo.flow_records = wmem_array_new(pinfo->pool, sizeof(netflow_flow_record_t));
+    }
 
     if (tree)
         proto_tree_add_uint(netflow_tree, hf_cflow_version, tvb, offset, 2, ver);
@@ -4658,6 +4692,14 @@ dissect_netflow(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data
         show_sequence_analysis_info(hdrinfo.src_id, flow_sequence, pinfo, tvb, flow_sequence_ti, netflow_tree);
     }
 
+    if (hdrinfo.flow_records != NULL) {
+        netflow_flows_tap_t *tap_info = wmem_new(pinfo->pool, netflow_flows_tap_t);
+
+        tap_info->num_records = wmem_array_get_count(hdrinfo.flow_records);
+        tap_info->records = (const netflow_flow_record_t *)wmem_array_get_raw(hdrinfo.flow_records);
+        tap_queue_packet(netflow_tap, pinfo, tap_info);
+    }
+
     return tvb_reported_length(tvb);
 }
 
@@ -5010,7 +5052,6 @@ dissect_v9_v10_data(tvbuff_t *tvb, packet_info *pinfo, proto_tree *pdutree, int
                     guint16 id, guint length, hdrinfo_t *hdrinfo_p, guint32 *flows_seen)
 {
     v9_v10_tmplt_t *tmplt_p;
-    v9_v10_tmplt_t  tmplt_key;
     proto_tree     *data_tree;
     guint           pdu_len;
 
@@ -5019,12 +5060,27 @@ dissect_v9_v10_data(tvbuff_t *tvb, packet_info *pinfo, proto_tree *pdutree, int
     }
 
     /* Look up template */
-    v9_v10_tmplt_build_key(&tmplt_key, pinfo, hdrinfo_p->src_id, id);
-    tmplt_p = (v9_v10_tmplt_t *)wmem_map_lookup(v9_v10_tmplt_table, &tmplt_key);
+    tmplt_p = v9_v10_tmplt_lookup(pinfo, hdrinfo_p->src_id, id);
     if ((tmplt_p != NULL)  && (tmplt_p->length != 0)) {
         int count = 1;
         proto_item *ti;
 
+        if ((pdutree == NULL) && tmplt_p->plain) {
+            /* Nothing to show and nothing else to do for these records:  */
+            /* step over them using the template's record length.         */
+            guint records = length / tmplt_p->length;
+
+            /* Records cut short throw here just as they would when dissected */
+            tvb_ensure_bytes_exist(tvb, offset, (int)(records * tmplt_p->length));
+            if ((hdrinfo_p->flow_records != NULL) && tmplt_p->flow_keyed) {
+                for (guint r = 0; r < records; r++) {
+                    v9_v10_tap_add_record(tvb, offset + (int)(r * tmplt_p->length), tmplt_p, hdrinfo_p);
+                }
+            }
+            *flows_seen += records;
+            return 0;
+        }
+
         /* Provide a link back to template frame */
         ti = proto_tree_add_uint(pdutree, hf_template_frame, tvb,
                                  0, 0, tmplt_p->template_frame_number);
@@ -5040,6 +5096,9 @@ dissect_v9_v10_data(tvbuff_t *tvb, packet_info *pinfo, proto_tree *pdutree, int
                                             ett_dataflowset, NULL, "Flow %d", count++);
 
             pdu_len = dissect_v9_v10_pdu(tvb, pinfo, data_tree, offset, tmplt_p, hdrinfo_p, flows_seen);
+            if ((hdrinfo_p->flow_records != NULL) && tmplt_p->flow_keyed) {
+                v9_v10_tap_add_record(tvb, offset, tmplt_p, hdrinfo_p);
+            }
 
             offset += pdu_len;
             /* XXX - Throw an exception */
@@ -5175,7 +5234,6 @@ dissect_v10_pdu_subtemplate_list(tvbuff_t* tvb, packet_info* pinfo, proto_item*
     int            end_offset   = offset + length;
     guint32        semantic, subtemplate_id;
     v9_v10_tmplt_t *subtmplt_p;
-    v9_v10_tmplt_t  tmplt_key;
     proto_tree     *pdutree = proto_item_add_subtree(pduitem, ett_subtemplate_list);
 
     proto_tree_add_item_ret_uint(pdutree, hf_cflow_subtemplate_semantic, tvb, offset, 1, ENC_BIG_ENDIAN, &semantic);
@@ -5184,8 +5242,7 @@ dissect_v10_pdu_subtemplate_list(tvbuff_t* tvb, packet_info* pinfo, proto_item*
     offset += 3;
 
     /* Look up template */
-    v9_v10_tmplt_build_key(&tmplt_key, pinfo, hdrinfo_p->src_id, subtemplate_id);
-    subtmplt_p = (v9_v10_tmplt_t *)wmem_map_lookup(v9_v10_tmplt_table, &tmplt_key);
+    subtmplt_p = v9_v10_tmplt_lookup(pinfo, hdrinfo_p->src_id, subtemplate_id);
 
     if (subtmplt_p != NULL) {
         proto_item *ti;
@@ -13157,6 +13214,7 @@ dissect_v9_v10_options_template(tvbuff_t *tvb, packet_info *pinfo, proto_tree *p
             copy_address_wmem(wmem_file_scope(), &tmplt_p->dst_addr, &pinfo->net_dst);
             /* Remember when we saw this template */
             tmplt_p->template_frame_number = pinfo->num;
+            v9_v10_tmplt_compile(tmplt_p, TRUE);
             /* Add completed entry into table */
             wmem_map_insert(v9_v10_tmplt_table, tmplt_p, tmplt_p);
         }
@@ -13265,6 +13323,7 @@ dissect_v9_v10_data_template(tvbuff_t *tvb, packet_info *pinfo, proto_tree *pdut
             copy_address_wmem(wmem_file_scope(), &tmplt_p->dst_addr, &pinfo->net_dst);
             /* Remember when we saw this template */
             tmplt_p->template_frame_number = pinfo->num;
+            v9_v10_tmplt_compile(tmplt_p, FALSE);
             wmem_map_insert(v9_v10_tmplt_table, tmplt_p, tmplt_p);
 
             /* Create if necessary observation domain entry (for use with sequence analysis) */
@@ -13329,6 +13388,190 @@ v9_v10_tmplt_table_hash(gconstpointer k)
     return val;
 }
 
+/* Find the cached template for this exporter; try the last one found first */
+static v9_v10_tmplt_t *
+v9_v10_tmplt_lookup(packet_info *pinfo, guint32 src_id, guint16 tmplt_id)
+{
+    v9_v10_tmplt_t *tmplt_p = v9_v10_tmplt_last;
+    v9_v10_tmplt_t  tmplt_key;
+
+    if ((tmplt_p != NULL)                             &&
+        (tmplt_p->tmplt_id == tmplt_id)               &&
+        (tmplt_p->src_id   == src_id)                 &&
+        (tmplt_p->src_port == pinfo->srcport)         &&
+        (tmplt_p->dst_port == pinfo->destport)        &&
+        addresses_equal(&tmplt_p->src_addr, &pinfo->net_src) &&
+        addresses_equal(&tmplt_p->dst_addr, &pinfo->net_dst)) {
+        return tmplt_p;
+    }
+
+    v9_v10_tmplt_build_key(&tmplt_key, pinfo, src_id, tmplt_id);
+    tmplt_p = (v9_v10_tmplt_t *)wmem_map_lookup(v9_v10_tmplt_table, &tmplt_key);
+    if (tmplt_p != NULL) {
+        v9_v10_tmplt_last = tmplt_p;
+    }
+    return tmplt_p;
+}
+
+/* Which of the fields the tap wants (if any) an IANA field type is */
+static v9_v10_flow_key_t
+v9_v10_flow_key(guint16 type, guint16 length)
+{
+    switch (type) {
+    case 8:   /* sourceIPv4Address */
+        return (length == 4) ? FK_SRC_ADDR : FK_NUM;
+    case 27:  /* sourceIPv6Address */
+        return (length == 16) ? FK_SRC_ADDR : FK_NUM;
+    case 12:  /* destinationIPv4Address */
+        return (length == 4) ? FK_DST_ADDR : FK_NUM;
+    case 28:  /* destinationIPv6Address */
+        return (length == 16) ? FK_DST_ADDR : FK_NUM;
+    case 7:   /* sourceTransportPort */
+    case 180: /* udpSourcePort */
+    case 182: /* tcpSourcePort */
+        return (length == 2) ? FK_SRC_PORT : FK_NUM;
+    case 11:  /* destinationTransportPort */
+    case 181: /* udpDestinationPort */
+    case 183: /* tcpDestinationPort */
+        return (length == 2) ? FK_DST_PORT : FK_NUM;
+    case 4:   /* protocolIdentifier */
+        return (length == 1) ? FK_PROTOCOL : FK_NUM;
+    case 1:   /* octetDeltaCount */
+        return (length >= 1 && length <= 8) ? FK_BYTES : FK_NUM;
+    case 2:   /* packetDeltaCount */
+        return (length >= 1 && length <= 8) ? FK_PACKETS : FK_NUM;
+    default:
+        return FK_NUM;
+    }
+}
+
+/* Work out once, when a template is cached, what dissect_v9_v10_data()
+ * and the tap need to know about the layout of its records. */
+static void
+v9_v10_tmplt_compile(v9_v10_tmplt_t *tmplt_p, gboolean options)
+{
+    int offset = 0;
+    int i, j;
+
+    tmplt_p->fixed_length = TRUE;
+    /* Process information templates are passed on to procflow, see the */
+    /* end of dissect_v9_v10_pdu_data().                                  */
+    tmplt_p->plain = (tmplt_p->tmplt_id < 256) || (tmplt_p->tmplt_id > 259);
+    for (i = 0; i < FK_NUM; i++) {
+        tmplt_p->flow_key_offset[i] = -1;
+        tmplt_p->flow_key_length[i] = 0;
+    }
+
+    for (i = TF_SCOPES; i <= TF_ENTRIES; i++) {
+        const v9_v10_tmplt_entry_t *entries_p = tmplt_p->fields_p[i];
+
+        if (entries_p == NULL)
+            continue;
+
+        for (j = 0; j < tmplt_p->field_count[i]; j++) {
+            guint16            type   = entries_p[j].type;
+            guint16            length = entries_p[j].length;
+            v9_v10_flow_key_t  key;
+
+            if (length == VARIABLE_LENGTH) {
+                /* Nothing from here on is at a fixed offset */
+                tmplt_p->fixed_length = FALSE;
+                tmplt_p->plain = FALSE;
+                continue;
+            }
+            if (entries_p[j].pen != 0) {
+                /* Vendor fields may call other dissectors or add expert info */
+                tmplt_p->plain = FALSE;
+            } else if ((type == 292) || (type == 315)) {
+                /* subTemplateList and dataLinkFrameSection dissect their contents */
+                tmplt_p->plain = FALSE;
+            }
+
+            if (tmplt_p->fixed_length && (i == TF_ENTRIES) && (entries_p[j].pen == 0)) {
+                key = v9_v10_flow_key(type, length);
+                if ((key != FK_NUM) && (tmplt_p->flow_key_offset[key] < 0)) {
+                    tmplt_p->flow_key_offset[key] = offset;
+                    tmplt_p->flow_key_length[key] = length;
+                }
+            }
+            offset += length;
+        }
+    }
+
+    /* Options records describe the exporter, not flows, and a record  */
+    /* without any of the 5-tuple's endpoints would only add "<none>"   */
+    /* flows to the tap.                                                */
+    tmplt_p->flow_keyed = !options &&
+        ((tmplt_p->flow_key_offset[FK_SRC_ADDR] >= 0) || (tmplt_p->flow_key_offset[FK_DST_ADDR] >= 0) ||
+         (tmplt_p->flow_key_offset[FK_SRC_PORT] >= 0) || (tmplt_p->flow_key_offset[FK_DST_PORT] >= 0));
+}
+
+static guint64
+v9_v10_get_counter(tvbuff_t *tvb, int offset, guint16 length)
+{
+    switch (length) {
+    case 1:
+        return tvb_get_guint8(tvb, offset);
+    case 2:
+        return tvb_get_ntohs(tvb, offset);
+    case 3:
+        return tvb_get_ntoh24(tvb, offset);
+    case 4:
+        return tvb_get_ntohl(tvb, offset);
+    case 5:
+        return tvb_get_ntoh40(tvb, offset);
+    case 6:
+        return tvb_get_ntoh48(tvb, offset);
+    case 7:
+        return tvb_get_ntoh56(tvb, offset);
+    default:
+        return tvb_get_ntoh64(tvb, offset);
+    }
+}
+
+/* Pick the tap's fields out of the data record at offset using the template's decode plan */
+static void
+v9_v10_tap_add_record(tvbuff_t *tvb, int offset, v9_v10_tmplt_t *tmplt_p, hdrinfo_t *hdrinfo_p)
+{
+    const gint            *key_offset = tmplt_p->flow_key_offset;
+    const guint16         *key_length = tmplt_p->flow_key_length;
+    netflow_flow_record_t  record;
+
+    /* All the fields at fixed offsets lie within the first 'length' bytes; */
+    /* a record cut short by the capture is left out rather than thrown on.  */
+    if (!tvb_bytes_exist(tvb, offset, tmplt_p->length))
+        return;
+
+    memset(&record, 0, sizeof(record));
+    if (key_offset[FK_SRC_ADDR] >= 0) {
+        set_address_tvb(&record.src_addr, (key_length[FK_SRC_ADDR] == 4) ? AT_IPv4 : AT_IPv6,
+                        key_length[FK_SRC_ADDR], tvb, offset + key_offset[FK_SRC_ADDR]);
+    }
+    if (key_offset[FK_DST_ADDR] >= 0) {
+        set_address_tvb(&record.dst_addr, (key_length[FK_DST_ADDR] == 4) ? AT_IPv4 : AT_IPv6,
+                        key_length[FK_DST_ADDR], tvb, offset + key_offset[FK_DST_ADDR]);
+    }
+    if (key_offset[FK_SRC_PORT] >= 0)
+        record.src_port = tvb_get_ntohs(tvb, offset + key_offset[FK_SRC_PORT]);
+    if (key_offset[FK_DST_PORT] >= 0)
+        record.dst_port = tvb_get_ntohs(tvb, offset + key_offset[FK_DST_PORT]);
+    if (key_offset[FK_PROTOCOL] >= 0)
+        record.protocol = tvb_get_guint8(tvb, offset + key_offset[FK_PROTOCOL]);
+    if (key_offset[FK_BYTES] >= 0)
+        record.bytes = v9_v10_get_counter(tvb, offset + key_offset[FK_BYTES], key_length[FK_BYTES]);
+    if (key_offset[FK_PACKETS] >= 0)
+        record.packets = v9_v10_get_counter(tvb, offset + key_offset[FK_PACKETS], key_length[FK_PACKETS]);
+
+    wmem_array_append_one(hdrinfo_p->flow_records, record);
+}
+
+static void
+netflow_cleanup(void)
+{
+    /* The templates themselves go with the file scope */
+    v9_v10_tmplt_last = NULL;
+}
+
 /*
  * dissect a version 1, 5, or 7 pdu and return the length of the pdu we
  * processed
@@ -22243,6 +22486,9 @@ proto_register_netflow(void)
                                    &netflow_preference_tcpflags_1byte_cwr);
 
     v9_v10_tmplt_table = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), v9_v10_tmplt_table_hash, v9_v10_tmplt_table_equal);
+    register_cleanup_routine(netflow_cleanup);
+
+    netflow_tap = register_tap("netflow");
 }
 
 static guint
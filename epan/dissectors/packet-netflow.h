@@ -0,0 +1,35 @@
+/* packet-netflow.h
+ * Definitions for Cisco NetFlow and IPFIX
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __PACKET_NETFLOW_H__
+#define __PACKET_NETFLOW_H__
+
+#include <epan/address.h>
+
+/* One NetFlow v9 / IPFIX data record, as seen by the "netflow" tap.
+ * Fields the record's template doesn't carry are left zeroed
+ * (AT_NONE for the addresses). */
+typedef struct _netflow_flow_record_t {
+    address  src_addr;
+    address  dst_addr;
+    guint16  src_port;
+    guint16  dst_port;
+    guint8   protocol;
+    guint64  bytes;
+    guint64  packets;
+} netflow_flow_record_t;
+
+/* Data queued to the "netflow" tap, once per packet */
+typedef struct _netflow_flows_tap_t {
+    guint                        num_records;
+    const netflow_flow_record_t *records;
+} netflow_flows_tap_t;
+
+#endif /* __PACKET_NETFLOW_H__ */
@@ -2813,6 +2813,7 @@ quic_decrypt_message(quic_pp_cipher *pp_cipher, tvbuff_t *head, guint header_len
                      guint8 first_byte, guint pkn_len, guint64 packet_number, quic_decrypt_result_t *result, packet_info *pinfo)
 {
     gcry_error_t    err;
+    guint8          header_buf[64];
     guint8         *header;
     guint8          nonce[TLS13_AEAD_NONCE_LENGTH];
     guint8         *buffer;
@@ -2828,7 +2829,12 @@ quic_decrypt_message(quic_pp_cipher *pp_cipher, tvbuff_t *head, guint header_len
     DISSECTOR_ASSERT(pkn_len < header_length);
     DISSECTOR_ASSERT(1 <= pkn_len && pkn_len <= 4);
     // copy header, but replace encrypted first byte and PKN by plaintext.
-    header = (guint8 *)tvb_memdup(pinfo->pool, head, 0, header_length);
+    // Short headers (the bulk of the packets) always fit on the stack.
+    if (header_length <= sizeof(header_buf)) {
+        header = (guint8 *)tvb_memcpy(head, header_buf, 0, header_length);
+    } else {
+        header = (guint8 *)tvb_memdup(pinfo->pool, head, 0, header_length);
+    }
     header[0] = first_byte;
     for (guint i = 0; i < pkn_len; i++) {
         header[header_length - 1 - i] = (guint8)(packet_number >> (8 * i));
@@ -3471,6 +3477,10 @@ quic_process_payload(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, proto_
     }
 }
 
+/* The Retry keys are constants, so one cipher handle per key is kept for
+ * the lifetime of the process instead of creating one per packet. */
+static gcry_cipher_hd_t quic_retry_ciphers[4];
+
 static void
 quic_verify_retry_token(tvbuff_t *tvb, quic_packet_info_t *quic_packet, const quic_cid_t *odcid, guint32 version)
 {
@@ -3506,33 +3516,42 @@ quic_verify_retry_token(tvbuff_t *tvb, quic_packet_info_t *quic_packet, const qu
     static const guint8 nonce_v2[] = {
         0xd8, 0x69, 0x69, 0xbc, 0x2d, 0x7c, 0x6d, 0x99, 0x90, 0xef, 0xb0, 0x4a
     };
-    gcry_cipher_hd_t    h = NULL;
+    const guint8       *key, *nonce;
+    guint               cipher_idx;
+    gcry_cipher_hd_t    h;
     gcry_error_t        err;
     gint                pseudo_packet_tail_length = tvb_reported_length(tvb) - 16;
 
     DISSECTOR_ASSERT(pseudo_packet_tail_length > 0);
 
-    err = gcry_cipher_open(&h, GCRY_CIPHER_AES128, GCRY_CIPHER_MODE_GCM, 0);
-    DISSECTOR_ASSERT_HINT(err == 0, "create cipher");
     if (is_quic_draft_max(version, 28)) {
-       err = gcry_cipher_setkey(h, key_draft_25, sizeof(key_draft_25));
+        cipher_idx = 0;
+        key = key_draft_25;
+        nonce = nonce_draft_25;
     } else if (is_quic_draft_max(version, 32)) {
-       err = gcry_cipher_setkey(h, key_draft_29, sizeof(key_draft_29));
+        cipher_idx = 1;
+        key = key_draft_29;
+        nonce = nonce_draft_29;
     } else if (is_quic_draft_max(version, 34)) {
-       err = gcry_cipher_setkey(h, key_v1, sizeof(key_v1));
+        cipher_idx = 2;
+        key = key_v1;
+        nonce = nonce_v1;
     } else {
-       err = gcry_cipher_setkey(h, key_v2, sizeof(key_v2));
-    }
-    DISSECTOR_ASSERT_HINT(err == 0, "set key");
-    if (is_quic_draft_max(version, 28)) {
-        err = gcry_cipher_setiv(h, nonce_draft_25, sizeof(nonce_draft_25));
-    } else if (is_quic_draft_max(version, 32)) {
-        err = gcry_cipher_setiv(h, nonce_draft_29, sizeof(nonce_draft_29));
-    } else if (is_quic_draft_max(version, 34)) {
-        err = gcry_cipher_setiv(h, nonce_v1, sizeof(nonce_v1));
+        cipher_idx = 3;
+        key = key_v2;
+        nonce = nonce_v2;
+    }
+    h = quic_retry_ciphers[cipher_idx];
+    if (!h) {
+        err = gcry_cipher_open(&h, GCRY_CIPHER_AES128, GCRY_CIPHER_MODE_GCM, 0);
+        DISSECTOR_ASSERT_HINT(err == 0, "create cipher");
+        err = gcry_cipher_setkey(h, key, sizeof(key_v1));
+        DISSECTOR_ASSERT_HINT(err == 0, "set key");
+        quic_retry_ciphers[cipher_idx] = h;
     } else {
-        err = gcry_cipher_setiv(h, nonce_v2, sizeof(nonce_v2));
+        gcry_cipher_reset(h);
     }
+    err = gcry_cipher_setiv(h, nonce, sizeof(nonce_v1));
     DISSECTOR_ASSERT_HINT(err == 0, "set nonce");
     G_STATIC_ASSERT(sizeof(odcid->len) == 1);
     err = gcry_cipher_authenticate(h, odcid, 1 + odcid->len);
@@ -3546,7 +3565,6 @@ quic_verify_retry_token(tvbuff_t *tvb, quic_packet_info_t *quic_packet, const qu
     } else {
         quic_packet->retry_integrity_success = TRUE;
     }
-    gcry_cipher_close(h);
 }
 
 void
@@ -4720,6 +4738,18 @@ quic_cleanup(void)
     quic_server_connections = NULL;
 }
 
+/** Release the Retry Integrity Tag cipher handles on exit. */
+static void
+quic_shutdown(void)
+{
+    for (guint i = 0; i < G_N_ELEMENTS(quic_retry_ciphers); i++) {
+        if (quic_retry_ciphers[i]) {
+            gcry_cipher_close(quic_retry_ciphers[i]);
+            quic_retry_ciphers[i] = NULL;
+        }
+    }
+}
+
 /* Follow QUIC Stream functionality {{{ */
 static void
 quic_streams_add(packet_info *pinfo, quic_info_data_t *quic_info, guint64 stream_id)
@@ -5656,6 +5686,7 @@ proto_register_quic(void)
 
     register_init_routine(quic_init);
     register_cleanup_routine(quic_cleanup);
+    register_shutdown_routine(quic_shutdown);
 
     register_follow_stream(proto_quic, "quic_follow", quic_follow_conv_filter, quic_follow_index_filter, quic_follow_address_filter,
                            udp_port_to_display, follow_quic_tap_listener, get_quic_connections_count,
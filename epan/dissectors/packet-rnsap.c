@@ -63116,7 +63116,7 @@ void proto_register_rnsap(void) {
   /* Register protocol */
   proto_rnsap = proto_register_protocol(PNAME, PSNAME, PFNAME);
   /* Register fields and subtrees */
-  proto_register_field_array(proto_rnsap, hf, array_length(hf));
+  proto_register_field_array_lazy(proto_rnsap, hf, array_length(hf));
   proto_register_subtree_array(ett, array_length(ett));
 
   /* Register dissector */
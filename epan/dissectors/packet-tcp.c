@@ -34,6 +34,7 @@
 #include <wsutil/wsgcrypt.h>
 #include <wsutil/pint.h>
 #include <wsutil/ws_assert.h>
+#include <wsutil/wslog.h>
 
 #include "packet-tcp.h"
 #include "packet-ip.h"
@@ -743,6 +744,40 @@ static capture_dissector_handle_t tcp_cap_handle;
 static guint32 tcp_stream_count;
 static guint32 mptcp_stream_count;
 
+/* Per-frame analysis results (struct tcp_acked), indexed by frame number.
+ * A flat array is both smaller and faster than one wmem_tree per
+ * conversation keyed by frame, seq and ack.
+ */
+static GPtrArray *tcp_acked_by_frame;
+
+/* Memory accounting for the per-file TCP state, reported in the debug
+ * log when the capture file is closed. "count" and "bytes" are the live
+ * totals, "peak_bytes" is their high-water mark.
+ */
+typedef struct {
+    guint64 count;
+    guint64 bytes;
+    guint64 peak_bytes;
+} tcp_mem_counter_t;
+
+static struct {
+    tcp_mem_counter_t conversations;
+    tcp_mem_counter_t acked;
+    tcp_mem_counter_t unacked;
+    tcp_mem_counter_t msps;
+    tcp_mem_counter_t ooo_segments;
+} tcp_mem_stats;
+
+static inline void
+tcp_mem_account(tcp_mem_counter_t *counter, gint64 count, gint64 bytes)
+{
+    counter->count += count;
+    counter->bytes += bytes;
+    if (counter->bytes > counter->peak_bytes) {
+        counter->peak_bytes = counter->bytes;
+    }
+}
+
 
 
 /*
@@ -1773,6 +1808,7 @@ init_tcp_conversation_data(packet_info *pinfo, int direction)
 
     /* Initialize the tcp protocol data structure to add to the tcp conversation */
     tcpd=wmem_new0(wmem_file_scope(), struct tcp_analysis);
+    tcp_mem_account(&tcp_mem_stats.conversations, 1, sizeof(struct tcp_analysis));
     tcpd->flow1.win_scale = (direction >= 0) ? pinfo->src_win_scale : pinfo->dst_win_scale;
     tcpd->flow1.window = G_MAXUINT32;
     tcpd->flow1.multisegment_pdus=wmem_tree_new(wmem_file_scope());
@@ -1791,15 +1827,16 @@ init_tcp_conversation_data(packet_info *pinfo, int direction)
     {
         tcpd->flow1.tcp_analyze_seq_info = wmem_new0(wmem_file_scope(), struct tcp_analyze_seq_flow_info_t);
         tcpd->flow2.tcp_analyze_seq_info = wmem_new0(wmem_file_scope(), struct tcp_analyze_seq_flow_info_t);
+        tcp_mem_account(&tcp_mem_stats.conversations, 0, 2 * sizeof(struct tcp_analyze_seq_flow_info_t));
     }
     /* Only allocate the data if its actually going to be displayed */
     if (tcp_display_process_info)
     {
         tcpd->flow1.process_info = wmem_new0(wmem_file_scope(), struct tcp_process_info_t);
         tcpd->flow2.process_info = wmem_new0(wmem_file_scope(), struct tcp_process_info_t);
+        tcp_mem_account(&tcp_mem_stats.conversations, 0, 2 * sizeof(struct tcp_process_info_t));
     }
 
-    tcpd->acked_table=wmem_tree_new(wmem_file_scope());
     tcpd->ts_first.secs=pinfo->abs_ts.secs;
     tcpd->ts_first.nsecs=pinfo->abs_ts.nsecs;
     nstime_set_zero(&tcpd->ts_mru_syn);
@@ -2124,6 +2161,7 @@ pdu_store_sequencenumber_of_next_pdu(packet_info *pinfo, guint32 seq, guint32 nx
     msp->last_frame_time=pinfo->abs_ts;
     msp->flags=0;
     wmem_tree_insert32(multisegment_pdus, seq, (void *)msp);
+    tcp_mem_account(&tcp_mem_stats.msps, 1, sizeof(struct tcp_multisegment_pdu));
     /*ws_warning("pdu_store_sequencenumber_of_next_pdu: seq %u", seq);*/
     return msp;
 }
@@ -2189,30 +2227,33 @@ pdu_store_window_scale_option(guint8 ws, struct tcp_analysis *tcpd)
 static void
 tcp_analyze_get_acked_struct(guint32 frame, guint32 seq, guint32 ack, gboolean createflag, struct tcp_analysis *tcpd)
 {
-
-    wmem_tree_key_t key[4];
-
-    key[0].length = 1;
-    key[0].key = &frame;
-
-    key[1].length = 1;
-    key[1].key = &seq;
-
-    key[2].length = 1;
-    key[2].key = &ack;
-
-    key[3].length = 0;
-    key[3].key = NULL;
+    struct tcp_acked *ta = NULL;
 
     if (!tcpd) {
         return;
     }
 
-    tcpd->ta = (struct tcp_acked *)wmem_tree_lookup32_array(tcpd->acked_table, key);
-    if((!tcpd->ta) && createflag) {
-        tcpd->ta = wmem_new0(wmem_file_scope(), struct tcp_acked);
-        wmem_tree_insert32_array(tcpd->acked_table, key, (void *)tcpd->ta);
+    if (frame < tcp_acked_by_frame->len) {
+        for (ta = (struct tcp_acked *)g_ptr_array_index(tcp_acked_by_frame, frame); ta; ta = ta->next) {
+            if (ta->stream == tcpd->stream && ta->seq == seq && ta->ack == ack) {
+                break;
+            }
+        }
+    }
+    if ((!ta) && createflag) {
+        ta = wmem_new0(wmem_file_scope(), struct tcp_acked);
+        ta->stream = tcpd->stream;
+        ta->seq = seq;
+        ta->ack = ack;
+        if (frame >= tcp_acked_by_frame->len) {
+            g_ptr_array_set_size(tcp_acked_by_frame, frame + 1);
+        }
+        /* Several segments in one frame are rare; prepend to the chain. */
+        ta->next = (struct tcp_acked *)g_ptr_array_index(tcp_acked_by_frame, frame);
+        g_ptr_array_index(tcp_acked_by_frame, frame) = ta;
+        tcp_mem_account(&tcp_mem_stats.acked, 1, sizeof(struct tcp_acked));
     }
+    tcpd->ta = ta;
 }
 
 
@@ -2757,6 +2798,7 @@ finished_checking_retransmission_type:
          * aren't "too many" unacked segments (e.g., we're not seeing the ACKs).
          */
         ual = wmem_new(wmem_file_scope(), tcp_unacked_t);
+        tcp_mem_account(&tcp_mem_stats.unacked, 1, sizeof(tcp_unacked_t));
         ual->next=tcpd->fwd->tcp_analyze_seq_info->segments;
         tcpd->fwd->tcp_analyze_seq_info->segments=ual;
         tcpd->fwd->tcp_analyze_seq_info->segment_count++;
@@ -2929,6 +2971,7 @@ finished_checking_retransmission_type:
             prevual->next = tmpual;
         }
         wmem_free(wmem_file_scope(), ual);
+        tcp_mem_account(&tcp_mem_stats.unacked, -1, -(gint64)sizeof(tcp_unacked_t));
         ual = tmpual;
         tcpd->rev->tcp_analyze_seq_info->segment_count--;
     }
@@ -4127,6 +4170,10 @@ msp_add_out_of_order(packet_info *pinfo, struct tcp_multisegment_pdu *msp, struc
         tvb_free(tvb_data);
         wmem_list_remove_frame(tcpd->fwd->ooo_segments, curr_entry);
         curr_entry = wmem_list_head(tcpd->fwd->ooo_segments);
+        /* The reassembly code has its own copy of the data now. */
+        tcp_mem_account(&tcp_mem_stats.ooo_segments, -1, -(gint64)(sizeof(ooo_segment_item) + fd->len));
+        wmem_free(wmem_file_scope(), fd->data);
+        wmem_free(wmem_file_scope(), fd);
 
     }
     /* There might be segments already added to the msp that now extend
@@ -4607,6 +4654,7 @@ again:
              * which means that these bytes exist. */
             fd->data = tvb_memdup(wmem_file_scope(), tvb, offset, fd->len);
             wmem_list_insert_sorted(tcpd->fwd->ooo_segments, fd, compare_ooo_segment_item);
+            tcp_mem_account(&tcp_mem_stats.ooo_segments, 1, sizeof(ooo_segment_item) + fd->len);
         }
         ipfd_head = NULL;
     } else {
@@ -8960,12 +9008,36 @@ static void
 tcp_init(void)
 {
     tcp_stream_count = 0;
+    tcp_acked_by_frame = g_ptr_array_new();
+    memset(&tcp_mem_stats, 0, sizeof(tcp_mem_stats));
 
     /* MPTCP init */
     mptcp_stream_count = 0;
     mptcp_tokens = wmem_tree_new(wmem_file_scope());
 }
 
+static void
+tcp_log_mem_counter(const char *name, const tcp_mem_counter_t *counter)
+{
+    ws_debug("%-14s %10" PRIu64 " items %12" PRIu64 " bytes (peak %" PRIu64 ")",
+             name, counter->count, counter->bytes, counter->peak_bytes);
+}
+
+static void
+tcp_cleanup(void)
+{
+    tcp_log_mem_counter("conversations", &tcp_mem_stats.conversations);
+    tcp_log_mem_counter("acked", &tcp_mem_stats.acked);
+    tcp_log_mem_counter("unacked", &tcp_mem_stats.unacked);
+    tcp_log_mem_counter("msps", &tcp_mem_stats.msps);
+    tcp_log_mem_counter("ooo segments", &tcp_mem_stats.ooo_segments);
+    ws_debug("acked side table: %u frames, %" PRIu64 " bytes",
+             tcp_acked_by_frame->len, (guint64)tcp_acked_by_frame->len * sizeof(gpointer));
+
+    g_ptr_array_free(tcp_acked_by_frame, TRUE);
+    tcp_acked_by_frame = NULL;
+}
+
 void
 proto_register_tcp(void)
 {
@@ -10191,6 +10263,7 @@ proto_register_tcp(void)
         &read_seq_as_syn_cookie);
 
     register_init_routine(tcp_init);
+    register_cleanup_routine(tcp_cleanup);
     reassembly_table_register(&tcp_reassembly_table,
                           &tcp_reassembly_table_functions);
 
@@ -159,14 +159,24 @@ typedef struct _tcp_unacked_t {
 	nstime_t ts;
 } tcp_unacked_t;
 
+/* One instance of this structure is created for each frame with
+ * "interesting" analysis results.  They are kept in a side table indexed
+ * by frame number; the rare frames carrying more than one TCP segment
+ * chain the extra entries through "next".  Fields are ordered to avoid
+ * padding, since a capture can hold millions of these.
+ */
 struct tcp_acked {
-	guint32 frame_acked;
+	struct tcp_acked *next;	/* next entry for the same frame */
 	nstime_t ts;
-
-	guint32  rto_frame;
 	nstime_t rto_ts;	/* Time since previous packet for
 				   retransmissions. */
-	guint16 flags; /* see TCP_A_* in packet-tcp.c */
+
+	guint32 stream;		/* tcp.stream, seq and ack of the */
+	guint32 seq;		/* segment this entry belongs to */
+	guint32 ack;
+
+	guint32 frame_acked;
+	guint32 rto_frame;
 	guint32 dupack_num;	/* dup ack number */
 	guint32 dupack_frame;	/* dup ack to frame # */
 	guint32 bytes_in_flight; /* number of bytes in flight */
@@ -174,7 +184,8 @@ struct tcp_acked {
 
 	guint32 new_data_seq; /* For segments with old data,
 				 where new data starts */
-	gboolean partial_ack; /* true when acknowledging data
+	guint16 flags; /* see TCP_A_* in packet-tcp.c */
+	guint16 partial_ack; /* true when acknowledging data
 				 and not a full segment */
 };
 
@@ -444,10 +455,6 @@ struct tcp_analysis {
 	 * similar
 	 */
 	struct tcp_acked *ta;
-	/* This structure contains a tree containing all the various ta's
-	 * keyed by frame number.
-	 */
-	wmem_tree_t	*acked_table;
 
 	/* Remember the timestamp of the first frame seen in this tcp
 	 * conversation to be able to calculate a relative time compared
@@ -38,6 +38,7 @@ typedef zng_stream zlib_stream;
 #include <epan/proto_data.h>
 #include <epan/oids.h>
 #include <epan/secrets.h>
+#include <epan/tls_keylog.h>
 
 #include <wsutil/inet_cidr.h>
 #include <wsutil/filesystem.h>
@@ -5299,6 +5300,12 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
      * In TLS 1.3 this explicit nonce is gone.
      * With AES GCM/CCM, "[content]" is actually the concatenation of the
      * ciphertext and authentication tag.
+     *
+     * XXX - An AEAD record's nonce only depends on the sequence number,
+     * so the records of a segment could be decrypted in one batch.  We
+     * decrypt each one as it's dissected instead, because the record
+     * before it can change the keys (a TLS 1.3 Finished or KeyUpdate, or
+     * a ChangeCipherSpec) and we only know that once it's been dissected.
      */
     const guint16   version = ssl->session.version;
     const gboolean  is_v12 = version == TLSV1DOT2_VERSION || version == DTLSV1DOT2_VERSION || version == TLCPV1_VERSION;
@@ -5311,6 +5318,8 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
     const guint8    draft_version = ssl->session.tls13_draft_version;
     const guchar   *auth_tag_wire;
     guchar          auth_tag_calc[16];
+    /* Large enough for the DTLS 1.2 connection ID AAD with the longest CID. */
+    guchar          aad_buf[23 + 255];
     guchar         *aad = NULL;
     guint           aad_len = 0;
 
@@ -5387,7 +5396,7 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
     if (is_cid) { /* if connection ID */
         if (ssl->session.deprecated_cid) {
             aad_len = 14 + cidl;
-            aad = wmem_alloc(wmem_packet_scope(), aad_len);
+            aad = aad_buf;
             phton64(aad, decoder->seq);         /* record sequence number */
             phton16(aad, decoder->epoch);       /* DTLS 1.2 includes epoch. */
             aad[8] = ct;                        /* TLSCompressed.type */
@@ -5397,7 +5406,7 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
             phton16(aad + 12 + cidl, ciphertext_len);  /* TLSCompressed.length */
         } else {
             aad_len = 23 + cidl;
-            aad = wmem_alloc(wmem_packet_scope(), aad_len);
+            aad = aad_buf;
             memset(aad, 0xFF, 8);               /* seq_num_placeholder */
             aad[8] = ct;                        /* TLSCompressed.type */
             aad[9] = cidl;                      /* cid_length */
@@ -5410,7 +5419,7 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
         }
     } else if (is_v12) {
         aad_len = 13;
-        aad = wmem_alloc(wmem_packet_scope(), aad_len);
+        aad = aad_buf;
         phton64(aad, decoder->seq);         /* record sequence number */
         if (version == DTLSV1DOT2_VERSION) {
             phton16(aad, decoder->epoch);   /* DTLS 1.2 includes epoch. */
@@ -5423,7 +5432,7 @@ tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
         aad = decoder->dtls13_aad.data;
     } else if (draft_version >= 25 || draft_version == 0) {
         aad_len = 5;
-        aad = wmem_alloc(wmem_packet_scope(), aad_len);
+        aad = aad_buf;
         aad[0] = ct;                        /* TLSCiphertext.opaque_type (23) */
         phton16(aad + 1, record_version);   /* TLSCiphertext.legacy_record_version (0x0303) */
         phton16(aad + 3, inl);              /* TLSCiphertext.length */
@@ -5506,12 +5515,16 @@ ssl_decrypt_record(SslDecryptSession *ssl, SslDecoder *decoder, guint8 ct, guint
         return -1;
     }
 
-    /* ensure we have enough storage space for decrypted data */
+    /* ensure we have enough storage space for decrypted data. The buffer is
+     * shared by all records, so grow it to the largest record size allowed
+     * (plaintext limit plus the TLS 1.2 expansion limit) at once instead of
+     * creeping up record by record. */
     if (inl > out_str->data_len)
     {
+        guint new_len = MAX((guint)inl + 32, TLS_MAX_RECORD_LENGTH + 2048);
         ssl_debug_printf("ssl_decrypt_record: allocating %d bytes for decrypt data (old len %d)\n",
-                inl + 32, out_str->data_len);
-        ssl_data_realloc(out_str, inl + 32);
+                new_len, out_str->data_len);
+        ssl_data_realloc(out_str, new_len);
     }
 
     /* AEAD ciphers (GenericAEADCipher in TLS 1.2; TLS 1.3) have no padding nor
@@ -6166,6 +6179,8 @@ ssl_common_init(ssl_master_key_map_t *mk_map,
     ssl_data_alloc(compressed_data, 32);
 }
 
+static void tls_keylog_cache_invalidate(FILE **keylog_file);
+
 void
 ssl_common_cleanup(ssl_master_key_map_t *mk_map, FILE **ssl_keylog_file,
                    StringInfo *decrypted_data, StringInfo *compressed_data)
@@ -6188,12 +6203,10 @@ ssl_common_cleanup(ssl_master_key_map_t *mk_map, FILE **ssl_keylog_file,
     g_free(decrypted_data->data);
     g_free(compressed_data->data);
 
-    /* close the previous keylog file now that the cache are cleared, this
-     * allows the cache to be filled with the full keylog file contents. */
-    if (*ssl_keylog_file) {
-        fclose(*ssl_keylog_file);
-        *ssl_keylog_file = NULL;
-    }
+    /* The keylog file stays open; the secrets read from it so far are
+     * restored into the new maps by the next ssl_load_keyfile(), unless
+     * there were too many of them to keep. */
+    tls_keylog_cache_invalidate(ssl_keylog_file);
 }
 /* }}} */
 
@@ -6603,78 +6616,81 @@ tls_save_crandom(SslDecryptSession *ssl, ssl_master_key_map_t *mk_map)
 
 /** SSL keylog file handling. {{{ */
 
-static GRegex *
-ssl_compile_keyfile_regex(void)
-{
-#define OCTET "(?:[[:xdigit:]]{2})"
-    const gchar *pattern =
-        "(?:"
-        /* Matches Client Hellos having this Client Random */
-        "PMS_CLIENT_RANDOM (?<client_random_pms>" OCTET "{32}) "
-        /* Matches first part of encrypted RSA pre-master secret */
-        "|RSA (?<encrypted_pmk>" OCTET "{8}) "
-        /* Pre-Master-Secret is given, it is 48 bytes for RSA,
-           but it can be of any length for DHE */
-        ")(?<pms>" OCTET "+)"
-        "|(?:"
-        /* Matches Server Hellos having a Session ID */
-        "RSA Session-ID:(?<session_id>" OCTET "+) Master-Key:"
-        /* Matches Client Hellos having this Client Random */
-        "|CLIENT_RANDOM (?<client_random>" OCTET "{32}) "
-        /* Master-Secret is given, its length is fixed */
-        ")(?<master_secret>" OCTET "{" G_STRINGIFY(SSL_MASTER_SECRET_LENGTH) "})"
-        "|(?"
-        /* TLS 1.3 Client Random to Derived Secrets mapping. */
-        ":CLIENT_EARLY_TRAFFIC_SECRET (?<client_early>" OCTET "{32})"
-        "|CLIENT_HANDSHAKE_TRAFFIC_SECRET (?<client_handshake>" OCTET "{32})"
-        "|SERVER_HANDSHAKE_TRAFFIC_SECRET (?<server_handshake>" OCTET "{32})"
-        "|CLIENT_TRAFFIC_SECRET_0 (?<client_appdata>" OCTET "{32})"
-        "|SERVER_TRAFFIC_SECRET_0 (?<server_appdata>" OCTET "{32})"
-        "|EARLY_EXPORTER_SECRET (?<early_exporter>" OCTET "{32})"
-        "|EXPORTER_SECRET (?<exporter>" OCTET "{32})"
-        ") (?<derived_secret>" OCTET "+)";
-#undef OCTET
-    static GRegex *regex = NULL;
-    GError *gerr = NULL;
-
-    if (!regex) {
-        regex = g_regex_new(pattern,
-                (GRegexCompileFlags)(G_REGEX_OPTIMIZE | G_REGEX_ANCHORED | G_REGEX_RAW),
-                G_REGEX_MATCH_ANCHORED, &gerr);
-        if (gerr) {
-            ssl_debug_printf("%s failed to compile regex: %s\n", G_STRFUNC,
-                             gerr->message);
-            g_error_free(gerr);
-            regex = NULL;
-        }
-    }
-
-    return regex;
-}
-
-typedef struct ssl_master_key_match_group {
-    const char *re_group_name;
-    GHashTable *master_key_ht;
-} ssl_master_key_match_group_t;
+static GHashTable *
+tls_keylog_map_table(const ssl_master_key_map_t *mk_map, tls_keylog_label_t label)
+{
+    switch (label) {
+    case TLS_KEYLOG_PRE_MASTER:         return mk_map->pre_master;
+    case TLS_KEYLOG_SESSION:            return mk_map->session;
+    case TLS_KEYLOG_CRANDOM:            return mk_map->crandom;
+    case TLS_KEYLOG_PMS:                return mk_map->pms;
+    case TLS_KEYLOG_CLIENT_EARLY:       return mk_map->tls13_client_early;
+    case TLS_KEYLOG_CLIENT_HANDSHAKE:   return mk_map->tls13_client_handshake;
+    case TLS_KEYLOG_SERVER_HANDSHAKE:   return mk_map->tls13_server_handshake;
+    case TLS_KEYLOG_CLIENT_APPDATA:     return mk_map->tls13_client_appdata;
+    case TLS_KEYLOG_SERVER_APPDATA:     return mk_map->tls13_server_appdata;
+    case TLS_KEYLOG_EARLY_EXPORTER:     return mk_map->tls13_early_exporter;
+    case TLS_KEYLOG_EXPORTER:           return mk_map->tls13_exporter;
+    case TLS_KEYLOG_NUM_LABELS:         break;
+    }
+    ws_assert_not_reached();
+    return NULL;
+}
+
+static StringInfo *
+tls_keylog_string_info(wmem_allocator_t *scope, const char *hex, guint nbytes)
+{
+    /* ssl_hash() depends on the key data being aligned for guint access,
+     * which wmem allocations are. */
+    StringInfo *out = wmem_new(scope, StringInfo);
+
+    out->data = (guchar *)wmem_alloc(scope, nbytes);
+    tls_keylog_hex_decode(hex, nbytes, out->data);
+    out->data_len = nbytes;
+    return out;
+}
+
+/**
+ * Splits "data" into lines and calls "func" for every line that parses
+ * as a key log entry, with the key and secret allocated from "scope".
+ */
+static void
+tls_keylog_foreach_line(wmem_allocator_t *scope, const guint8 *data, guint datalen,
+                        void (*func)(tls_keylog_label_t label, StringInfo *key, StringInfo *secret, void *user_data),
+                        void *user_data)
+{
+    const char *pos = (const char *)data;
+    const char *end = pos + datalen;
+    const char *line;
+    gsize linelen;
+
+    while ((line = tls_keylog_next_line(&pos, end, &linelen)) != NULL) {
+        tls_keylog_line_t parsed;
+
+        ssl_debug_printf("  checking keylog line: %.*s\n", (int)linelen, line);
+        if (tls_keylog_parse_line(line, linelen, &parsed)) {
+            ssl_debug_printf("    matched %s\n", tls_keylog_label_name(parsed.label));
+            func(parsed.label,
+                 tls_keylog_string_info(scope, parsed.key, parsed.key_len),
+                 tls_keylog_string_info(scope, parsed.secret, parsed.secret_len),
+                 user_data);
+        } else if (linelen > 0 && line[0] != '#') {
+            ssl_debug_printf("    unrecognized line\n");
+        }
+    }
+}
+
+static void
+tls_keylog_insert(tls_keylog_label_t label, StringInfo *key, StringInfo *secret, void *user_data)
+{
+    const ssl_master_key_map_t *mk_map = (const ssl_master_key_map_t *)user_data;
+
+    g_hash_table_insert(tls_keylog_map_table(mk_map, label), key, secret);
+}
 
 void
 tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const guint8 *data, guint datalen)
 {
-    ssl_master_key_match_group_t mk_groups[] = {
-        { "encrypted_pmk",  mk_map->pre_master },
-        { "session_id",     mk_map->session },
-        { "client_random",  mk_map->crandom },
-        { "client_random_pms",  mk_map->pms },
-        /* TLS 1.3 map from Client Random to derived secret. */
-        { "client_early",       mk_map->tls13_client_early },
-        { "client_handshake",   mk_map->tls13_client_handshake },
-        { "server_handshake",   mk_map->tls13_server_handshake },
-        { "client_appdata",     mk_map->tls13_client_appdata },
-        { "server_appdata",     mk_map->tls13_server_appdata },
-        { "early_exporter",     mk_map->tls13_early_exporter },
-        { "exporter",           mk_map->tls13_exporter },
-    };
-
     /* The format of the file is a series of records with one of the following formats:
      *   - "RSA xxxx yyyy"
      *     Where xxxx are the first 8 bytes of the encrypted pre-master secret (hex-encoded)
@@ -6713,78 +6729,95 @@ tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const guint8 *data,
      *     handshake or master secrets. (This format is introduced with TLS 1.3
      *     and supported by BoringSSL, OpenSSL, etc. See bug 12779.)
      */
-    GRegex *regex = ssl_compile_keyfile_regex();
-    if (!regex)
-        return;
+    tls_keylog_foreach_line(wmem_file_scope(), data, datalen, tls_keylog_insert, (void *)mk_map);
+}
 
-    const char *next_line = (const char *)data;
-    const char *line_end = next_line + datalen;
-    while (next_line && next_line < line_end) {
-        const char *line = next_line;
-        next_line = (const char *)memchr(line, '\n', line_end - line);
-        gssize linelen;
+/*
+ * Secrets read from the key log file. They outlive the capture file (and
+ * the secrets maps, which are recreated on every redissection), so the file
+ * is parsed only once and later loads only read lines appended since then.
+ * The cache is dropped when the preference names another file, and once it
+ * holds TLS_KEYLOG_CACHE_MAX_ENTRIES secrets it's dropped at the next
+ * cleanup instead of being kept, so that a huge key log is re-read like it
+ * was before rather than held for the life of the process.
+ */
+#define TLS_KEYLOG_CACHE_MAX_ENTRIES    100000
+
+typedef struct {
+    tls_keylog_label_t  label;
+    StringInfo         *key;
+    StringInfo         *secret;
+} tls_keylog_entry_t;
+
+static struct {
+    char               *filename;   /* the key log file the entries came from */
+    wmem_allocator_t   *allocator;  /* entries, keys and secrets */
+    wmem_array_t       *entries;
+    GSList             *retired;    /* allocators of replaced caches, still
+                                       referenced by the secrets maps */
+    gboolean            replay;     /* entries must be re-added to the secrets maps */
+    gboolean            full;       /* too many entries, don't keep them */
+} tls_keylog_cache;
+
+/* Drops the cached entries, e.g. when the key log file was replaced. */
+static void
+tls_keylog_cache_clear(void)
+{
+    if (tls_keylog_cache.allocator) {
+        tls_keylog_cache.retired = g_slist_prepend(tls_keylog_cache.retired, tls_keylog_cache.allocator);
+    }
+    tls_keylog_cache.allocator = NULL;
+    tls_keylog_cache.entries = NULL;
+    tls_keylog_cache.replay = FALSE;
+    tls_keylog_cache.full = FALSE;
+}
 
-        if (next_line) {
-            linelen = next_line - line;
-            next_line++;    /* drop LF */
-        } else {
-            linelen = (gssize)(line_end - line);
-        }
-        if (linelen > 0 && line[linelen - 1] == '\r') {
-            linelen--;      /* drop CR */
-        }
+/* Starts an empty cache for the key log file that was just opened. */
+static void
+tls_keylog_cache_reset(const char *filename)
+{
+    tls_keylog_cache_clear();
+    if (g_strcmp0(tls_keylog_cache.filename, filename) != 0) {
+        g_free(tls_keylog_cache.filename);
+        tls_keylog_cache.filename = g_strdup(filename);
+    }
+    tls_keylog_cache.allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    tls_keylog_cache.entries = wmem_array_new(tls_keylog_cache.allocator, sizeof(tls_keylog_entry_t));
+}
 
-        ssl_debug_printf("  checking keylog line: %.*s\n", (int)linelen, line);
-        GMatchInfo *mi;
-        if (g_regex_match_full(regex, line, linelen, 0, G_REGEX_MATCH_ANCHORED, &mi, NULL)) {
-            gchar *hex_key, *hex_pre_ms_or_ms;
-            StringInfo *key = wmem_new(wmem_file_scope(), StringInfo);
-            StringInfo *pre_ms_or_ms = NULL;
-            GHashTable *ht = NULL;
-
-            /* Is the PMS being supplied with the PMS_CLIENT_RANDOM
-             * otherwise we will use the Master Secret
-             */
-            hex_pre_ms_or_ms = g_match_info_fetch_named(mi, "master_secret");
-            if (hex_pre_ms_or_ms == NULL || !*hex_pre_ms_or_ms) {
-                g_free(hex_pre_ms_or_ms);
-                hex_pre_ms_or_ms = g_match_info_fetch_named(mi, "pms");
-            }
-            if (hex_pre_ms_or_ms == NULL || !*hex_pre_ms_or_ms) {
-                g_free(hex_pre_ms_or_ms);
-                hex_pre_ms_or_ms = g_match_info_fetch_named(mi, "derived_secret");
-            }
-            /* There is always a match, otherwise the regex is wrong. */
-            DISSECTOR_ASSERT(hex_pre_ms_or_ms && strlen(hex_pre_ms_or_ms));
-
-            /* convert from hex to bytes and save to hashtable */
-            pre_ms_or_ms = wmem_new(wmem_file_scope(), StringInfo);
-            from_hex(pre_ms_or_ms, hex_pre_ms_or_ms, strlen(hex_pre_ms_or_ms));
-            g_free(hex_pre_ms_or_ms);
-
-            /* Find a master key from any format (CLIENT_RANDOM, SID, ...) */
-            for (unsigned i = 0; i < G_N_ELEMENTS(mk_groups); i++) {
-                ssl_master_key_match_group_t *g = &mk_groups[i];
-                hex_key = g_match_info_fetch_named(mi, g->re_group_name);
-                if (hex_key && *hex_key) {
-                    ssl_debug_printf("    matched %s\n", g->re_group_name);
-                    ht = g->master_key_ht;
-                    from_hex(key, hex_key, strlen(hex_key));
-                    g_free(hex_key);
-                    break;
-                }
-                g_free(hex_key);
-            }
-            DISSECTOR_ASSERT(ht); /* Cannot be reached, or regex is wrong. */
+/*
+ * Called once the secrets maps are destroyed. A full cache is dropped
+ * along with the file, so that the next load reads it again from the start.
+ */
+static void
+tls_keylog_cache_invalidate(FILE **keylog_file)
+{
+    if (tls_keylog_cache.full) {
+        tls_keylog_cache_clear();
+        if (*keylog_file) {
+            fclose(*keylog_file);
+            *keylog_file = NULL;
+        }
+    }
+    g_slist_free_full(tls_keylog_cache.retired, (GDestroyNotify)wmem_destroy_allocator);
+    tls_keylog_cache.retired = NULL;
+    tls_keylog_cache.replay = tls_keylog_cache.allocator != NULL;
+}
 
-            g_hash_table_insert(ht, key, pre_ms_or_ms);
+static void
+tls_keylog_cache_add(tls_keylog_label_t label, StringInfo *key, StringInfo *secret, void *user_data)
+{
+    if (!tls_keylog_cache.full) {
+        tls_keylog_entry_t entry = { label, key, secret };
 
-        } else if (linelen > 0 && line[0] != '#') {
-            ssl_debug_printf("    unrecognized line\n");
+        if (wmem_array_get_count(tls_keylog_cache.entries) < TLS_KEYLOG_CACHE_MAX_ENTRIES) {
+            wmem_array_append_one(tls_keylog_cache.entries, entry);
+        } else {
+            ssl_debug_printf("%s more than %u secrets, not caching them\n", G_STRFUNC, TLS_KEYLOG_CACHE_MAX_ENTRIES);
+            tls_keylog_cache.full = TRUE;
         }
-        /* always free match info even if there is no match. */
-        g_match_info_free(mi);
     }
+    tls_keylog_insert(label, key, secret, user_data);
 }
 
 void
@@ -6795,16 +6828,23 @@ ssl_load_keyfile(const gchar *tls_keylog_filename, FILE **keylog_file,
     if (!tls_keylog_filename || !*tls_keylog_filename) {
         ssl_debug_printf("%s dtls/tls.keylog_file is not configured!\n",
                          G_STRFUNC);
-        return;
-    }
-
-    /* Validate regexes before even trying to use it. */
-    if (!ssl_compile_keyfile_regex()) {
+        if (*keylog_file) {
+            fclose(*keylog_file);
+            *keylog_file = NULL;
+        }
+        tls_keylog_cache_clear();
         return;
     }
 
     ssl_debug_printf("trying to use TLS keylog in %s\n", tls_keylog_filename);
 
+    /* The preference was changed, forget the old file's secrets. */
+    if (*keylog_file && g_strcmp0(tls_keylog_cache.filename, tls_keylog_filename) != 0) {
+        ssl_debug_printf("%s key log file changed, reading the new one\n", G_STRFUNC);
+        fclose(*keylog_file);
+        *keylog_file = NULL;
+    }
+
     /* if the keylog file was deleted/overwritten, re-open it */
     if (*keylog_file && file_needs_reopen(ws_fileno(*keylog_file), tls_keylog_filename)) {
         ssl_debug_printf("%s file got deleted, trying to re-open\n", G_STRFUNC);
@@ -6812,12 +6852,35 @@ ssl_load_keyfile(const gchar *tls_keylog_filename, FILE **keylog_file,
         *keylog_file = NULL;
     }
 
+    /* A file truncated in place is shorter than what was read already. */
+    if (*keylog_file && tls_keylog_cache.replay) {
+        ws_statb64 st;
+        if (ws_fstat64(ws_fileno(*keylog_file), &st) == 0 && st.st_size < ws_ftell64(*keylog_file)) {
+            ssl_debug_printf("%s file got truncated, re-reading it\n", G_STRFUNC);
+            fclose(*keylog_file);
+            *keylog_file = NULL;
+        }
+    }
+
     if (*keylog_file == NULL) {
         *keylog_file = ws_fopen(tls_keylog_filename, "r");
         if (!*keylog_file) {
             ssl_debug_printf("%s failed to open SSL keylog\n", G_STRFUNC);
             return;
         }
+        tls_keylog_cache_reset(tls_keylog_filename);
+    }
+
+    /* The secrets maps were recreated, add what was read before. */
+    if (tls_keylog_cache.replay) {
+        guint count = wmem_array_get_count(tls_keylog_cache.entries);
+        const tls_keylog_entry_t *entries = (const tls_keylog_entry_t *)wmem_array_get_raw(tls_keylog_cache.entries);
+
+        ssl_debug_printf("%s restoring %u cached secrets\n", G_STRFUNC, count);
+        for (guint i = 0; i < count; i++) {
+            tls_keylog_insert(entries[i].label, entries[i].key, entries[i].secret, (void *)mk_map);
+        }
+        tls_keylog_cache.replay = FALSE;
     }
 
     for (;;) {
@@ -6834,7 +6897,8 @@ ssl_load_keyfile(const gchar *tls_keylog_filename, FILE **keylog_file,
             }
             break;
         }
-        tls_keylog_process_lines(mk_map, (guint8 *)line, (int)strlen(line));
+        tls_keylog_foreach_line(tls_keylog_cache.allocator, (guint8 *)line, (int)strlen(line),
+                                tls_keylog_cache_add, (void *)mk_map);
     }
 }
 /** SSL keylog file handling. }}} */
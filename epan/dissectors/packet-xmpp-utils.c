@@ -801,6 +801,7 @@ proto_item_get_text(wmem_allocator_t *pool, proto_item *item)
     if(fi==NULL)
         return NULL;
 
+    proto_item_render_label(fi);
     if (fi->rep == NULL)
         return NULL;
 
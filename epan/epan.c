@@ -110,7 +110,9 @@
 static GSList *epan_plugin_register_all_procotols;
 static GSList *epan_plugin_register_all_handoffs;
 
-static wmem_allocator_t *pinfo_pool_cache;
+/* One spare pinfo pool per thread, so that dissecting a packet doesn't have
+ * to create a new allocator each time. */
+static GPrivate pinfo_pool_cache = G_PRIVATE_INIT((GDestroyNotify)wmem_destroy_allocator);
 
 /* Global variables holding the content of the corresponding environment variable
  * to save fetching it repeatedly.
@@ -449,10 +451,7 @@ epan_cleanup(void)
 
 	dfilter_translator_cleanup();
 
-	if (pinfo_pool_cache != NULL) {
-		wmem_destroy_allocator(pinfo_pool_cache);
-		pinfo_pool_cache = NULL;
-	}
+	g_private_replace(&pinfo_pool_cache, NULL);
 
 	wmem_cleanup_scopes();
 
@@ -565,9 +564,9 @@ epan_dissect_init(epan_dissect_t *edt, epan_t *session, const gboolean create_pr
 	edt->session = session;
 
 	memset(&edt->pi, 0, sizeof(edt->pi));
-	if (pinfo_pool_cache != NULL) {
-		edt->pi.pool = pinfo_pool_cache;
-		pinfo_pool_cache = NULL;
+	edt->pi.pool = (wmem_allocator_t *)g_private_get(&pinfo_pool_cache);
+	if (edt->pi.pool != NULL) {
+		g_private_set(&pinfo_pool_cache, NULL);
 	}
 	else {
 		edt->pi.pool = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK_FAST);
@@ -720,9 +719,9 @@ epan_dissect_cleanup(epan_dissect_t* edt)
 		proto_tree_free(edt->tree);
 	}
 
-	if (pinfo_pool_cache == NULL) {
+	if (g_private_get(&pinfo_pool_cache) == NULL) {
 		wmem_free_all(edt->pi.pool);
-		pinfo_pool_cache = edt->pi.pool;
+		g_private_set(&pinfo_pool_cache, edt->pi.pool);
 	}
 	else {
 		wmem_destroy_allocator(edt->pi.pool);
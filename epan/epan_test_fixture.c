@@ -0,0 +1,70 @@
+/* epan_test_fixture.c
+ * Start and stop epan for unit tests that dissect or build protocol trees
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include <epan/epan.h>
+#include <wiretap/wtap.h>
+#include <wsutil/filesystem.h>
+#include <wsutil/privileges.h>
+
+#include "epan_test_fixture.h"
+
+bool
+epan_test_fixture_init(const char *argv0, void (*register_protocols)(void))
+{
+	char *configuration_init_error;
+
+	init_process_policies();
+
+	/* We only need this to find the data files. */
+	configuration_init_error = configuration_init(argv0, NULL);
+	if (configuration_init_error != NULL) {
+		g_printerr("Can't get pathname of the test program: %s.\n", configuration_init_error);
+		g_free(configuration_init_error);
+	}
+
+	wtap_init(false);
+	if (!epan_init(NULL, NULL, false)) {
+		wtap_cleanup();
+		return false;
+	}
+
+	/*
+	 * Fields registered now can be added to trees and looked up by
+	 * name; the test's protocols don't need handoffs.
+	 */
+	if (register_protocols != NULL)
+		register_protocols();
+
+	return true;
+}
+
+void
+epan_test_fixture_cleanup(void)
+{
+	epan_cleanup();
+	wtap_cleanup();
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
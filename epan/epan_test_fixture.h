@@ -0,0 +1,34 @@
+/** @file
+ * Start and stop epan for unit tests that dissect or build protocol trees
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __EPAN_TEST_FIXTURE_H__
+#define __EPAN_TEST_FIXTURE_H__
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Initialize wiretap and epan without plugins, and then register any
+ * protocols of the test's own.
+ * @param argv0 the test program's argv[0]
+ * @param register_protocols registers the test's protocols and fields, or NULL
+ * @return true on success, false if epan couldn't be initialized */
+bool epan_test_fixture_init(const char *argv0, void (*register_protocols)(void));
+
+/** Clean up what epan_test_fixture_init() set up. */
+void epan_test_fixture_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EPAN_TEST_FIXTURE_H__ */
@@ -14,6 +14,7 @@
 #include "config.h"
 
 #include <glib.h>
+#include <string.h>
 
 #include <epan/tvbuff.h>
 #include <epan/in_cksum.h>
@@ -28,6 +29,52 @@
 #define ADDCARRY(x)  {if ((x) > 65535) (x) -= 65535;}
 #define REDUCE {l_util.l = sum; sum = l_util.s[0] + l_util.s[1]; ADDCARRY(sum);}
 
+/*
+ * One's complement sum of a run of 16-bit words, len bytes long, with
+ * len a multiple of 8.  Because one's complement addition is associative
+ * and commutative and the end-around carry can be deferred, we can add
+ * the data 32 bits at a time into a 64-bit accumulator with two
+ * independent chains (so the adds can be issued in parallel) and fold
+ * the carries back in at the end; the result is congruent, modulo
+ * 0xFFFF, to adding the 16-bit words one by one, and is zero only if
+ * all of the words are.  A 64-bit accumulator can absorb 2^32 32-bit
+ * words without overflow, far more than a vec_t length can hold.
+ */
+static guint32
+in_cksum_sum_words(const guint8 *p, int len)
+{
+	guint64 sum0 = 0, sum1 = 0;
+	guint32 v0, v1;
+
+	while (len >= 32) {
+		memcpy(&v0, p, 4);      memcpy(&v1, p + 4, 4);
+		sum0 += v0;             sum1 += v1;
+		memcpy(&v0, p + 8, 4);  memcpy(&v1, p + 12, 4);
+		sum0 += v0;             sum1 += v1;
+		memcpy(&v0, p + 16, 4); memcpy(&v1, p + 20, 4);
+		sum0 += v0;             sum1 += v1;
+		memcpy(&v0, p + 24, 4); memcpy(&v1, p + 28, 4);
+		sum0 += v0;             sum1 += v1;
+		p += 32;
+		len -= 32;
+	}
+	while (len >= 8) {
+		memcpy(&v0, p, 4);      memcpy(&v1, p + 4, 4);
+		sum0 += v0;             sum1 += v1;
+		p += 8;
+		len -= 8;
+	}
+
+	/* Fold to 16 bits; 2^32 and 2^16 are both 1 modulo 0xFFFF. */
+	sum0 += sum1;
+	sum0 = (sum0 & 0xFFFFFFFF) + (sum0 >> 32);
+	sum0 = (sum0 & 0xFFFFFFFF) + (sum0 >> 32);
+	sum0 = (sum0 & 0xFFFF) + (sum0 >> 16);
+	sum0 = (sum0 & 0xFFFF) + (sum0 >> 16);
+	sum0 = (sum0 & 0xFFFF) + (sum0 >> 16);
+	return (guint32)sum0;
+}
+
 /*
  * Linux and Windows, at least, when performing Local Checksum Offload
  * store the one's complement sum (not inverted to its bitwise complement)
@@ -95,22 +142,17 @@ in_cksum_ret_partial(const vec_t *vec, int veclen, uint16_t *partial)
 			byte_swapped = 1;
 		}
 		/*
-		 * Unroll the loop to make overhead from
-		 * branches &c small.
+		 * Sum the bulk of the chunk a wide word at a time; that
+		 * leaves fewer than 8 bytes for the loop below.
 		 */
-		while ((mlen -= 32) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			sum += w[4]; sum += w[5]; sum += w[6]; sum += w[7];
-			sum += w[8]; sum += w[9]; sum += w[10]; sum += w[11];
-			sum += w[12]; sum += w[13]; sum += w[14]; sum += w[15];
-			w += 16;
-		}
-		mlen += 32;
-		while ((mlen -= 8) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			w += 4;
+		if (mlen >= 8) {
+			int blen = mlen & ~7;
+
+			REDUCE;
+			sum += in_cksum_sum_words((const guint8 *)w, blen);
+			w += blen / 2;
+			mlen -= blen;
 		}
-		mlen += 8;
 		if (mlen == 0 && byte_swapped == 0)
 			continue;
 		REDUCE;
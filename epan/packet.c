@@ -851,9 +851,12 @@ call_dissector_through_handle(dissector_handle_t handle, tvbuff_t *tvb,
 
 	saved_proto = pinfo->current_proto;
 
-	if ((handle->protocol != NULL) && (!proto_is_pino(handle->protocol))) {
-		pinfo->current_proto =
-			proto_get_protocol_short_name(handle->protocol);
+	if (handle->protocol != NULL) {
+		proto_register_deferred_fields(handle->protocol);
+		if (!proto_is_pino(handle->protocol)) {
+			pinfo->current_proto =
+				proto_get_protocol_short_name(handle->protocol);
+		}
 	}
 
 	switch (handle->dissector_type) {
@@ -3037,6 +3040,7 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 		}
 
 		if (hdtbl_entry->protocol != NULL) {
+			proto_register_deferred_fields(hdtbl_entry->protocol);
 			proto_id = proto_get_id(hdtbl_entry->protocol);
 			/* do NOT change this behavior - wslua uses the protocol short name set here in order
 			   to determine which Lua-based heurisitc dissector to call */
@@ -3652,6 +3656,7 @@ void call_heur_dissector_direct(heur_dtbl_entry_t *heur_dtbl_entry, tvbuff_t *tv
 	}
 
 	if (heur_dtbl_entry->protocol != NULL) {
+		proto_register_deferred_fields(heur_dtbl_entry->protocol);
 		/* do NOT change this behavior - wslua uses the protocol short name set here in order
 			to determine which Lua-based heuristic dissector to call */
 		pinfo->current_proto = proto_get_protocol_short_name(heur_dtbl_entry->protocol);
@@ -63,8 +63,20 @@ typedef struct {
     gboolean        print_text;
     proto_node_children_grouper_func node_children_grouper;
     json_dumper    *dumper;
+    wmem_allocator_t *pool;         /* per-packet scratch memory (pinfo->pool) */
+    proto_node     *cached_repr_node;   /* node whose JSON value is in cached_repr */
+    char           *cached_repr;
 } write_json_data;
 
+/* The nodes written as the value(s) of a single JSON object member. */
+typedef struct {
+    proto_node    **nodes;
+    unsigned        count;
+} json_node_group;
+
+/* Below this many children, json keys are grouped by linear search. */
+#define JSON_GROUP_LINEAR_MAX 16
+
 typedef struct {
     output_fields_t *fields;
     epan_dissect_t  *edt;
@@ -106,12 +118,12 @@ static void print_escaped_csv(FILE *fh, const char *unescaped_string, char delim
 
 typedef void (*proto_node_value_writer)(proto_node *, write_json_data *);
 static void write_json_index(json_dumper *dumper, epan_dissect_t *edt);
-static void write_json_proto_node_list(GSList *proto_node_list_head, write_json_data *data);
-static void write_json_proto_node(GSList *node_values_head,
+static void write_json_proto_node_list(const json_node_group *groups, unsigned num_groups, write_json_data *data);
+static void write_json_proto_node(const json_node_group *group,
                                   const char *suffix,
                                   proto_node_value_writer value_writer,
                                   write_json_data *data);
-static void write_json_proto_node_value_list(GSList *node_values_head,
+static void write_json_proto_node_value_list(const json_node_group *group,
                                              proto_node_value_writer value_writer,
                                              write_json_data *data);
 static void write_json_proto_node_filtered(proto_node *node, write_json_data *data);
@@ -183,6 +195,7 @@ proto_tree_print_node(proto_node *node, gpointer data)
         return;
 
     /* was a free format label produced? */
+    proto_item_render_label(fi);
     if (fi->rep) {
         label_ptr = fi->rep->representation;
     }
@@ -373,6 +386,9 @@ write_ek_proto_tree(output_fields_t* fields,
     };
 
     data.dumper = &dumper;
+    data.pool = edt->pi.pool;
+    data.cached_repr_node = NULL;
+    data.cached_repr = NULL;
 
     json_dumper_begin_object(&dumper);
     json_dumper_set_member_name(&dumper, "index");
@@ -478,6 +494,8 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
         print_indent(pdata->level + 1, pdata->fh);
     }
 
+    proto_item_render_label(fi);
+
     /* Text label. It's printed as a field with no name. */
     if (fi->hfinfo->id == hf_text_only) {
         /* Get the text */
@@ -747,6 +765,9 @@ write_json_proto_tree(output_fields_t* fields,
     write_json_data data;
 
     data.dumper = dumper;
+    data.pool = edt->pi.pool;
+    data.cached_repr_node = NULL;
+    data.cached_repr = NULL;
 
     json_dumper_begin_object(dumper);
     write_json_index(dumper, edt);
@@ -779,18 +800,15 @@ write_json_proto_tree(output_fields_t* fields,
 }
 
 /**
- * Returns a boolean telling us whether that node list contains any node which has children
+ * Returns a boolean telling us whether that node group contains any node which has children
  */
 static gboolean
-any_has_children(GSList *node_values_list)
+any_has_children(const json_node_group *group)
 {
-    GSList *current_node = node_values_list;
-    while (current_node != NULL) {
-        proto_node *current_value = (proto_node *) current_node->data;
-        if (current_value->first_child != NULL) {
+    for (unsigned i = 0; i < group->count; i++) {
+        if (group->nodes[i]->first_child != NULL) {
             return TRUE;
         }
-        current_node = current_node->next;
     }
     return FALSE;
 }
@@ -798,53 +816,56 @@ any_has_children(GSList *node_values_list)
 /**
  * Write a json object containing a list of key:value pairs where each key:value pair corresponds to a different json
  * key and its associated nodes in the proto_tree.
- * @param proto_node_list_head A 2-dimensional list containing a list of values for each different node json key. The
- * elements themselves are a linked list of values associated with the same json key.
+ * @param groups Array containing the nodes for each different node json key, in output order.
+ * @param num_groups Number of elements in groups.
  * @param pdata json writing metadata
  */
 static void
-write_json_proto_node_list(GSList *proto_node_list_head, write_json_data *pdata)
+write_json_proto_node_list(const json_node_group *groups, unsigned num_groups, write_json_data *pdata)
 {
-    GSList *current_node = proto_node_list_head;
-
     json_dumper_begin_object(pdata->dumper);
 
-    // Loop over each list of nodes (differentiated by json key) and write the associated json key:value pair in the
+    // Loop over each group of nodes (differentiated by json key) and write the associated json key:value pair in the
     // output.
-    while (current_node != NULL) {
-        // Get the list of values for the current json key.
-        GSList *node_values_list = (GSList *) current_node->data;
+    for (unsigned g = 0; g < num_groups; g++) {
+        const json_node_group *group = &groups[g];
 
         // Retrieve the json key from the first value.
-        proto_node *first_value = (proto_node *) node_values_list->data;
+        proto_node *first_value = group->nodes[0];
         const char *json_key = proto_node_to_json_key(first_value);
         // Check if the current json key is filtered from the output with the "-j" cli option.
         pf_flags filter_flags = PF_NONE;
         gboolean is_filtered = pdata->filter != NULL && !check_protocolfilter(pdata->filter, json_key, &filter_flags);
 
         field_info *fi = first_value->finfo;
-        char *value_string_repr = fvalue_to_string_repr(NULL, fi->value, FTREPR_JSON, fi->hfinfo->display);
-        gboolean has_children = any_has_children(node_values_list);
+        char *value_string_repr = fvalue_to_string_repr(pdata->pool, fi->value, FTREPR_JSON, fi->hfinfo->display);
+        gboolean has_children = any_has_children(group);
 
         // We assume all values of a json key have roughly the same layout. Thus we can use the first value to derive
         // attributes of all the values.
         gboolean has_value = value_string_repr != NULL;
         gboolean is_pseudo_text_field = fi->hfinfo->id == hf_text_only;
 
-        wmem_free(NULL, value_string_repr); // fvalue_to_string_repr returns allocated buffer
+        // Keep the representation around so write_json_proto_node_value doesn't format the first value twice.
+        pdata->cached_repr_node = first_value;
+        pdata->cached_repr = value_string_repr;
 
         // "-x" command line option. A "_raw" suffix is added to the json key so the textual value can be printed
         // with the original json key. If both hex and text writing are enabled the raw information of fields whose
         // length is equal to 0 is not written to the output. If the field is a special text pseudo field no raw
         // information is written either.
         if (pdata->print_hex && (!pdata->print_text || fi->length > 0) && !is_pseudo_text_field) {
-            write_json_proto_node(node_values_list, "_raw", write_json_proto_node_hex_dump, pdata);
+            write_json_proto_node(group, "_raw", write_json_proto_node_hex_dump, pdata);
         }
 
         if (pdata->print_text && has_value) {
-            write_json_proto_node(node_values_list, "", write_json_proto_node_value, pdata);
+            write_json_proto_node(group, "", write_json_proto_node_value, pdata);
         }
 
+        pdata->cached_repr_node = NULL;
+        pdata->cached_repr = NULL;
+        wmem_free(pdata->pool, value_string_repr);
+
         if (has_children) {
             // If a node has both a value and a set of children we print the value and the children in separate
             // key:value pairs. These can't have the same key so whenever a value is already printed with the node
@@ -852,7 +873,7 @@ write_json_proto_node_list(GSList *proto_node_list_head, write_json_data *pdata)
             char *suffix = has_value ? "_tree": "";
 
             if (is_filtered) {
-                write_json_proto_node(node_values_list, suffix, write_json_proto_node_filtered, pdata);
+                write_json_proto_node(group, suffix, write_json_proto_node_filtered, pdata);
             } else {
                 // Remove protocol filter for children, if children should be included. This functionality is enabled
                 // with the "-J" command line option. We save the filter so it can be reenabled when we are done with
@@ -865,7 +886,7 @@ write_json_proto_node_list(GSList *proto_node_list_head, write_json_data *pdata)
 
                 // has_children is TRUE if any of the nodes have children. So we're not 100% sure whether this
                 // particular node has children or not => use the 'dynamic' version of 'write_json_proto_node'
-                write_json_proto_node(node_values_list, suffix, write_json_proto_node_dynamic, pdata);
+                write_json_proto_node(group, suffix, write_json_proto_node_dynamic, pdata);
 
                 // Put protocol filter back
                 if ((filter_flags&PF_INCLUDE_CHILDREN) == PF_INCLUDE_CHILDREN) {
@@ -875,10 +896,8 @@ write_json_proto_node_list(GSList *proto_node_list_head, write_json_data *pdata)
         }
 
         if (!has_value && !has_children && (pdata->print_text || (pdata->print_hex && is_pseudo_text_field))) {
-            write_json_proto_node(node_values_list, "", write_json_proto_node_no_value, pdata);
+            write_json_proto_node(group, "", write_json_proto_node_no_value, pdata);
         }
-
-        current_node = current_node->next;
     }
     json_dumper_end_object(pdata->dumper);
 }
@@ -886,46 +905,46 @@ write_json_proto_node_list(GSList *proto_node_list_head, write_json_data *pdata)
 /**
  * Writes a single node as a key:value pair. The value_writer param can be used to specify how the node's value should
  * be written.
- * @param node_values_head Linked list containing all nodes associated with the same json key in this object.
+ * @param group All nodes associated with the same json key in this object.
  * @param suffix Suffix that should be added to the json key.
  * @param value_writer A function which writes the actual values of the node json key.
  * @param pdata json writing metadata
  */
 static void
-write_json_proto_node(GSList *node_values_head,
+write_json_proto_node(const json_node_group *group,
                       const char *suffix,
                       proto_node_value_writer value_writer,
                       write_json_data *pdata)
 {
     // Retrieve json key from first value.
-    proto_node *first_value = (proto_node *) node_values_head->data;
-    const char *json_key = proto_node_to_json_key(first_value);
-    gchar* json_key_suffix = ws_strdup_printf("%s%s", json_key, suffix);
-    json_dumper_set_member_name(pdata->dumper, json_key_suffix);
-    g_free(json_key_suffix);
-    write_json_proto_node_value_list(node_values_head, value_writer, pdata);
+    const char *json_key = proto_node_to_json_key(group->nodes[0]);
+    if (suffix[0] == '\0') {
+        json_dumper_set_member_name(pdata->dumper, json_key);
+    } else {
+        char *json_key_suffix = wmem_strconcat(pdata->pool, json_key, suffix, NULL);
+        json_dumper_set_member_name(pdata->dumper, json_key_suffix);
+        wmem_free(pdata->pool, json_key_suffix);
+    }
+    write_json_proto_node_value_list(group, value_writer, pdata);
 }
 
 /**
  * Writes a list of values of a single json key. If multiple values are passed they are wrapped in a json array.
- * @param node_values_head Linked list containing all values that should be written.
+ * @param group All values that should be written.
  * @param value_writer Function which writes the separate values.
  * @param pdata json writing metadata
  */
 static void
-write_json_proto_node_value_list(GSList *node_values_head, proto_node_value_writer value_writer, write_json_data *pdata)
+write_json_proto_node_value_list(const json_node_group *group, proto_node_value_writer value_writer, write_json_data *pdata)
 {
-    GSList *current_value = node_values_head;
-
     // Write directly if only a single value is passed. Wrap in json array otherwise.
-    if (current_value->next == NULL) {
-        value_writer((proto_node *) current_value->data, pdata);
+    if (group->count == 1) {
+        value_writer(group->nodes[0], pdata);
     } else {
         json_dumper_begin_array(pdata->dumper);
 
-        while (current_value != NULL) {
-            value_writer((proto_node *) current_value->data, pdata);
-            current_value = current_value->next;
+        for (unsigned i = 0; i < group->count; i++) {
+            value_writer(group->nodes[i], pdata);
         }
         json_dumper_end_array(pdata->dumper);
     }
@@ -945,6 +964,63 @@ write_json_proto_node_filtered(proto_node *node, write_json_data *pdata)
     json_dumper_end_object(pdata->dumper);
 }
 
+/**
+ * Writes a 64-bit value as an upper case hexadecimal JSON string, without
+ * going through printf.
+ */
+static void
+json_write_hex_uint64(write_json_data *pdata, guint64 value)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    char buf[sizeof(value) * 2 + 1];
+    char *p = buf + sizeof(buf);
+
+    *--p = '\0';
+    do {
+        *--p = hex[value & 0xF];
+        value >>= 4;
+    } while (value);
+    json_dumper_value_string(pdata->dumper, p);
+}
+
+/**
+ * Writes the (masked) value of a bitfield as a hexadecimal string.
+ */
+static void
+json_write_bitfield_hex_value(write_json_data *pdata, field_info *fi)
+{
+    switch (fvalue_type_ftenum(fi->value)) {
+        case FT_INT8:
+        case FT_INT16:
+        case FT_INT24:
+        case FT_INT32:
+            json_write_hex_uint64(pdata, (guint) fvalue_get_sinteger(fi->value));
+            break;
+        case FT_CHAR:
+        case FT_UINT8:
+        case FT_UINT16:
+        case FT_UINT24:
+        case FT_UINT32:
+            json_write_hex_uint64(pdata, fvalue_get_uinteger(fi->value));
+            break;
+        case FT_INT40:
+        case FT_INT48:
+        case FT_INT56:
+        case FT_INT64:
+            json_write_hex_uint64(pdata, (guint64) fvalue_get_sinteger64(fi->value));
+            break;
+        case FT_UINT40:
+        case FT_UINT48:
+        case FT_UINT56:
+        case FT_UINT64:
+        case FT_BOOLEAN:
+            json_write_hex_uint64(pdata, fvalue_get_uinteger64(fi->value));
+            break;
+        default:
+            ws_assert_not_reached();
+    }
+}
+
 /**
  * Writes the hex dump of a node. A json array is written containing the hex dump, position, length, bitmask and type of
  * the node.
@@ -957,45 +1033,16 @@ write_json_proto_node_hex_dump(proto_node *node, write_json_data *pdata)
     json_dumper_begin_array(pdata->dumper);
 
     if (fi->hfinfo->bitmask!=0) {
-        switch (fvalue_type_ftenum(fi->value)) {
-            case FT_INT8:
-            case FT_INT16:
-            case FT_INT24:
-            case FT_INT32:
-                json_dumper_value_anyf(pdata->dumper, "\"%X\"", (guint) fvalue_get_sinteger(fi->value));
-                break;
-            case FT_CHAR:
-            case FT_UINT8:
-            case FT_UINT16:
-            case FT_UINT24:
-            case FT_UINT32:
-                json_dumper_value_anyf(pdata->dumper, "\"%X\"", fvalue_get_uinteger(fi->value));
-                break;
-            case FT_INT40:
-            case FT_INT48:
-            case FT_INT56:
-            case FT_INT64:
-                json_dumper_value_anyf(pdata->dumper, "\"%" PRIX64 "\"", fvalue_get_sinteger64(fi->value));
-                break;
-            case FT_UINT40:
-            case FT_UINT48:
-            case FT_UINT56:
-            case FT_UINT64:
-            case FT_BOOLEAN:
-                json_dumper_value_anyf(pdata->dumper, "\"%" PRIX64 "\"", fvalue_get_uinteger64(fi->value));
-                break;
-            default:
-                ws_assert_not_reached();
-        }
+        json_write_bitfield_hex_value(pdata, fi);
     } else {
         json_write_field_hex_value(pdata, fi);
     }
 
     /* Dump raw hex-encoded dissected information including position, length, bitmask, type */
-    json_dumper_value_anyf(pdata->dumper, "%" PRId32, fi->start);
-    json_dumper_value_anyf(pdata->dumper, "%" PRId32, fi->length);
-    json_dumper_value_anyf(pdata->dumper, "%" PRIu64, fi->hfinfo->bitmask);
-    json_dumper_value_anyf(pdata->dumper, "%" PRId32, (gint32)fvalue_type_ftenum(fi->value));
+    json_dumper_value_int64(pdata->dumper, fi->start);
+    json_dumper_value_int64(pdata->dumper, fi->length);
+    json_dumper_value_uint64(pdata->dumper, fi->hfinfo->bitmask);
+    json_dumper_value_int64(pdata->dumper, (gint32)fvalue_type_ftenum(fi->value));
 
     json_dumper_end_array(pdata->dumper);
 }
@@ -1014,6 +1061,134 @@ write_json_proto_node_dynamic(proto_node *node, write_json_data *data)
     }
 }
 
+/**
+ * Returns the index of the group for json_key, adding a new group if
+ * there's none yet.
+ */
+static unsigned
+json_group_index(const char **group_keys, unsigned *num_groups, wmem_map_t *lookup, const char *json_key)
+{
+    unsigned g;
+
+    if (lookup == NULL) {
+        for (g = 0; g < *num_groups; g++) {
+            if (group_keys[g] == json_key || strcmp(group_keys[g], json_key) == 0) {
+                return g;
+            }
+        }
+    } else {
+        gpointer value = wmem_map_lookup(lookup, json_key);
+        if (value != NULL) {
+            return GPOINTER_TO_UINT(value) - 1;
+        }
+        wmem_map_insert(lookup, json_key, GUINT_TO_POINTER(*num_groups + 1));
+    }
+
+    g = (*num_groups)++;
+    group_keys[g] = json_key;
+    return g;
+}
+
+/**
+ * Groups the children of a node as the node children grouper in pdata
+ * would, but into arrays allocated from the per-packet pool rather than
+ * into GSLists. The two groupers exported from this file are handled
+ * inline; any other grouper is called and its result converted.
+ * @return The number of groups stored in *groups_out.
+ */
+static unsigned
+json_group_children(proto_node *node, write_json_data *pdata, json_node_group **groups_out)
+{
+    proto_node *child;
+    proto_node **nodes;
+    json_node_group *groups;
+    unsigned num_children = 0;
+    unsigned num_groups = 0;
+    unsigned i;
+
+    *groups_out = NULL;
+
+    if (pdata->node_children_grouper == proto_node_group_children_by_unique) {
+        for (child = node->first_child; child != NULL; child = child->next) {
+            num_children++;
+        }
+        if (num_children == 0) {
+            return 0;
+        }
+        nodes = wmem_alloc_array(pdata->pool, proto_node *, num_children);
+        groups = wmem_alloc_array(pdata->pool, json_node_group, num_children);
+        for (child = node->first_child, i = 0; child != NULL; child = child->next, i++) {
+            nodes[i] = child;
+            groups[i].nodes = &nodes[i];
+            groups[i].count = 1;
+        }
+        num_groups = num_children;
+    } else if (pdata->node_children_grouper == proto_node_group_children_by_json_key) {
+        const char **group_keys;
+        unsigned *group_of;
+        unsigned offset;
+        wmem_map_t *lookup = NULL;
+
+        for (child = node->first_child; child != NULL; child = child->next) {
+            num_children++;
+        }
+        if (num_children == 0) {
+            return 0;
+        }
+        nodes = wmem_alloc_array(pdata->pool, proto_node *, num_children);
+        groups = wmem_alloc0_array(pdata->pool, json_node_group, num_children);
+        group_keys = wmem_alloc_array(pdata->pool, const char *, num_children);
+        group_of = wmem_alloc_array(pdata->pool, unsigned, num_children);
+        if (num_children > JSON_GROUP_LINEAR_MAX) {
+            lookup = wmem_map_new(pdata->pool, g_str_hash, g_str_equal);
+        }
+
+        /* First pass: assign every child to a group and count the group sizes. */
+        for (child = node->first_child, i = 0; child != NULL; child = child->next, i++) {
+            group_of[i] = json_group_index(group_keys, &num_groups, lookup, proto_node_to_json_key(child));
+            groups[group_of[i]].count++;
+        }
+
+        /* Give each group a contiguous slice of nodes, in order of first appearance. */
+        offset = 0;
+        for (i = 0; i < num_groups; i++) {
+            groups[i].nodes = &nodes[offset];
+            offset += groups[i].count;
+            groups[i].count = 0;
+        }
+
+        /* Second pass: fill in the slices, preserving the order of the children. */
+        for (child = node->first_child, i = 0; child != NULL; child = child->next, i++) {
+            json_node_group *group = &groups[group_of[i]];
+            group->nodes[group->count++] = child;
+        }
+    } else {
+        GSList *grouped_children_list = pdata->node_children_grouper(node);
+        GSList *current;
+
+        num_groups = g_slist_length(grouped_children_list);
+        if (num_groups == 0) {
+            return 0;
+        }
+        groups = wmem_alloc_array(pdata->pool, json_node_group, num_groups);
+        for (current = grouped_children_list, i = 0; current != NULL; current = current->next, i++) {
+            GSList *node_values_list = (GSList *) current->data;
+            GSList *value;
+            unsigned j;
+
+            groups[i].count = g_slist_length(node_values_list);
+            groups[i].nodes = wmem_alloc_array(pdata->pool, proto_node *, groups[i].count);
+            for (value = node_values_list, j = 0; value != NULL; value = value->next, j++) {
+                groups[i].nodes[j] = (proto_node *) value->data;
+            }
+        }
+        g_slist_free_full(grouped_children_list, (GDestroyNotify) g_slist_free);
+    }
+
+    *groups_out = groups;
+    return num_groups;
+}
+
 /**
  * Writes the children of a node. Calls write_json_proto_node_list internally which recursively writes children of nodes
  * to the output.
@@ -1021,9 +1196,9 @@ write_json_proto_node_dynamic(proto_node *node, write_json_data *data)
 static void
 write_json_proto_node_children(proto_node *node, write_json_data *data)
 {
-    GSList *grouped_children_list = data->node_children_grouper(node);
-    write_json_proto_node_list(grouped_children_list, data);
-    g_slist_free_full(grouped_children_list, (GDestroyNotify) g_slist_free);
+    json_node_group *groups;
+    unsigned num_groups = json_group_children(node, data, &groups);
+    write_json_proto_node_list(groups, num_groups, data);
 }
 
 /**
@@ -1033,14 +1208,20 @@ static void
 write_json_proto_node_value(proto_node *node, write_json_data *pdata)
 {
     field_info *fi = node->finfo;
+
+    if (node == pdata->cached_repr_node) {
+        json_dumper_value_string(pdata->dumper, pdata->cached_repr);
+        return;
+    }
+
     // Get the actual value of the node as a string.
-    char *value_string_repr = fvalue_to_string_repr(NULL, fi->value, FTREPR_JSON, fi->hfinfo->display);
+    char *value_string_repr = fvalue_to_string_repr(pdata->pool, fi->value, FTREPR_JSON, fi->hfinfo->display);
 
     //TODO: Have FTREPR_JSON include quotes where appropriate and use json_dumper_value_anyf() here,
     // so we can output booleans and numbers and not only strings.
     json_dumper_value_string(pdata->dumper, value_string_repr);
 
-    wmem_free(NULL, value_string_repr);
+    wmem_free(pdata->pool, value_string_repr);
 }
 
 /**
@@ -1053,6 +1234,7 @@ write_json_proto_node_no_value(proto_node *node, write_json_data *pdata)
     field_info *fi = node->finfo;
 
     if (fi->hfinfo->type == FT_PROTOCOL) {
+        proto_item_render_label(fi);
         if (fi->rep) {
             json_dumper_value_string(pdata->dumper, fi->rep->representation);
         } else {
@@ -1146,10 +1328,13 @@ proto_node_to_json_key(proto_node *node)
     // Check if node has abbreviated name.
     if (node->finfo->hfinfo->id != hf_text_only) {
         json_key = node->finfo->hfinfo->abbrev;
-    } else if (node->finfo->rep != NULL) {
-        json_key = node->finfo->rep->representation;
     } else {
-        json_key = "";
+        proto_item_render_label(node->finfo);
+        if (node->finfo->rep != NULL) {
+            json_key = node->finfo->rep->representation;
+        } else {
+            json_key = "";
+        }
     }
 
     return json_key;
@@ -1194,18 +1379,30 @@ write_ek_summary(column_info *cinfo, write_json_data* pdata)
     for (i = 0; i < cinfo->num_cols; i++) {
         if (!get_column_visible(i))
             continue;
-        json_dumper_set_member_name(pdata->dumper, g_ascii_strdown(cinfo->columns[i].col_title, -1));
+        gchar *name = g_ascii_strdown(cinfo->columns[i].col_title, -1);
+        json_dumper_set_member_name(pdata->dumper, name);
+        g_free(name);
         json_dumper_value_string(pdata->dumper, get_column_text(cinfo, i));
     }
 }
 
+/*
+ * The descendants of a node to be written as EK attributes, grouped by
+ * field abbreviation. The groups are kept in order of first appearance;
+ * all of it is allocated from the per-packet pool.
+ */
+typedef struct {
+    wmem_map_t   *lookup;       /* abbrev -> wmem_array_t of proto_node * */
+    wmem_array_t *attrs;        /* wmem_array_t *, in order of first appearance */
+} ek_attr_table;
+
 /* Write out a tree's data, and any child nodes, as JSON for EK */
 static void
 // NOLINTNEXTLINE(misc-no-recursion)
-ek_fill_attr(proto_node *node, GHashTable *attr_table, write_json_data *pdata)
+ek_fill_attr(proto_node *node, ek_attr_table *attr_table, write_json_data *pdata)
 {
     field_info *fi         = NULL;
-    GSList *attr_instances = NULL;
+    wmem_array_t *attr_instances = NULL;
 
     proto_node *current_node = node->first_child;
     while (current_node != NULL) {
@@ -1214,10 +1411,13 @@ ek_fill_attr(proto_node *node, GHashTable *attr_table, write_json_data *pdata)
         /* dissection with an invisible proto tree? */
         ws_assert(fi);
 
-        attr_instances = (GSList *) g_hash_table_lookup(attr_table, fi->hfinfo->abbrev);
-        attr_instances = g_slist_append(attr_instances, current_node);
-        // Update instance list for this attr in hash table
-        g_hash_table_insert(attr_table, g_strdup(fi->hfinfo->abbrev), attr_instances);
+        attr_instances = (wmem_array_t *) wmem_map_lookup(attr_table->lookup, fi->hfinfo->abbrev);
+        if (attr_instances == NULL) {
+            attr_instances = wmem_array_new(pdata->pool, sizeof(proto_node *));
+            wmem_map_insert(attr_table->lookup, fi->hfinfo->abbrev, attr_instances);
+            wmem_array_append_one(attr_table->attrs, attr_instances);
+        }
+        wmem_array_append_one(attr_instances, current_node);
 
         /* Field, recurse through children*/
         if (fi->hfinfo->type != FT_PROTOCOL && current_node->first_child != NULL) {
@@ -1261,49 +1461,23 @@ ek_write_name(proto_node *pnode, gchar* suffix, write_json_data* pdata)
 
     if (fi->hfinfo->parent != -1) {
         header_field_info* parent = proto_registrar_get_nth(fi->hfinfo->parent);
-        str = ws_strdup_printf("%s_%s%s", parent->abbrev, fi->hfinfo->abbrev, suffix ? suffix : "");
+        str = wmem_strconcat(pdata->pool, parent->abbrev, "_", fi->hfinfo->abbrev, suffix, NULL);
         json_dumper_set_member_name(pdata->dumper, str);
-    } else {
-        str = ws_strdup_printf("%s%s", fi->hfinfo->abbrev, suffix ? suffix : "");
+        wmem_free(pdata->pool, str);
+    } else if (suffix) {
+        str = wmem_strconcat(pdata->pool, fi->hfinfo->abbrev, suffix, NULL);
         json_dumper_set_member_name(pdata->dumper, str);
+        wmem_free(pdata->pool, str);
+    } else {
+        json_dumper_set_member_name(pdata->dumper, fi->hfinfo->abbrev);
     }
-    g_free(str);
 }
 
 static void
 ek_write_hex(field_info *fi, write_json_data *pdata)
 {
     if (fi->hfinfo->bitmask != 0) {
-        switch (fvalue_type_ftenum(fi->value)) {
-            case FT_INT8:
-            case FT_INT16:
-            case FT_INT24:
-            case FT_INT32:
-                json_dumper_value_anyf(pdata->dumper, "\"%X\"", (guint) fvalue_get_sinteger(fi->value));
-                break;
-            case FT_CHAR:
-            case FT_UINT8:
-            case FT_UINT16:
-            case FT_UINT24:
-            case FT_UINT32:
-                json_dumper_value_anyf(pdata->dumper, "\"%X\"", fvalue_get_uinteger(fi->value));
-                break;
-            case FT_INT40:
-            case FT_INT48:
-            case FT_INT56:
-            case FT_INT64:
-                json_dumper_value_anyf(pdata->dumper, "\"%" PRIX64 "\"", fvalue_get_sinteger64(fi->value));
-                break;
-            case FT_UINT40:
-            case FT_UINT48:
-            case FT_UINT56:
-            case FT_UINT64:
-            case FT_BOOLEAN:
-                json_dumper_value_anyf(pdata->dumper, "\"%" PRIX64 "\"", fvalue_get_uinteger64(fi->value));
-                break;
-            default:
-                ws_assert_not_reached();
-        }
+        json_write_bitfield_hex_value(pdata, fi);
     } else {
         json_write_field_hex_value(pdata, fi);
     }
@@ -1317,6 +1491,8 @@ ek_write_field_value(field_info *fi, write_json_data* pdata)
     char time_buf[NSTIME_ISO8601_BUFSIZE];
     size_t time_len;
 
+    proto_item_render_label(fi);
+
     /* Text label */
     if (fi->hfinfo->id == hf_text_only && fi->rep) {
         json_dumper_value_string(pdata->dumper, fi->rep->representation);
@@ -1361,40 +1537,35 @@ ek_write_field_value(field_info *fi, write_json_data* pdata)
 }
 
 static void
-ek_write_attr_hex(GSList *attr_instances, write_json_data *pdata)
+ek_write_attr_hex(wmem_array_t *attr_instances, write_json_data *pdata)
 {
-    GSList *current_node = attr_instances;
-    proto_node *pnode    = (proto_node *) current_node->data;
-    field_info *fi       = NULL;
+    proto_node **pnodes = (proto_node **) wmem_array_get_raw(attr_instances);
+    guint        count  = wmem_array_get_count(attr_instances);
 
     // Raw name
-    ek_write_name(pnode, "_raw", pdata);
+    ek_write_name(pnodes[0], "_raw", pdata);
 
-    if (g_slist_length(attr_instances) > 1) {
+    if (count > 1) {
         json_dumper_begin_array(pdata->dumper);
     }
 
     // Raw value(s)
-    while (current_node != NULL) {
-        pnode = (proto_node *) current_node->data;
-        fi    = PNODE_FINFO(pnode);
-
-        ek_write_hex(fi, pdata);
-
-        current_node = current_node->next;
+    for (guint i = 0; i < count; i++) {
+        ek_write_hex(PNODE_FINFO(pnodes[i]), pdata);
     }
 
-    if (g_slist_length(attr_instances) > 1) {
+    if (count > 1) {
         json_dumper_end_array(pdata->dumper);
     }
 }
 
 static void
 // NOLINTNEXTLINE(misc-no-recursion)
-ek_write_attr(GSList *attr_instances, write_json_data *pdata)
+ek_write_attr(wmem_array_t *attr_instances, write_json_data *pdata)
 {
-    GSList *current_node  = attr_instances;
-    proto_node *pnode     = (proto_node *) current_node->data;
+    proto_node **pnodes   = (proto_node **) wmem_array_get_raw(attr_instances);
+    guint        count    = wmem_array_get_count(attr_instances);
+    proto_node *pnode     = pnodes[0];
     field_info *fi        = PNODE_FINFO(pnode);
     pf_flags filter_flags = PF_NONE;
 
@@ -1406,12 +1577,12 @@ ek_write_attr(GSList *attr_instances, write_json_data *pdata)
     // Print attr name
     ek_write_name(pnode, NULL, pdata);
 
-    if (g_slist_length(attr_instances) > 1) {
+    if (count > 1) {
         json_dumper_begin_array(pdata->dumper);
     }
 
-    while (current_node != NULL) {
-        pnode = (proto_node *) current_node->data;
+    for (guint i = 0; i < count; i++) {
+        pnode = pnodes[i];
         fi    = PNODE_FINFO(pnode);
 
         /* Field */
@@ -1457,48 +1628,30 @@ ek_write_attr(GSList *attr_instances, write_json_data *pdata)
 
             json_dumper_end_object(pdata->dumper);
         }
-
-        current_node = current_node->next;
     }
 
-    if (g_slist_length(attr_instances) > 1) {
+    if (count > 1) {
         json_dumper_end_array(pdata->dumper);
     }
 }
 
-// NOLINTNEXTLINE(misc-no-recursion)
-void process_ek_attrs(gpointer key _U_, gpointer value, gpointer pdata)
-{
-    GSList *attr_instances = (GSList *) value;
-    ek_write_attr(attr_instances, pdata);
-}
-
 /* Write out a tree's data, and any child nodes, as JSON for EK */
 static void
 // NOLINTNEXTLINE(misc-no-recursion)
 proto_tree_write_node_ek(proto_node *node, write_json_data *pdata)
 {
-    GHashTable *attr_table  = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
-    GHashTableIter iter;
-    gpointer key, value;
-    ek_fill_attr(node, attr_table, pdata);
+    ek_attr_table attr_table;
+
+    attr_table.lookup = wmem_map_new(pdata->pool, g_str_hash, g_str_equal);
+    attr_table.attrs = wmem_array_new(pdata->pool, sizeof(wmem_array_t *));
+    ek_fill_attr(node, &attr_table, pdata);
 
     // Print attributes
-    g_hash_table_iter_init(&iter, attr_table);
-    while (g_hash_table_iter_next (&iter, &key, &value)) {
-        process_ek_attrs(key, value, pdata);
-        g_hash_table_iter_remove(&iter);
-        /* We lookup a list in the table, append to it, and re-insert it; as
-         * g_slist_append() can change the start pointer of the list we can't
-         * just append to the list without replacing the old value. In turn,
-         * that means we can't set the value_destroy_func when creating
-         * the hash table, because on re-insertion that would destroy the
-         * nodes of the old list, which are still being used by the new list.
-         * So free it here.
-         */
-        g_slist_free((GSList*)value);
+    wmem_array_t **attrs = (wmem_array_t **) wmem_array_get_raw(attr_table.attrs);
+    guint num_attrs = wmem_array_get_count(attr_table.attrs);
+    for (guint i = 0; i < num_attrs; i++) {
+        ek_write_attr(attrs[i], pdata);
     }
-    g_hash_table_destroy(attr_table);
 }
 
 /* Print info for a 'geninfo' pseudo-protocol. This is required by
@@ -1954,7 +2107,7 @@ json_write_field_hex_value(write_json_data *pdata, field_info *fi)
 
     if (pd) {
         gint i;
-        gchar* str = (gchar*)g_malloc(fi->length*2 + 1);    /* no need to zero */
+        gchar* str = (gchar*)wmem_alloc(pdata->pool, fi->length*2 + 1);    /* no need to zero */
         static const char hex[] = "0123456789abcdef";
         /* Print a simple hex dump */
         for (i = 0; i < fi->length; i++) {
@@ -1964,7 +2117,7 @@ json_write_field_hex_value(write_json_data *pdata, field_info *fi)
         }
         str[2 * fi->length] = '\0';
         json_dumper_value_string(pdata->dumper, str);
-        g_free(str);
+        wmem_free(pdata->pool, str);
     } else {
         json_dumper_value_string(pdata->dumper, "");
     }
@@ -2677,6 +2830,8 @@ void write_fields_finale(output_fields_t* fields _U_ , FILE *fh _U_)
 /* Returns an g_malloced string */
 gchar* get_node_field_value(field_info* fi, epan_dissect_t* edt)
 {
+    proto_item_render_label(fi);
+
     if (fi->hfinfo->id == hf_text_only) {
         /* Text label.
          * Get the text */
@@ -2777,21 +2932,13 @@ get_field_hex_value(GSList *src_list, field_info *fi)
     pd = get_field_data(src_list, fi);
 
     if (pd) {
-        int        i;
         gchar     *buffer;
         gchar     *p;
-        int        len;
-        const int  chars_per_byte = 2;
 
-        len    = chars_per_byte * fi->length;
-        buffer = (gchar *)g_malloc(sizeof(gchar)*(len + 1));
-        buffer[len] = '\0'; /* Ensure NULL termination in bad cases */
-        p = buffer;
+        buffer = (gchar *)g_malloc(sizeof(gchar)*(2 * fi->length + 1));
         /* Print a simple hex dump */
-        for (i = 0 ; i < fi->length; i++) {
-            snprintf(p, chars_per_byte+1, "%02x", pd[i]);
-            p += chars_per_byte;
-        }
+        p = bytes_to_hexstr(buffer, pd, fi->length);
+        *p = '\0';
         return buffer;
     } else {
         return NULL;
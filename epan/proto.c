@@ -17,6 +17,7 @@
 #include <float.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <stdlib.h>
 
 #include <wsutil/array.h>
 #include <wsutil/bits_ctz.h>
@@ -50,6 +51,7 @@
 #include "show_exception.h"
 #include "in_cksum.h"
 #include "register-int.h"
+#include "tree_slab.h"
 
 #include <wsutil/crash_info.h>
 #include <wsutil/epochs.h>
@@ -402,8 +404,16 @@ struct _protocol {
 	                                   can be added to a dissector table, but use the
 	                                   parent_proto_id for things like enable/disable */
 	GList      *heur_list;          /* Heuristic dissectors associated with this protocol */
+	GSList     *lazy_fields;        /* Field arrays registered with proto_register_field_array_lazy()
+	                                   that haven't been registered yet */
 };
 
+/* A field array whose registration was deferred */
+typedef struct {
+	hf_register_info *hf;
+	int               num_records;
+} lazy_field_array_t;
+
 /* List of all protocols */
 static GList *protocols;
 
@@ -421,20 +431,23 @@ static GPtrArray *deregistered_slice;
 /* indexed by prefix, contains initializers */
 static GHashTable* prefixes;
 
+/* indexed by filter name, contains protocols with deferred field arrays */
+static GHashTable* lazy_field_protocols;
+static gboolean    lazy_fields_enabled;
+static guint       lazy_field_count;
+
 /* Contains information about a field when a dissector calls
  * proto_tree_add_item.  */
-#define FIELD_INFO_NEW(pool, fi)  fi = wmem_new(pool, field_info)
-#define FIELD_INFO_FREE(pool, fi) wmem_free(pool, fi)
+#define FIELD_INFO_NEW(tree, fi)  fi = (field_info *)tree_slab_alloc(PTREE_DATA(tree)->slab, sizeof(field_info))
 
 /* Contains the space for proto_nodes. */
+#define PROTO_NODE_NEW(tree, node) node = (proto_node *)tree_slab_alloc(PTREE_DATA(tree)->slab, sizeof(proto_node))
+
 #define PROTO_NODE_INIT(node)			\
 	node->first_child = NULL;		\
 	node->last_child = NULL;		\
 	node->next = NULL;
 
-#define PROTO_NODE_FREE(pool, node)			\
-	wmem_free(pool, node)
-
 /* String space for protocol and field items for the GUI */
 #define ITEM_LABEL_NEW(pool, il)			\
 	il = wmem_new(pool, item_label_t);
@@ -593,6 +606,13 @@ proto_init(GSList *register_all_plugin_protocols_list,
 	deregistered_fields      = g_ptr_array_new();
 	deregistered_data        = g_ptr_array_new();
 	deregistered_slice       = g_ptr_array_new();
+	lazy_field_protocols     = g_hash_table_new(g_str_hash, g_str_equal);
+
+	/*
+	 * Defer the registration of large field arrays until they're needed
+	 * unless told otherwise; see proto_register_field_array_lazy().
+	 */
+	lazy_fields_enabled = getenv("WIRESHARK_NO_LAZY_FIELDS") == NULL;
 
 	/* Initialize the ftype subsystem */
 	ftypes_initialize();
@@ -687,6 +707,7 @@ proto_cleanup_base(void)
 				g_ptr_array_free(protocol->fields, TRUE);
 			}
 			g_list_free(protocol->heur_list);
+			g_slist_free_full(protocol->lazy_fields, g_free);
 		}
 		protocols = g_list_remove(protocols, protocol);
 		g_free(protocol);
@@ -739,13 +760,27 @@ proto_cleanup_base(void)
 
 	if (prefixes)
 		g_hash_table_destroy(prefixes);
+
+	if (lazy_field_protocols) {
+		g_hash_table_destroy(lazy_field_protocols);
+		lazy_field_protocols = NULL;
+	}
+	lazy_field_count = 0;
 }
 
 void
 proto_cleanup(void)
 {
+	guint64 deferred, rendered;
+
+	tree_label_counts_get(&deferred, &rendered);
+	if (deferred)
+		ws_debug("%" PRIu64 " item labels deferred, %" PRIu64 " never rendered",
+			 deferred, deferred - rendered);
+
 	proto_free_deregistered_fields();
 	proto_cleanup_base();
+	register_cleanup();
 
 	g_slist_free(dissector_plugins);
 	dissector_plugins = NULL;
@@ -799,10 +834,8 @@ proto_tree_children_foreach(proto_tree *tree, proto_tree_foreach_func func,
 }
 
 static void
-free_GPtrArray_value(gpointer key, gpointer value, gpointer user_data _U_)
+unreference_interesting_hfid(const gint hfid)
 {
-	GPtrArray         *ptrs = (GPtrArray *)value;
-	gint               hfid = GPOINTER_TO_UINT(key);
 	header_field_info *hfinfo;
 
 	PROTO_REGISTRAR_GET_NTH(hfid, hfinfo);
@@ -818,8 +851,30 @@ free_GPtrArray_value(gpointer key, gpointer value, gpointer user_data _U_)
 		}
 		hfinfo->ref_type = HF_REF_TYPE_NONE;
 	}
+}
+
+/* Undo the priming of the tree's interesting fields. */
+static void
+tree_data_reset_interesting_fields(tree_data_t *tree_data)
+{
+	guint i;
+
+	if (tree_data->interesting == NULL)
+		return;
+
+	for (i = 0; i < tree_data->interesting->count; i++)
+		unreference_interesting_hfid(tree_data->interesting->slots[i].hfid);
+
+	/* It's in the slab. */
+	tree_data->interesting = NULL;
+}
 
-	g_ptr_array_free(ptrs, TRUE);
+static void
+tree_data_flush_label_counts(tree_data_t *tree_data)
+{
+	tree_label_counts_add(tree_data->labels_deferred, tree_data->labels_rendered);
+	tree_data->labels_deferred = 0;
+	tree_data->labels_rendered = 0;
 }
 
 static void
@@ -840,15 +895,10 @@ proto_tree_reset(proto_tree *tree)
 
 	proto_tree_children_foreach(tree, proto_tree_free_node, NULL);
 
-	/* free tree data */
-	if (tree_data->interesting_hfids) {
-		/* Free all the GPtrArray's in the interesting_hfids hash. */
-		g_hash_table_foreach(tree_data->interesting_hfids,
-			free_GPtrArray_value, NULL);
-
-		/* And then remove all values. */
-		g_hash_table_remove_all(tree_data->interesting_hfids);
-	}
+	/* reset tree data */
+	tree_data_reset_interesting_fields(tree_data);
+	tree_data_flush_label_counts(tree_data);
+	tree_slab_reset(tree_data->slab);
 
 	/* Reset track of the number of children */
 	tree_data->count = 0;
@@ -865,14 +915,9 @@ proto_tree_free(proto_tree *tree)
 	proto_tree_children_foreach(tree, proto_tree_free_node, NULL);
 
 	/* free tree data */
-	if (tree_data->interesting_hfids) {
-		/* Free all the GPtrArray's in the interesting_hfids hash. */
-		g_hash_table_foreach(tree_data->interesting_hfids,
-			free_GPtrArray_value, NULL);
-
-		/* And then destroy the hash. */
-		g_hash_table_destroy(tree_data->interesting_hfids);
-	}
+	tree_data_reset_interesting_fields(tree_data);
+	tree_data_flush_label_counts(tree_data);
+	tree_slab_free(tree_data->slab);
 
 	g_slice_free(tree_data_t, tree_data);
 
@@ -1007,7 +1052,42 @@ initialize_prefix(gpointer k, gpointer v, gpointer u _U_) {
 /** Initialize every remaining uninitialized prefix. */
 void
 proto_initialize_all_prefixes(void) {
-	g_hash_table_foreach_remove(prefixes, initialize_prefix, NULL);
+	GList *l;
+
+	for (l = protocols; l != NULL; l = l->next) {
+		proto_register_deferred_fields((protocol_t *)l->data);
+	}
+
+	if (prefixes)
+		g_hash_table_foreach_remove(prefixes, initialize_prefix, NULL);
+}
+
+/*
+ * Finds the protocol with deferred field arrays whose filter name is a
+ * prefix of "field_name" ending at a dot, trying the shortest prefix
+ * first; filter names can contain dots themselves.
+ */
+static protocol_t *
+find_lazy_field_protocol(const char *field_name)
+{
+	protocol_t *protocol = NULL;
+	gchar      *name;
+	gchar      *dot;
+
+	if (!lazy_field_protocols || g_hash_table_size(lazy_field_protocols) == 0)
+		return NULL;
+
+	name = g_strdup(field_name);
+	for (dot = strchr(name, '.'); dot != NULL; dot = strchr(dot + 1, '.')) {
+		*dot = '\0';
+		protocol = (protocol_t *)g_hash_table_lookup(lazy_field_protocols, name);
+		*dot = '.';
+		if (protocol)
+			break;
+	}
+	g_free(name);
+
+	return protocol;
 }
 
 /* Finds a record in the hfinfo array by name.
@@ -1021,6 +1101,7 @@ proto_registrar_get_byname(const char *field_name)
 {
 	header_field_info    *hfinfo;
 	prefix_initializer_t  pi;
+	protocol_t           *protocol;
 
 	if (!field_name)
 		return NULL;
@@ -1038,18 +1119,23 @@ proto_registrar_get_byname(const char *field_name)
 		return hfinfo;
 	}
 
-	if (!prefixes)
-		return NULL;
+	/*
+	 * The field may belong to a protocol whose filter name is a longer
+	 * prefix than the first one with deferred fields, e.g. "foo.bar.baz"
+	 * when both "foo" and "foo.bar" are lazy, so keep going until it
+	 * turns up or there's nothing left to register.
+	 */
+	while (hfinfo == NULL && (protocol = find_lazy_field_protocol(field_name)) != NULL) {
+		proto_register_deferred_fields(protocol);
+		hfinfo = (header_field_info *)g_hash_table_lookup(gpa_name_map, field_name);
+	}
 
-	if ((pi = (prefix_initializer_t)g_hash_table_lookup(prefixes, field_name) ) != NULL) {
+	if (hfinfo == NULL && prefixes && (pi = (prefix_initializer_t)g_hash_table_lookup(prefixes, field_name)) != NULL) {
 		pi(field_name);
 		g_hash_table_remove(prefixes, field_name);
-	} else {
-		return NULL;
+		hfinfo = (header_field_info *)g_hash_table_lookup(gpa_name_map, field_name);
 	}
 
-	hfinfo = (header_field_info *)g_hash_table_lookup(gpa_name_map, field_name);
-
 	if (hfinfo) {
 		g_free(last_field_name);
 		last_field_name = g_strdup(field_name);
@@ -2658,25 +2744,12 @@ tree_data_add_maybe_interesting_field(tree_data_t *tree_data, field_info *fi)
 	const header_field_info *hfinfo = fi->hfinfo;
 
 	if (hfinfo->ref_type == HF_REF_TYPE_DIRECT || hfinfo->ref_type == HF_REF_TYPE_PRINT) {
-		GPtrArray *ptrs = NULL;
-
-		if (tree_data->interesting_hfids == NULL) {
-			/* Initialize the hash because we now know that it is needed */
-			tree_data->interesting_hfids =
-				g_hash_table_new(g_direct_hash, NULL /* g_direct_equal */);
-		} else if (g_hash_table_size(tree_data->interesting_hfids)) {
-			ptrs = (GPtrArray *)g_hash_table_lookup(tree_data->interesting_hfids,
-					   GINT_TO_POINTER(hfinfo->id));
-		}
+		interesting_slot_t *slot;
 
-		if (!ptrs) {
-			/* First element triggers the creation of pointer array */
-			ptrs = g_ptr_array_new();
-			g_hash_table_insert(tree_data->interesting_hfids,
-					    GINT_TO_POINTER(hfinfo->id), ptrs);
-		}
-
-		g_ptr_array_add(ptrs, fi);
+		/* Normally set up when the tree was primed, but the field
+		 * may have been primed for some other tree. */
+		slot = interesting_fields_get(&tree_data->interesting, tree_data->slab, hfinfo->id);
+		interesting_slot_add(slot, tree_data->slab, fi);
 	}
 }
 
@@ -6405,7 +6478,7 @@ proto_tree_add_node(proto_tree *tree, field_info *fi)
 		/* XXX - is it safe to continue here? */
 	}
 
-	pnode = wmem_new(PNODE_POOL(tree), proto_node);
+	PROTO_NODE_NEW(tree, pnode);
 	PROTO_NODE_INIT(pnode);
 	pnode->parent = tnode;
 	PNODE_FINFO(pnode) = fi;
@@ -6741,7 +6814,7 @@ new_field_info(proto_tree *tree, header_field_info *hfinfo, tvbuff_t *tvb,
 {
 	field_info *fi;
 
-	FIELD_INFO_NEW(PNODE_POOL(tree), fi);
+	FIELD_INFO_NEW(tree, fi);
 
 	fi->hfinfo     = hfinfo;
 	fi->start      = start;
@@ -6759,6 +6832,7 @@ new_field_info(proto_tree *tree, header_field_info *hfinfo, tvbuff_t *tvb,
 	}
 	fi->value = fvalue_new(fi->hfinfo->type);
 	fi->rep        = NULL;
+	fi->deferred_rep = NULL;
 
 	/* add the data source tvbuff */
 	fi->ds_tvb = tvb ? tvb_get_ds_tvb(tvb) : NULL;
@@ -6772,6 +6846,179 @@ new_field_info(proto_tree *tree, header_field_info *hfinfo, tvbuff_t *tvb,
 	return fi;
 }
 
+/*
+ * Labels set by dissectors - proto_tree_add_XXX_format(),
+ * proto_item_set_text(), proto_item_append_text() and
+ * proto_item_prepend_text() - on items in a tree that isn't visible
+ * are rarely looked at: the tree exists for filtering, for -T fields
+ * or for taps, and only a few of its items, if any, ever have their
+ * label read.  So for such trees we format the dissector's text, which
+ * has to be done right away as the arguments may not outlive the call,
+ * and queue it on the field_info instead of building the label, which
+ * for appends and prepends also means formatting the item's value.
+ * proto_item_render_label() replays the queue into fi->rep when the
+ * label is needed.
+ */
+typedef enum {
+	LABEL_OP_SET,		/* the label is the text */
+	LABEL_OP_APPEND,	/* append the text to the label */
+	LABEL_OP_PREPEND	/* prepend the text to the label */
+} label_op_kind_t;
+
+typedef struct _label_op {
+	struct _label_op *next;
+	label_op_kind_t   kind;
+	const char       *text;
+} label_op_t;
+
+struct _item_label_deferred {
+	wmem_allocator_t *pool;
+	tree_data_t      *tree_data;	/* whose counts to bump when it's rendered */
+	label_op_t       *first;
+	label_op_t       *last;
+};
+
+static void
+label_apply(wmem_allocator_t *pool, field_info *fi, label_op_kind_t kind, const char *str)
+{
+	gsize	    pos;
+	char        representation[ITEM_LABEL_LENGTH];
+
+	switch (kind) {
+
+	case LABEL_OP_SET:
+		ITEM_LABEL_NEW(pool, fi->rep);
+		pos = ws_label_strcpy(fi->rep->representation, ITEM_LABEL_LENGTH, 0, str, 0);
+		if (pos >= ITEM_LABEL_LENGTH) {
+			/* Uh oh, we don't have enough room.  Tell the user
+			 * that the field is truncated.
+			 */
+			LABEL_MARK_TRUNCATED_START(fi->rep->representation);
+		}
+		break;
+
+	case LABEL_OP_APPEND:
+		/*
+		 * If we don't already have a representation,
+		 * generate the default representation.
+		 */
+		if (fi->rep == NULL) {
+			ITEM_LABEL_NEW(pool, fi->rep);
+			proto_item_fill_label(fi, fi->rep->representation);
+		}
+		pos = strlen(fi->rep->representation);
+		/* pos doesn't include the \0 byte.
+		 * XXX: If pos + 4 > ITEM_LABEL_LENGTH, we can't tell if
+		 * the representation has already been truncated (of an up
+		 * to 4 byte UTF-8 character) or is just at the maximum length
+		 * unless we search for " [truncated]" (which may not be
+		 * at the start.)
+		 * It's safer to do nothing.
+		 */
+		if (ITEM_LABEL_LENGTH > (pos + 4)) {
+			pos = ws_label_strcpy(fi->rep->representation, ITEM_LABEL_LENGTH, pos, str, 0);
+			if (pos >= ITEM_LABEL_LENGTH) {
+				/* Uh oh, we don't have enough room.  Tell the user
+				 * that the field is truncated.
+				 */
+				LABEL_MARK_TRUNCATED_START(fi->rep->representation);
+			}
+		}
+		break;
+
+	case LABEL_OP_PREPEND:
+		/*
+		 * If we don't already have a representation,
+		 * generate the default representation.
+		 */
+		if (fi->rep == NULL) {
+			ITEM_LABEL_NEW(pool, fi->rep);
+			proto_item_fill_label(fi, representation);
+		} else
+			(void) g_strlcpy(representation, fi->rep->representation, ITEM_LABEL_LENGTH);
+
+		pos = ws_label_strcpy(fi->rep->representation, ITEM_LABEL_LENGTH, 0, str, 0);
+		pos = ws_label_strcpy(fi->rep->representation, ITEM_LABEL_LENGTH, pos, representation, 0);
+		/* XXX: As above, if the old representation is close to the label
+		 * length, it might already be marked as truncated. */
+		if (pos >= ITEM_LABEL_LENGTH && (strlen(representation) + 4) <= ITEM_LABEL_LENGTH) {
+			/* Uh oh, we don't have enough room.  Tell the user
+			 * that the field is truncated.
+			 */
+			LABEL_MARK_TRUNCATED_START(fi->rep->representation);
+		}
+		break;
+	}
+}
+
+/* Format the text for a label operation and either apply it or, if the
+ * tree isn't visible, queue it. */
+static void
+proto_item_label_op(proto_item *pi, label_op_kind_t kind, const char *format, va_list ap)
+{
+	field_info                  *fi = PITEM_FINFO(pi);
+	struct _item_label_deferred *deferred;
+	label_op_t                  *op;
+	char                        *str;
+
+	str = wmem_strdup_vprintf(PNODE_POOL(pi), format, ap);
+	WS_UTF_8_CHECK(str, -1);
+
+	if (PTREE_DATA(pi)->visible) {
+		proto_item_render_label(fi);
+		label_apply(PNODE_POOL(pi), fi, kind, str);
+		return;
+	}
+
+	deferred = fi->deferred_rep;
+	if (deferred == NULL) {
+		deferred = wmem_new(PNODE_POOL(pi), struct _item_label_deferred);
+		deferred->pool = PNODE_POOL(pi);
+		deferred->tree_data = PTREE_DATA(pi);
+		deferred->first = NULL;
+		deferred->last = NULL;
+		fi->deferred_rep = deferred;
+		PTREE_DATA(pi)->labels_deferred++;
+	}
+
+	op = wmem_new(PNODE_POOL(pi), label_op_t);
+	op->next = NULL;
+	op->kind = kind;
+	op->text = str;
+	if (kind == LABEL_OP_SET || deferred->first == NULL) {
+		/* Setting the text replaces whatever came before. */
+		deferred->first = op;
+	} else {
+		deferred->last->next = op;
+	}
+	deferred->last = op;
+}
+
+void
+proto_item_render_label(const field_info *finfo)
+{
+	/* The label is a cache of the queued text; filling it in doesn't
+	 * change the item as far as the caller is concerned. */
+	field_info                  *fi = (field_info *)finfo;
+	struct _item_label_deferred *deferred;
+	label_op_t                  *op;
+
+	if (fi == NULL || fi->deferred_rep == NULL)
+		return;
+
+	deferred = fi->deferred_rep;
+	fi->deferred_rep = NULL;
+	deferred->tree_data->labels_rendered++;
+	for (op = deferred->first; op != NULL; op = op->next)
+		label_apply(deferred->pool, fi, op->kind, op->text);
+}
+
+void
+proto_get_deferred_label_counts(guint64 *deferred, guint64 *rendered)
+{
+	tree_label_counts_get(deferred, rendered);
+}
+
 /* If the protocol tree is to be visible, set the representation of a
    proto_tree entry with the name of the field for the item and with
    the value formatted with the supplied printf-style format and
@@ -6826,30 +7073,18 @@ proto_tree_set_representation_value(proto_item *pi, const char *format, va_list
 	}
 }
 
-/* If the protocol tree is to be visible, set the representation of a
-   proto_tree entry with the representation formatted with the supplied
-   printf-style format and argument list. */
+/* Set the representation of a proto_tree entry with the representation
+   formatted with the supplied printf-style format and argument list;
+   if the tree isn't visible, that's deferred until the label is needed. */
 static void
 proto_tree_set_representation(proto_item *pi, const char *format, va_list ap)
 {
-	gsize	    ret;	/*tmp return value */
-	char       *str;
 	field_info *fi = PITEM_FINFO(pi);
 
 	DISSECTOR_ASSERT(fi);
 
 	if (!proto_item_is_hidden(pi)) {
-		ITEM_LABEL_NEW(PNODE_POOL(pi), fi->rep);
-
-		str = wmem_strdup_vprintf(PNODE_POOL(pi), format, ap);
-		WS_UTF_8_CHECK(str, -1);
-		ret = ws_label_strcpy(fi->rep->representation, ITEM_LABEL_LENGTH, 0, str, 0);
-		if (ret >= ITEM_LABEL_LENGTH) {
-			/* Uh oh, we don't have enough room.  Tell the user
-			 * that the field is truncated.
-			 */
-			LABEL_MARK_TRUNCATED_START(fi->rep->representation);
-		}
+		proto_item_label_op(pi, LABEL_OP_SET, format, ap);
 	}
 }
 
@@ -7575,6 +7810,10 @@ proto_item_set_text(proto_item *pi, const char *format, ...)
 		ITEM_LABEL_FREE(PNODE_POOL(pi), fi->rep);
 		fi->rep = NULL;
 	}
+	if (fi->deferred_rep) {
+		fi->deferred_rep->first = NULL;
+		fi->deferred_rep->last = NULL;
+	}
 
 	va_start(ap, format);
 	proto_tree_set_representation(pi, format, ap);
@@ -7586,8 +7825,6 @@ void
 proto_item_append_text(proto_item *pi, const char *format, ...)
 {
 	field_info *fi = NULL;
-	size_t      curlen;
-	char       *str;
 	va_list     ap;
 
 	TRY_TO_FAKE_THIS_REPR_VOID(pi);
@@ -7599,37 +7836,16 @@ proto_item_append_text(proto_item *pi, const char *format, ...)
 
 	if (!proto_item_is_hidden(pi)) {
 		/*
-		 * If we don't already have a representation,
-		 * generate the default representation.
+		 * If the label is already full, don't bother formatting
+		 * the text; see label_apply().
 		 */
-		if (fi->rep == NULL) {
-			ITEM_LABEL_NEW(PNODE_POOL(pi), fi->rep);
-			proto_item_fill_label(fi, fi->rep->representation);
-		}
-		if (fi->rep) {
-			curlen = strlen(fi->rep->representation);
-			/* curlen doesn't include the \0 byte.
-			 * XXX: If curlen + 4 > ITEM_LABEL_LENGTH, we can't tell if
-			 * the representation has already been truncated (of an up
-			 * to 4 byte UTF-8 character) or is just at the maximum length
-			 * unless we search for " [truncated]" (which may not be
-			 * at the start.)
-			 * It's safer to do nothing.
-			 */
-			if (ITEM_LABEL_LENGTH > (curlen + 4)) {
-				va_start(ap, format);
-				str = wmem_strdup_vprintf(PNODE_POOL(pi), format, ap);
-				va_end(ap);
-				WS_UTF_8_CHECK(str, -1);
-				curlen = ws_label_strcpy(fi->rep->representation, ITEM_LABEL_LENGTH, curlen, str, 0);
-				if (curlen >= ITEM_LABEL_LENGTH) {
-					/* Uh oh, we don't have enough room.  Tell the user
-					 * that the field is truncated.
-					 */
-					LABEL_MARK_TRUNCATED_START(fi->rep->representation);
-				}
-			}
-		}
+		if (fi->rep && fi->deferred_rep == NULL &&
+		    ITEM_LABEL_LENGTH <= (strlen(fi->rep->representation) + 4))
+			return;
+
+		va_start(ap, format);
+		proto_item_label_op(pi, LABEL_OP_APPEND, format, ap);
+		va_end(ap);
 	}
 }
 
@@ -7638,9 +7854,6 @@ void
 proto_item_prepend_text(proto_item *pi, const char *format, ...)
 {
 	field_info *fi = NULL;
-	gsize       pos;
-	char        representation[ITEM_LABEL_LENGTH];
-	char       *str;
 	va_list     ap;
 
 	TRY_TO_FAKE_THIS_REPR_VOID(pi);
@@ -7651,30 +7864,9 @@ proto_item_prepend_text(proto_item *pi, const char *format, ...)
 	}
 
 	if (!proto_item_is_hidden(pi)) {
-		/*
-		 * If we don't already have a representation,
-		 * generate the default representation.
-		 */
-		if (fi->rep == NULL) {
-			ITEM_LABEL_NEW(PNODE_POOL(pi), fi->rep);
-			proto_item_fill_label(fi, representation);
-		} else
-			(void) g_strlcpy(representation, fi->rep->representation, ITEM_LABEL_LENGTH);
-
 		va_start(ap, format);
-		str = wmem_strdup_vprintf(PNODE_POOL(pi), format, ap);
+		proto_item_label_op(pi, LABEL_OP_PREPEND, format, ap);
 		va_end(ap);
-		WS_UTF_8_CHECK(str, -1);
-		pos = ws_label_strcpy(fi->rep->representation, ITEM_LABEL_LENGTH, 0, str, 0);
-		pos = ws_label_strcpy(fi->rep->representation, ITEM_LABEL_LENGTH, pos, representation, 0);
-		/* XXX: As above, if the old representation is close to the label
-		 * length, it might already be marked as truncated. */
-		if (pos >= ITEM_LABEL_LENGTH && (strlen(representation) + 4) <= ITEM_LABEL_LENGTH) {
-			/* Uh oh, we don't have enough room.  Tell the user
-			 * that the field is truncated.
-			 */
-			LABEL_MARK_TRUNCATED_START(fi->rep->representation);
-		}
 	}
 }
 
@@ -7803,8 +7995,13 @@ proto_tree_create_root(packet_info *pinfo)
 	/* Make sure we can access pinfo everywhere */
 	pnode->tree_data->pinfo = pinfo;
 
-	/* Don't initialize the tree_data_t. Wait until we know we need it */
-	pnode->tree_data->interesting_hfids = NULL;
+	/* Don't initialize the interesting fields. Wait until we know we need them */
+	pnode->tree_data->interesting = NULL;
+
+	pnode->tree_data->slab = tree_slab_new();
+
+	pnode->tree_data->labels_deferred = 0;
+	pnode->tree_data->labels_rendered = 0;
 
 	/* Set the default to FALSE so it's easier to
 	 * find errors; if we expect to see the protocol tree
@@ -7825,11 +8022,13 @@ proto_tree_create_root(packet_info *pinfo)
 /* "prime" a proto_tree with a single hfid that a dfilter
  * is interested in. */
 void
-proto_tree_prime_with_hfid(proto_tree *tree _U_, const gint hfid)
+proto_tree_prime_with_hfid(proto_tree *tree, const gint hfid)
 {
 	header_field_info *hfinfo;
 
 	PROTO_REGISTRAR_GET_NTH(hfid, hfinfo);
+	if (tree)
+		interesting_fields_get(&PTREE_DATA(tree)->interesting, PTREE_DATA(tree)->slab, hfid);
 	/* this field is referenced by a filter so increase the refcount.
 	   also increase the refcount for the parent, i.e the protocol.
 	   Don't increase the refcount if we're already printing the
@@ -7857,11 +8056,13 @@ proto_tree_prime_with_hfid(proto_tree *tree _U_, const gint hfid)
 /* "prime" a proto_tree with a single hfid that a dfilter
  * is interested in. */
 void
-proto_tree_prime_with_hfid_print(proto_tree *tree _U_, const gint hfid)
+proto_tree_prime_with_hfid_print(proto_tree *tree, const gint hfid)
 {
 	header_field_info *hfinfo;
 
 	PROTO_REGISTRAR_GET_NTH(hfid, hfinfo);
+	if (tree)
+		interesting_fields_get(&PTREE_DATA(tree)->interesting, PTREE_DATA(tree)->slab, hfid);
 	/* this field is referenced by an (output) filter so increase the refcount.
 	   also increase the refcount for the parent, i.e the protocol.
 	*/
@@ -8138,6 +8339,7 @@ proto_register_protocol(const char *name, const char *short_name,
 	protocol->can_toggle = TRUE;
 	protocol->parent_proto_id = -1;
 	protocol->heur_list = NULL;
+	protocol->lazy_fields = NULL;
 
 	/* List will be sorted later by name, when all protocols completed registering */
 	protocols = g_list_prepend(protocols, protocol);
@@ -8197,6 +8399,7 @@ proto_register_protocol_in_name_only(const char *name, const char *short_name, c
 
 	protocol->parent_proto_id = parent_proto;
 	protocol->heur_list = NULL;
+	protocol->lazy_fields = NULL;
 
 	/* List will be sorted later by name, when all protocols completed registering */
 	protocols = g_list_prepend(protocols, protocol);
@@ -8250,6 +8453,12 @@ proto_deregister_protocol(const char *short_name)
 
 	g_list_free(protocol->heur_list);
 
+	if (protocol->lazy_fields) {
+		g_hash_table_remove(lazy_field_protocols, protocol->filter_name);
+		g_slist_free_full(protocol->lazy_fields, g_free);
+		protocol->lazy_fields = NULL;
+	}
+
 	/* Remove this protocol from the list of known protocols */
 	protocols = g_list_remove(protocols, protocol);
 
@@ -8320,6 +8529,8 @@ proto_get_first_protocol_field(const int proto_id, void **cookie)
 {
 	protocol_t *protocol = find_protocol_by_id(proto_id);
 
+	proto_register_deferred_fields(protocol);
+
 	if ((protocol == NULL) || (protocol->fields == NULL) || (protocol->fields->len == 0))
 		return NULL;
 
@@ -8720,6 +8931,66 @@ proto_register_field_array(const int parent, hf_register_info *hf, const int num
 	}
 }
 
+void
+proto_register_field_array_lazy(const int parent, hf_register_info *hf, const int num_records)
+{
+	protocol_t	   *proto;
+	lazy_field_array_t *lazy;
+
+	if (!lazy_fields_enabled) {
+		proto_register_field_array(parent, hf, num_records);
+		return;
+	}
+
+	proto = find_protocol_by_id(parent);
+	if (proto->parent_proto_id != -1) {
+		REPORT_DISSECTOR_BUG("Deferred fields registered for helper protocol \"%s\"", proto->name);
+	}
+
+	lazy = g_new(lazy_field_array_t, 1);
+	lazy->hf = hf;
+	lazy->num_records = num_records;
+	proto->lazy_fields = g_slist_append(proto->lazy_fields, lazy);
+	g_hash_table_insert(lazy_field_protocols, (gpointer)proto->filter_name, proto);
+	lazy_field_count += num_records;
+}
+
+void
+proto_register_deferred_fields(protocol_t *protocol)
+{
+	GSList *lazy_fields, *l;
+
+	if (protocol == NULL)
+		return;
+
+	/* Helper protocols share the fields of their parent */
+	if (protocol->parent_proto_id != -1)
+		protocol = find_protocol_by_id(protocol->parent_proto_id);
+
+	if (protocol == NULL || protocol->lazy_fields == NULL)
+		return;
+
+	/* Detach the list first, in case registration looks up one of our fields */
+	lazy_fields = protocol->lazy_fields;
+	protocol->lazy_fields = NULL;
+	g_hash_table_remove(lazy_field_protocols, protocol->filter_name);
+
+	for (l = lazy_fields; l != NULL; l = l->next) {
+		lazy_field_array_t *lazy = (lazy_field_array_t *)l->data;
+
+		proto_register_field_array(protocol->proto_id, lazy->hf, lazy->num_records);
+		lazy_field_count -= lazy->num_records;
+	}
+	g_slist_free_full(lazy_fields, g_free);
+}
+
+void
+proto_registrar_get_counts(guint *registered, guint *deferred)
+{
+	*registered = gpa_hfinfo.len;
+	*deferred = lazy_field_count;
+}
+
 /* deregister already registered fields */
 void
 proto_deregister_field (const int parent, gint hf_id)
@@ -11182,32 +11453,30 @@ proto_check_for_protocol_or_field(const proto_tree* tree, const int id)
 /* Return GPtrArray* of field_info pointers for all hfindex that appear in tree.
  * This only works if the hfindex was "primed" before the dissection
  * took place, as we just pass back the already-created GPtrArray*.
- * The caller should *not* free the GPtrArray*; proto_tree_free_node()
- * handles that. */
+ * The caller should *not* free the GPtrArray*, or add to or remove from
+ * it; it belongs to the tree, and goes away when the tree is reset. */
 GPtrArray *
 proto_get_finfo_ptr_array(const proto_tree *tree, const int id)
 {
+	interesting_slot_t *slot;
+
 	if (!tree)
 		return NULL;
 
-	if (PTREE_DATA(tree)->interesting_hfids != NULL)
-		return (GPtrArray *)g_hash_table_lookup(PTREE_DATA(tree)->interesting_hfids,
-					   GINT_TO_POINTER(id));
-	else
+	slot = interesting_fields_lookup(PTREE_DATA(tree)->interesting, id);
+	if (slot == NULL || slot->finfos.len == 0)
 		return NULL;
+
+	return &slot->finfos;
 }
 
 gboolean
 proto_tracking_interesting_fields(const proto_tree *tree)
 {
-	GHashTable *interesting_hfids;
-
 	if (!tree)
 		return FALSE;
 
-	interesting_hfids = PTREE_DATA(tree)->interesting_hfids;
-
-	return (interesting_hfids != NULL) && g_hash_table_size(interesting_hfids);
+	return PTREE_DATA(tree)->interesting != NULL;
 }
 
 /* Helper struct for proto_find_info() and	proto_all_finfos() */
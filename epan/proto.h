@@ -822,6 +822,7 @@ typedef struct field_info {
     gint                 tree_type;       /**< one of ETT_ or -1 */
     guint32              flags;           /**< bitfield like FI_GENERATED, ... */
     item_label_t        *rep;             /**< string for GUI tree */
+    struct _item_label_deferred *deferred_rep; /**< text for rep not rendered yet; see proto_item_render_label() */
     tvbuff_t            *ds_tvb;          /**< data source tvbuff */
     fvalue_t            *value;
     int                 total_layer_num;        /**< Hierarchical layer number, for all protocols in the tree. */
@@ -893,11 +894,14 @@ typedef struct
 /** One of these exists for the entire protocol tree. Each proto_node
  * in the protocol tree points to the same copy. */
 typedef struct {
-    GHashTable          *interesting_hfids;
+    struct _interesting_fields *interesting; /**< field_infos for each interesting hfid, see proto_tree_prime_with_hfid() */
     gboolean             visible;
     gboolean             fake_protocols;
     guint                count;
     struct _packet_info *pinfo;
+    struct _tree_slab   *slab;               /**< backing store for proto_nodes and field_infos */
+    guint                labels_deferred;    /**< items whose label was deferred since the last reset */
+    guint                labels_rendered;    /**< how many of those labels were built anyway */
 } tree_data_t;
 
 /** Each proto_tree, proto_item is one of these. */
@@ -1226,7 +1230,9 @@ proto_tree_set_fake_protocols(proto_tree *tree, gboolean fake_protocols);
  * That means that we don't fake the item (because we are filtering on it),
  * and we mark its parent protocol (if any) as being indirectly referenced
  * (so proto_field_is_referenced() will return TRUE for the protocol as well.)
- @param tree the tree to be set (currently ignored)
+ * If a tree is given, a slot for the field's items is set up in it ahead of
+ * dissection.
+ @param tree the tree to be set, or NULL
  @param hfid the interesting field id */
 extern void
 proto_tree_prime_with_hfid(proto_tree *tree, const int hfid);
@@ -1234,7 +1240,7 @@ proto_tree_prime_with_hfid(proto_tree *tree, const int hfid);
 /** Mark a field/protocol ID as something we want to print.
  * That means that we don't fake it, and we also don't hide it by
  * default even if the tree isn't visible.
- @param tree the tree to be set (currently ignored)
+ @param tree the tree to be set, or NULL
  @param hfid the field id */
 extern void
 proto_tree_prime_with_hfid_print(proto_tree *tree, const int hfid);
@@ -2543,6 +2549,22 @@ WS_DLL_PUBLIC proto_item *
 proto_tree_add_debug_text(proto_tree *tree, const char *format,
     ...) G_GNUC_PRINTF(2,3);
 
+/** If the text of an item's label was set while the tree wasn't visible,
+ * the label is only built when it's needed. Call this before looking at
+ * finfo->rep of an item that might come from such a tree; it does nothing
+ * if the label is already built.
+ @param finfo the item whose label to build */
+WS_DLL_PUBLIC void
+proto_item_render_label(const field_info *finfo);
+
+/** Get the number of items whose label was deferred, and how many
+ * of those were later built by proto_item_render_label(). A tree's
+ * counts are included once it has been reset or freed.
+ @param deferred set to the number of deferred labels, if not NULL
+ @param rendered set to the number of those that were built, if not NULL */
+WS_DLL_PUBLIC void
+proto_get_deferred_label_counts(guint64 *deferred, guint64 *rendered);
+
 /** Fill given label_str with a simple string representation of field.
  @param finfo the item to get the info from
  @param label_str the string to fill
@@ -2627,6 +2649,36 @@ WS_DLL_PUBLIC void proto_initialize_all_prefixes(void);
 WS_DLL_PUBLIC void
 proto_register_field_array(const int parent, hf_register_info *hf, const int num_records);
 
+/** Register a header_field array when it's first needed rather than now.
+ Meant for protocols with very large field arrays, such as those generated
+ from ASN.1, where registering every field at startup is a noticeable part
+ of the startup time. The fields are registered the first time one of them
+ is looked up by name, the protocol's fields are iterated over, or a packet
+ is handed to one of the protocol's dissectors through a handle or a
+ heuristic dissector table. The fields must not be referenced in any other
+ way, for example by dissection functions exported to other dissectors, and
+ "hf" must stay valid until then (in practice, it must be static).
+ Setting the WIRESHARK_NO_LAZY_FIELDS environment variable registers them
+ right away.
+ @param parent the protocol handle from proto_register_protocol()
+ @param hf the hf_register_info array
+ @param num_records the number of records in hf */
+WS_DLL_PUBLIC void
+proto_register_field_array_lazy(const int parent, hf_register_info *hf, const int num_records);
+
+/** Register the field arrays of a protocol whose registration was deferred
+ with proto_register_field_array_lazy(), if any.
+ @param protocol the protocol; if it's a helper protocol, its parent */
+WS_DLL_PUBLIC void
+proto_register_deferred_fields(protocol_t *protocol);
+
+/** Get the number of header fields registered so far, and the number of
+ fields whose registration is still deferred.
+ @param registered set to the number of registered fields and protocols
+ @param deferred set to the number of deferred fields */
+extern void
+proto_registrar_get_counts(guint *registered, guint *deferred);
+
 /** Deregister an already registered field.
  @param parent the protocol handle from proto_register_protocol()
  @param hf_id the field to deregister */
@@ -2856,9 +2908,11 @@ extern gboolean proto_check_for_protocol_or_field(const proto_tree* tree, const
 
 /** Return GPtrArray* of field_info pointers for all hfindex that appear in
     tree. Only works with primed trees, and is fast.
+    The array belongs to the tree and is valid until the tree is reset;
+    it can be sorted, but not freed, added to or removed from.
  @param tree tree of interest
  @param hfindex primed hfindex
- @return GPtrArray pointer */
+ @return GPtrArray pointer, or NULL if there are none */
 WS_DLL_PUBLIC GPtrArray* proto_get_finfo_ptr_array(const proto_tree *tree, const int hfindex);
 
 /** Return whether we're tracking any interesting fields.
@@ -44,6 +44,9 @@ void register_all_protocol_handoffs(register_cb cb, gpointer client_data);
 
 gulong register_count(void);
 
+/** Free the startup profile. */
+void register_cleanup(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -12,8 +12,11 @@
 #include "ws_attributes.h"
 
 #include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 #include <epan/exceptions.h>
+#include <epan/proto.h>
 
 #include "epan/dissectors/dissectors.h"
 
@@ -26,6 +29,38 @@ static GAsyncQueue *register_cb_done_q;
 
 #define CB_WAIT_TIME (150 * 1000) // microseconds
 
+/*
+ * What each registration routine cost at startup, for "tshark -G
+ * startup-profile". Timing the routines is cheap next to what they do,
+ * so this is always recorded.
+ */
+typedef struct {
+    const char *cb_name;
+    gint64 usec;
+    guint fields;       /* header fields registered */
+    guint deferred;     /* header fields whose registration was deferred */
+} register_profile_t;
+
+static register_profile_t *register_profile;
+static gulong register_profile_count;
+
+static void
+call_register_routine(const dissector_reg_t *reg)
+{
+    register_profile_t *prof = &register_profile[register_profile_count++];
+    guint fields, deferred;
+    gint64 start;
+
+    proto_registrar_get_counts(&fields, &deferred);
+    start = g_get_monotonic_time();
+    reg->cb_func();
+    prof->usec = g_get_monotonic_time() - start;
+    prof->cb_name = reg->cb_name;
+    proto_registrar_get_counts(&prof->fields, &prof->deferred);
+    prof->fields -= fields;
+    prof->deferred -= deferred;
+}
+
 static void set_cb_name(const char *proto) {
     g_mutex_lock(&cur_cb_name_mtx);
     cur_cb_name = proto;
@@ -40,7 +75,7 @@ register_all_protocols_worker(void *arg _U_)
     TRY {
         for (gulong i = 0; i < dissector_reg_proto_count; i++) {
             set_cb_name(dissector_reg_proto[i].cb_name);
-            dissector_reg_proto[i].cb_func();
+            call_register_routine(&dissector_reg_proto[i]);
         }
     }
     CATCH(DissectorError) {
@@ -70,6 +105,10 @@ register_all_protocols(register_cb cb, gpointer cb_data)
     GThread *rapw_thread;
     const char *error_message;
 
+    g_free(register_profile);
+    register_profile = g_new0(register_profile_t, register_count());
+    register_profile_count = 0;
+
     rapw_thread = g_thread_new("register_all_protocols_worker", &register_all_protocols_worker, NULL);
     while (!g_async_queue_timeout_pop(register_cb_done_q, CB_WAIT_TIME)) {
         g_mutex_lock(&cur_cb_name_mtx);
@@ -96,7 +135,7 @@ register_all_protocol_handoffs_worker(void *arg _U_)
     TRY {
         for (gulong i = 0; i < dissector_reg_handoff_count; i++) {
             set_cb_name(dissector_reg_handoff[i].cb_name);
-            dissector_reg_handoff[i].cb_func();
+            call_register_routine(&dissector_reg_handoff[i]);
         }
     }
     CATCH(DissectorError) {
@@ -150,6 +189,38 @@ gulong register_count(void)
     return dissector_reg_proto_count + dissector_reg_handoff_count;
 }
 
+static gint
+register_profile_compare(gconstpointer a, gconstpointer b)
+{
+    const register_profile_t *pa = (const register_profile_t *)a;
+    const register_profile_t *pb = (const register_profile_t *)b;
+
+    if (pa->usec != pb->usec)
+        return pa->usec < pb->usec ? 1 : -1;
+    return g_strcmp0(pa->cb_name, pb->cb_name);
+}
+
+void
+register_dump_startup_profile(void)
+{
+    if (!register_profile_count)
+        return;
+
+    qsort(register_profile, register_profile_count, sizeof(register_profile_t), register_profile_compare);
+    for (gulong i = 0; i < register_profile_count; i++) {
+        printf("%s\t%" G_GINT64_FORMAT "\t%u\t%u\n", register_profile[i].cb_name,
+               register_profile[i].usec, register_profile[i].fields, register_profile[i].deferred);
+    }
+}
+
+void
+register_cleanup(void)
+{
+    g_free(register_profile);
+    register_profile = NULL;
+    register_profile_count = 0;
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
@@ -13,6 +13,7 @@
 #define __REGISTER_H__
 
 #include <glib.h>
+#include "ws_symbol_export.h"
 
 typedef enum {
     RA_NONE,              /* For initialization */
@@ -34,6 +35,19 @@ typedef enum {
 
 typedef void (*register_cb)(register_action_e action, const char *message, gpointer client_data);
 
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Dump what each built-in registration and handoff routine cost at
+ * startup: its name, the time it took in microseconds, and the number of
+ * header fields it registered and deferred, most expensive first. */
+WS_DLL_PUBLIC void register_dump_startup_profile(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
 #endif /* __REGISTER_H__ */
 
 /*
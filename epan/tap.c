@@ -86,15 +86,24 @@ typedef struct _tap_listener_t {
 	guint flags;
 	gchar *fstring;
 	dfilter_t *code;
+	guint code_idx;		/* index of code in tap_filter_group */
 	void *tapdata;
 	tap_reset_cb reset;
 	tap_packet_cb packet;
 	tap_draw_cb draw;
 	tap_finish_cb finish;
+	tap_split_cb split;
+	tap_merge_cb merge;
+	void *partial;		/* where packets go between split and merge */
 } tap_listener_t;
 
 static tap_listener_t *tap_listener_queue;
 
+/* The filters of all tap listeners, applied together so that each is
+ * evaluated once per packet and fields they share are read once.
+ * Rebuilt when it's next needed after a listener or filter changes. */
+static dfilter_group_t *tap_filter_group;
+
 static GSList *tap_plugins;
 
 #ifdef HAVE_PLUGINS
@@ -297,6 +306,29 @@ tap_queue_init(epan_dissect_t *edt)
 	tap_build_interesting (edt);
 }
 
+static void
+invalidate_tap_filter_group(void)
+{
+	dfilter_group_free(tap_filter_group);
+	tap_filter_group=NULL;
+}
+
+static gboolean
+tap_listener_filter_matches(tap_listener_t *tl, epan_dissect_t *edt)
+{
+	tap_listener_t *tl2;
+
+	if(!tap_filter_group){
+		tap_filter_group=dfilter_group_new();
+		for(tl2=tap_listener_queue;tl2;tl2=tl2->next){
+			if(tl2->code){
+				tl2->code_idx=dfilter_group_add(tap_filter_group, tl2->code);
+			}
+		}
+	}
+	return dfilter_group_test(tap_filter_group, tl->code_idx, edt);
+}
+
 /* this function is called after a packet has been fully dissected to push the tapped
    data to all extensions that has callbacks registered.
 */
@@ -350,7 +382,7 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 					 */
 					guint flags = tl->flags;
 					if(tl->code){
-						if (!dfilter_apply_edt(tl->code, edt)){
+						if (!tap_listener_filter_matches(tl, edt)){
 							/* The packet didn't
 							 * pass the filter. */
 							if (tl->flags & TL_IGNORE_DISPLAY_FILTER)
@@ -363,7 +395,7 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 					/* So call the per-packet routine. */
 					tap_packet_status status;
 
-					status = tl->packet(tl->tapdata, tp->pinfo, edt, tp->tap_specific_data, flags);
+					status = tl->packet(tl->partial ? tl->partial : tl->tapdata, tp->pinfo, edt, tp->tap_specific_data, flags);
 
 					switch (status) {
 
@@ -382,6 +414,10 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 			}
 		}
 	}
+
+	if(tap_filter_group){
+		dfilter_group_reset(tap_filter_group);
+	}
 }
 
 
@@ -512,6 +548,10 @@ find_tap_id(const char *name)
 static void
 free_tap_listener(tap_listener_t *tl)
 {
+	if (tl->partial) {
+		tl->merge(tl->tapdata, tl->partial);
+		tl->partial = NULL;
+	}
 	/* The free_tap_listener is called in the error path of
 	 * register_tap_listener (when the dfilter fails to be registered)
 	 * and the finish callback is set after that.
@@ -521,6 +561,9 @@ free_tap_listener(tap_listener_t *tl)
 	if (tl->finish) {
 		tl->finish(tl->tapdata);
 	}
+	if (tl->code) {
+		invalidate_tap_filter_group();
+	}
 	dfilter_free(tl->code);
 	g_free(tl->fstring);
 	g_free(tl);
@@ -577,6 +620,7 @@ register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
 	tl->next=tap_listener_queue;
 
 	tap_listener_queue=tl;
+	invalidate_tap_filter_group();
 
 	return NULL;
 }
@@ -608,6 +652,7 @@ set_tap_dfilter(void *tapdata, const char *fstring)
 	}
 
 	if(tl){
+		invalidate_tap_filter_group();
 		if(tl->code){
 			dfilter_free(tl->code);
 			tl->code=NULL;
@@ -640,6 +685,7 @@ tap_listeners_dfilter_recompile(void)
 	tap_listener_t *tl;
 	dfilter_t *code;
 
+	invalidate_tap_filter_group();
 	for(tl=tap_listener_queue;tl;tl=tl->next){
 		if(tl->code){
 			dfilter_free(tl->code);
@@ -657,6 +703,89 @@ tap_listeners_dfilter_recompile(void)
 	}
 }
 
+static tap_listener_t *
+find_tap_listener(void *tapdata)
+{
+	tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->tapdata==tapdata){
+			return tl;
+		}
+	}
+	return NULL;
+}
+
+/* this function lets the results of a tap listener be gathered in parts
+ * and merged
+ */
+gboolean
+set_tap_listener_merge(void *tapdata, tap_split_cb split, tap_merge_cb merge)
+{
+	tap_listener_t *tl=find_tap_listener(tapdata);
+
+	if(!tl){
+		ws_warning("no listener found with that tap data");
+		return FALSE;
+	}
+	if(tl->partial){
+		/* Can't change this in the middle of a part */
+		return FALSE;
+	}
+
+	tl->split=split;
+	tl->merge=merge;
+	return TRUE;
+}
+
+/*
+ * Return TRUE if every tap listener can gather its results in parts,
+ * FALSE otherwise.
+ */
+gboolean
+tap_listeners_can_merge(void)
+{
+	tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(!tl->split || !tl->merge){
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/* this function starts a new part: until tap_listeners_merge() is called,
+ * listeners that can merge are given packets in a new, empty instance
+ */
+void
+tap_listeners_split(void)
+{
+	tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->split && tl->merge && !tl->partial){
+			tl->partial=tl->split(tl->tapdata);
+		}
+	}
+}
+
+/* this function merges the current part into the listeners' results,
+ * in the order the parts were split
+ */
+void
+tap_listeners_merge(void)
+{
+	tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->partial){
+			tl->merge(tl->tapdata, tl->partial);
+			tl->partial=NULL;
+		}
+	}
+}
+
 /* this function removes a tap listener
  */
 void
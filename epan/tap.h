@@ -34,6 +34,8 @@ typedef void (*tap_reset_cb)(void *tapdata);
 typedef tap_packet_status (*tap_packet_cb)(void *tapdata, packet_info *pinfo, epan_dissect_t *edt, const void *data, tap_flags_t flags);
 typedef void (*tap_draw_cb)(void *tapdata);
 typedef void (*tap_finish_cb)(void *tapdata);
+typedef void *(*tap_split_cb)(void *tapdata);
+typedef void (*tap_merge_cb)(void *tapdata, void *partial_tapdata);
 
 /**
  * Flags to indicate what a tap listener's packet routine requires.
@@ -233,6 +235,39 @@ WS_DLL_PUBLIC GString *register_tap_listener(const char *tapname, void *tapdata,
     tap_packet_cb tap_packet, tap_draw_cb tap_draw,
     tap_finish_cb tap_finish) G_GNUC_WARN_UNUSED_RESULT;
 
+/** This function lets a tap listener's results be gathered in parts and
+ * then combined, for example when a capture is retapped in several
+ * pieces.
+ *
+ * @param tapdata    The tap listener instance given to register_tap_listener().
+ * @param split      void *(*split)(void *tapdata)
+ *                   Returns a new, empty instance with the same settings as
+ *                   tapdata. Packets for the current part are passed to the
+ *                   (*packet) callback with that instance.
+ * @param merge      void (*merge)(void *tapdata, void *partial_tapdata)
+ *                   Adds the results in partial_tapdata to tapdata and frees
+ *                   partial_tapdata. Parts are merged in packet order, so
+ *                   the result must be the same as if tapdata had seen every
+ *                   packet itself.
+ * @return TRUE on success, FALSE if there is no such listener.
+ */
+WS_DLL_PUBLIC gboolean set_tap_listener_merge(void *tapdata, tap_split_cb split, tap_merge_cb merge);
+
+/**
+ * Return TRUE if every tap listener can have its results gathered in parts,
+ * FALSE otherwise.
+ */
+WS_DLL_PUBLIC gboolean tap_listeners_can_merge(void);
+
+/** Start a new part: until tap_listeners_merge() is called, listeners that
+ * support it receive packets in a new, empty instance. Others keep
+ * receiving packets as usual.
+ */
+WS_DLL_PUBLIC void tap_listeners_split(void);
+
+/** Merge the current part into each listener's results. */
+WS_DLL_PUBLIC void tap_listeners_merge(void);
+
 /** This function sets a new dfilter to a tap listener */
 WS_DLL_PUBLIC GString *set_tap_dfilter(void *tapdata, const char *fstring);
 
@@ -0,0 +1,340 @@
+/* test_dfilter_group.c
+ * Unit tests for applying display filters in groups
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/epan.h>
+#include <epan/epan_dissect.h>
+#include <epan/color_filters.h>
+#include <epan/dfilter/dfilter.h>
+#include <epan/epan_test_fixture.h>
+#include <wiretap/wtap.h>
+#include <wsutil/wslog.h>
+
+/*
+ * Overlapping filters: most of them read "tcp", "udp" or "ip.addr",
+ * two of them have the same text, and two read ip.addr only in one
+ * layer, which isn't shared with the filters that read all of it.
+ */
+static const char *group_filters[] = {
+    "tcp",
+    "ip.addr == 10.0.0.1",
+    "tcp && ip.addr == 10.0.0.2",
+    "udp || ip.addr == 10.0.0.3",
+    "ip.addr == 10.0.0.1",
+    "tcp.port == 80 && ip.src == 10.0.0.1",
+    "ip.addr == 10.0.0.9",
+    "!tcp && ip.dst == 10.0.0.1",
+    "ip.addr#1 == 10.0.0.2",
+    "ip.addr#2 == 10.0.0.2",
+    "ip.len > 30 && udp",
+};
+
+typedef struct {
+    guint8  proto;      /* IP_PROTO_TCP or IP_PROTO_UDP */
+    guint8  src;        /* last byte of 10.0.0.x */
+    guint8  dst;
+} group_packet_t;
+
+static const group_packet_t group_packets[] = {
+    { 6,  1, 2 },
+    { 17, 3, 1 },
+    { 6,  4, 5 },
+    { 17, 2, 9 },
+    { 6,  7, 8 },
+};
+
+static epan_t *session;
+
+static const nstime_t *
+test_get_frame_ts(struct packet_provider_data *prov _U_, guint32 frame_num _U_)
+{
+    static nstime_t empty;
+
+    return &empty;
+}
+
+static epan_t *
+test_epan_new(void)
+{
+    static const struct packet_provider_funcs funcs = {
+        test_get_frame_ts,
+        NULL,
+        NULL,
+        NULL
+    };
+
+    return epan_new(NULL, &funcs);
+}
+
+/* Build an Ethernet frame with an IPv4 TCP SYN or an empty UDP datagram. */
+static guint
+build_frame(guint8 *buf, const group_packet_t *packet)
+{
+    static const guint8 eth[] = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55,
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x66,
+        0x08, 0x00,
+    };
+    static const guint8 tcp[] = {
+        0x04, 0xd2, 0x00, 0x50,
+        0x00, 0x00, 0x00, 0x01,
+        0x00, 0x00, 0x00, 0x00,
+        0x50, 0x02, 0x72, 0x10,
+        0x00, 0x00, 0x00, 0x00,
+    };
+    static const guint8 udp[] = {
+        0x00, 0x35, 0x04, 0x00,
+        0x00, 0x08, 0x00, 0x00,
+    };
+    const guint8 *l4 = packet->proto == 6 ? tcp : udp;
+    guint l4_len = packet->proto == 6 ? sizeof(tcp) : sizeof(udp);
+    guint8 *ip = buf + sizeof(eth);
+
+    memcpy(buf, eth, sizeof(eth));
+    memset(ip, 0, 20);
+    ip[0] = 0x45;
+    ip[3] = 20 + l4_len;
+    ip[5] = 1;
+    ip[8] = 64;
+    ip[9] = packet->proto;
+    ip[12] = 10;
+    ip[15] = packet->src;
+    ip[16] = 10;
+    ip[19] = packet->dst;
+    memcpy(ip + 20, l4, l4_len);
+
+    return (guint)sizeof(eth) + 20 + l4_len;
+}
+
+/* Dissect a packet into edt, which has already been primed. */
+static void
+dissect_packet(epan_dissect_t *edt, guint32 num, const group_packet_t *packet, guint8 *buf, frame_data *fd)
+{
+    wtap_rec rec;
+    guint len = build_frame(buf, packet);
+
+    memset(&rec, 0, sizeof(rec));
+    rec.rec_type = REC_TYPE_PACKET;
+    rec.presence_flags = WTAP_HAS_TS | WTAP_HAS_CAP_LEN;
+    rec.rec_header.packet_header.caplen = len;
+    rec.rec_header.packet_header.len = len;
+    rec.rec_header.packet_header.pkt_encap = WTAP_ENCAP_ETHERNET;
+
+    frame_data_init(fd, num, &rec, 0, 0);
+    epan_dissect_run(edt, WTAP_FILE_TYPE_SUBTYPE_UNKNOWN, &rec,
+            tvb_new_real_data(buf, len, len), fd, NULL);
+}
+
+static dfilter_t *
+compile_filter(const char *text)
+{
+    dfilter_t *df = NULL;
+    df_error_t *df_err = NULL;
+
+    if (!dfilter_compile(text, &df, &df_err)) {
+        g_error("Can't compile \"%s\": %s", text, df_err->msg);
+    }
+    return df;
+}
+
+/*
+ * A group's results must be the same as applying each filter on its own,
+ * whichever order the group's filters are tested in.
+ */
+static void
+test_dfilter_group_apply(void)
+{
+    dfilter_t *alone[G_N_ELEMENTS(group_filters)];
+    dfilter_t *grouped[G_N_ELEMENTS(group_filters)];
+    dfilter_group_t *group = dfilter_group_new();
+    bool results[G_N_ELEMENTS(group_filters)];
+
+    for (size_t i = 0; i < G_N_ELEMENTS(group_filters); i++) {
+        alone[i] = compile_filter(group_filters[i]);
+        grouped[i] = compile_filter(group_filters[i]);
+        g_assert_cmpuint(dfilter_group_add(group, grouped[i]), ==, i);
+    }
+    g_assert_cmpuint(dfilter_group_size(group), ==, G_N_ELEMENTS(group_filters));
+
+    for (size_t p = 0; p < G_N_ELEMENTS(group_packets); p++) {
+        epan_dissect_t *edt = epan_dissect_new(session, true, false);
+        guint8 buf[128];
+        frame_data fd;
+        bool expected[G_N_ELEMENTS(group_filters)];
+        int first = -1;
+
+        for (size_t i = 0; i < G_N_ELEMENTS(group_filters); i++) {
+            epan_dissect_prime_with_dfilter(edt, alone[i]);
+            epan_dissect_prime_with_dfilter(edt, grouped[i]);
+        }
+        dissect_packet(edt, (guint32)p + 1, &group_packets[p], buf, &fd);
+
+        for (size_t i = 0; i < G_N_ELEMENTS(group_filters); i++) {
+            expected[i] = dfilter_apply_edt(alone[i], edt);
+            if (expected[i] && first < 0) {
+                first = (int)i;
+            }
+        }
+
+        dfilter_group_apply(group, edt, results);
+        for (size_t i = 0; i < G_N_ELEMENTS(group_filters); i++) {
+            g_assert_cmpint(results[i], ==, expected[i]);
+        }
+
+        g_assert_cmpint(dfilter_group_apply_first(group, edt), ==, first);
+
+        /* Backwards, so that the fields are first read by other filters */
+        for (size_t i = G_N_ELEMENTS(group_filters); i-- > 0; ) {
+            g_assert_cmpint(dfilter_group_test(group, (unsigned)i, edt), ==, expected[i]);
+        }
+        dfilter_group_reset(group);
+
+        epan_dissect_free(edt);
+        frame_data_destroy(&fd);
+    }
+
+    dfilter_group_free(group);
+    for (size_t i = 0; i < G_N_ELEMENTS(group_filters); i++) {
+        dfilter_free(alone[i]);
+        dfilter_free(grouped[i]);
+    }
+}
+
+static color_t color_black = { 0, 0, 0 };
+
+static GSList *
+color_filter_list_new(const char * const *specs, size_t count)
+{
+    GSList *cfl = NULL;
+
+    /* Each filter is given as its name and text, and a leading "-" in
+     * the name disables it. */
+    for (size_t i = 0; i < count; i += 2) {
+        bool disabled = specs[i][0] == '-';
+
+        cfl = g_slist_append(cfl, color_filter_new(specs[i] + (disabled ? 1 : 0), specs[i + 1],
+                    &color_black, &color_black, disabled));
+    }
+    return cfl;
+}
+
+/* The coloring rule that matches a packet, or NULL */
+static const char *
+colorize_packet(guint32 num, const group_packet_t *packet)
+{
+    epan_dissect_t *edt = epan_dissect_new(session, true, false);
+    const color_filter_t *colorf;
+    const char *name;
+    guint8 buf[128];
+    frame_data fd;
+
+    color_filters_prime_edt(edt);
+    dissect_packet(edt, num, packet, buf, &fd);
+    colorf = color_filters_colorize_packet(edt);
+    name = colorf ? colorf->filter_name : NULL;
+
+    epan_dissect_free(edt);
+    frame_data_destroy(&fd);
+    return name;
+}
+
+/*
+ * The coloring rules are applied as a group that's built on the first
+ * packet; changing the rules must rebuild it.
+ */
+static void
+test_color_filters_group(void)
+{
+    static const char * const first_rules[] = {
+        "UDP",          "udp",
+        "Host 1",       "ip.addr == 10.0.0.1",
+        "TCP",          "tcp",
+    };
+    static const char * const second_rules[] = {
+        "TCP first",    "tcp",
+        "Host 1 again", "ip.addr == 10.0.0.1",
+        "Host 9",       "ip.addr == 10.0.0.9",
+    };
+    static const char * const third_rules[] = {
+        "-TCP first",   "tcp",
+        "Host 2",       "ip.addr == 10.0.0.2",
+    };
+    GSList *cfl;
+    char *err_msg;
+
+    cfl = color_filter_list_new(first_rules, G_N_ELEMENTS(first_rules));
+    g_assert_true(color_filters_apply(NULL, cfl, &err_msg));
+    color_filter_list_delete(&cfl);
+    g_assert_cmpstr(colorize_packet(1, &group_packets[0]), ==, "Host 1");
+    g_assert_cmpstr(colorize_packet(2, &group_packets[1]), ==, "UDP");
+    g_assert_cmpstr(colorize_packet(3, &group_packets[2]), ==, "TCP");
+
+    cfl = color_filter_list_new(second_rules, G_N_ELEMENTS(second_rules));
+    g_assert_true(color_filters_apply(NULL, cfl, &err_msg));
+    color_filter_list_delete(&cfl);
+    g_assert_cmpstr(colorize_packet(1, &group_packets[0]), ==, "TCP first");
+    g_assert_cmpstr(colorize_packet(2, &group_packets[1]), ==, "Host 1 again");
+    g_assert_cmpstr(colorize_packet(4, &group_packets[3]), ==, "Host 9");
+
+    /* Disabled rules are left out of the group */
+    cfl = color_filter_list_new(third_rules, G_N_ELEMENTS(third_rules));
+    g_assert_true(color_filters_apply(NULL, cfl, &err_msg));
+    color_filter_list_delete(&cfl);
+    g_assert_cmpstr(colorize_packet(1, &group_packets[0]), ==, "Host 2");
+    g_assert_null(colorize_packet(3, &group_packets[2]));
+
+    /* An empty list turns coloring off */
+    g_assert_true(color_filters_apply(NULL, NULL, &err_msg));
+    g_assert_null(colorize_packet(1, &group_packets[0]));
+
+    color_filters_cleanup();
+}
+
+int main(int argc, char **argv)
+{
+    int ret;
+
+    ws_log_init("test_dfilter_group", NULL);
+
+    g_test_init(&argc, &argv, NULL);
+
+    if (!epan_test_fixture_init(argv[0], NULL)) {
+        return 1;
+    }
+    session = test_epan_new();
+
+    g_test_add_func("/dfilter_group/apply", test_dfilter_group_apply);
+    g_test_add_func("/dfilter_group/color_filters", test_color_filters_group);
+
+    ret = g_test_run();
+
+    epan_free(session);
+    epan_test_fixture_cleanup();
+
+    return ret;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
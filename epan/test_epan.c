@@ -9,6 +9,10 @@
 #include "config.h"
 
 #include "strutil.h"
+#include "conversation_table.h"
+#include "in_cksum.h"
+#include "tree_slab.h"
+#include "tls_keylog.h"
 #include <wsutil/utf8_entities.h>
 
 /*
@@ -74,6 +78,530 @@ void test_label_escape_control(void)
     g_assert_cmpuint(pos, ==, strlen(dst));
 }
 
+/*
+ * Packets for the conversation and endpoint table tests. Some are out of
+ * time order, some don't match the display filter, and some conversations
+ * are first seen from the other end in a later part.
+ */
+typedef struct {
+    int      src;
+    int      dst;
+    guint32  src_port;
+    guint32  dst_port;
+    int      bytes;
+    int      msecs;
+    gboolean ignored;
+} conv_test_packet_t;
+
+static const guint8 conv_test_addrs[][4] = {
+    { 192, 0, 2, 1 },
+    { 192, 0, 2, 2 },
+    { 198, 51, 100, 3 },
+};
+
+static const conv_test_packet_t conv_test_packets[] = {
+    { 0, 1, 1000,   80,   60, 1000, FALSE },
+    { 1, 0,   80, 1000, 1500, 1100, FALSE },
+    { 0, 2, 1001,   53,   70, 1200, TRUE },
+    { 2, 0,   53, 1001,   90,  900, FALSE },
+    { 1, 2, 2000,  443,  100, 2000, FALSE },
+    { 0, 1, 1000,   80,   40, 2500, TRUE },
+    { 2, 1,  443, 2000,  200, 3000, FALSE },
+    { 0, 1, 1000,   80,   60,  500, FALSE },
+    { 2, 0,   53, 1002,   10, 4000, TRUE },
+    { 1, 0,   80, 1000,   52, 4100, FALSE },
+};
+
+static void
+conv_test_add_packet(conv_hash_t *conv_hash, conv_hash_t *endpoint_hash, const conv_test_packet_t *packet)
+{
+    address src, dst;
+    nstime_t ts = NSTIME_INIT_SECS_MSECS(packet->msecs / 1000, packet->msecs % 1000);
+    nstime_t abs_ts = NSTIME_INIT_SECS_MSECS(1000 + packet->msecs / 1000, packet->msecs % 1000);
+
+    set_address(&src, AT_IPv4, 4, conv_test_addrs[packet->src]);
+    set_address(&dst, AT_IPv4, 4, conv_test_addrs[packet->dst]);
+
+    /* The conversation and endpoint tap packet callbacks do this. */
+    conv_hash->flags = packet->ignored ? TL_DISPLAY_FILTER_IGNORED : 0;
+    add_conversation_table_data(conv_hash, &src, &dst, packet->src_port, packet->dst_port,
+            1, packet->bytes, &ts, &abs_ts, NULL, CONVERSATION_TCP);
+
+    endpoint_hash->flags = conv_hash->flags;
+    add_endpoint_table_data(endpoint_hash, &src, packet->src_port, TRUE, 1, packet->bytes, NULL, ENDPOINT_TCP);
+    add_endpoint_table_data(endpoint_hash, &dst, packet->dst_port, FALSE, 1, packet->bytes, NULL, ENDPOINT_TCP);
+}
+
+/*
+ * Tapping the packets in parts and merging each part must give the same
+ * tables as tapping them all at once.
+ */
+void test_conversation_table_merge(void)
+{
+    conv_hash_t conv_whole = { 0 }, endpoint_whole = { 0 };
+
+    for (size_t i = 0; i < G_N_ELEMENTS(conv_test_packets); i++) {
+        conv_test_add_packet(&conv_whole, &endpoint_whole, &conv_test_packets[i]);
+    }
+
+    for (size_t part_len = 1; part_len <= G_N_ELEMENTS(conv_test_packets); part_len++) {
+        conv_hash_t conv_merged = { 0 }, endpoint_merged = { 0 };
+        conv_hash_t *conv_part = NULL, *endpoint_part = NULL;
+
+        for (size_t i = 0; i < G_N_ELEMENTS(conv_test_packets); i++) {
+            if (i % part_len == 0) {
+                conv_part = (conv_hash_t *)split_conversation_table_data(&conv_merged);
+                endpoint_part = (conv_hash_t *)split_endpoint_table_data(&endpoint_merged);
+            }
+            conv_test_add_packet(conv_part, endpoint_part, &conv_test_packets[i]);
+            if ((i + 1) % part_len == 0 || i + 1 == G_N_ELEMENTS(conv_test_packets)) {
+                merge_conversation_table_data(&conv_merged, conv_part);
+                merge_endpoint_table_data(&endpoint_merged, endpoint_part);
+            }
+        }
+
+        g_assert_cmpuint(conv_merged.conv_array->len, ==, conv_whole.conv_array->len);
+        for (guint i = 0; i < conv_whole.conv_array->len; i++) {
+            const conv_item_t *whole = &g_array_index(conv_whole.conv_array, conv_item_t, i);
+            const conv_item_t *merged = &g_array_index(conv_merged.conv_array, conv_item_t, i);
+
+            g_assert_true(addresses_equal(&merged->src_address, &whole->src_address));
+            g_assert_true(addresses_equal(&merged->dst_address, &whole->dst_address));
+            g_assert_cmpuint(merged->src_port, ==, whole->src_port);
+            g_assert_cmpuint(merged->dst_port, ==, whole->dst_port);
+            g_assert_cmpuint(merged->rx_frames, ==, whole->rx_frames);
+            g_assert_cmpuint(merged->tx_frames, ==, whole->tx_frames);
+            g_assert_cmpuint(merged->rx_bytes, ==, whole->rx_bytes);
+            g_assert_cmpuint(merged->tx_bytes, ==, whole->tx_bytes);
+            g_assert_cmpuint(merged->rx_frames_total, ==, whole->rx_frames_total);
+            g_assert_cmpuint(merged->tx_frames_total, ==, whole->tx_frames_total);
+            g_assert_cmpuint(merged->rx_bytes_total, ==, whole->rx_bytes_total);
+            g_assert_cmpuint(merged->tx_bytes_total, ==, whole->tx_bytes_total);
+            g_assert_cmpint(nstime_cmp(&merged->start_time, &whole->start_time), ==, 0);
+            g_assert_cmpint(nstime_cmp(&merged->stop_time, &whole->stop_time), ==, 0);
+            g_assert_cmpint(nstime_cmp(&merged->start_abs_time, &whole->start_abs_time), ==, 0);
+            g_assert_cmpint(merged->filtered, ==, whole->filtered);
+        }
+
+        g_assert_cmpuint(endpoint_merged.conv_array->len, ==, endpoint_whole.conv_array->len);
+        for (guint i = 0; i < endpoint_whole.conv_array->len; i++) {
+            const endpoint_item_t *whole = &g_array_index(endpoint_whole.conv_array, endpoint_item_t, i);
+            const endpoint_item_t *merged = &g_array_index(endpoint_merged.conv_array, endpoint_item_t, i);
+
+            g_assert_true(addresses_equal(&merged->myaddress, &whole->myaddress));
+            g_assert_cmpuint(merged->port, ==, whole->port);
+            g_assert_cmpuint(merged->rx_frames, ==, whole->rx_frames);
+            g_assert_cmpuint(merged->tx_frames, ==, whole->tx_frames);
+            g_assert_cmpuint(merged->rx_bytes, ==, whole->rx_bytes);
+            g_assert_cmpuint(merged->tx_bytes, ==, whole->tx_bytes);
+            g_assert_cmpuint(merged->rx_frames_total, ==, whole->rx_frames_total);
+            g_assert_cmpuint(merged->tx_frames_total, ==, whole->tx_frames_total);
+            g_assert_cmpuint(merged->rx_bytes_total, ==, whole->rx_bytes_total);
+            g_assert_cmpuint(merged->tx_bytes_total, ==, whole->tx_bytes_total);
+            g_assert_cmpint(merged->filtered, ==, whole->filtered);
+        }
+
+        reset_conversation_table_data(&conv_merged);
+        reset_endpoint_table_data(&endpoint_merged);
+    }
+
+    reset_conversation_table_data(&conv_whole);
+    reset_endpoint_table_data(&endpoint_whole);
+}
+
+/*
+ * The Internet checksum computed the obvious way, a 16-bit word at a
+ * time, in host byte order like in_cksum().
+ */
+static guint16
+in_cksum_reference(const guint8 *data, int len)
+{
+    guint32 sum = 0;
+    int i;
+
+    for (i = 0; i + 1 < len; i += 2)
+        sum += (data[i] << 8) | data[i + 1];
+    if (i < len)
+        sum += data[i] << 8;
+    while (sum > 0xffff)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return g_htons(~sum & 0xffff);
+}
+
+void test_in_cksum(void)
+{
+    /* RFC 1071 section 3 */
+    static const guint8 rfc1071[] = { 0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7 };
+    /* An IPv4 header, with and without its checksum */
+    static const guint8 ipv4_hdr[] = {
+        0x45, 0x00, 0x00, 0x73, 0x00, 0x00, 0x40, 0x00, 0x40, 0x11,
+        0x00, 0x00, 0xc0, 0xa8, 0x00, 0x01, 0xc0, 0xa8, 0x00, 0xc7
+    };
+    static const guint8 ipv4_hdr_cksum[] = {
+        0x45, 0x00, 0x00, 0x73, 0x00, 0x00, 0x40, 0x00, 0x40, 0x11,
+        0xb8, 0x61, 0xc0, 0xa8, 0x00, 0x01, 0xc0, 0xa8, 0x00, 0xc7
+    };
+    guint8 buf[300];
+    vec_t vec[3];
+    guint32 seed = 1;
+
+    g_assert_cmpuint(ip_checksum(rfc1071, sizeof(rfc1071)), ==, g_htons(0x220d));
+    g_assert_cmpuint(ip_checksum(ipv4_hdr, sizeof(ipv4_hdr)), ==, g_htons(0xb861));
+    g_assert_cmpuint(ip_checksum(ipv4_hdr_cksum, sizeof(ipv4_hdr_cksum)), ==, 0);
+    g_assert_cmpuint(ip_checksum(buf, 0), ==, 0xffff);
+
+    /* Bytes of 0xff make the wide sums carry as much as they can */
+    memset(buf, 0xff, sizeof(buf));
+    for (int len = 0; len <= 67; len++) {
+        g_assert_cmpuint(ip_checksum(buf, len), ==, in_cksum_reference(buf, len));
+    }
+
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        seed = seed * 1103515245 + 12345;
+        buf[i] = (guint8)(seed >> 16);
+    }
+
+    /* Every length, odd or even, starting at even and odd addresses */
+    for (int start = 0; start < 4; start++) {
+        for (int len = 0; len <= 130; len++) {
+            g_assert_cmpuint(ip_checksum(buf + start, len), ==, in_cksum_reference(buf + start, len));
+        }
+    }
+
+    /* The same data split into vecs at every pair of points */
+    for (int len = 0; len <= 80; len += 3) {
+        guint16 expected = in_cksum_reference(buf + 1, len);
+
+        for (int split1 = 0; split1 <= len; split1++) {
+            for (int split2 = split1; split2 <= len; split2++) {
+                SET_CKSUM_VEC_PTR(vec[0], buf + 1, split1);
+                SET_CKSUM_VEC_PTR(vec[1], buf + 1 + split1, split2 - split1);
+                SET_CKSUM_VEC_PTR(vec[2], buf + 1 + split2, len - split2);
+                g_assert_cmpint(in_cksum(vec, 3), ==, expected);
+            }
+        }
+    }
+
+    /* A long buffer, as for a TCP segment */
+    SET_CKSUM_VEC_PTR(vec[0], buf + 3, 12);
+    SET_CKSUM_VEC_PTR(vec[1], buf + 15, sizeof(buf) - 15);
+    g_assert_cmpint(in_cksum(vec, 2), ==, in_cksum_reference(buf + 3, sizeof(buf) - 3));
+}
+
+static guint
+tree_slab_count_chunks(const tree_slab_t *slab)
+{
+    guint count = 0;
+
+    for (const tree_slab_chunk_t *chunk = slab->first; chunk != NULL; chunk = chunk->next)
+        count++;
+    return count;
+}
+
+/*
+ * Allocations from a tree slab are 8-byte aligned and don't overlap,
+ * and resetting the slab hands out its first chunk again.
+ */
+void test_tree_slab_alloc(void)
+{
+    enum { NUM_ALLOCS = 50000 };
+    tree_slab_t *slab = tree_slab_new();
+    guint8 **ptrs = g_new(guint8 *, NUM_ALLOCS);
+    guint8 *large;
+
+    for (guint i = 0; i < NUM_ALLOCS; i++) {
+        size_t size = 1 + i % 200;
+
+        ptrs[i] = (guint8 *)tree_slab_alloc(slab, size);
+        g_assert_cmpuint((guintptr)ptrs[i] % 8, ==, 0);
+        memset(ptrs[i], i & 0xff, size);
+    }
+    g_assert_cmpuint((guintptr)ptrs[0] % TREE_SLAB_ALIGN, ==, 0);
+    for (guint i = 0; i < NUM_ALLOCS; i++) {
+        size_t size = 1 + i % 200;
+
+        for (size_t j = 0; j < size; j++)
+            g_assert_cmpuint(ptrs[i][j], ==, i & 0xff);
+    }
+    g_assert_cmpuint(tree_slab_count_chunks(slab), >, TREE_SLAB_KEEP_CHUNKS);
+
+    /* Too big for a chunk */
+    large = (guint8 *)tree_slab_alloc(slab, 3 * TREE_SLAB_CHUNK_SIZE);
+    g_assert_cmpuint((guintptr)large % 8, ==, 0);
+    memset(large, 0x5a, 3 * TREE_SLAB_CHUNK_SIZE);
+    g_assert_nonnull(slab->large);
+
+    /* Only the first chunks are kept */
+    tree_slab_reset(slab);
+    g_assert_null(slab->large);
+    g_assert_cmpuint(tree_slab_count_chunks(slab), ==, TREE_SLAB_KEEP_CHUNKS);
+    g_assert_true(tree_slab_alloc(slab, 24) == ptrs[0]);
+
+    g_free(ptrs);
+    tree_slab_free(slab);
+}
+
+static void
+interesting_fields_check(const interesting_fields_t *fields, const int *hfids, guint count)
+{
+    g_assert_nonnull(fields);
+    g_assert_cmpuint(fields->count, ==, count);
+    for (guint i = 0; i < count; i++) {
+        interesting_slot_t *slot = interesting_fields_lookup(fields, hfids[i]);
+
+        /* Slots are numbered in the order the hfids were added */
+        g_assert_true(slot == &fields->slots[i]);
+        g_assert_cmpint(slot->hfid, ==, hfids[i]);
+    }
+}
+
+/*
+ * The slots of the interesting fields of a tree are numbered densely
+ * for each set of hfids the tree is primed with, and the field_infos
+ * go in them in the order they're added.
+ */
+void test_interesting_fields(void)
+{
+    /* 5, 21, 37 and 69 all go in the same bucket at first */
+    static const int primed[] = { 5, 21, 300000, 37, 0, 69 };
+    static const int reprimed[] = { 300000, 7 };
+    tree_slab_t *slab = tree_slab_new();
+    interesting_fields_t *fields = NULL;
+    interesting_slot_t *slot;
+    int many[200];
+
+    g_assert_null(interesting_fields_lookup(NULL, 5));
+
+    for (guint i = 0; i < G_N_ELEMENTS(primed); i++) {
+        slot = interesting_fields_get(&fields, slab, primed[i]);
+        g_assert_cmpuint(slot->finfos.len, ==, 0);
+    }
+    interesting_fields_check(fields, primed, G_N_ELEMENTS(primed));
+    g_assert_null(interesting_fields_lookup(fields, 53));
+    g_assert_null(interesting_fields_lookup(fields, 1));
+
+    /* Getting a slot again doesn't add one */
+    slot = interesting_fields_get(&fields, slab, 37);
+    g_assert_true(slot == &fields->slots[3]);
+    interesting_fields_check(fields, primed, G_N_ELEMENTS(primed));
+
+    /* Field infos, including more than fit in a chunk for one field */
+    for (guint i = 0; i < 20000; i++) {
+        slot = interesting_fields_get(&fields, slab, primed[i % 3]);
+        interesting_slot_add(slot, slab, GUINT_TO_POINTER(i + 1));
+    }
+    for (guint j = 0; j < 3; j++) {
+        slot = interesting_fields_lookup(fields, primed[j]);
+        g_assert_cmpuint(slot->finfos.len, ==, (20000 - j + 2) / 3);
+        for (guint i = 0; i < slot->finfos.len; i++)
+            g_assert_cmpuint(GPOINTER_TO_UINT(g_ptr_array_index(&slot->finfos, i)), ==, 3 * i + j + 1);
+    }
+    g_assert_cmpuint(interesting_fields_lookup(fields, 37)->finfos.len, ==, 0);
+
+    /* Lots of fields; the slots and the hash table grow */
+    for (guint i = 0; i < G_N_ELEMENTS(many); i++)
+        many[i] = (i < G_N_ELEMENTS(primed)) ? primed[i] : (int)(i * 16 + 5);
+    for (guint i = G_N_ELEMENTS(primed); i < G_N_ELEMENTS(many); i++)
+        interesting_fields_get(&fields, slab, many[i]);
+    interesting_fields_check(fields, many, G_N_ELEMENTS(many));
+    g_assert_cmpuint(interesting_fields_lookup(fields, 21)->finfos.len, ==, 6667);
+    g_assert_cmpuint(GPOINTER_TO_UINT(g_ptr_array_index(&interesting_fields_lookup(fields, 21)->finfos, 6666)), ==, 20000);
+
+    /* Resetting gives the next packet's fields the first slots again */
+    tree_slab_reset(slab);
+    fields = NULL;
+    for (guint i = 0; i < G_N_ELEMENTS(reprimed); i++)
+        interesting_fields_get(&fields, slab, reprimed[i]);
+    interesting_fields_check(fields, reprimed, G_N_ELEMENTS(reprimed));
+    g_assert_null(interesting_fields_lookup(fields, 5));
+    g_assert_cmpuint(interesting_fields_lookup(fields, 300000)->finfos.len, ==, 0);
+
+    tree_slab_free(slab);
+}
+
+#define LABEL_COUNT_THREADS 8
+#define LABEL_COUNT_PACKETS 10000
+
+/* Each thread stands in for a tree that's reset once per packet. */
+static gpointer
+label_counts_thread(gpointer data)
+{
+    guint id = GPOINTER_TO_UINT(data);
+
+    for (guint i = 0; i < LABEL_COUNT_PACKETS; i++)
+        tree_label_counts_add(id + 1, i % 2);
+    return NULL;
+}
+
+void test_tree_label_counts(void)
+{
+    GThread *threads[LABEL_COUNT_THREADS];
+    guint64 deferred_before, rendered_before, deferred, rendered;
+    guint64 expected = 0;
+
+    tree_label_counts_get(&deferred_before, &rendered_before);
+
+    /* Trees with nothing deferred don't change anything */
+    tree_label_counts_add(0, 0);
+    tree_label_counts_get(&deferred, NULL);
+    g_assert_cmpuint(deferred, ==, deferred_before);
+
+    tree_label_counts_add(3, 1);
+    tree_label_counts_get(&deferred, &rendered);
+    g_assert_cmpuint(deferred - deferred_before, ==, 3);
+    g_assert_cmpuint(rendered - rendered_before, ==, 1);
+
+    for (guint i = 0; i < LABEL_COUNT_THREADS; i++) {
+        threads[i] = g_thread_new("label counts", label_counts_thread, GUINT_TO_POINTER(i));
+        expected += (guint64)(i + 1) * LABEL_COUNT_PACKETS;
+    }
+    for (guint i = 0; i < LABEL_COUNT_THREADS; i++)
+        g_thread_join(threads[i]);
+
+    /* No updates are lost when trees on several threads add their counts */
+    tree_label_counts_get(&deferred, &rendered);
+    g_assert_cmpuint(deferred - deferred_before, ==, 3 + expected);
+    g_assert_cmpuint(rendered - rendered_before, ==, 1 + LABEL_COUNT_THREADS * LABEL_COUNT_PACKETS / 2);
+    g_assert_cmpuint(rendered, <=, deferred);
+}
+
+#define KEYLOG_RANDOM  "0123456789abcdef0123456789ABCDEF0123456789abcdef0123456789abcdef"
+#define KEYLOG_MASTER  "00112233445566778899aabbccddeeff00112233445566778899aabbccddeeff" \
+                       "00112233445566778899aabbccddeeff"
+
+typedef struct {
+    const char         *line;
+    tls_keylog_label_t  label;
+    guint               key_len;
+    guint               secret_len;
+} keylog_test_line_t;
+
+static const keylog_test_line_t keylog_valid_lines[] = {
+    { "PMS_CLIENT_RANDOM " KEYLOG_RANDOM " 0303aabbccdd",          TLS_KEYLOG_PMS, 32, 6 },
+    { "RSA Session-ID:0a0b0c Master-Key:" KEYLOG_MASTER,           TLS_KEYLOG_SESSION, 3, 48 },
+    /* Only the master secret is used, whatever follows it */
+    { "RSA Session-ID:0a0b0c Master-Key:" KEYLOG_MASTER "ff ignored", TLS_KEYLOG_SESSION, 3, 48 },
+    { "RSA 0102030405060708 0303aabbccdd",                         TLS_KEYLOG_PRE_MASTER, 8, 6 },
+    { "CLIENT_RANDOM " KEYLOG_RANDOM " " KEYLOG_MASTER,            TLS_KEYLOG_CRANDOM, 32, 48 },
+    { "CLIENT_EARLY_TRAFFIC_SECRET " KEYLOG_RANDOM " 0a0b",        TLS_KEYLOG_CLIENT_EARLY, 32, 2 },
+    { "CLIENT_HANDSHAKE_TRAFFIC_SECRET " KEYLOG_RANDOM " 0a0b0c",  TLS_KEYLOG_CLIENT_HANDSHAKE, 32, 3 },
+    { "SERVER_HANDSHAKE_TRAFFIC_SECRET " KEYLOG_RANDOM " 0a0b0c",  TLS_KEYLOG_SERVER_HANDSHAKE, 32, 3 },
+    { "CLIENT_TRAFFIC_SECRET_0 " KEYLOG_RANDOM " 0a0b0c0d",        TLS_KEYLOG_CLIENT_APPDATA, 32, 4 },
+    { "SERVER_TRAFFIC_SECRET_0 " KEYLOG_RANDOM " 0a0b0c0d",        TLS_KEYLOG_SERVER_APPDATA, 32, 4 },
+    { "EARLY_EXPORTER_SECRET " KEYLOG_RANDOM " 0a",                TLS_KEYLOG_EARLY_EXPORTER, 32, 1 },
+    /* A secret of variable length stops at the first non-hex digit */
+    { "EXPORTER_SECRET " KEYLOG_RANDOM " 0a0b # comment",          TLS_KEYLOG_EXPORTER, 32, 2 },
+};
+
+static const char *keylog_invalid_lines[] = {
+    "",
+    "# CLIENT_RANDOM " KEYLOG_RANDOM " " KEYLOG_MASTER,
+    "CLIENT_RANDOM",
+    "CLIENT_RANDOM " KEYLOG_RANDOM,
+    "CLIENT_RANDOM " KEYLOG_RANDOM " ",
+    /* Wrong client random and master secret lengths */
+    "CLIENT_RANDOM 0123456789abcdef " KEYLOG_MASTER,
+    "CLIENT_RANDOM " KEYLOG_RANDOM "00 " KEYLOG_MASTER,
+    "CLIENT_RANDOM " KEYLOG_RANDOM " 00112233",
+    "RSA 01020304050607 0303aabbccdd",
+    /* Odd number of digits */
+    "RSA Session-ID:0a0b0 Master-Key:" KEYLOG_MASTER,
+    "CLIENT_TRAFFIC_SECRET_0 " KEYLOG_RANDOM " 0",
+    /* Missing or wrong separator */
+    "RSA Session-ID:0a0b0c " KEYLOG_MASTER,
+    "CLIENT_HANDSHAKE_TRAFFIC_SECRET " KEYLOG_RANDOM "0a0b0c",
+    "CLIENT_HANDSHAKE_TRAFFIC_SECRET " KEYLOG_RANDOM ":0a0b0c",
+    /* Not hex */
+    "SERVER_TRAFFIC_SECRET_0 " KEYLOG_RANDOM " xyz",
+    "SERVER_TRAFFIC_SECRET_0 g123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef 0a0b",
+    "client_random " KEYLOG_RANDOM " " KEYLOG_MASTER,
+    " CLIENT_RANDOM " KEYLOG_RANDOM " " KEYLOG_MASTER,
+    "UNKNOWN_SECRET " KEYLOG_RANDOM " 0a0b",
+};
+
+void test_tls_keylog_parse_line(void)
+{
+    tls_keylog_line_t parsed;
+    guint8 key[32];
+    gboolean seen[TLS_KEYLOG_NUM_LABELS] = { FALSE };
+
+    for (size_t i = 0; i < G_N_ELEMENTS(keylog_valid_lines); i++) {
+        const keylog_test_line_t *t = &keylog_valid_lines[i];
+
+        g_test_message("%s", t->line);
+        g_assert_true(tls_keylog_parse_line(t->line, strlen(t->line), &parsed));
+        g_assert_cmpint(parsed.label, ==, t->label);
+        g_assert_cmpuint(parsed.key_len, ==, t->key_len);
+        g_assert_cmpuint(parsed.secret_len, ==, t->secret_len);
+        g_assert_true(g_str_has_prefix(t->line, tls_keylog_label_name(parsed.label)));
+        g_assert_true(parsed.key > t->line && parsed.secret > parsed.key);
+        seen[parsed.label] = TRUE;
+
+        /* Nothing past the given length is looked at */
+        g_assert_false(tls_keylog_parse_line(t->line, strlen(tls_keylog_label_name(t->label)), &parsed));
+    }
+    for (int label = 0; label < TLS_KEYLOG_NUM_LABELS; label++)
+        g_assert_true(seen[label]);
+
+    for (size_t i = 0; i < G_N_ELEMENTS(keylog_invalid_lines); i++) {
+        g_test_message("%s", keylog_invalid_lines[i]);
+        g_assert_false(tls_keylog_parse_line(keylog_invalid_lines[i], strlen(keylog_invalid_lines[i]), &parsed));
+    }
+
+    g_assert_true(tls_keylog_parse_line(keylog_valid_lines[4].line, strlen(keylog_valid_lines[4].line), &parsed));
+    tls_keylog_hex_decode(parsed.key, parsed.key_len, key);
+    g_assert_cmpmem(key, 8, "\x01\x23\x45\x67\x89\xab\xcd\xef", 8);
+    g_assert_cmpmem(key + 16, 8, "\x01\x23\x45\x67\x89\xab\xcd\xef", 8);
+    g_assert_cmpmem(key + 8, 8, "\x01\x23\x45\x67\x89\xAB\xCD\xEF", 8);
+}
+
+void test_tls_keylog_next_line(void)
+{
+    static const char data[] =
+        "# comment\n"
+        "CLIENT_RANDOM " KEYLOG_RANDOM " " KEYLOG_MASTER "\r\n"
+        "\n"
+        "\r\n"
+        "garbage\r\r\n"
+        "EXPORTER_SECRET " KEYLOG_RANDOM " 0a0b";
+    static const struct {
+        const char *line;
+        gboolean    valid;
+    } expected[] = {
+        { "# comment", FALSE },
+        { "CLIENT_RANDOM " KEYLOG_RANDOM " " KEYLOG_MASTER, TRUE },
+        { "", FALSE },
+        { "", FALSE },
+        { "garbage\r", FALSE },
+        /* The last line doesn't need a line terminator */
+        { "EXPORTER_SECRET " KEYLOG_RANDOM " 0a0b", TRUE },
+    };
+    const char *pos = data;
+    const char *end = data + strlen(data);
+    const char *line;
+    gsize linelen;
+    size_t n = 0;
+    tls_keylog_line_t parsed;
+
+    while ((line = tls_keylog_next_line(&pos, end, &linelen)) != NULL) {
+        g_assert_cmpuint(n, <, G_N_ELEMENTS(expected));
+        g_assert_cmpuint(linelen, ==, strlen(expected[n].line));
+        g_assert_cmpmem(line, linelen, expected[n].line, linelen);
+        g_assert_cmpint(tls_keylog_parse_line(line, linelen, &parsed), ==, expected[n].valid);
+        n++;
+    }
+    g_assert_cmpuint(n, ==, G_N_ELEMENTS(expected));
+    g_assert_true(pos == end);
+
+    /* A final LF doesn't add an empty line, and there are no lines in nothing */
+    pos = "# comment\n";
+    end = pos + strlen(pos);
+    g_assert_nonnull(tls_keylog_next_line(&pos, end, &linelen));
+    g_assert_null(tls_keylog_next_line(&pos, end, &linelen));
+    pos = end = "";
+    g_assert_null(tls_keylog_next_line(&pos, end, &linelen));
+}
+
 int main(int argc, char **argv)
 {
     int ret;
@@ -85,6 +613,13 @@ int main(int argc, char **argv)
     g_test_add_func("/label/strcat", test_label_strcat);
     g_test_add_func("/label/escape_whitespace", test_label_strcat_escape_whitespace);
     g_test_add_func("/label/escape_control", test_label_escape_control);
+    g_test_add_func("/conversation_table/merge", test_conversation_table_merge);
+    g_test_add_func("/in_cksum/in_cksum", test_in_cksum);
+    g_test_add_func("/tree_slab/alloc", test_tree_slab_alloc);
+    g_test_add_func("/tree_slab/interesting_fields", test_interesting_fields);
+    g_test_add_func("/tree_slab/label_counts", test_tree_label_counts);
+    g_test_add_func("/tls_keylog/parse_line", test_tls_keylog_parse_line);
+    g_test_add_func("/tls_keylog/next_line", test_tls_keylog_next_line);
 
     ret = g_test_run();
 
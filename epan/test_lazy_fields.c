@@ -0,0 +1,297 @@
+/* test_lazy_fields.c
+ * Unit tests for deferred registration of header fields
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/epan.h>
+#include <epan/epan_dissect.h>
+#include <epan/packet.h>
+#include <epan/dfilter/dfilter.h>
+#include <epan/epan_test_fixture.h>
+#include <wiretap/wtap.h>
+#include <wsutil/wslog.h>
+
+#define LAZYHANDLE_UDP_PORT 40000
+
+/*
+ * "lazytest" and "lazytest.sub" both defer their fields, so that a
+ * "lazytest.sub" field has to be looked up through both of them.
+ * "lazyhandle" is only ever reached through its dissector handle.
+ */
+static int proto_lazytest;
+static int proto_lazytest_sub;
+static int proto_lazyhandle;
+
+static int hf_lazytest_value;
+static int hf_lazytest_text;
+static int hf_lazytest_sub_value;
+static int hf_lazyhandle_value;
+static int hf_lazyhandle_flags;
+
+static gboolean lazy_fields;
+static epan_t *session;
+
+static int
+dissect_lazyhandle(tvbuff_t *tvb, packet_info *pinfo _U_, proto_tree *tree, void *data _U_)
+{
+    proto_tree_add_item(tree, proto_lazyhandle, tvb, 0, -1, ENC_NA);
+    proto_tree_add_item(tree, hf_lazyhandle_value, tvb, 0, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item(tree, hf_lazyhandle_flags, tvb, 1, 2, ENC_BIG_ENDIAN);
+
+    return tvb_captured_length(tvb);
+}
+
+static void
+register_lazy_protocols(void)
+{
+    static hf_register_info hf_lazytest[] = {
+        { &hf_lazytest_value,
+          { "Value", "lazytest.value",
+            FT_UINT8, BASE_DEC, NULL, 0x0,
+            NULL, HFILL }
+        },
+        { &hf_lazytest_text,
+          { "Text", "lazytest.text",
+            FT_STRING, BASE_NONE, NULL, 0x0,
+            NULL, HFILL }
+        },
+    };
+    static hf_register_info hf_lazytest_sub[] = {
+        { &hf_lazytest_sub_value,
+          { "Value", "lazytest.sub.value",
+            FT_UINT16, BASE_HEX, NULL, 0x0,
+            NULL, HFILL }
+        },
+    };
+    static hf_register_info hf_lazyhandle[] = {
+        { &hf_lazyhandle_value,
+          { "Value", "lazyhandle.value",
+            FT_UINT8, BASE_DEC, NULL, 0x0,
+            NULL, HFILL }
+        },
+        { &hf_lazyhandle_flags,
+          { "Flags", "lazyhandle.flags",
+            FT_UINT16, BASE_HEX, NULL, 0x0,
+            NULL, HFILL }
+        },
+    };
+    dissector_handle_t lazyhandle_handle;
+
+    proto_lazytest = proto_register_protocol("Lazy Test", "LAZYTEST", "lazytest");
+    proto_register_field_array_lazy(proto_lazytest, hf_lazytest, array_length(hf_lazytest));
+
+    proto_lazytest_sub = proto_register_protocol("Lazy Test Sub", "LAZYTEST-SUB", "lazytest.sub");
+    proto_register_field_array_lazy(proto_lazytest_sub, hf_lazytest_sub, array_length(hf_lazytest_sub));
+
+    proto_lazyhandle = proto_register_protocol("Lazy Handle", "LAZYHANDLE", "lazyhandle");
+    proto_register_field_array_lazy(proto_lazyhandle, hf_lazyhandle, array_length(hf_lazyhandle));
+    lazyhandle_handle = register_dissector("lazyhandle", dissect_lazyhandle, proto_lazyhandle);
+    dissector_add_uint("udp.port", LAZYHANDLE_UDP_PORT, lazyhandle_handle);
+}
+
+static const nstime_t *
+test_get_frame_ts(struct packet_provider_data *prov _U_, guint32 frame_num _U_)
+{
+    static nstime_t empty;
+
+    return &empty;
+}
+
+static epan_t *
+test_epan_new(void)
+{
+    static const struct packet_provider_funcs funcs = {
+        test_get_frame_ts,
+        NULL,
+        NULL,
+        NULL
+    };
+
+    return epan_new(NULL, &funcs);
+}
+
+/* Dissect a raw IPv4 UDP datagram to and from the "lazyhandle" port. */
+static void
+dissect_packet(epan_dissect_t *edt, guint32 num, guint8 *buf, frame_data *fd)
+{
+    static const guint8 payload[] = { 0x2a, 0x12, 0x34 };
+    guint8 *udp = buf + 20;
+    guint len = 20 + 8 + sizeof(payload);
+    wtap_rec rec;
+
+    memset(buf, 0, 28);
+    buf[0] = 0x45;
+    buf[3] = (guint8)len;
+    buf[5] = 1;
+    buf[8] = 64;
+    buf[9] = 17;
+    buf[12] = 10;
+    buf[15] = 1;
+    buf[16] = 10;
+    buf[19] = 2;
+    udp[0] = udp[2] = LAZYHANDLE_UDP_PORT >> 8;
+    udp[1] = udp[3] = LAZYHANDLE_UDP_PORT & 0xff;
+    udp[5] = 8 + sizeof(payload);
+    memcpy(udp + 8, payload, sizeof(payload));
+
+    memset(&rec, 0, sizeof(rec));
+    rec.rec_type = REC_TYPE_PACKET;
+    rec.presence_flags = WTAP_HAS_TS | WTAP_HAS_CAP_LEN;
+    rec.rec_header.packet_header.caplen = len;
+    rec.rec_header.packet_header.len = len;
+    rec.rec_header.packet_header.pkt_encap = WTAP_ENCAP_RAW_IP;
+
+    frame_data_init(fd, num, &rec, 0, 0);
+    epan_dissect_run(edt, WTAP_FILE_TYPE_SUBTYPE_UNKNOWN, &rec,
+            tvb_new_real_data(buf, len, len), fd, NULL);
+}
+
+/*
+ * Until something asks for them, deferred fields haven't been given an
+ * id, unless WIRESHARK_NO_LAZY_FIELDS turned deferral off. This has to
+ * run before the other tests.
+ */
+static void
+test_lazy_fields_deferred(void)
+{
+    g_assert_nonnull(proto_registrar_get_byname("lazytest"));
+    g_assert_nonnull(proto_registrar_get_byname("lazyhandle"));
+
+    if (lazy_fields) {
+        g_assert_cmpint(hf_lazytest_value, ==, 0);
+        g_assert_cmpint(hf_lazytest_text, ==, 0);
+        g_assert_cmpint(hf_lazytest_sub_value, ==, 0);
+        g_assert_cmpint(hf_lazyhandle_value, ==, 0);
+        g_assert_cmpint(hf_lazyhandle_flags, ==, 0);
+    } else {
+        g_assert_cmpint(hf_lazytest_value, >, 0);
+        g_assert_cmpint(hf_lazytest_text, >, 0);
+        g_assert_cmpint(hf_lazytest_sub_value, >, 0);
+        g_assert_cmpint(hf_lazyhandle_value, >, 0);
+        g_assert_cmpint(hf_lazyhandle_flags, >, 0);
+    }
+}
+
+/* Looking up a field by name registers its protocol's fields. */
+static void
+test_lazy_fields_byname(void)
+{
+    header_field_info *hfinfo;
+
+    /* Both "lazytest" and "lazytest.sub" are still deferred here */
+    hfinfo = proto_registrar_get_byname("lazytest.sub.value");
+    g_assert_nonnull(hfinfo);
+    g_assert_cmpint(hfinfo->id, ==, hf_lazytest_sub_value);
+    g_assert_cmpint(hfinfo->parent, ==, proto_lazytest_sub);
+
+    hfinfo = proto_registrar_get_byname("lazytest.value");
+    g_assert_nonnull(hfinfo);
+    g_assert_cmpint(hfinfo->id, ==, hf_lazytest_value);
+    g_assert_cmpint(hfinfo->parent, ==, proto_lazytest);
+    g_assert_cmpstr(hfinfo->abbrev, ==, "lazytest.value");
+
+    /* The rest of the array came with it */
+    g_assert_cmpint(hf_lazytest_text, >, 0);
+    g_assert_cmpstr(proto_registrar_get_abbrev(hf_lazytest_text), ==, "lazytest.text");
+
+    g_assert_null(proto_registrar_get_byname("lazytest.missing"));
+    g_assert_null(proto_registrar_get_byname("lazytest.sub.missing"));
+
+    /* The dissector handle's fields are left alone */
+    if (lazy_fields) {
+        g_assert_cmpint(hf_lazyhandle_value, ==, 0);
+    }
+}
+
+/* Calling a dissector through its handle registers its protocol's fields. */
+static void
+test_lazy_fields_handle(void)
+{
+    epan_dissect_t *edt;
+    GPtrArray *finfos;
+    dfilter_t *df = NULL;
+    df_error_t *df_err = NULL;
+    guint8 buf[64];
+    frame_data fd;
+
+    edt = epan_dissect_new(session, true, true);
+    dissect_packet(edt, 1, buf, &fd);
+
+    g_assert_cmpint(hf_lazyhandle_value, >, 0);
+    g_assert_cmpint(hf_lazyhandle_flags, >, 0);
+
+    finfos = proto_find_first_finfo(edt->tree, hf_lazyhandle_value);
+    g_assert_cmpuint(finfos->len, ==, 1);
+    g_assert_cmpuint(fvalue_get_uinteger(((field_info *)finfos->pdata[0])->value), ==, 0x2a);
+
+    finfos = proto_find_first_finfo(edt->tree, hf_lazyhandle_flags);
+    g_assert_cmpuint(finfos->len, ==, 1);
+    g_assert_cmpuint(fvalue_get_uinteger(((field_info *)finfos->pdata[0])->value), ==, 0x1234);
+
+    epan_dissect_free(edt);
+    frame_data_destroy(&fd);
+
+    /* A filter on the fields works on the next packet */
+    if (!dfilter_compile("lazyhandle.value == 42 && lazyhandle.flags == 0x1234", &df, &df_err)) {
+        g_error("Can't compile filter: %s", df_err->msg);
+    }
+    edt = epan_dissect_new(session, true, false);
+    epan_dissect_prime_with_dfilter(edt, df);
+    dissect_packet(edt, 2, buf, &fd);
+    g_assert_true(dfilter_apply_edt(df, edt));
+
+    epan_dissect_free(edt);
+    frame_data_destroy(&fd);
+    dfilter_free(df);
+}
+
+int main(int argc, char **argv)
+{
+    int ret;
+
+    ws_log_init("test_lazy_fields", NULL);
+
+    g_test_init(&argc, &argv, NULL);
+
+    lazy_fields = g_getenv("WIRESHARK_NO_LAZY_FIELDS") == NULL;
+
+    if (!epan_test_fixture_init(argv[0], register_lazy_protocols)) {
+        return 1;
+    }
+    session = test_epan_new();
+
+    g_test_add_func("/lazy_fields/deferred", test_lazy_fields_deferred);
+    g_test_add_func("/lazy_fields/byname", test_lazy_fields_byname);
+    g_test_add_func("/lazy_fields/handle", test_lazy_fields_handle);
+
+    ret = g_test_run();
+
+    epan_free(session);
+    epan_test_fixture_cleanup();
+
+    return ret;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,707 @@
+/* test_quic.c
+ * Tests and benchmark of QUIC decryption over a generated capture
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/epan.h>
+#include <epan/epan_dissect.h>
+#include <epan/prefs.h>
+#include <epan/dfilter/dfilter.h>
+#include <epan/epan_test_fixture.h>
+#include <wiretap/wtap.h>
+#include <wsutil/file_util.h>
+#include <wsutil/wsgcrypt.h>
+#include <wsutil/wslog.h>
+
+/*
+ * The capture has QUIC v1 connections between 10.0.0.1 and 10.0.0.2:443.
+ * Each one starts with a client Initial (with a ClientHello) and a
+ * server Initial (with a ServerHello), whose keys the dissector derives
+ * itself, followed by 1-RTT packets in both directions, whose secrets
+ * are in a key log file.  Every QUIC_RETRY_EVERY'th connection is
+ * answered with a Retry instead.  A second capture has the same 1-RTT
+ * packets without the key log file, which is what most captures look
+ * like.
+ */
+#define QUIC_CONNECTIONS        16
+#define QUIC_1RTT_PACKETS       64      /* per connection */
+#define QUIC_RETRY_EVERY        4
+#define QUIC_STREAM_DATA_LEN    200
+#define QUIC_CID_LEN            8
+#define QUIC_SERVER_PORT        443
+
+#define QUIC_PERF_CONNECTIONS   256
+#define QUIC_PERF_PASSES        5
+
+#define QUIC_MAX_PACKET         1300
+
+typedef enum {
+    QUIC_TEST_CLIENT_INITIAL,
+    QUIC_TEST_SERVER_INITIAL,
+    QUIC_TEST_RETRY,
+    QUIC_TEST_1RTT,
+} quic_test_packet_type_t;
+
+typedef struct {
+    quic_test_packet_type_t type;
+    guint8     *data;
+    guint       len;
+    frame_data  fd;
+} quic_test_packet_t;
+
+typedef struct {
+    GArray     *packets;        /* quic_test_packet_t */
+    char       *keylog_path;
+} quic_test_capture_t;
+
+typedef struct {
+    gcry_cipher_hd_t    pp;     /* AES-128-GCM packet protection */
+    gcry_cipher_hd_t    hp;     /* AES-128-ECB header protection */
+    guint8              iv[12];
+} quic_test_keys_t;
+
+typedef struct {
+    guint               index;
+    guint8              client_dcid[QUIC_CID_LEN];
+    guint8              client_scid[QUIC_CID_LEN];
+    guint8              server_scid[QUIC_CID_LEN];
+    guint8              client_random[32];
+    guint8              client_secret[32];
+    guint8              server_secret[32];
+} quic_test_conn_t;
+
+static epan_t *session;
+
+static const nstime_t *
+test_get_frame_ts(struct packet_provider_data *prov _U_, guint32 frame_num _U_)
+{
+    static nstime_t empty;
+
+    return &empty;
+}
+
+static epan_t *
+test_epan_new(void)
+{
+    static const struct packet_provider_funcs funcs = {
+        test_get_frame_ts,
+        NULL,
+        NULL,
+        NULL
+    };
+
+    return epan_new(NULL, &funcs);
+}
+
+/* HKDF-Expand-Label from TLS 1.3 with SHA-256 and an empty context */
+static void
+quic_test_expand_label(const guint8 *secret, const char *label, guint8 *out, guint out_len)
+{
+    guint8 info[2 + 1 + 255 + 1];
+    guint label_len = (guint)strlen("tls13 ") + (guint)strlen(label);
+    guint info_len = 0;
+
+    info[info_len++] = (guint8)(out_len >> 8);
+    info[info_len++] = (guint8)out_len;
+    info[info_len++] = (guint8)label_len;
+    memcpy(info + info_len, "tls13 ", 6);
+    memcpy(info + info_len + 6, label, strlen(label));
+    info_len += label_len;
+    info[info_len++] = 0;
+
+    g_assert_cmpint(hkdf_expand(GCRY_MD_SHA256, secret, 32, info, info_len, out, out_len), ==, 0);
+}
+
+static void
+quic_test_keys_init(quic_test_keys_t *keys, const guint8 *secret)
+{
+    guint8 key[16], hp[16];
+
+    quic_test_expand_label(secret, "quic key", key, sizeof(key));
+    quic_test_expand_label(secret, "quic iv", keys->iv, sizeof(keys->iv));
+    quic_test_expand_label(secret, "quic hp", hp, sizeof(hp));
+
+    g_assert_cmpint(gcry_cipher_open(&keys->pp, GCRY_CIPHER_AES128, GCRY_CIPHER_MODE_GCM, 0), ==, 0);
+    g_assert_cmpint(gcry_cipher_setkey(keys->pp, key, sizeof(key)), ==, 0);
+    g_assert_cmpint(gcry_cipher_open(&keys->hp, GCRY_CIPHER_AES128, GCRY_CIPHER_MODE_ECB, 0), ==, 0);
+    g_assert_cmpint(gcry_cipher_setkey(keys->hp, hp, sizeof(hp)), ==, 0);
+}
+
+static void
+quic_test_keys_init_initial(quic_test_keys_t *keys, const guint8 *dcid, gboolean from_server)
+{
+    static const guint8 initial_salt_v1[20] = {
+        0x38, 0x76, 0x2c, 0xf7, 0xf5, 0x59, 0x34, 0xb3, 0x4d, 0x17,
+        0x9a, 0xe6, 0xa4, 0xc8, 0x0c, 0xad, 0xcc, 0xbb, 0x7f, 0x0a
+    };
+    guint8 initial_secret[32], secret[32];
+
+    g_assert_cmpint(hkdf_extract(GCRY_MD_SHA256, initial_salt_v1, sizeof(initial_salt_v1),
+                dcid, QUIC_CID_LEN, initial_secret), ==, 0);
+    quic_test_expand_label(initial_secret, from_server ? "server in" : "client in", secret, sizeof(secret));
+    quic_test_keys_init(keys, secret);
+}
+
+static void
+quic_test_keys_free(quic_test_keys_t *keys)
+{
+    gcry_cipher_close(keys->pp);
+    gcry_cipher_close(keys->hp);
+}
+
+/*
+ * Encrypt the payload that follows the packet number in place, append
+ * the AEAD tag and apply header protection.  Returns the packet length.
+ */
+static guint
+quic_test_protect(quic_test_keys_t *keys, guint8 *packet, guint pn_offset, guint pn_len,
+        guint64 pn, guint payload_len)
+{
+    guint header_len = pn_offset + pn_len;
+    guint8 nonce[12], mask[16];
+
+    memcpy(nonce, keys->iv, sizeof(nonce));
+    for (guint i = 0; i < 8; i++) {
+        nonce[sizeof(nonce) - 1 - i] ^= (guint8)(pn >> (8 * i));
+    }
+    g_assert_cmpint(gcry_cipher_reset(keys->pp), ==, 0);
+    g_assert_cmpint(gcry_cipher_setiv(keys->pp, nonce, sizeof(nonce)), ==, 0);
+    g_assert_cmpint(gcry_cipher_authenticate(keys->pp, packet, header_len), ==, 0);
+    g_assert_cmpint(gcry_cipher_encrypt(keys->pp, packet + header_len, payload_len, NULL, 0), ==, 0);
+    g_assert_cmpint(gcry_cipher_gettag(keys->pp, packet + header_len + payload_len, 16), ==, 0);
+
+    /* The sample starts 4 bytes after the start of the packet number. */
+    g_assert_cmpint(gcry_cipher_encrypt(keys->hp, mask, sizeof(mask), packet + pn_offset + 4, 16), ==, 0);
+    packet[0] ^= mask[0] & ((packet[0] & 0x80) ? 0x0f : 0x1f);
+    for (guint i = 0; i < pn_len; i++) {
+        packet[pn_offset + i] ^= mask[1 + i];
+    }
+    return header_len + payload_len + 16;
+}
+
+static guint
+quic_test_put_varint2(guint8 *p, guint value)
+{
+    g_assert_cmpuint(value, <, 0x4000);
+    p[0] = 0x40 | (guint8)(value >> 8);
+    p[1] = (guint8)value;
+    return 2;
+}
+
+/* A minimal TLS 1.3 ClientHello or ServerHello for TLS_AES_128_GCM_SHA256 */
+static guint
+quic_test_put_hello(guint8 *p, const quic_test_conn_t *conn, gboolean from_server)
+{
+    guint len = 0, body;
+
+    p[len++] = from_server ? 2 : 1;
+    len += 3;
+    body = len;
+    p[len++] = 0x03;
+    p[len++] = 0x03;
+    memcpy(p + len, conn->client_random, 32);
+    if (from_server) {
+        p[len] ^= 0xff;
+    }
+    len += 32;
+    p[len++] = 0;                       /* legacy_session_id */
+    if (!from_server) {
+        p[len++] = 0;
+        p[len++] = 2;
+    }
+    p[len++] = 0x13;                    /* TLS_AES_128_GCM_SHA256 */
+    p[len++] = 0x01;
+    if (!from_server) {
+        p[len++] = 1;
+    }
+    p[len++] = 0;                       /* null compression */
+    if (from_server) {
+        static const guint8 sh_ext[] = { 0x00, 0x06, 0x00, 0x2b, 0x00, 0x02, 0x03, 0x04 };
+        memcpy(p + len, sh_ext, sizeof(sh_ext));
+        len += sizeof(sh_ext);
+    } else {
+        static const guint8 ch_ext[] = { 0x00, 0x07, 0x00, 0x2b, 0x00, 0x03, 0x02, 0x03, 0x04 };
+        memcpy(p + len, ch_ext, sizeof(ch_ext));
+        len += sizeof(ch_ext);
+    }
+    p[1] = 0;
+    p[2] = (guint8)((len - body) >> 8);
+    p[3] = (guint8)(len - body);
+    return len;
+}
+
+static guint
+quic_test_put_long_header(guint8 *p, guint8 first_byte, const guint8 *dcid, const guint8 *scid)
+{
+    guint len = 0;
+
+    p[len++] = first_byte;
+    p[len++] = 0;
+    p[len++] = 0;
+    p[len++] = 0;
+    p[len++] = 1;                       /* QUIC v1 */
+    p[len++] = QUIC_CID_LEN;
+    memcpy(p + len, dcid, QUIC_CID_LEN);
+    len += QUIC_CID_LEN;
+    p[len++] = QUIC_CID_LEN;
+    memcpy(p + len, scid, QUIC_CID_LEN);
+    len += QUIC_CID_LEN;
+    return len;
+}
+
+/* An Initial with a CRYPTO frame, padded to 1200 bytes like a client's */
+static guint
+quic_test_build_initial(guint8 *p, const quic_test_conn_t *conn, gboolean from_server)
+{
+    quic_test_keys_t keys;
+    guint len, length_offset, pn_offset, payload_offset, crypto_len;
+
+    if (from_server) {
+        len = quic_test_put_long_header(p, 0xc3, conn->client_scid, conn->server_scid);
+    } else {
+        len = quic_test_put_long_header(p, 0xc3, conn->client_dcid, conn->client_scid);
+    }
+    p[len++] = 0;                       /* token length */
+    length_offset = len;
+    len += 2;
+    pn_offset = len;
+    memset(p + len, 0, 4);              /* packet number 0 */
+    len += 4;
+
+    payload_offset = len;
+    p[len++] = 0x06;                    /* CRYPTO */
+    p[len++] = 0;                       /* offset */
+    crypto_len = quic_test_put_hello(p + len + 2, conn, from_server);
+    len += quic_test_put_varint2(p + len, crypto_len);
+    len += crypto_len;
+    memset(p + len, 0, 1200 - 16 - len); /* PADDING */
+    len = 1200 - 16;
+    quic_test_put_varint2(p + length_offset, len - pn_offset + 16);
+
+    quic_test_keys_init_initial(&keys, conn->client_dcid, from_server);
+    len = quic_test_protect(&keys, p, pn_offset, 4, 0, len - payload_offset);
+    quic_test_keys_free(&keys);
+    return len;
+}
+
+static guint
+quic_test_build_retry(guint8 *p, const quic_test_conn_t *conn)
+{
+    static const guint8 retry_key_v1[16] = {
+        0xbe, 0x0c, 0x69, 0x0b, 0x9f, 0x66, 0x57, 0x5a,
+        0x1d, 0x76, 0x6b, 0x54, 0xe3, 0x68, 0xc8, 0x4e
+    };
+    static const guint8 retry_nonce_v1[12] = {
+        0x46, 0x15, 0x99, 0xd3, 0x5d, 0x63, 0x2b, 0xf2, 0x23, 0x98, 0x25, 0xbb
+    };
+    guint8 odcid[1 + QUIC_CID_LEN];
+    gcry_cipher_hd_t h;
+    guint len;
+
+    len = quic_test_put_long_header(p, 0xf0, conn->client_scid, conn->server_scid);
+    memcpy(p + len, "retry token", 11);
+    len += 11;
+
+    /* The tag authenticates the pseudo-packet of the original DCID and the Retry */
+    odcid[0] = QUIC_CID_LEN;
+    memcpy(odcid + 1, conn->client_dcid, QUIC_CID_LEN);
+    g_assert_cmpint(gcry_cipher_open(&h, GCRY_CIPHER_AES128, GCRY_CIPHER_MODE_GCM, 0), ==, 0);
+    g_assert_cmpint(gcry_cipher_setkey(h, retry_key_v1, sizeof(retry_key_v1)), ==, 0);
+    g_assert_cmpint(gcry_cipher_setiv(h, retry_nonce_v1, sizeof(retry_nonce_v1)), ==, 0);
+    g_assert_cmpint(gcry_cipher_authenticate(h, odcid, sizeof(odcid)), ==, 0);
+    g_assert_cmpint(gcry_cipher_authenticate(h, p, len), ==, 0);
+    g_assert_cmpint(gcry_cipher_encrypt(h, NULL, 0, NULL, 0), ==, 0);
+    g_assert_cmpint(gcry_cipher_gettag(h, p + len, 16), ==, 0);
+    gcry_cipher_close(h);
+
+    return len + 16;
+}
+
+/* A short header packet with a STREAM frame on stream 0 */
+static guint
+quic_test_build_1rtt(guint8 *p, quic_test_keys_t *keys, const quic_test_conn_t *conn,
+        gboolean from_server, guint64 pn)
+{
+    guint len = 0, pn_offset, payload_offset;
+
+    p[len++] = 0x41;                    /* 2-byte packet number */
+    memcpy(p + len, from_server ? conn->client_scid : conn->server_scid, QUIC_CID_LEN);
+    len += QUIC_CID_LEN;
+    pn_offset = len;
+    p[len++] = (guint8)(pn >> 8);
+    p[len++] = (guint8)pn;
+
+    payload_offset = len;
+    p[len++] = 0x0a;                    /* STREAM with length, without offset */
+    p[len++] = 0;                       /* stream 0 */
+    len += quic_test_put_varint2(p + len, QUIC_STREAM_DATA_LEN);
+    for (guint i = 0; i < QUIC_STREAM_DATA_LEN; i++) {
+        p[len++] = (guint8)(pn + i);
+    }
+
+    return quic_test_protect(keys, p, pn_offset, 2, pn, len - payload_offset);
+}
+
+/* Wrap a QUIC packet in IPv4 and UDP, as a raw IP frame */
+static void
+quic_test_add_packet(GArray *packets, quic_test_packet_type_t type, const quic_test_conn_t *conn,
+        gboolean from_server, const guint8 *quic, guint quic_len)
+{
+    quic_test_packet_t packet;
+    guint16 client_port = (guint16)(50000 + conn->index);
+    guint len = 20 + 8 + quic_len;
+    guint8 *ip, *udp;
+
+    packet.type = type;
+    packet.data = ip = (guint8 *)g_malloc0(len);
+    packet.len = len;
+
+    ip[0] = 0x45;
+    ip[2] = (guint8)(len >> 8);
+    ip[3] = (guint8)len;
+    ip[8] = 64;
+    ip[9] = 17;
+    ip[12] = 10;
+    ip[15] = from_server ? 2 : 1;
+    ip[16] = 10;
+    ip[19] = from_server ? 1 : 2;
+
+    udp = ip + 20;
+    udp[0] = (guint8)((from_server ? QUIC_SERVER_PORT : client_port) >> 8);
+    udp[1] = (guint8)(from_server ? QUIC_SERVER_PORT : client_port);
+    udp[2] = (guint8)((from_server ? client_port : QUIC_SERVER_PORT) >> 8);
+    udp[3] = (guint8)(from_server ? client_port : QUIC_SERVER_PORT);
+    udp[4] = (guint8)((8 + quic_len) >> 8);
+    udp[5] = (guint8)(8 + quic_len);
+    memcpy(udp + 8, quic, quic_len);
+
+    g_array_append_val(packets, packet);
+}
+
+static void
+quic_test_conn_init(quic_test_conn_t *conn, guint index)
+{
+    memset(conn, 0, sizeof(*conn));
+    conn->index = index;
+    for (guint i = 0; i < QUIC_CID_LEN; i++) {
+        conn->client_dcid[i] = (guint8)(0x83 + i);
+        conn->client_scid[i] = (guint8)(0xc1 + i);
+        conn->server_scid[i] = (guint8)(0x5e + i);
+    }
+    for (guint i = 0; i < 32; i++) {
+        conn->client_random[i] = (guint8)(0xa0 + i);
+        conn->client_secret[i] = (guint8)(0x10 + i);
+        conn->server_secret[i] = (guint8)(0x70 + i);
+    }
+    /* Make everything unique to the connection */
+    conn->client_dcid[0] = conn->client_scid[0] = conn->server_scid[0] = (guint8)(index >> 8);
+    conn->client_dcid[1] = conn->client_scid[1] = conn->server_scid[1] = (guint8)index;
+    conn->client_random[0] = conn->client_secret[0] = conn->server_secret[0] = (guint8)(index >> 8);
+    conn->client_random[1] = conn->client_secret[1] = conn->server_secret[1] = (guint8)index;
+}
+
+static void
+quic_test_keylog_secret(FILE *fp, const char *label, const guint8 *client_random, const guint8 *secret)
+{
+    fprintf(fp, "%s ", label);
+    for (guint i = 0; i < 32; i++) {
+        fprintf(fp, "%02x", client_random[i]);
+    }
+    fprintf(fp, " ");
+    for (guint i = 0; i < 32; i++) {
+        fprintf(fp, "%02x", secret[i]);
+    }
+    fprintf(fp, "\n");
+}
+
+static void
+quic_test_capture_init(quic_test_capture_t *capture, guint connections, gboolean keylog)
+{
+    guint8 buf[QUIC_MAX_PACKET];
+    FILE *fp = NULL;
+    int fd;
+
+    capture->packets = g_array_new(FALSE, FALSE, sizeof(quic_test_packet_t));
+    capture->keylog_path = NULL;
+    if (keylog) {
+        fd = g_file_open_tmp("test_quic_XXXXXX.keys", &capture->keylog_path, NULL);
+        g_assert_cmpint(fd, >=, 0);
+        fp = ws_fdopen(fd, "w");
+        g_assert_nonnull(fp);
+        fprintf(fp, "# QUIC test keys\n");
+    }
+
+    for (guint c = 0; c < connections; c++) {
+        quic_test_conn_t conn;
+        quic_test_keys_t client_keys, server_keys;
+        guint len;
+
+        quic_test_conn_init(&conn, c);
+
+        len = quic_test_build_initial(buf, &conn, FALSE);
+        quic_test_add_packet(capture->packets, QUIC_TEST_CLIENT_INITIAL, &conn, FALSE, buf, len);
+
+        if (c % QUIC_RETRY_EVERY == QUIC_RETRY_EVERY - 1) {
+            len = quic_test_build_retry(buf, &conn);
+            quic_test_add_packet(capture->packets, QUIC_TEST_RETRY, &conn, TRUE, buf, len);
+            continue;
+        }
+
+        len = quic_test_build_initial(buf, &conn, TRUE);
+        quic_test_add_packet(capture->packets, QUIC_TEST_SERVER_INITIAL, &conn, TRUE, buf, len);
+
+        if (fp) {
+            quic_test_keylog_secret(fp, "CLIENT_TRAFFIC_SECRET_0", conn.client_random, conn.client_secret);
+            quic_test_keylog_secret(fp, "SERVER_TRAFFIC_SECRET_0", conn.client_random, conn.server_secret);
+        }
+
+        quic_test_keys_init(&client_keys, conn.client_secret);
+        quic_test_keys_init(&server_keys, conn.server_secret);
+        for (guint i = 0; i < QUIC_1RTT_PACKETS; i++) {
+            gboolean from_server = i % 2;
+
+            len = quic_test_build_1rtt(buf, from_server ? &server_keys : &client_keys, &conn, from_server, i / 2);
+            quic_test_add_packet(capture->packets, QUIC_TEST_1RTT, &conn, from_server, buf, len);
+        }
+        quic_test_keys_free(&client_keys);
+        quic_test_keys_free(&server_keys);
+    }
+
+    if (fp) {
+        fclose(fp);
+    }
+}
+
+static void
+quic_test_capture_free(quic_test_capture_t *capture)
+{
+    for (guint i = 0; i < capture->packets->len; i++) {
+        g_free(g_array_index(capture->packets, quic_test_packet_t, i).data);
+    }
+    g_array_free(capture->packets, TRUE);
+    if (capture->keylog_path) {
+        ws_unlink(capture->keylog_path);
+        g_free(capture->keylog_path);
+    }
+}
+
+static void
+quic_test_set_keylog(const char *path)
+{
+    char *pref = g_strdup_printf("tls.keylog_file:%s", path ? path : "");
+    char *errmsg = NULL;
+
+    g_assert_cmpint(prefs_set_pref(pref, &errmsg), ==, PREFS_SET_OK);
+    g_free(errmsg);
+    g_free(pref);
+    prefs_apply_all();
+}
+
+static void
+quic_test_dissect(epan_dissect_t *edt, quic_test_packet_t *packet, guint32 num, gboolean init_fd)
+{
+    wtap_rec rec;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.rec_type = REC_TYPE_PACKET;
+    rec.presence_flags = WTAP_HAS_TS | WTAP_HAS_CAP_LEN;
+    rec.rec_header.packet_header.caplen = packet->len;
+    rec.rec_header.packet_header.len = packet->len;
+    rec.rec_header.packet_header.pkt_encap = WTAP_ENCAP_RAW_IP;
+
+    if (init_fd) {
+        frame_data_init(&packet->fd, num, &rec, 0, 0);
+    }
+    epan_dissect_run(edt, WTAP_FILE_TYPE_SUBTYPE_UNKNOWN, &rec,
+            tvb_new_real_data(packet->data, packet->len, packet->len), &packet->fd, NULL);
+}
+
+static dfilter_t *
+compile_filter(const char *text)
+{
+    dfilter_t *df = NULL;
+    df_error_t *df_err = NULL;
+
+    if (!dfilter_compile(text, &df, &df_err)) {
+        g_error("Can't compile \"%s\": %s", text, df_err->msg);
+    }
+    return df;
+}
+
+/*
+ * Dissect the capture twice, like a first pass and a redissection, and
+ * check that every packet was decrypted, or not, each time.
+ */
+static void
+quic_test_check_capture(quic_test_capture_t *capture, gboolean keylog)
+{
+    const char *filters[] = {
+        [QUIC_TEST_CLIENT_INITIAL] = "tls.handshake.type == 1 && quic.crypto.offset == 0",
+        [QUIC_TEST_SERVER_INITIAL] = "tls.handshake.type == 2 && quic.crypto.offset == 0",
+        [QUIC_TEST_RETRY] = "quic.retry_integrity_tag && !quic.bad_retry",
+        [QUIC_TEST_1RTT] = keylog ?
+            "quic.short && quic.stream.stream_id == 0 && quic.stream.length == 200 && !quic.decryption_failed" :
+            "quic.short && !quic.stream",
+    };
+    dfilter_t *dfs[G_N_ELEMENTS(filters)];
+
+    quic_test_set_keylog(capture->keylog_path);
+    session = test_epan_new();
+    for (size_t i = 0; i < G_N_ELEMENTS(filters); i++) {
+        dfs[i] = compile_filter(filters[i]);
+    }
+
+    for (guint pass = 0; pass < 2; pass++) {
+        for (guint i = 0; i < capture->packets->len; i++) {
+            quic_test_packet_t *packet = &g_array_index(capture->packets, quic_test_packet_t, i);
+            epan_dissect_t *edt = epan_dissect_new(session, true, false);
+            dfilter_t *df = dfs[packet->type];
+
+            epan_dissect_prime_with_dfilter(edt, df);
+            quic_test_dissect(edt, packet, i + 1, pass == 0);
+            if (!dfilter_apply_edt(df, edt)) {
+                g_error("Pass %u, frame %u doesn't match \"%s\"", pass + 1, i + 1, filters[packet->type]);
+            }
+            epan_dissect_free(edt);
+        }
+    }
+
+    for (guint i = 0; i < capture->packets->len; i++) {
+        frame_data_destroy(&g_array_index(capture->packets, quic_test_packet_t, i).fd);
+    }
+    for (size_t i = 0; i < G_N_ELEMENTS(filters); i++) {
+        dfilter_free(dfs[i]);
+    }
+    epan_free(session);
+    session = NULL;
+    quic_test_set_keylog(NULL);
+}
+
+static void
+test_quic_decrypt(void)
+{
+    quic_test_capture_t capture;
+
+    quic_test_capture_init(&capture, QUIC_CONNECTIONS, TRUE);
+    quic_test_check_capture(&capture, TRUE);
+    quic_test_capture_free(&capture);
+}
+
+static void
+test_quic_no_keys(void)
+{
+    quic_test_capture_t capture;
+
+    quic_test_capture_init(&capture, QUIC_CONNECTIONS, FALSE);
+    quic_test_check_capture(&capture, FALSE);
+    quic_test_capture_free(&capture);
+}
+
+/* Dissect the capture like tshark without -V would, in a new session each time. */
+static void
+quic_test_perf_run(quic_test_capture_t *capture, double *first_ms, double *second_ms)
+{
+    gint64 start;
+
+    quic_test_set_keylog(capture->keylog_path);
+    session = test_epan_new();
+
+    for (guint pass = 0; pass < 2; pass++) {
+        start = g_get_monotonic_time();
+        for (guint i = 0; i < capture->packets->len; i++) {
+            quic_test_packet_t *packet = &g_array_index(capture->packets, quic_test_packet_t, i);
+            epan_dissect_t *edt = epan_dissect_new(session, false, false);
+
+            quic_test_dissect(edt, packet, i + 1, pass == 0);
+            epan_dissect_free(edt);
+        }
+        *(pass == 0 ? first_ms : second_ms) = (g_get_monotonic_time() - start) / 1000.0;
+    }
+
+    for (guint i = 0; i < capture->packets->len; i++) {
+        frame_data_destroy(&g_array_index(capture->packets, quic_test_packet_t, i).fd);
+    }
+    epan_free(session);
+    session = NULL;
+    quic_test_set_keylog(NULL);
+}
+
+/* NOTE: You have to run "test_quic -m perf" to run the performance tests. */
+static void
+test_quic_perf(void)
+{
+    static const struct {
+        const char *name;
+        gboolean    keylog;
+    } captures[] = {
+        { "with keys", TRUE },
+        { "without keys", FALSE },
+    };
+
+    for (size_t c = 0; c < G_N_ELEMENTS(captures); c++) {
+        quic_test_capture_t capture;
+        double first_ms, second_ms, best_first = G_MAXDOUBLE, best_second = G_MAXDOUBLE;
+
+        quic_test_capture_init(&capture, QUIC_PERF_CONNECTIONS, captures[c].keylog);
+        for (guint i = 0; i < QUIC_PERF_PASSES; i++) {
+            quic_test_perf_run(&capture, &first_ms, &second_ms);
+            best_first = MIN(best_first, first_ms);
+            best_second = MIN(best_second, second_ms);
+        }
+        g_test_minimized_result(best_first, "%s, %u packets, first pass: %.3f ms",
+                captures[c].name, capture.packets->len, best_first);
+        g_test_minimized_result(best_second, "%s, %u packets, redissection: %.3f ms",
+                captures[c].name, capture.packets->len, best_second);
+        quic_test_capture_free(&capture);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int ret;
+
+    ws_log_init("test_quic", NULL);
+
+    g_test_init(&argc, &argv, NULL);
+
+    if (!epan_test_fixture_init(argv[0], NULL)) {
+        return 1;
+    }
+
+    g_test_add_func("/quic/decrypt", test_quic_decrypt);
+    g_test_add_func("/quic/no_keys", test_quic_no_keys);
+    if (g_test_perf()) {
+        g_test_add_func("/quic/perf", test_quic_perf);
+    }
+
+    ret = g_test_run();
+
+    epan_test_fixture_cleanup();
+
+    return ret;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,148 @@
+/* tls_keylog.c
+ * Parsing of TLS key log files (SSLKEYLOGFILE)
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <wsutil/str_util.h>
+
+#include "tls_keylog.h"
+
+/*
+ * Line formats, as "<label><key><separator><secret>", indexed by
+ * tls_keylog_label_t.  A key length of 0 accepts any number of octets; a
+ * secret length of 0 takes all octets up to the first non-hex character,
+ * otherwise exactly that many octets are used and anything after them is
+ * ignored.
+ */
+static const struct {
+	const char *label;
+	const char *separator;
+	guint       key_len;
+	guint       secret_len;
+} tls_keylog_formats[TLS_KEYLOG_NUM_LABELS] = {
+	{ "PMS_CLIENT_RANDOM ",			" ",		32, 0 },
+	/* Must come before "RSA ", although a Session-ID never parses as hex. */
+	{ "RSA Session-ID:",			" Master-Key:",	0,  TLS_KEYLOG_MASTER_SECRET_LENGTH },
+	{ "RSA ",				" ",		8,  0 },
+	{ "CLIENT_RANDOM ",			" ",		32, TLS_KEYLOG_MASTER_SECRET_LENGTH },
+	{ "CLIENT_EARLY_TRAFFIC_SECRET ",	" ",		32, 0 },
+	{ "CLIENT_HANDSHAKE_TRAFFIC_SECRET ",	" ",		32, 0 },
+	{ "SERVER_HANDSHAKE_TRAFFIC_SECRET ",	" ",		32, 0 },
+	{ "CLIENT_TRAFFIC_SECRET_0 ",		" ",		32, 0 },
+	{ "SERVER_TRAFFIC_SECRET_0 ",		" ",		32, 0 },
+	{ "EARLY_EXPORTER_SECRET ",		" ",		32, 0 },
+	{ "EXPORTER_SECRET ",			" ",		32, 0 },
+};
+
+const char *
+tls_keylog_label_name(tls_keylog_label_t label)
+{
+	return tls_keylog_formats[label].label;
+}
+
+/* Returns the number of hex digits at the start of [p, end). */
+static gsize
+tls_keylog_hex_run(const char *p, const char *end)
+{
+	const char *q = p;
+
+	while (q < end && g_ascii_isxdigit(*q))
+		q++;
+	return q - p;
+}
+
+gboolean
+tls_keylog_parse_line(const char *line, gsize linelen, tls_keylog_line_t *parsed)
+{
+	const char *end = line + linelen;
+
+	for (int i = 0; i < TLS_KEYLOG_NUM_LABELS; i++) {
+		const char *p = line;
+		gsize label_len = strlen(tls_keylog_formats[i].label);
+		gsize sep_len = strlen(tls_keylog_formats[i].separator);
+		guint key_len = tls_keylog_formats[i].key_len;
+		guint secret_len = tls_keylog_formats[i].secret_len;
+		gsize key_digits, secret_digits;
+
+		if (linelen < label_len || memcmp(p, tls_keylog_formats[i].label, label_len) != 0)
+			continue;
+		p += label_len;
+
+		key_digits = tls_keylog_hex_run(p, end);
+		if (key_digits == 0 || (key_digits & 1) ||
+				(key_len && key_digits != 2 * key_len))
+			continue;
+		if ((gsize)(end - p) < key_digits + sep_len ||
+				memcmp(p + key_digits, tls_keylog_formats[i].separator, sep_len) != 0)
+			continue;
+
+		secret_digits = tls_keylog_hex_run(p + key_digits + sep_len, end);
+		if (secret_len) {
+			if (secret_digits < 2 * secret_len)
+				continue;
+		} else {
+			secret_len = (guint)(secret_digits / 2);
+			if (secret_len == 0)
+				continue;
+		}
+
+		parsed->label = (tls_keylog_label_t)i;
+		parsed->key = p;
+		parsed->key_len = (guint)(key_digits / 2);
+		parsed->secret = p + key_digits + sep_len;
+		parsed->secret_len = secret_len;
+		return TRUE;
+	}
+	return FALSE;
+}
+
+const char *
+tls_keylog_next_line(const char **pos, const char *end, gsize *linelen)
+{
+	const char *line = *pos;
+	const char *lf;
+
+	if (line == NULL || line >= end)
+		return NULL;
+
+	lf = (const char *)memchr(line, '\n', end - line);
+	if (lf) {
+		*linelen = lf - line;
+		*pos = lf + 1;
+	} else {
+		*linelen = end - line;
+		*pos = end;
+	}
+	if (*linelen > 0 && line[*linelen - 1] == '\r')
+		(*linelen)--;
+	return line;
+}
+
+void
+tls_keylog_hex_decode(const char *hex, guint nbytes, guint8 *out)
+{
+	for (guint i = 0; i < nbytes; i++)
+		out[i] = ws_xton(hex[i*2]) << 4 | ws_xton(hex[i*2 + 1]);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
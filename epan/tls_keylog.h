@@ -0,0 +1,83 @@
+/** @file
+ * Parsing of TLS key log files (SSLKEYLOGFILE)
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __TLS_KEYLOG_H__
+#define __TLS_KEYLOG_H__
+
+#include <glib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* The length of a TLS 1.2 and earlier master secret, in octets */
+#define TLS_KEYLOG_MASTER_SECRET_LENGTH	48
+
+/* The labels a key log line can start with, in the order they're tried. */
+typedef enum {
+	TLS_KEYLOG_PMS,			/* PMS_CLIENT_RANDOM <client random> <pre-master secret> */
+	TLS_KEYLOG_SESSION,		/* RSA Session-ID:<session ID> Master-Key:<master secret> */
+	TLS_KEYLOG_PRE_MASTER,		/* RSA <encrypted pre-master secret> <pre-master secret> */
+	TLS_KEYLOG_CRANDOM,		/* CLIENT_RANDOM <client random> <master secret> */
+	TLS_KEYLOG_CLIENT_EARLY,	/* TLS 1.3: <label> <client random> <secret> */
+	TLS_KEYLOG_CLIENT_HANDSHAKE,
+	TLS_KEYLOG_SERVER_HANDSHAKE,
+	TLS_KEYLOG_CLIENT_APPDATA,
+	TLS_KEYLOG_SERVER_APPDATA,
+	TLS_KEYLOG_EARLY_EXPORTER,
+	TLS_KEYLOG_EXPORTER,
+	TLS_KEYLOG_NUM_LABELS
+} tls_keylog_label_t;
+
+/* A parsed line; the key and secret are still hex digits in the line. */
+typedef struct {
+	tls_keylog_label_t  label;
+	const char         *key;
+	guint               key_len;	/**< in octets */
+	const char         *secret;
+	guint               secret_len;	/**< in octets */
+} tls_keylog_line_t;
+
+/* The label as it appears in the file, including what follows it up to the key. */
+const char *tls_keylog_label_name(tls_keylog_label_t label);
+
+/*
+ * Parse one line, without its line terminator.  Returns FALSE if it
+ * isn't a key log entry, e.g. a comment or a malformed line.
+ */
+gboolean tls_keylog_parse_line(const char *line, gsize linelen, tls_keylog_line_t *parsed);
+
+/*
+ * Return the next line of [*pos, end) and its length without the LF or
+ * CR LF terminator, and advance *pos past it; NULL if there are no more.
+ */
+const char *tls_keylog_next_line(const char **pos, const char *end, gsize *linelen);
+
+/* Convert nbytes octets of valid hex digits to binary. */
+void tls_keylog_hex_decode(const char *hex, guint nbytes, guint8 *out);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __TLS_KEYLOG_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
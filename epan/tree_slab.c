@@ -0,0 +1,250 @@
+/* tree_slab.c
+ * Storage for the nodes and interesting fields of a protocol tree
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "tree_slab.h"
+
+#define INTERESTING_MIN_SLOTS	8
+#define INTERESTING_MIN_INDEX	16
+#define INTERESTING_MIN_FINFOS	4
+
+static GMutex  label_counts_mutex;
+static guint64 labels_deferred;
+static guint64 labels_rendered;
+
+tree_slab_t *
+tree_slab_new(void)
+{
+	return g_new0(tree_slab_t, 1);
+}
+
+void
+tree_slab_next_chunk(tree_slab_t *slab)
+{
+	tree_slab_chunk_t *chunk;
+
+	chunk = slab->current ? slab->current->next : slab->first;
+	if (chunk == NULL) {
+		chunk = (tree_slab_chunk_t *)g_malloc(TREE_SLAB_CHUNK_SIZE);
+		chunk->next = NULL;
+		if (slab->current)
+			slab->current->next = chunk;
+		else
+			slab->first = chunk;
+	}
+	slab->current = chunk;
+	slab->pos = (guint8 *)(((guintptr)(chunk + 1) + TREE_SLAB_ALIGN - 1) & ~(guintptr)(TREE_SLAB_ALIGN - 1));
+	slab->end = (guint8 *)chunk + TREE_SLAB_CHUNK_SIZE;
+}
+
+void *
+tree_slab_alloc_large(tree_slab_t *slab, size_t size)
+{
+	tree_slab_chunk_t *chunk;
+
+	/* Keep the data as aligned as the other chunks' */
+	chunk = (tree_slab_chunk_t *)g_malloc(TREE_SLAB_ALIGN + size);
+	chunk->next = slab->large;
+	slab->large = chunk;
+	return (guint8 *)chunk + TREE_SLAB_ALIGN;
+}
+
+static void
+tree_slab_free_chunks(tree_slab_chunk_t *chunk)
+{
+	tree_slab_chunk_t *next;
+
+	for (; chunk != NULL; chunk = next) {
+		next = chunk->next;
+		g_free(chunk);
+	}
+}
+
+void
+tree_slab_reset(tree_slab_t *slab)
+{
+	tree_slab_chunk_t *chunk, *next;
+	guint kept = 1;
+
+	tree_slab_free_chunks(slab->large);
+	slab->large = NULL;
+
+	if (slab->current != NULL && slab->current != slab->first) {
+		/* Give back what a particularly large tree needed. */
+		for (chunk = slab->first; chunk->next != NULL && kept < TREE_SLAB_KEEP_CHUNKS; chunk = chunk->next)
+			kept++;
+		next = chunk->next;
+		chunk->next = NULL;
+		tree_slab_free_chunks(next);
+	}
+	slab->current = NULL;
+	slab->pos = NULL;
+	slab->end = NULL;
+}
+
+void
+tree_slab_free(tree_slab_t *slab)
+{
+	tree_slab_free_chunks(slab->large);
+	tree_slab_free_chunks(slab->first);
+	g_free(slab);
+}
+
+/*
+ * Copy an array to a bigger one in the slab; the old one stays where
+ * it is until the slab is reset.
+ */
+static void *
+tree_slab_grow(tree_slab_t *slab, const void *old, size_t old_size, size_t new_size)
+{
+	void *ptr = tree_slab_alloc(slab, new_size);
+
+	if (old_size != 0)
+		memcpy(ptr, old, old_size);
+	return ptr;
+}
+
+static inline guint
+interesting_fields_bucket(const interesting_fields_t *fields, int hfid)
+{
+	return (guint)hfid & fields->index_mask;
+}
+
+interesting_slot_t *
+interesting_fields_lookup(const interesting_fields_t *fields, int hfid)
+{
+	guint bucket, slot_index;
+
+	if (fields == NULL)
+		return NULL;
+
+	for (bucket = interesting_fields_bucket(fields, hfid);
+	     (slot_index = fields->index[bucket]) != 0;
+	     bucket = (bucket + 1) & fields->index_mask) {
+		if (fields->slots[slot_index - 1].hfid == hfid)
+			return &fields->slots[slot_index - 1];
+	}
+	return NULL;
+}
+
+/* Rebuild the hash table with room for twice as many slots as we have room for. */
+static void
+interesting_fields_reindex(interesting_fields_t *fields, tree_slab_t *slab)
+{
+	guint size = INTERESTING_MIN_INDEX, bucket, i;
+
+	while (size < 2 * fields->alloc)
+		size *= 2;
+	fields->index = (guint *)tree_slab_alloc(slab, size * sizeof(guint));
+	memset(fields->index, 0, size * sizeof(guint));
+	fields->index_mask = size - 1;
+
+	for (i = 0; i < fields->count; i++) {
+		bucket = interesting_fields_bucket(fields, fields->slots[i].hfid);
+		while (fields->index[bucket] != 0)
+			bucket = (bucket + 1) & fields->index_mask;
+		fields->index[bucket] = i + 1;
+	}
+}
+
+interesting_slot_t *
+interesting_fields_get(interesting_fields_t **fieldsp, tree_slab_t *slab, int hfid)
+{
+	interesting_fields_t *fields = *fieldsp;
+	interesting_slot_t   *slot;
+	guint                 bucket;
+
+	slot = interesting_fields_lookup(fields, hfid);
+	if (slot != NULL)
+		return slot;
+
+	if (fields == NULL) {
+		fields = (interesting_fields_t *)tree_slab_alloc(slab, sizeof(interesting_fields_t));
+		fields->slots = NULL;
+		fields->count = 0;
+		fields->alloc = 0;
+		*fieldsp = fields;
+	}
+	if (fields->count == fields->alloc) {
+		guint alloc = MAX(INTERESTING_MIN_SLOTS, 2 * fields->alloc);
+
+		fields->slots = (interesting_slot_t *)tree_slab_grow(slab, fields->slots,
+				fields->count * sizeof(interesting_slot_t),
+				alloc * sizeof(interesting_slot_t));
+		fields->alloc = alloc;
+		interesting_fields_reindex(fields, slab);
+	}
+
+	slot = &fields->slots[fields->count++];
+	slot->hfid = hfid;
+	slot->alloc = 0;
+	slot->finfos.pdata = NULL;
+	slot->finfos.len = 0;
+
+	bucket = interesting_fields_bucket(fields, hfid);
+	while (fields->index[bucket] != 0)
+		bucket = (bucket + 1) & fields->index_mask;
+	fields->index[bucket] = fields->count;
+
+	return slot;
+}
+
+void
+interesting_slot_add(interesting_slot_t *slot, tree_slab_t *slab, gpointer finfo)
+{
+	if (slot->finfos.len == slot->alloc) {
+		guint alloc = MAX(INTERESTING_MIN_FINFOS, 2 * slot->alloc);
+
+		slot->finfos.pdata = (gpointer *)tree_slab_grow(slab, slot->finfos.pdata,
+				slot->finfos.len * sizeof(gpointer),
+				alloc * sizeof(gpointer));
+		slot->alloc = alloc;
+	}
+	slot->finfos.pdata[slot->finfos.len++] = finfo;
+}
+
+void
+tree_label_counts_add(guint deferred, guint rendered)
+{
+	if (deferred == 0 && rendered == 0)
+		return;
+
+	g_mutex_lock(&label_counts_mutex);
+	labels_deferred += deferred;
+	labels_rendered += rendered;
+	g_mutex_unlock(&label_counts_mutex);
+}
+
+void
+tree_label_counts_get(guint64 *deferred, guint64 *rendered)
+{
+	g_mutex_lock(&label_counts_mutex);
+	if (deferred)
+		*deferred = labels_deferred;
+	if (rendered)
+		*rendered = labels_rendered;
+	g_mutex_unlock(&label_counts_mutex);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -0,0 +1,139 @@
+/** @file
+ * Storage for the nodes and interesting fields of a protocol tree
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __TREE_SLAB_H__
+#define __TREE_SLAB_H__
+
+#include <glib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * proto_nodes and field_infos are carved out of a slab owned by the
+ * tree rather than allocated one by one from the packet pool.  They're
+ * small, fixed-size, created in the hot path and never freed
+ * individually, so we hand them out back to back from cache-line
+ * aligned chunks with no per-allocation header, and resetting the tree
+ * just rewinds the slab to its first chunk.  Chunks are kept across
+ * resets, up to a limit, so after the first few packets building a tree
+ * doesn't touch malloc at all.
+ */
+#define TREE_SLAB_CHUNK_SIZE	(64 * 1024)
+#define TREE_SLAB_KEEP_CHUNKS	16
+#define TREE_SLAB_ALIGN		64
+#define TREE_SLAB_SIZE(size)	(((size) + 7) & ~(size_t)7)
+
+typedef struct tree_slab_chunk {
+	struct tree_slab_chunk *next;
+} tree_slab_chunk_t;
+
+/* Anything bigger than this gets a chunk of its own. */
+#define TREE_SLAB_MAX_SIZE	(TREE_SLAB_CHUNK_SIZE / 4)
+
+typedef struct _tree_slab {
+	tree_slab_chunk_t *first;
+	tree_slab_chunk_t *current;
+	guint8            *pos;
+	guint8            *end;
+	tree_slab_chunk_t *large;	/**< chunks for big allocations, freed on reset */
+} tree_slab_t;
+
+tree_slab_t *tree_slab_new(void);
+
+void tree_slab_next_chunk(tree_slab_t *slab);
+
+void *tree_slab_alloc_large(tree_slab_t *slab, size_t size);
+
+static inline void *
+tree_slab_alloc(tree_slab_t *slab, size_t size)
+{
+	void *ptr;
+
+	size = TREE_SLAB_SIZE(size);
+	if (G_UNLIKELY(size > TREE_SLAB_MAX_SIZE))
+		return tree_slab_alloc_large(slab, size);
+	if (G_UNLIKELY((size_t)(slab->end - slab->pos) < size))
+		tree_slab_next_chunk(slab);
+	ptr = slab->pos;
+	slab->pos += size;
+	return ptr;
+}
+
+/* Free everything allocated from the slab, keeping its first chunks. */
+void tree_slab_reset(tree_slab_t *slab);
+
+void tree_slab_free(tree_slab_t *slab);
+
+/*
+ * The field_infos for each hfid a tree is primed with, or that a filter
+ * refers to, go in a slot.  The slots are numbered densely from 0 in
+ * the order the tree gets its hfids, and a small open-addressed hash
+ * table maps an hfid to its slot.  The table, the slots and their
+ * arrays of field_infos are all allocated from the tree's slab, so
+ * they go away when the tree is reset, and the tree has to be primed
+ * again for the next packet.
+ */
+typedef struct {
+	int        hfid;
+	guint      alloc;	/**< number of pointers finfos.pdata has room for */
+	GPtrArray  finfos;	/**< only pdata and len are used; pdata is in the slab */
+} interesting_slot_t;
+
+typedef struct _interesting_fields {
+	interesting_slot_t *slots;
+	guint               count;
+	guint               alloc;
+	guint              *index;	/**< 1 + slot number of each bucket's hfid, or 0 */
+	guint               index_mask;
+} interesting_fields_t;
+
+/* Find the slot for hfid, or return NULL if it doesn't have one. */
+interesting_slot_t *interesting_fields_lookup(const interesting_fields_t *fields, int hfid);
+
+/*
+ * Find the slot for hfid, giving it the next slot if it doesn't have one;
+ * *fieldsp is created if it's NULL.
+ */
+interesting_slot_t *interesting_fields_get(interesting_fields_t **fieldsp, tree_slab_t *slab, int hfid);
+
+/* Append a field_info to a slot. */
+void interesting_slot_add(interesting_slot_t *slot, tree_slab_t *slab, gpointer finfo);
+
+/*
+ * Process-wide totals of the item labels that were deferred because the
+ * tree wasn't visible, and of how many of those were built later anyway.
+ * Each tree keeps its own counts and adds them in when it's reset or
+ * freed, so trees being built on several threads only take the lock once
+ * per packet.
+ */
+void tree_label_counts_add(guint deferred, guint rendered);
+
+void tree_label_counts_get(guint64 *deferred, guint64 *rendered);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __TREE_SLAB_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -35,38 +35,65 @@
  * perfect, but it should stop most of the bad behaviour that emem permitted.
  */
 
-/* TODO: Make these thread-local */
+/* The packet scope is per-thread: the thread that called wmem_init_scopes()
+ * uses the global one below, and any other thread that dissects packets gets
+ * its own from wmem_init_thread_scopes(). Those are kept in a registry so that
+ * the file scope transitions can check (and garbage-collect) all of them.
+ *
+ * The file scope is shared by every thread and is backed by the concurrent
+ * allocator; the epan scope is only expected to be allocated from during
+ * registration and so is a plain block allocator. */
 static wmem_allocator_t *packet_scope;
 static wmem_allocator_t *file_scope;
 static wmem_allocator_t *epan_scope;
 
+static GPrivate          thread_packet_scope;
+static GMutex            registry_lock;
+static GSList           *thread_packet_scopes;
+
+static inline wmem_allocator_t *
+current_packet_scope(void)
+{
+    wmem_allocator_t *scope;
+
+    scope = (wmem_allocator_t *)g_private_get(&thread_packet_scope);
+
+    return scope ? scope : packet_scope;
+}
+
 /* Packet Scope */
 
 wmem_allocator_t *
 wmem_packet_scope(void)
 {
-    ws_assert(packet_scope);
+    wmem_allocator_t *scope = current_packet_scope();
+
+    ws_assert(scope);
 
-    return packet_scope;
+    return scope;
 }
 
 void
 wmem_enter_packet_scope(void)
 {
-    ws_assert(packet_scope);
+    wmem_allocator_t *scope = current_packet_scope();
+
+    ws_assert(scope);
     ws_assert(wmem_in_scope(file_scope));
-    ws_assert(!wmem_in_scope(packet_scope));
+    ws_assert(!wmem_in_scope(scope));
 
-    wmem_enter_scope(packet_scope);
+    wmem_enter_scope(scope);
 }
 
 void
 wmem_leave_packet_scope(void)
 {
-    ws_assert(packet_scope);
-    ws_assert(wmem_in_scope(packet_scope));
+    wmem_allocator_t *scope = current_packet_scope();
 
-    wmem_leave_scope(packet_scope);
+    ws_assert(scope);
+    ws_assert(wmem_in_scope(scope));
+
+    wmem_leave_scope(scope);
 }
 
 /* File Scope */
@@ -91,15 +118,26 @@ wmem_enter_file_scope(void)
 void
 wmem_leave_file_scope(void)
 {
+    GSList *l;
+
     ws_assert(file_scope);
     ws_assert(wmem_in_scope(file_scope));
     ws_assert(!wmem_in_scope(packet_scope));
 
+    g_mutex_lock(&registry_lock);
+    for (l = thread_packet_scopes; l; l = l->next) {
+        ws_assert(!wmem_in_scope((wmem_allocator_t *)l->data));
+    }
+
     wmem_leave_scope(file_scope);
 
     /* this seems like a good time to do garbage collection */
     wmem_gc(file_scope);
     wmem_gc(packet_scope);
+    for (l = thread_packet_scopes; l; l = l->next) {
+        wmem_gc((wmem_allocator_t *)l->data);
+    }
+    g_mutex_unlock(&registry_lock);
 }
 
 /* Epan Scope */
@@ -124,7 +162,7 @@ wmem_init_scopes(void)
     wmem_init();
 
     packet_scope = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK_FAST);
-    file_scope   = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    file_scope   = wmem_allocator_new(WMEM_ALLOCATOR_CONCURRENT);
     epan_scope   = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
 
     /* Scopes are initialized to TRUE by default on creation */
@@ -141,6 +179,7 @@ wmem_cleanup_scopes(void)
 
     ws_assert(!wmem_in_scope(packet_scope));
     ws_assert(!wmem_in_scope(file_scope));
+    ws_assert(thread_packet_scopes == NULL);
 
     wmem_destroy_allocator(packet_scope);
     wmem_destroy_allocator(file_scope);
@@ -153,6 +192,42 @@ wmem_cleanup_scopes(void)
     epan_scope   = NULL;
 }
 
+void
+wmem_init_thread_scopes(void)
+{
+    wmem_allocator_t *scope;
+
+    ws_assert(file_scope);
+    ws_assert(g_private_get(&thread_packet_scope) == NULL);
+
+    scope = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK_FAST);
+    wmem_leave_scope(scope);
+
+    g_mutex_lock(&registry_lock);
+    thread_packet_scopes = g_slist_prepend(thread_packet_scopes, scope);
+    g_mutex_unlock(&registry_lock);
+
+    g_private_set(&thread_packet_scope, scope);
+}
+
+void
+wmem_cleanup_thread_scopes(void)
+{
+    wmem_allocator_t *scope;
+
+    scope = (wmem_allocator_t *)g_private_get(&thread_packet_scope);
+
+    ws_assert(scope);
+    ws_assert(!wmem_in_scope(scope));
+
+    g_mutex_lock(&registry_lock);
+    thread_packet_scopes = g_slist_remove(thread_packet_scopes, scope);
+    g_mutex_unlock(&registry_lock);
+
+    g_private_set(&thread_packet_scope, NULL);
+    wmem_destroy_allocator(scope);
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
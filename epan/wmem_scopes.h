@@ -73,6 +73,21 @@ WS_DLL_PUBLIC
 void
 wmem_cleanup_scopes(void);
 
+/**
+ * @brief Give the calling thread its own packet scope.
+ *
+ * Threads other than the one that called wmem_init_scopes() must call this
+ * before dissecting packets, and wmem_cleanup_thread_scopes() before they
+ * exit. The file and epan scopes are shared by all threads.
+ */
+WS_DLL_PUBLIC
+void
+wmem_init_thread_scopes(void);
+
+WS_DLL_PUBLIC
+void
+wmem_cleanup_thread_scopes(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
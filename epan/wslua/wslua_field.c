@@ -164,6 +164,7 @@ WSLUA_METAMETHOD FieldInfo__call(lua_State* L) {
                 return 1;
             }
         case FT_NONE:
+                proto_item_render_label(fi->ws_fi);
                 if (fi->ws_fi->length > 0 && fi->ws_fi->rep) {
                     /* it has a length, but calling fvalue_get() on an FT_NONE asserts,
                        so get the label instead (it's a FT_NONE, so a label is what it basically is) */
@@ -239,6 +240,7 @@ static int FieldInfo_get_display(lua_State* L) {
     char         *label_ptr;
     char         *value_ptr;
 
+    proto_item_render_label(fi->ws_fi);
     if (!fi->ws_fi->rep) {
         label_ptr = label_str;
         proto_item_fill_label(fi->ws_fi, label_str);
@@ -760,6 +760,7 @@ static int TreeItem_get_text(lua_State* L) {
     if (ti->item) {
         field_info *fi = PITEM_FINFO(ti->item);
 
+        proto_item_render_label(fi);
         if (!fi->rep) {
             label_ptr = label_str;
             proto_item_fill_label(fi, label_str);
@@ -79,6 +79,22 @@ static gboolean read_record(capture_file *cf, wtap_rec *rec, Buffer *buf,
 
 static void rescan_packets(capture_file *cf, const char *action, const char *action_item, gboolean redissect);
 
+/*
+ * The records of a file found by wtap_index_records(), for the first
+ * pass through the file.
+ */
+typedef struct {
+    GArray *records;
+    guint   pos;
+    int     err;
+    gchar  *err_info;
+} record_index_t;
+
+static void index_file_records(capture_file *cf, record_index_t *index);
+static gboolean read_next_record(capture_file *cf, record_index_t *index,
+    wtap_rec *rec, Buffer *buf, int *err, gchar **err_info, gint64 *offset);
+static void free_record_index(record_index_t *index);
+
 typedef enum {
     MR_NOTMATCHED,
     MR_MATCHED,
@@ -501,6 +517,7 @@ cf_read(capture_file *cf, gboolean reloading)
     guint                tap_flags;
     gboolean             compiled _U_;
     volatile gboolean    is_read_aborted = FALSE;
+    record_index_t       index;
 
     /* The update_progress_dlg call below might end up accepting a user request to
      * trigger redissection/rescans which can modify/destroy the dissection
@@ -604,6 +621,8 @@ cf_read(capture_file *cf, gboolean reloading)
 
     g_timer_start(prog_timer);
 
+    index_file_records(cf, &index);
+
     wtap_rec_init(&rec);
     ws_buffer_init(&buf, 1514);
 
@@ -614,7 +633,7 @@ cf_read(capture_file *cf, gboolean reloading)
         float   progbar_val;
         gchar   status_str[100];
 
-        while ((wtap_read(cf->provider.wth, &rec, &buf, &err, &err_info,
+        while ((read_next_record(cf, &index, &rec, &buf, &err, &err_info,
                         &data_offset))) {
             if (size >= 0) {
                 if (cf->count == max_records) {
@@ -625,7 +644,15 @@ cf_read(capture_file *cf, gboolean reloading)
                     too_many_records = TRUE;
                     break;
                 }
-                file_pos = wtap_read_so_far(cf->provider.wth);
+                /*
+                 * If the file was indexed, the sequential side is already
+                 * past the indexed records, but the file is uncompressed,
+                 * so the record's offset is how far we've got.
+                 */
+                if (index.records->len != 0)
+                    file_pos = data_offset;
+                else
+                    file_pos = wtap_read_so_far(cf->provider.wth);
 
                 /* Create the progress bar if necessary. */
                 if (progress_is_slow(progbar, prog_timer, size, file_pos)) {
@@ -713,6 +740,7 @@ cf_read(capture_file *cf, gboolean reloading)
     epan_dissect_cleanup(&edt);
     wtap_rec_cleanup(&rec);
     ws_buffer_free(&buf);
+    free_record_index(&index);
 
     /* Close the sequential I/O side, to free up memory it requires. */
     wtap_sequential_close(cf->provider.wth);
@@ -1298,6 +1326,62 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
     epan_dissect_reset(edt);
 }
 
+/*
+ * If the file type supports it, find the records in the file with
+ * several threads before the first pass; the first pass then reads
+ * each of them with a random-access read, and carries on sequentially
+ * after the last one that was found.
+ */
+static void
+index_file_records(capture_file *cf, record_index_t *index)
+{
+    guint num_threads = (guint)g_get_num_processors();
+
+    index->records = NULL;
+    index->pos = 0;
+    index->err = 0;
+    index->err_info = NULL;
+    if (num_threads > 1)
+        index->records = wtap_index_records(cf->provider.wth, num_threads,
+                &index->err, &index->err_info);
+    if (index->records == NULL)
+        index->records = g_array_new(FALSE, FALSE, sizeof(wtap_record_index_entry));
+}
+
+/*
+ * Read the next record on the first pass, from the index if there are
+ * any indexed records left, otherwise sequentially.
+ */
+static gboolean
+read_next_record(capture_file *cf, record_index_t *index, wtap_rec *rec,
+        Buffer *buf, int *err, gchar **err_info, gint64 *offset)
+{
+    if (index->pos < index->records->len) {
+        const wtap_record_index_entry *entry =
+            &g_array_index(index->records, wtap_record_index_entry, index->pos++);
+
+        *offset = entry->file_off;
+        return wtap_seek_read(cf->provider.wth, entry->file_off, rec, buf,
+                err, err_info);
+    }
+    if (index->err != 0) {
+        /* We got an error while indexing; report it, once. */
+        *err = index->err;
+        *err_info = index->err_info;
+        index->err = 0;
+        index->err_info = NULL;
+        return FALSE;
+    }
+    return wtap_read(cf->provider.wth, rec, buf, err, err_info, offset);
+}
+
+static void
+free_record_index(record_index_t *index)
+{
+    g_array_free(index->records, TRUE);
+    g_free(index->err_info);
+}
+
 /*
  * Read in a new record.
  * Returns TRUE if the packet was added to the packet (record) list,
@@ -3378,6 +3462,7 @@ match_subtree_text(proto_node *node, gpointer data)
         }
     } else {
         /* was a free format label produced? */
+        proto_item_render_label(fi);
         if (fi->rep) {
             label_ptr = fi->rep->representation;
         } else {
@@ -3472,6 +3557,7 @@ match_subtree_text_reverse(proto_node *node, gpointer data)
     }
 
     /* was a free format label produced? */
+    proto_item_render_label(fi);
     if (fi->rep) {
         label_ptr = fi->rep->representation;
     } else {
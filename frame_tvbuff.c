@@ -24,6 +24,7 @@ struct tvb_frame {
     struct tvbuff tvb;
 
     Buffer *buf;         /* Packet data */
+    const guint8 *mapped; /* Packet data in a mapping of the file, if not in buf */
 
     const struct packet_provider_data *prov;	/* provider of packet information */
     gint64 file_off;     /**< File offset */
@@ -32,7 +33,7 @@ struct tvb_frame {
 };
 
 static gboolean
-frame_read(struct tvb_frame *frame_tvb, wtap_rec *rec, Buffer *buf)
+frame_read(struct tvb_frame *frame_tvb, wtap_rec *rec, Buffer *buf, const guint8 **data)
 {
     int    err;
     gchar *err_info;
@@ -41,7 +42,7 @@ frame_read(struct tvb_frame *frame_tvb, wtap_rec *rec, Buffer *buf)
     /* XXX, what if phdr->caplen isn't equal to
      * frame_tvb->tvb.length + frame_tvb->offset?
      */
-    if (!wtap_seek_read(frame_tvb->prov->wth, frame_tvb->file_off, rec, buf, &err, &err_info)) {
+    if (!wtap_seek_read_mapped(frame_tvb->prov->wth, frame_tvb->file_off, rec, buf, data, &err, &err_info)) {
         /* XXX - report error! */
         switch (err) {
             case WTAP_ERR_BAD_FILE:
@@ -59,10 +60,11 @@ static void
 frame_cache(struct tvb_frame *frame_tvb)
 {
     wtap_rec rec; /* Record metadata */
+    const guint8 *data = NULL;
 
     wtap_rec_init(&rec);
 
-    if (frame_tvb->buf == NULL) {
+    if (frame_tvb->buf == NULL && frame_tvb->mapped == NULL) {
         if (G_UNLIKELY(!buffer_cache)) buffer_cache = g_ptr_array_sized_new(1024);
 
         if (buffer_cache->len > 0) {
@@ -73,11 +75,22 @@ frame_cache(struct tvb_frame *frame_tvb)
 
         ws_buffer_init(frame_tvb->buf, frame_tvb->tvb.length + frame_tvb->offset);
 
-        if (!frame_read(frame_tvb, &rec, frame_tvb->buf))
+        if (!frame_read(frame_tvb, &rec, frame_tvb->buf, &data))
         { /* TODO: THROW(???); */ }
+
+        if (data != NULL && data != ws_buffer_start_ptr(frame_tvb->buf)) {
+            /* The data is in a mapping of the file; we don't need a copy. */
+            ws_buffer_free(frame_tvb->buf);
+            g_ptr_array_add(buffer_cache, frame_tvb->buf);
+            frame_tvb->buf = NULL;
+            frame_tvb->mapped = data;
+        }
     }
 
-    frame_tvb->tvb.real_data = ws_buffer_start_ptr(frame_tvb->buf) + frame_tvb->offset;
+    if (frame_tvb->mapped != NULL)
+        frame_tvb->tvb.real_data = frame_tvb->mapped + frame_tvb->offset;
+    else
+        frame_tvb->tvb.real_data = ws_buffer_start_ptr(frame_tvb->buf) + frame_tvb->offset;
 
     wtap_rec_cleanup(&rec);
 }
@@ -214,6 +227,7 @@ frame_tvbuff_new(const struct packet_provider_data *prov, const frame_data *fd,
         frame_tvb->prov = NULL;
 
     frame_tvb->buf = NULL;
+    frame_tvb->mapped = NULL;
 
     return tvb;
 }
@@ -259,6 +273,7 @@ frame_clone(tvbuff_t *tvb, guint abs_offset, guint abs_length)
     cloned_frame_tvb->file_off = frame_tvb->file_off;
     cloned_frame_tvb->offset = abs_offset;
     cloned_frame_tvb->buf = NULL;
+    cloned_frame_tvb->mapped = NULL;
 
     return cloned_tvb;
 }
@@ -319,6 +334,7 @@ file_tvbuff_new(const struct packet_provider_data *prov, const frame_data *fd,
         frame_tvb->prov = NULL;
 
     frame_tvb->buf = NULL;
+    frame_tvb->mapped = NULL;
 
     return tvb;
 }
@@ -228,7 +228,7 @@ sharkd_epan_new(capture_file *cf)
 
 static gboolean
 process_packet(capture_file *cf, epan_dissect_t *edt,
-        gint64 offset, wtap_rec *rec, Buffer *buf)
+        gint64 offset, wtap_rec *rec, const guint8 *pd)
 {
     frame_data     fdlocal;
     gboolean       passed;
@@ -271,7 +271,7 @@ process_packet(capture_file *cf, epan_dissect_t *edt,
         }
 
         epan_dissect_run(edt, cf->cd_t, rec,
-                frame_tvbuff_new_buffer(&cf->provider, &fdlocal, buf),
+                frame_tvbuff_new(&cf->provider, &fdlocal, pd),
                 &fdlocal, NULL);
 
         /* Run the read filter if we have one. */
@@ -309,6 +309,39 @@ process_packet(capture_file *cf, epan_dissect_t *edt,
 }
 
 
+/*
+ * Read the next record on the first pass.  If the file's records have
+ * been found with wtap_index_records(), read the ones it found with
+ * random-access reads, which can return the packet data in place, and
+ * carry on sequentially after them.
+ */
+static gboolean
+read_next_record(capture_file *cf, GArray *index, guint *index_pos,
+        int *index_err, gchar **index_err_info, wtap_rec *rec, Buffer *buf,
+        const guint8 **pd, int *err, gchar **err_info, gint64 *data_offset)
+{
+    if (index != NULL && *index_pos < index->len) {
+        const wtap_record_index_entry *entry =
+            &g_array_index(index, wtap_record_index_entry, (*index_pos)++);
+
+        *data_offset = entry->file_off;
+        return wtap_seek_read_mapped(cf->provider.wth, entry->file_off, rec,
+                buf, pd, err, err_info);
+    }
+    if (*index_err != 0) {
+        /* We got an error while indexing; report it. */
+        *err = *index_err;
+        *err_info = *index_err_info;
+        *index_err = 0;
+        *index_err_info = NULL;
+        return FALSE;
+    }
+    if (!wtap_read(cf->provider.wth, rec, buf, err, err_info, data_offset))
+        return FALSE;
+    *pd = ws_buffer_start_ptr(buf);
+    return TRUE;
+}
+
 static int
 load_cap_file(capture_file *cf, int max_packet_count, gint64 max_byte_count)
 {
@@ -317,7 +350,13 @@ load_cap_file(capture_file *cf, int max_packet_count, gint64 max_byte_count)
     gint64       data_offset;
     wtap_rec     rec;
     Buffer       buf;
+    const guint8 *pd;
     epan_dissect_t *edt = NULL;
+    GArray      *index = NULL;
+    guint        index_pos = 0;
+    int          index_err = 0;
+    gchar       *index_err_info = NULL;
+    guint        num_threads = (guint)g_get_num_processors();
 
     {
         /* Allocate a frame_data_sequence for all the frames. */
@@ -345,11 +384,16 @@ load_cap_file(capture_file *cf, int max_packet_count, gint64 max_byte_count)
             edt = epan_dissect_new(cf->epan, create_proto_tree, FALSE);
         }
 
+        /* Find the records with several threads, if we can. */
+        if (num_threads > 1)
+            index = wtap_index_records(cf->provider.wth, num_threads, &index_err, &index_err_info);
+
         wtap_rec_init(&rec);
         ws_buffer_init(&buf, 1514);
 
-        while (wtap_read(cf->provider.wth, &rec, &buf, &err, &err_info, &data_offset)) {
-            if (process_packet(cf, edt, data_offset, &rec, &buf)) {
+        while (read_next_record(cf, index, &index_pos, &index_err, &index_err_info,
+                    &rec, &buf, &pd, &err, &err_info, &data_offset)) {
+            if (process_packet(cf, edt, data_offset, &rec, pd)) {
                 wtap_rec_reset(&rec);
                 /* Stop reading if we have the maximum number of packets;
                  * When the -c option has not been used, max_packet_count
@@ -370,6 +414,9 @@ load_cap_file(capture_file *cf, int max_packet_count, gint64 max_byte_count)
 
         wtap_rec_cleanup(&rec);
         ws_buffer_free(&buf);
+        if (index != NULL)
+            g_array_free(index, TRUE);
+        g_free(index_err_info);
 
         /* Close the sequential I/O side, to free up memory it requires. */
         wtap_sequential_close(cf->provider.wth);
@@ -492,12 +539,13 @@ sharkd_dissect_request(guint32 framenum, guint32 frame_ref_num,
     frame_data *fdata;
     epan_dissect_t edt;
     gboolean create_proto_tree;
+    const guint8 *pd;
 
     fdata = sharkd_get_frame(framenum);
     if (fdata == NULL)
         return DISSECT_REQUEST_NO_SUCH_FRAME;
 
-    if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, rec, buf, err, err_info)) {
+    if (!wtap_seek_read_mapped(cfile.provider.wth, fdata->file_off, rec, buf, &pd, err, err_info)) {
         if (cinfo != NULL)
             col_fill_in_error(cinfo, fdata, FALSE, FALSE /* fill_fd_columns */);
         return DISSECT_REQUEST_READ_ERROR; /* error reading the record */
@@ -524,7 +572,7 @@ sharkd_dissect_request(guint32 framenum, guint32 frame_ref_num,
     fdata->frame_ref_num = frame_ref_num;
     fdata->prev_dis_num = prev_dis_num;
     epan_dissect_run(&edt, cfile.cd_t, rec,
-            frame_tvbuff_new_buffer(&cfile.provider, fdata, buf),
+            frame_tvbuff_new(&cfile.provider, fdata, pd),
             fdata, cinfo);
 
     if (cinfo) {
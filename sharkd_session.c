@@ -4064,6 +4064,7 @@ sharkd_session_process_frame_cb_tree(const char *key, epan_dissect_t *edt, proto
 
         json_dumper_begin_object(&dumper);
 
+        proto_item_render_label(finfo);
         if (!finfo->rep)
         {
             char label_str[ITEM_LABEL_LENGTH];
@@ -0,0 +1,63 @@
+#
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Capinfos tests'''
+
+import subprocess
+import pytest
+
+
+capinfos_files = (
+    'dhcp.pcap',
+    'dhcp.pcapng',
+    'comments.pcapng',
+    'dns+icmp.pcapng.gz',
+    'http.pcap',
+    'many_interfaces.pcapng.1',
+    'sip.pcapng',
+    'empty.pcap',
+)
+
+
+def run_capinfos(cmd_capinfos, args, files, env):
+    return subprocess.run([cmd_capinfos] + list(args) + list(files),
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                          encoding='utf-8', env=env)
+
+
+class TestCapinfosJobs:
+    @pytest.mark.parametrize('jobs', ('2', '4', '16'))
+    def test_capinfos_jobs_files(self, cmd_capinfos, capture_file, jobs, test_env):
+        '''capinfos -j gives the same report as a single thread'''
+        files = [capture_file(f) for f in capinfos_files]
+        single = run_capinfos(cmd_capinfos, (), files, test_env)
+        threaded = run_capinfos(cmd_capinfos, ('-j', jobs), files, test_env)
+        assert threaded.returncode == single.returncode
+        assert threaded.stdout == single.stdout
+        assert 'Number of packets' in threaded.stdout
+
+    def test_capinfos_jobs_table(self, cmd_capinfos, capture_file, test_env):
+        '''capinfos -j -T keeps the table rows in the order of the files'''
+        files = [capture_file(f) for f in capinfos_files]
+        single = run_capinfos(cmd_capinfos, ('-T', '-m'), files, test_env)
+        threaded = run_capinfos(cmd_capinfos, ('-T', '-m', '-j', '3'), files, test_env)
+        assert threaded.returncode == single.returncode
+        assert threaded.stdout == single.stdout
+
+    def test_capinfos_jobs_missing_file(self, cmd_capinfos, capture_file, result_file, test_env):
+        '''capinfos -j reports a missing file like a single thread does'''
+        files = [capture_file('dhcp.pcap'), result_file('does-not-exist.pcap'), capture_file('http.pcap')]
+        single = run_capinfos(cmd_capinfos, (), files, test_env)
+        threaded = run_capinfos(cmd_capinfos, ('-j', '2'), files, test_env)
+        assert threaded.returncode == single.returncode
+        assert threaded.stdout == single.stdout
+
+    @pytest.mark.parametrize('capture', ('dhcp.pcapng', 'many_interfaces.pcapng.1', 'sip.pcapng'))
+    def test_capinfos_jobs_single_pcapng(self, cmd_capinfos, capture_file, capture, test_env):
+        '''capinfos -j on one pcapng file scans it with several threads'''
+        single = run_capinfos(cmd_capinfos, (), (capture_file(capture),), test_env)
+        threaded = run_capinfos(cmd_capinfos, ('-j', '4'), (capture_file(capture),), test_env)
+        assert threaded.returncode == single.returncode
+        assert threaded.stdout == single.stdout
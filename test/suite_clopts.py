@@ -195,6 +195,40 @@ class TestTsharkDumpGlossaries:
         process = subprocesstest.run((cmd_tshark, '-G', 'plugins'), capture_output=True, env=base_env)
         assert count_output(process.stdout, 'dissector') >= 10, 'Fewer than 10 dissector plugins found'
 
+    def test_tshark_startup_profile(self, cmd_tshark, base_env):
+        def nbap_counts(env):
+            proc = subprocess.run((cmd_tshark, '-G', 'startup-profile'),
+                check=True, capture_output=True, encoding='utf-8', env=env)
+            profile = {}
+            for line in proc.stdout.splitlines():
+                name, usec, registered, deferred = line.split('\t')
+                assert int(usec) >= 0
+                profile[name] = (int(registered), int(deferred))
+            assert 'proto_register_frame' in profile
+            return profile['proto_register_nbap']
+
+        # NBAP registers its fields lazily, unless that's turned off.
+        registered, deferred = nbap_counts(base_env)
+        assert deferred > 0
+        env = dict(base_env)
+        env['WIRESHARK_NO_LAZY_FIELDS'] = '1'
+        registered_no_lazy, deferred_no_lazy = nbap_counts(env)
+        assert deferred_no_lazy == 0
+        assert registered_no_lazy >= registered + deferred
+
+    def test_tshark_lazy_fields_glossary(self, cmd_tshark, base_env):
+        '''Deferring field registration doesn't change the fields glossary'''
+        def dump_fields(env):
+            proc = subprocess.run((cmd_tshark, '-G', 'fields'),
+                check=True, capture_output=True, encoding='utf-8', env=env)
+            return sorted(proc.stdout.splitlines())
+
+        lazy_fields = dump_fields(base_env)
+        env = dict(base_env)
+        env['WIRESHARK_NO_LAZY_FIELDS'] = '1'
+        assert lazy_fields == dump_fields(env)
+        assert any(line.startswith('F\t') and '\tnbap.' in line for line in lazy_fields)
+
     def test_tshark_elastic_mapping(self, cmd_tshark, dirs, base_env):
         def get_ip_props(obj):
             return obj['mappings']['properties']['layers']['properties']['ip']['properties']
@@ -8,6 +8,7 @@
 #
 '''Dissection tests'''
 
+import struct
 import sys
 import os.path
 import subprocess
@@ -934,3 +935,219 @@ class TestDecompressMongo:
         ), encoding='utf-8', env=test_env)
         # Check the element names of the decompressed body.
         assert 'drop,lsid,id,$db' == stdout.strip()
+
+class TestDissectDiameter:
+    '''The Diameter dictionary cache in the personal configuration directory'''
+
+    @staticmethod
+    def diameter_fields(cmd_tshark, env):
+        stdout = subprocess.check_output((cmd_tshark, '-G', 'fields'),
+                encoding='utf-8', env=env)
+        fields = [line for line in stdout.splitlines() if '\tdiameter' in line]
+        assert len(fields) > 1000
+        return fields
+
+    def test_diameter_dict_cache(self, cmd_tshark, conf_path, base_env):
+        cache_path = os.path.join(conf_path, 'diameter_dictionary.cache')
+        no_cache_env = dict(base_env, WIRESHARK_DIAM_DICT_NO_CACHE='1')
+        scanned = self.diameter_fields(cmd_tshark, no_cache_env)
+        assert not os.path.exists(cache_path)
+
+        # The first run writes the cache, the next ones read it.
+        assert self.diameter_fields(cmd_tshark, base_env) == scanned
+        cache_stat = os.stat(cache_path)
+        assert self.diameter_fields(cmd_tshark, base_env) == scanned
+        assert os.stat(cache_path).st_ino == cache_stat.st_ino
+
+        # A damaged cache is ignored and replaced.
+        with open(cache_path, 'r+b') as f:
+            f.truncate(cache_stat.st_size // 2)
+        assert self.diameter_fields(cmd_tshark, base_env) == scanned
+        assert os.stat(cache_path).st_size == cache_stat.st_size
+
+    def test_diameter_dict_no_config_dir(self, cmd_tshark, home_path, base_env):
+        # The configuration directory isn't created just for the cache.
+        no_cache_env = dict(base_env, WIRESHARK_DIAM_DICT_NO_CACHE='1')
+        scanned = self.diameter_fields(cmd_tshark, no_cache_env)
+        assert self.diameter_fields(cmd_tshark, base_env) == scanned
+        if sys.platform.startswith('win32'):
+            conf_path = os.path.join(home_path, 'Wireshark')
+        else:
+            conf_path = os.path.join(home_path, '.config', 'wireshark')
+        assert not os.path.exists(conf_path)
+
+class TestDissectDns:
+    '''Names expanded through the per-message name cache'''
+
+    class Message:
+        '''A DNS response whose names are compressed like a server would.'''
+        def __init__(self, id):
+            self.data = bytearray(struct.pack('!6H', id, 0x8180, 0, 0, 0, 0))
+            self.counts = [0, 0, 0, 0]
+            self.suffixes = {}
+
+        def raw(self, data):
+            offset = len(self.data)
+            self.data += data
+            return offset
+
+        def name(self, name):
+            '''Writes a name, pointing at the longest suffix already written.'''
+            labels = name.split('.')
+            for i in range(len(labels)):
+                suffix = '.'.join(labels[i:])
+                if suffix in self.suffixes:
+                    self.data += struct.pack('!H', 0xc000 | self.suffixes[suffix])
+                    return
+                self.suffixes[suffix] = len(self.data)
+                self.data += bytes((len(labels[i]),)) + labels[i].encode()
+            self.data += b'\0'
+
+        def question(self, name):
+            self.name(name)
+            self.data += struct.pack('!HH', 1, 1)
+            self.counts[0] += 1
+
+        def rr(self, section, name, rr_type, rdata):
+            '''Adds a record to a section (1-3); rdata is bytes or writes itself.'''
+            self.name(name)
+            self.data += struct.pack('!HHIH', rr_type, 1, 300, 0)
+            start = len(self.data)
+            if callable(rdata):
+                rdata(self)
+            else:
+                self.data += rdata
+            struct.pack_into('!H', self.data, start - 2, len(self.data) - start)
+            self.counts[section] += 1
+
+        def to_bytes(self):
+            struct.pack_into('!4H', self.data, 4, *self.counts)
+            return bytes(self.data)
+
+    @staticmethod
+    def reuse_message():
+        '''Lots of names that are suffixes of each other, some too long.'''
+        m = TestDissectDns.Message(1)
+        m.question('www.example.com')
+        m.rr(1, 'www.example.com', 5, lambda m: m.name('web.cdn.example.com'))
+        m.rr(1, 'web.cdn.example.com', 5, lambda m: m.name('edge1.web.cdn.example.com'))
+        for i in range(1, 33):
+            m.rr(1, 'host%d.edge1.web.cdn.example.com' % i, 1, bytes((192, 0, 2, i)))
+        m.rr(1, 'alias.host7.edge1.web.cdn.example.com', 5, lambda m: m.name('host7.edge1.web.cdn.example.com'))
+        # 203 characters, then 267 and 269, over the 255 character limit
+        long_name = '.'.join(c * 63 for c in 'abc') + '.example.com'
+        m.rr(1, long_name, 5, lambda m: m.name('d' * 63 + '.' + long_name))
+        m.rr(1, 'x.' + 'd' * 63 + '.' + long_name, 1, bytes((192, 0, 2, 100)))
+        m.rr(2, 'example.com', 2, lambda m: m.name('ns1.example.com'))
+        m.rr(2, 'example.com', 2, lambda m: m.name('ns2.example.com'))
+        def soa(m):
+            m.name('ns1.example.com')
+            m.name('hostmaster.example.com')
+            m.data += struct.pack('!5I', 2024010101, 3600, 600, 86400, 300)
+        m.rr(2, 'example.com', 6, soa)
+        m.rr(3, 'ns1.example.com', 1, bytes((192, 0, 2, 201)))
+        m.rr(3, 'ns2.example.com', 28, bytes(15) + b'\1')
+        def mx(m):
+            m.data += struct.pack('!H', 10)
+            m.name('mail.example.com')
+        m.rr(3, 'example.com', 15, mx)
+        def srv(m):
+            m.data += struct.pack('!3H', 0, 5, 5060)
+            m.name('sip.cdn.example.com')
+        m.rr(3, '_sip._udp.example.com', 33, srv)
+        m.rr(3, '7.2.0.192.in-addr.arpa', 12, lambda m: m.name('alias.host7.edge1.web.cdn.example.com'))
+        return m.to_bytes()
+
+    @staticmethod
+    def loop_message():
+        '''Names with pointers that loop, directly or through a label.'''
+        m = TestDissectDns.Message(2)
+        m.raw(b'\4loop\xc0\x0c' + struct.pack('!HH', 1, 1))
+        m.counts[0] += 1
+        def self_pointer(m):
+            m.raw(struct.pack('!H', 0xc000 | len(m.data)))
+        m.rr(1, 'ok.example.com', 5, self_pointer)
+        m.raw(b'\xc0\x0c' + struct.pack('!HHIH', 1, 1, 300, 4) + bytes((192, 0, 2, 53)))
+        m.counts[1] += 1
+        loop_at = []
+        def mutual_pointers(m):
+            loop_at.append(len(m.data))
+            m.raw(struct.pack('!HH', 0xc000 | (loop_at[0] + 2), 0xc000 | loop_at[0]))
+        m.rr(1, 'ok.example.com', 5, mutual_pointers)
+        m.raw(b'\5loop2' + struct.pack('!H', 0xc000 | loop_at[0]) + struct.pack('!HHIH', 5, 1, 300, 2))
+        m.name('ok.example.com')
+        m.counts[1] += 1
+        return m.to_bytes()
+
+    @staticmethod
+    def forward_message():
+        '''A name pointing forward, into one that comes later.'''
+        m = TestDissectDns.Message(3)
+        m.raw(b'\1a')
+        forward_at = m.raw(b'\0\0')
+        m.data += struct.pack('!HH', 1, 1)
+        m.counts[0] += 1
+        m.suffixes['a.fwd.example.org'] = 12
+        struct.pack_into('!H', m.data, forward_at, 0xc000 | len(m.data))
+        m.rr(1, 'fwd.example.org', 1, bytes((192, 0, 2, 3)))
+        m.rr(1, 'b.a.fwd.example.org', 5, lambda m: m.name('example.org'))
+        return m.to_bytes()
+
+    @staticmethod
+    def other_message():
+        '''Different names at the same offsets as the previous message.'''
+        m = TestDissectDns.Message(4)
+        m.question('www.example.net')
+        m.rr(1, 'www.example.net', 5, lambda m: m.name('a.www.example.net'))
+        m.rr(1, 'a.www.example.net', 1, bytes((192, 0, 2, 4)))
+        return m.to_bytes()
+
+    @staticmethod
+    def write_capture(path, packets):
+        '''Writes raw IPv4 UDP or TCP packets from port 53 to a pcap file.'''
+        with open(path, 'wb') as f:
+            f.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, 101))
+            for num, (proto, payload) in enumerate(packets):
+                if proto == 17:
+                    l4 = struct.pack('!4H', 53, 40000, 8 + len(payload), 0)
+                else:
+                    l4 = struct.pack('!HHIIBBHHH', 53, 40000, 1000, 1, 0x50, 0x18, 65535, 0, 0)
+                ip = struct.pack('!BBHHHBBH4s4s', 0x45, 0, 20 + len(l4) + len(payload),
+                        num + 1, 0, 64, proto, 0, bytes((192, 0, 2, 53)), bytes((192, 0, 2, 1)))
+                frame = ip + l4 + payload
+                f.write(struct.pack('<IIII', num + 1, 0, len(frame), len(frame)))
+                f.write(frame)
+
+    def test_dns_name_cache(self, cmd_tshark, result_file, test_env):
+        '''The name cache doesn't change what is dissected.'''
+        capture_file = result_file('dns-names.pcap')
+        tcp_payload = b''
+        for message in (self.forward_message(), self.other_message()):
+            tcp_payload += struct.pack('!H', len(message)) + message
+        self.write_capture(capture_file, (
+            (17, self.reuse_message()),
+            (17, self.loop_message()),
+            (6, tcp_payload),
+        ))
+
+        def dissect(env, *args):
+            return subprocess.check_output((cmd_tshark, '-r', capture_file) + args,
+                    encoding='utf-8', env=env)
+
+        no_cache_env = dict(test_env, WIRESHARK_DNS_NO_NAME_CACHE='1')
+        verbose = dissect(test_env, '-V')
+        assert verbose == dissect(no_cache_env, '-V')
+        assert grep_output(verbose, 'host32.edge1.web.cdn.example.com: type A')
+        assert grep_output(verbose, 'Primary name server: ns1.example.com')
+        assert grep_output(verbose, 'Mail Exchange: mail.example.com')
+        assert grep_output(verbose, 'Domain Name: alias.host7.edge1.web.cdn.example.com')
+        assert count_output(verbose, '<Name too long>') > 0
+
+        fields = ('-Tfields', '-edns.qry.name', '-edns.resp.name', '-edns.cname')
+        names = dissect(test_env, *fields)
+        assert names == dissect(no_cache_env, *fields)
+        lines = names.splitlines()
+        assert lines[0].startswith('www.example.com\twww.example.com,web.cdn.example.com,edge1.web.cdn.example.com,')
+        assert lines[1].split('\t')[0] == '<Name contains a pointer that loops>'
+        assert lines[1].split('\t')[2] == '<Name contains a pointer that loops>,<Name contains a pointer that loops>,ok.example.com'
+        assert lines[2] == 'a.fwd.example.org,www.example.net\tfwd.example.org,b.a.fwd.example.org,www.example.net,a.www.example.net\texample.org,a.www.example.net'
@@ -47,6 +47,57 @@ class TestUnitTests:
             '--verbose'
         ), env=base_env)
 
+    def test_unit_dfilter_group(self, program, base_env):
+        '''display filter group unit tests'''
+        subprocess.check_call((program('test_dfilter_group'),
+            '--verbose'
+        ), env=base_env)
+
+    def test_unit_lazy_fields(self, program, base_env):
+        '''deferred field registration unit tests'''
+        subprocess.check_call((program('test_lazy_fields'),
+            '--verbose'
+        ), env=base_env)
+
+    def test_unit_lazy_fields_disabled(self, program, base_env):
+        '''deferred field registration unit tests, with deferral turned off'''
+        env = base_env
+        env['WIRESHARK_NO_LAZY_FIELDS'] = '1'
+        subprocess.check_call((program('test_lazy_fields'),
+            '--verbose'
+        ), env=env)
+
+    def test_unit_quic(self, program, base_env):
+        '''QUIC decryption unit tests'''
+        subprocess.check_call((program('test_quic'),
+            '--verbose'
+        ), env=base_env)
+
+    def test_unit_ui(self, program, base_env):
+        '''ui unit tests'''
+        subprocess.check_call((program('test_ui'),
+            '--verbose'
+        ), env=base_env)
+
+    def test_unit_qtui(self, program, base_env):
+        '''Qt UI unit tests'''
+        subprocess.check_call((program('test_qtui'),
+            '--verbose'
+        ), env=base_env)
+
+    def test_unit_wiretap(self, program, capture_file, base_env):
+        '''wiretap unit tests'''
+        subprocess.check_call((program('test_wiretap'),
+            '--verbose',
+            capture_file('dhcp.pcap'),
+            capture_file('dhcp.pcapng'),
+            capture_file('comments.pcapng'),
+            capture_file('many_interfaces.pcapng.1'),
+            capture_file('tls12-dsb.pcapng'),
+            capture_file('sip-rtp.pcapng'),
+            capture_file('dns+icmp.pcapng.gz'),
+        ), env=base_env)
+
     def test_unit_wsutil(self, program, base_env):
         '''wsutil unit tests'''
         subprocess.check_call((program('test_wsutil'),
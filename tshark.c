@@ -626,6 +626,7 @@ glossary_option_help(void)
     fprintf(output, "  -G plugins               dump installed plugins and exit\n");
     fprintf(output, "  -G protocols             dump protocols in registration database and exit\n");
     fprintf(output, "  -G services              dump transport service (port) names\n");
+    fprintf(output, "  -G startup-profile       dump the time taken by each protocol registration routine\n");
     fprintf(output, "  -G values                dump value, range, true/false strings and exit\n");
     fprintf(output, "\n");
     fprintf(output, "Preference reports:\n");
@@ -1331,7 +1332,9 @@ main(int argc, char *argv[])
             else if (strcmp(argv[2], "protocols") == 0) {
                 epan_load_settings();
                 proto_registrar_dump_protocols();
-            } else if (strcmp(argv[2], "values") == 0)
+            } else if (strcmp(argv[2], "startup-profile") == 0)
+                register_dump_startup_profile();
+            else if (strcmp(argv[2], "values") == 0)
                 proto_registrar_dump_values();
             else if (strcmp(argv[2], "help") == 0)
                 glossary_option_help();
@@ -3529,7 +3532,7 @@ process_cap_file_first_pass(capture_file *cf, int max_packet_count,
 static gboolean
 process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
         frame_data *fdata, wtap_rec *rec,
-        Buffer *buf, guint tap_flags _U_)
+        const guint8 *pd, guint tap_flags _U_)
 {
     column_info    *cinfo;
     gboolean        passed;
@@ -3593,7 +3596,7 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
         block = wtap_block_ref(rec->block);
         elapsed_start = g_get_monotonic_time();
         epan_dissect_run_with_taps(edt, cf->cd_t, rec,
-                frame_tvbuff_new_buffer(&cf->provider, fdata, buf),
+                frame_tvbuff_new(&cf->provider, fdata, pd),
                 fdata, cinfo);
         tshark_elapsed.second_pass.dissect += g_get_monotonic_time() - elapsed_start;
 
@@ -3666,6 +3669,7 @@ process_cap_file_second_pass(capture_file *cf, wtap_dumper *pdh,
 {
     wtap_rec        rec;
     Buffer          buf;
+    const guint8   *pd;
     int             framenum = 0;
     int             write_framenum = 0;
     frame_data     *fdata;
@@ -3736,21 +3740,21 @@ process_cap_file_second_pass(capture_file *cf, wtap_dumper *pdh,
             break;
         }
         fdata = frame_data_sequence_find(cf->provider.frames, framenum);
-        if (!wtap_seek_read(cf->provider.wth, fdata->file_off, &rec, &buf, err,
-                    err_info)) {
+        if (!wtap_seek_read_mapped(cf->provider.wth, fdata->file_off, &rec, &buf,
+                    &pd, err, err_info)) {
             /* Error reading from the input file. */
             status = PASS_READ_ERROR;
             break;
         }
         ws_debug("tshark: invoking process_packet_second_pass() for frame #%d", framenum);
-        if (process_packet_second_pass(cf, edt, fdata, &rec, &buf, tap_flags)) {
+        if (process_packet_second_pass(cf, edt, fdata, &rec, pd, tap_flags)) {
             /* Either there's no read filtering or this packet passed the
                filter, so, if we're writing to a capture file, write
                this packet out. */
             write_framenum++;
             if (pdh != NULL) {
                 ws_debug("tshark: writing packet #%d to outfile packet #%d", framenum, write_framenum);
-                if (!wtap_dump(pdh, &rec, ws_buffer_start_ptr(&buf), err, err_info)) {
+                if (!wtap_dump(pdh, &rec, pd, err, err_info)) {
                     /* Error writing to the output file. */
                     ws_debug("tshark: error writing to a capture file (%d)", *err);
                     *err_framenum = framenum;
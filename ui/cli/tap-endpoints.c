@@ -117,6 +117,7 @@ void init_endpoints(struct register_ct *ct, const char *filter)
 		g_string_free(error_string, true);
 		exit(1);
 	}
+	set_tap_listener_merge(&iu->hash, split_endpoint_table_data, merge_endpoint_table_data);
 
 }
 
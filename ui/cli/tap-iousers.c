@@ -250,6 +250,7 @@ void init_iousers(struct register_ct *ct, const char *filter)
 		g_string_free(error_string, true);
 		exit(1);
 	}
+	set_tap_listener_merge(&iu->hash, split_conversation_table_data, merge_conversation_table_data);
 
 }
 
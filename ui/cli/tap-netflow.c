@@ -0,0 +1,244 @@
+/* tap-netflow.c
+ * NetFlow v9 / IPFIX flow record statistics for tshark
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/* This module aggregates the data records carried in NetFlow v9 and IPFIX
+ * export packets by their 5-tuple.  The dissector hands the tap only the
+ * few fields it needs, so no protocol tree has to be built for it.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/packet_info.h>
+#include <epan/address.h>
+#include <epan/ipproto.h>
+#include <epan/to_str.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/dissectors/packet-netflow.h>
+
+#include <wsutil/cmdarg_err.h>
+
+void register_tap_listener_netflow(void);
+
+/* one aggregated flow: the key fields and the totals of its records */
+typedef struct _netflow_flow_t {
+    address  src_addr;
+    address  dst_addr;
+    guint16  src_port;
+    guint16  dst_port;
+    guint8   protocol;
+    guint64  records;
+    guint64  packets;
+    guint64  bytes;
+} netflow_flow_t;
+
+typedef struct _netflowstat_t {
+    char       *filter;
+    GHashTable *flows;
+    guint64     records;
+} netflowstat_t;
+
+static guint
+netflow_flow_hash(gconstpointer key)
+{
+    const netflow_flow_t *flow = (const netflow_flow_t *)key;
+    guint hash_val;
+
+    hash_val = flow->src_port ^ (flow->dst_port << 16) ^ flow->protocol;
+    hash_val = add_address_to_hash(hash_val, &flow->src_addr);
+    hash_val = add_address_to_hash(hash_val, &flow->dst_addr);
+
+    return hash_val;
+}
+
+static gboolean
+netflow_flow_equal(gconstpointer key1, gconstpointer key2)
+{
+    const netflow_flow_t *f1 = (const netflow_flow_t *)key1;
+    const netflow_flow_t *f2 = (const netflow_flow_t *)key2;
+
+    return f1->src_port == f2->src_port &&
+           f1->dst_port == f2->dst_port &&
+           f1->protocol == f2->protocol &&
+           addresses_equal(&f1->src_addr, &f2->src_addr) &&
+           addresses_equal(&f1->dst_addr, &f2->dst_addr);
+}
+
+static void
+netflow_flow_free(gpointer data)
+{
+    netflow_flow_t *flow = (netflow_flow_t *)data;
+
+    free_address(&flow->src_addr);
+    free_address(&flow->dst_addr);
+    g_free(flow);
+}
+
+static void
+netflowstat_reset(void *tapdata)
+{
+    netflowstat_t *ns = (netflowstat_t *)tapdata;
+
+    g_hash_table_remove_all(ns->flows);
+    ns->records = 0;
+}
+
+static tap_packet_status
+netflowstat_packet(void *tapdata, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *data, tap_flags_t flags _U_)
+{
+    netflowstat_t *ns = (netflowstat_t *)tapdata;
+    const netflow_flows_tap_t *tap_info = (const netflow_flows_tap_t *)data;
+    guint i;
+
+    if (tap_info == NULL || tap_info->num_records == 0)
+        return TAP_PACKET_DONT_REDRAW;
+
+    for (i = 0; i < tap_info->num_records; i++) {
+        const netflow_flow_record_t *record = &tap_info->records[i];
+        netflow_flow_t key;
+        netflow_flow_t *flow;
+
+        /* Only the key fields are used for the lookup; the addresses
+         * still point into the packet. */
+        key.src_addr = record->src_addr;
+        key.dst_addr = record->dst_addr;
+        key.src_port = record->src_port;
+        key.dst_port = record->dst_port;
+        key.protocol = record->protocol;
+
+        flow = (netflow_flow_t *)g_hash_table_lookup(ns->flows, &key);
+        if (flow == NULL) {
+            flow = g_new0(netflow_flow_t, 1);
+            copy_address(&flow->src_addr, &record->src_addr);
+            copy_address(&flow->dst_addr, &record->dst_addr);
+            flow->src_port = record->src_port;
+            flow->dst_port = record->dst_port;
+            flow->protocol = record->protocol;
+            g_hash_table_insert(ns->flows, flow, flow);
+        }
+        flow->records++;
+        flow->packets += record->packets;
+        flow->bytes += record->bytes;
+    }
+    ns->records += tap_info->num_records;
+
+    return TAP_PACKET_REDRAW;
+}
+
+/* largest byte count first */
+static gint
+netflow_flow_cmp(gconstpointer a, gconstpointer b)
+{
+    const netflow_flow_t *fa = (const netflow_flow_t *)a;
+    const netflow_flow_t *fb = (const netflow_flow_t *)b;
+
+    if (fa->bytes != fb->bytes)
+        return (fa->bytes < fb->bytes) ? 1 : -1;
+    if (fa->records != fb->records)
+        return (fa->records < fb->records) ? 1 : -1;
+    return 0;
+}
+
+static void
+netflowstat_draw(void *tapdata)
+{
+    netflowstat_t *ns = (netflowstat_t *)tapdata;
+    GList *flows, *item;
+
+    printf("\n");
+    printf("===================================================================================================================\n");
+    printf("NetFlow/IPFIX Flows:\n");
+    printf("Filter: %s\n", ns->filter ? ns->filter : "<none>");
+    printf("Records: %" PRIu64 ", Flows: %u\n", ns->records, g_hash_table_size(ns->flows));
+    printf("%-39s %5s  %-39s %5s  %-8s %10s %12s %15s\n",
+           "Source", "Port", "Destination", "Port", "Protocol", "Records", "Packets", "Bytes");
+
+    flows = g_list_sort(g_hash_table_get_values(ns->flows), netflow_flow_cmp);
+    for (item = flows; item != NULL; item = g_list_next(item)) {
+        const netflow_flow_t *flow = (const netflow_flow_t *)item->data;
+        char *src_str = address_to_str(NULL, &flow->src_addr);
+        char *dst_str = address_to_str(NULL, &flow->dst_addr);
+
+        printf("%-39s %5u  %-39s %5u  %-8s %10" PRIu64 " %12" PRIu64 " %15" PRIu64 "\n",
+               src_str, flow->src_port, dst_str, flow->dst_port,
+               ipprotostr(flow->protocol),
+               flow->records, flow->packets, flow->bytes);
+
+        wmem_free(NULL, src_str);
+        wmem_free(NULL, dst_str);
+    }
+    g_list_free(flows);
+    printf("===================================================================================================================\n");
+}
+
+static void
+netflowstat_init(const char *opt_arg, void *userdata _U_)
+{
+    netflowstat_t *ns;
+    const char *filter = NULL;
+    GString *error_string;
+
+    if (strncmp(opt_arg, "netflow,flows,", 14) == 0)
+        filter = opt_arg + 14;
+
+    ns = g_new0(netflowstat_t, 1);
+    ns->filter = g_strdup(filter);
+    ns->flows = g_hash_table_new_full(netflow_flow_hash, netflow_flow_equal, NULL, netflow_flow_free);
+
+    /* The records come with the tap data, so nothing beyond the netflow
+     * dissector itself has to run for us. */
+    error_string = register_tap_listener("netflow", ns, ns->filter,
+        TL_REQUIRES_NOTHING, netflowstat_reset, netflowstat_packet, netflowstat_draw,
+        NULL);
+    if (error_string) {
+        /* error, we failed to attach to the tap. clean up */
+        g_hash_table_destroy(ns->flows);
+        g_free(ns->filter);
+        g_free(ns);
+
+        cmdarg_err("Couldn't register netflow,flows tap: %s", error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+static stat_tap_ui netflowstat_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "netflow,flows",
+    netflowstat_init,
+    0,
+    NULL
+};
+
+void
+register_tap_listener_netflow(void)
+{
+    register_stat_tap_ui(&netflowstat_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -134,6 +134,89 @@ GString *check_field_unit(const char *field_name, int *hf_index, io_graph_item_u
     return err_str;
 }
 
+void merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src, int hf_index, io_graph_item_unit_t item_unit)
+{
+    /*
+     * Frames are tapped in order, so the first frame in an interval is the
+     * lowest numbered one and the last is the highest, even if the capture
+     * has timestamps out of order.
+     */
+    if (src->first_frame_in_invl != 0 &&
+        (dst->first_frame_in_invl == 0 || src->first_frame_in_invl < dst->first_frame_in_invl)) {
+        dst->first_frame_in_invl = src->first_frame_in_invl;
+    }
+    if (src->last_frame_in_invl > dst->last_frame_in_invl) {
+        dst->last_frame_in_invl = src->last_frame_in_invl;
+    }
+
+    if (src->fields && hf_index >= 0) {
+        /* > 0 if src has the new maximum (minimum), 0 if it's a tie. */
+        int max_cmp = 0, min_cmp = 0;
+
+        switch (proto_registrar_get_ftype(hf_index)) {
+        case FT_UINT8:
+        case FT_UINT16:
+        case FT_UINT24:
+        case FT_UINT32:
+        case FT_UINT40:
+        case FT_UINT48:
+        case FT_UINT56:
+        case FT_UINT64:
+            max_cmp = (src->uint_max > dst->uint_max) - (src->uint_max < dst->uint_max);
+            min_cmp = (src->uint_min < dst->uint_min) - (src->uint_min > dst->uint_min);
+            dst->double_tot += src->double_tot;
+            break;
+        case FT_INT8:
+        case FT_INT16:
+        case FT_INT24:
+        case FT_INT32:
+        case FT_INT40:
+        case FT_INT48:
+        case FT_INT56:
+        case FT_INT64:
+            max_cmp = (src->int_max > dst->int_max) - (src->int_max < dst->int_max);
+            min_cmp = (src->int_min < dst->int_min) - (src->int_min > dst->int_min);
+            dst->double_tot += src->double_tot;
+            break;
+        case FT_FLOAT:
+        case FT_DOUBLE:
+            max_cmp = (src->double_max > dst->double_max) - (src->double_max < dst->double_max);
+            min_cmp = (src->double_min < dst->double_min) - (src->double_min > dst->double_min);
+            dst->double_tot += src->double_tot;
+            break;
+        case FT_RELATIVE_TIME:
+            /* LOAD only accumulates the time spent in each interval,
+             * which adds up across intervals. */
+            if (item_unit != IOG_ITEM_UNIT_CALC_LOAD) {
+                max_cmp = nstime_cmp(&src->time_max, &dst->time_max);
+                min_cmp = -nstime_cmp(&src->time_min, &dst->time_min);
+            }
+            nstime_add(&dst->time_tot, &src->time_tot);
+            break;
+        default:
+            /* Only counted. */
+            break;
+        }
+
+        /* On a tie, the tap would have kept the lower numbered frame.
+         * Copying the nstime_t member copies the whole union. */
+        if (dst->fields == 0 || max_cmp > 0 ||
+            (max_cmp == 0 && src->max_frame_in_invl < dst->max_frame_in_invl)) {
+            dst->time_max = src->time_max;
+            dst->max_frame_in_invl = src->max_frame_in_invl;
+        }
+        if (dst->fields == 0 || min_cmp > 0 ||
+            (min_cmp == 0 && src->min_frame_in_invl < dst->min_frame_in_invl)) {
+            dst->time_min = src->time_min;
+            dst->min_frame_in_invl = src->min_frame_in_invl;
+        }
+    }
+
+    dst->frames += src->frames;
+    dst->bytes += src->bytes;
+    dst->fields += src->fields;
+}
+
 // Adapted from get_it_value in gtk/io_stat.c.
 double get_io_graph_item(const io_graph_item_t *items_, io_graph_item_unit_t val_units_, int idx, int hf_index_, const capture_file *cap_file, int interval_, int cur_idx_)
 {
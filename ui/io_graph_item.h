@@ -191,6 +191,20 @@ GString *check_field_unit(const char *field_name, int *hf_index, io_graph_item_u
  */
 double get_io_graph_item(const io_graph_item_t *items, io_graph_item_unit_t val_units, int idx, int hf_index, const capture_file *cap_file, int interval, int cur_idx);
 
+/** Merge one io_graph_item_t into another.
+ *
+ * This lets items collected at a fine interval be combined into items
+ * for any interval that is a multiple of it, without retapping. The first
+ * and last frame numbers, and the frames holding the minimum and maximum
+ * values, match what a tap at the coarser interval would have found.
+ *
+ * @param dst [in,out] The item to merge into.
+ * @param src [in] The item to merge from.
+ * @param hf_index [in] Header field index for advanced statistics.
+ * @param item_unit [in] The type of unit being calculated. From IOG_ITEM_UNITS.
+ */
+void merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src, int hf_index, io_graph_item_unit_t item_unit);
+
 /** Update the values of an io_graph_item_t.
  *
  * Frame and byte counts are always calculated. If edt is non-NULL advanced
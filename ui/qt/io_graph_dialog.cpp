@@ -98,6 +98,12 @@ const int min_zoom_pixels_ = 20;
 
 const int stat_update_interval_ = 200; // ms
 
+// Base intervals that IOGraph taps into, finest first. See max_io_base_items_.
+const int io_base_intervals_[] = {
+    SCALE / 1000000, SCALE / 100000, SCALE / 10000, SCALE / 1000,
+    SCALE / 100, SCALE / 10, SCALE, SCALE * 10, SCALE * 60, SCALE * 600
+};
+
 // Saved graph settings
 typedef struct _io_graph_settings_t {
     bool enabled;
@@ -1510,6 +1516,7 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
 {
     int interval = ui->intervalComboBox->itemData(ui->intervalComboBox->currentIndex()).toInt();
     bool need_retap = false;
+    bool need_recalc = false;
 
     precision_ = ceil(log10(SCALE_F / interval));
     if (precision_ < 0) {
@@ -1531,8 +1538,10 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
         for (int row = 0; row < uat_model_->rowCount(); row++) {
             IOGraph *iog = ioGraphs_.value(row, NULL);
             if (iog) {
-                iog->setInterval(interval);
-                if (iog->visible()) {
+                if (iog->setInterval(interval)) {
+                    // Merged from what we've already tapped.
+                    need_recalc = true;
+                } else if (iog->visible()) {
                     need_retap = true;
                 } else {
                     iog->setNeedRetap(true);
@@ -1543,6 +1552,8 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
 
     if (need_retap) {
         scheduleRetap(true);
+    } else if (need_recalc) {
+        scheduleRecalc(true);
     }
 }
 
@@ -2108,6 +2119,9 @@ IOGraph::IOGraph(QCustomPlot *parent) :
     hf_index_(-1),
     interval_(0),
     start_time_(NSTIME_INIT_ZERO),
+    base_interval_(0),
+    base_cur_idx_(-1),
+    base_dirty_idx_(-1),
     cur_idx_(-1)
 {
     Q_ASSERT(parent_ != NULL);
@@ -2528,11 +2542,11 @@ int IOGraph::packetFromTime(double ts) const
     if (idx >= 0 && idx <= cur_idx_) {
         switch (val_units_) {
         case IOG_ITEM_UNIT_CALC_MAX:
-            return items_[idx].max_frame_in_invl;
+            return items()[idx].max_frame_in_invl;
         case IOG_ITEM_UNIT_CALC_MIN:
-            return items_[idx].min_frame_in_invl;
+            return items()[idx].min_frame_in_invl;
         default:
-            return items_[idx].last_frame_in_invl;
+            return items()[idx].last_frame_in_invl;
         }
     }
     return -1;
@@ -2541,8 +2555,11 @@ int IOGraph::packetFromTime(double ts) const
 void IOGraph::clearAllData()
 {
     cur_idx_ = -1;
-    if (items_.size()) {
-        reset_io_graph_items(&items_[0], items_.size(), hf_index_);
+    base_interval_ = 0;
+    base_cur_idx_ = -1;
+    base_dirty_idx_ = -1;
+    if (base_items_.size()) {
+        reset_io_graph_items(&base_items_[0], base_items_.size(), hf_index_);
     }
     if (graph_) {
         graph_->data()->clear();
@@ -2560,6 +2577,8 @@ void IOGraph::recalcGraphData(capture_file *cap_file)
     unsigned int mavg_to_remove = 0, mavg_to_add = 0;
     double mavg_cumulated = 0;
 
+    syncItems();
+
     if (graph_) {
         graph_->data()->clear();
     }
@@ -2749,7 +2768,7 @@ bool IOGraph::hasItemToShow(int idx, double value) const
 
     bool result = false;
 
-    const io_graph_item_t *item = &items_[idx];
+    const io_graph_item_t *item = &items()[idx];
 
     switch (val_units_) {
     case IOG_ITEM_UNIT_PACKETS:
@@ -2783,12 +2802,124 @@ bool IOGraph::hasItemToShow(int idx, double value) const
     return result;
 }
 
-void IOGraph::setInterval(int interval)
+// Returns false if the items we've tapped can't be merged into the new
+// interval, in which case we need to be retapped.
+bool IOGraph::setInterval(int interval)
 {
-    interval_ = interval;
-    if (bars_) {
-        bars_->setWidth(interval_ / SCALE_F);
+    if (interval != interval_) {
+        interval_ = interval;
+        if (bars_) {
+            bars_->setWidth(interval_ / SCALE_F);
+        }
+        // Rebuild items_ at the next recalculation.
+        cur_idx_ = -1;
+        if (base_cur_idx_ >= 0) {
+            base_dirty_idx_ = 0;
+        }
+    }
+
+    // Nothing has been tapped since the data was cleared, so there's
+    // nothing to merge from.
+    if (base_interval_ == 0) {
+        return false;
+    }
+    return baseFitsInterval();
+}
+
+// Whether the items at the base interval can be merged into interval_.
+// LOAD items are tapped at the displayed interval itself: a call is spread
+// over every interval it spans, so a fine base would make each packet walk
+// back through many more items.
+bool IOGraph::baseFitsInterval() const
+{
+    if (val_units_ == IOG_ITEM_UNIT_CALC_LOAD) {
+        return interval_ == base_interval_;
+    }
+    return interval_ % base_interval_ == 0;
+}
+
+// Returns the next base interval after base_interval that divides interval,
+// or 0 if there isn't one.
+static int nextBaseInterval(int base_interval, int interval)
+{
+    for (int next_interval : io_base_intervals_) {
+        if (next_interval >= interval) {
+            break;
+        }
+        if (next_interval > base_interval && interval % next_interval == 0) {
+            return next_interval;
+        }
     }
+    return interval > base_interval ? interval : 0;
+}
+
+// Merge the base items into coarser ones.
+bool IOGraph::coarsenBase(int base_interval)
+{
+    int factor = base_interval / base_interval_;
+    std::vector<io_graph_item_t> coarse_items;
+
+    if (base_cur_idx_ >= 0) {
+        try {
+            // resize zero-initializes new items, which is what we want
+            coarse_items.resize(base_cur_idx_ / factor + 1);
+        } catch (std::bad_alloc&) {
+            ws_warning("Failed memory allocation!");
+            return false;
+        }
+        for (int i = 0; i <= base_cur_idx_; i++) {
+            merge_io_graph_item(&coarse_items[i / factor], &base_items_[i], hf_index_, val_units_);
+        }
+        base_cur_idx_ /= factor;
+        base_dirty_idx_ = 0;
+    }
+    base_items_.swap(coarse_items);
+    base_interval_ = base_interval;
+    return true;
+}
+
+// Bring items_ up to date with the base items that changed since the last
+// call. Only the displayed intervals that contain those are rebuilt, so
+// during a live capture this is usually just the last one.
+void IOGraph::syncItems()
+{
+    if (base_dirty_idx_ < 0) {
+        return;
+    }
+    if (base_cur_idx_ < 0 || !baseFitsInterval()) {
+        // Nothing tapped, or waiting for a retap.
+        base_dirty_idx_ = -1;
+        cur_idx_ = -1;
+        return;
+    }
+
+    int factor = interval_ / base_interval_;
+    int first_idx = base_dirty_idx_ / factor;
+    int last_idx = base_cur_idx_ / factor;
+
+    base_dirty_idx_ = -1;
+    if (factor > 1) {
+        if (items_.size() <= (size_t)last_idx) {
+            try {
+                items_.resize(last_idx + 1);
+            } catch (std::bad_alloc&) {
+                ws_warning("Failed memory allocation!");
+                cur_idx_ = -1;
+                return;
+            }
+        }
+        reset_io_graph_items(&items_[first_idx], last_idx - first_idx + 1, hf_index_);
+        for (int i = first_idx * factor; i <= base_cur_idx_; i++) {
+            merge_io_graph_item(&items_[i / factor], &base_items_[i], hf_index_, val_units_);
+        }
+    }
+    cur_idx_ = last_idx;
+}
+
+// The items at the displayed interval.
+const io_graph_item_t *IOGraph::items() const
+{
+    return interval_ == base_interval_ ? base_items_.data() : items_.data();
 }
 
 // Get the value at the given interval (idx) for the current value unit.
@@ -2796,7 +2927,7 @@ double IOGraph::getItemValue(int idx, const capture_file *cap_file) const
 {
     ws_assert(idx < max_io_items_);
 
-    return get_io_graph_item(&items_[0], val_units_, idx, hf_index_, cap_file, interval_, cur_idx_);
+    return get_io_graph_item(items(), val_units_, idx, hf_index_, cap_file, interval_, cur_idx_);
 }
 
 // "tap_reset" callback for register_tap_listener
@@ -2817,12 +2948,42 @@ tap_packet_status IOGraph::tapPacket(void *iog_ptr, packet_info *pinfo, epan_dis
         return TAP_PACKET_DONT_REDRAW;
     }
 
-    int64_t tmp_idx = get_io_graph_index(pinfo, iog->interval_);
+    if (iog->interval_ <= 0) {
+        return TAP_PACKET_DONT_REDRAW;
+    }
+    if (iog->base_interval_ == 0) {
+        if (iog->val_units_ == IOG_ITEM_UNIT_CALC_LOAD) {
+            iog->base_interval_ = iog->interval_;
+        } else {
+            iog->base_interval_ = nextBaseInterval(0, iog->interval_);
+        }
+    }
+    if (!iog->baseFitsInterval()) {
+        /* Waiting for a retap at the new interval. */
+        return TAP_PACKET_DONT_REDRAW;
+    }
+
+    int64_t tmp_idx = get_io_graph_index(pinfo, iog->base_interval_);
     bool recalc = false;
 
+    /* If the base is getting too big, trade resolution for memory. */
+    if (iog->visible()) {
+        int next_interval;
+        while ((tmp_idx >= max_io_base_items_) &&
+               (next_interval = nextBaseInterval(iog->base_interval_, iog->interval_)) > 0 &&
+               iog->coarsenBase(next_interval)) {
+            tmp_idx = get_io_graph_index(pinfo, iog->base_interval_);
+        }
+    }
+
     /* some sanity checks */
     if ((tmp_idx < 0) || (tmp_idx >= max_io_items_)) {
-        iog->cur_idx_ = (int)iog->items_.size() - 1;
+        if ((int)iog->base_items_.size() - 1 > iog->base_cur_idx_) {
+            if (iog->base_dirty_idx_ < 0) {
+                iog->base_dirty_idx_ = iog->base_cur_idx_ + 1;
+            }
+            iog->base_cur_idx_ = (int)iog->base_items_.size() - 1;
+        }
         return TAP_PACKET_DONT_REDRAW;
     }
 
@@ -2836,14 +2997,14 @@ tap_packet_status IOGraph::tapPacket(void *iog_ptr, packet_info *pinfo, epan_dis
      * enabled/disabled taps.
      */
     if (!iog->visible()) {
-        if (idx > iog->cur_idx_) {
+        if (idx > iog->base_cur_idx_) {
             iog->need_retap_ = true;
         }
         return TAP_PACKET_DONT_REDRAW;
     }
 
-    if ((size_t)idx >= iog->items_.size()) {
-        const size_t old_size = iog->items_.size();
+    if ((size_t)idx >= iog->base_items_.size()) {
+        const size_t old_size = iog->base_items_.size();
         size_t new_size;
         if (old_size == 0) {
             new_size = 1024;
@@ -2852,7 +3013,7 @@ tap_packet_status IOGraph::tapPacket(void *iog_ptr, packet_info *pinfo, epan_dis
         }
         new_size = MAX(new_size, (size_t)idx + 1);
         try {
-            iog->items_.resize(new_size);
+            iog->base_items_.resize(new_size);
         } catch (std::bad_alloc&) {
             // std::vector.resize() has strong exception safety
             ws_warning("Failed memory allocation!");
@@ -2863,9 +3024,16 @@ tap_packet_status IOGraph::tapPacket(void *iog_ptr, packet_info *pinfo, epan_dis
     }
 
     /* update num_items */
-    if (idx > iog->cur_idx_) {
-        iog->cur_idx_ = idx;
-        recalc = true;
+    if (idx > iog->base_cur_idx_) {
+        iog->base_cur_idx_ = idx;
+        if (idx / (iog->interval_ / iog->base_interval_) > iog->cur_idx_) {
+            recalc = true;
+        }
+    }
+    /* LOAD can add to earlier items too, but it is tapped at the displayed
+     * interval, so there is nothing to merge for those. */
+    if (iog->base_dirty_idx_ < 0 || idx < iog->base_dirty_idx_) {
+        iog->base_dirty_idx_ = idx;
     }
 
     /* set start time */
@@ -2879,7 +3047,7 @@ tap_packet_status IOGraph::tapPacket(void *iog_ptr, packet_info *pinfo, epan_dis
         adv_edt = edt;
     }
 
-    if (!update_io_graph_item(&iog->items_[0], idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_, iog->interval_)) {
+    if (!update_io_graph_item(&iog->base_items_[0], idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_, iog->base_interval_)) {
         return TAP_PACKET_DONT_REDRAW;
     }
 
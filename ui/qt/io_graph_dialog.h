@@ -56,6 +56,16 @@ class QCPAxisTickerDateTime;
 // 2^25 = 16777216
 const int max_io_items_ = 1 << 25;
 
+// Each graph taps into items at a "base" interval that divides the displayed
+// interval, and any multiple of the base can be displayed by merging items
+// without retapping. LOAD graphs are the exception: they are tapped at the
+// displayed interval and retapped when it changes. The base starts at 1 μs
+// and is coarsened (to the next of 10 μs, 100 μs, ... 10 s, 1 min, 10 min
+// that still divides the displayed interval) each time it would need more
+// than this many items, so zooming in by a few decades stays cheap while
+// memory remains bounded. 2^18 items is about 22 MiB.
+const int max_io_base_items_ = 1 << 18;
+
 // XXX - Move to its own file?
 class IOGraph : public QObject {
 Q_OBJECT
@@ -85,7 +95,7 @@ public:
     QString valueUnitField() const { return vu_field_; }
     void setValueUnitField(const QString &vu_field);
     unsigned int movingAveragePeriod() const { return moving_avg_period_; }
-    void setInterval(int interval);
+    bool setInterval(int interval);
     bool addToLegend();
     bool removeFromLegend();
     QCPGraph *graph() const { return graph_; }
@@ -121,6 +131,10 @@ private:
     void removeTapListener();
 
     bool showsZero() const;
+    bool baseFitsInterval() const;
+    bool coarsenBase(int base_interval);
+    void syncItems();
+    const io_graph_item_t *items() const;
 
     template<class DataMap> double maxValueFromGraphData(const DataMap &map);
     template<class DataMap> void scaleGraphData(DataMap &map, int scalar);
@@ -144,6 +158,11 @@ private:
 
     // Cached data. We should be able to change the Y axis without retapping as
     // much as is feasible.
+    std::vector<io_graph_item_t> base_items_;
+    int base_interval_;
+    int base_cur_idx_;
+    int base_dirty_idx_; // Lowest base item changed since syncItems, or -1
+    // Items at interval_, merged from base_items_ (unused if they're the same.)
     std::vector<io_graph_item_t> items_;
     int cur_idx_;
 };
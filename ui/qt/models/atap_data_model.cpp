@@ -123,6 +123,11 @@ bool ATapDataModel::enableTap()
     if (errorString)
         g_string_free(errorString, true);
 
+    if (_type == ATapDataModel::DATAMODEL_ENDPOINT)
+        set_tap_listener_merge(hash(), split_endpoint_table_data, merge_endpoint_table_data);
+    else if (_type == ATapDataModel::DATAMODEL_CONVERSATION)
+        set_tap_listener_merge(hash(), split_conversation_table_data, merge_conversation_table_data);
+
     emit tapListenerChanged(true);
 
     return true;
@@ -8,8 +8,11 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <limits>
 #include <stdexcept>
+#include <vector>
 
 #include "packet_list_model.h"
 
@@ -38,6 +41,8 @@
 #include <QFontMetrics>
 #include <QModelIndex>
 #include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent>
 
 // Print timing information
 //#define DEBUG_PACKET_LIST_MODEL 1
@@ -75,7 +80,10 @@ packet_list_recreate_visible_rows(void)
 
 PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
     QAbstractItemModel(parent),
-    number_to_row_(QVector<int>()),
+    frame_count_(0),
+    visible_count_(0),
+    pending_count_(0),
+    sorted_(false),
     max_row_height_(0),
     max_line_count_(1),
     idle_dissection_row_(0)
@@ -84,10 +92,7 @@ PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
     glbl_plist_model = this;
     setCaptureFile(cf);
 
-    physical_rows_.reserve(reserved_packets_);
-    visible_rows_.reserve(reserved_packets_);
-    new_visible_rows_.reserve(1000);
-    number_to_row_.reserve(reserved_packets_);
+    visible_frames_.reserve(reserved_packets_);
 
     if (qobject_cast<MainWindow *>(mainApp->mainWindow()))
     {
@@ -118,15 +123,24 @@ void PacketListModel::setCaptureFile(capture_file *cf)
     cap_file_ = cf;
 }
 
+frame_data *PacketListModel::frameAt(uint32_t num) const
+{
+    if (!cap_file_ || !cap_file_->provider.frames || num < 1 || num > frame_count_)
+        return NULL;
+    return frame_data_sequence_find(cap_file_->provider.frames, num);
+}
+
 // Packet list records have no children (for now, at least).
 QModelIndex PacketListModel::index(int row, int column, const QModelIndex &) const
 {
-    if (row >= visible_rows_.count() || row < 0 || !cap_file_ || column >= prefs.num_cols)
+    if (row >= visible_count_ || row < 0 || !cap_file_ || column >= prefs.num_cols)
         return QModelIndex();
 
-    PacketListRecord *record = visible_rows_[row];
+    frame_data *fdata = getRowFdata(row);
+    if (!fdata)
+        return QModelIndex();
 
-    return createIndex(row, column, record);
+    return createIndex(row, column, fdata);
 }
 
 // Everything is under the root.
@@ -137,45 +151,61 @@ QModelIndex PacketListModel::parent(const QModelIndex &) const
 
 int PacketListModel::packetNumberToRow(int packet_num) const
 {
-    // map 1-based values to 0-based row numbers. Invisible rows are stored as
-    // the default value (0) and should map to -1.
-    return number_to_row_.value(packet_num) - 1;
+    if (packet_num < 1 || static_cast<uint32_t>(packet_num) > frame_count_)
+        return -1;
+
+    if (sorted_) {
+        // map 1-based values to 0-based row numbers. Invisible rows are
+        // stored as the default value (0) and should map to -1.
+        return number_to_row_.value(packet_num) - 1;
+    }
+
+    if (!visible_frames_.testBit(packet_num))
+        return -1;
+    int row = static_cast<int>(visible_frames_.rank(packet_num));
+    return row < visible_count_ ? row : -1;
 }
 
 unsigned PacketListModel::recreateVisibleRows()
 {
     beginResetModel();
-    visible_rows_.resize(0);
-    number_to_row_.fill(0);
+    visible_frames_.clear();
+    visible_count_ = 0;
+    pending_count_ = 0;
+    sorted_ = false;
+    sorted_frames_.clear();
+    number_to_row_.clear();
     endResetModel();
 
-    foreach (PacketListRecord *record, physical_rows_) {
-        frame_data *fdata = record->frameData();
-
-        if (fdata->passed_dfilter || fdata->ref_time) {
-            visible_rows_ << record;
-            if (static_cast<uint32_t>(number_to_row_.size()) <= fdata->num) {
-                number_to_row_.resize(fdata->num + 10000);
-            }
-            number_to_row_[fdata->num] = static_cast<int>(visible_rows_.count());
-        }
+    // Bit 0 stands for the nonexistent frame 0 so that bits are indexed by
+    // frame number.
+    visible_frames_.reserve(frame_count_ + 1);
+    visible_frames_.append(false);
+    for (uint32_t num = 1; num <= frame_count_; num++) {
+        frame_data *fdata = frameAt(num);
+        visible_frames_.append(fdata && (fdata->passed_dfilter || fdata->ref_time));
     }
-    if (!visible_rows_.isEmpty()) {
-        beginInsertRows(QModelIndex(), 0, static_cast<int>(visible_rows_.count()) - 1);
+
+    int count = static_cast<int>(visible_frames_.count());
+    if (count > 0) {
+        beginInsertRows(QModelIndex(), 0, count - 1);
+        visible_count_ = count;
         endInsertRows();
     }
     idle_dissection_row_ = 0;
-    return static_cast<unsigned>(visible_rows_.count());
+    return static_cast<unsigned>(visible_count_);
 }
 
 void PacketListModel::clear() {
     beginResetModel();
-    qDeleteAll(physical_rows_);
-    PacketListRecord::invalidateAllRecords();
-    physical_rows_.resize(0);
-    visible_rows_.resize(0);
-    new_visible_rows_.resize(0);
-    number_to_row_.resize(0);
+    PacketListRecord::clearAllRecords();
+    frame_count_ = 0;
+    visible_frames_.clear();
+    visible_count_ = 0;
+    pending_count_ = 0;
+    sorted_ = false;
+    sorted_frames_.clear();
+    number_to_row_.clear();
     endResetModel();
     max_row_height_ = 0;
     max_line_count_ = 1;
@@ -266,11 +296,7 @@ void PacketListModel::toggleFrameMark(const QModelIndexList &indeces)
         if (! index.isValid())
             continue;
 
-        PacketListRecord *record = static_cast<PacketListRecord*>(index.internalPointer());
-        if (!record)
-            continue;
-
-        frame_data *fdata = record->frameData();
+        frame_data *fdata = static_cast<frame_data*>(index.internalPointer());
         if (!fdata)
             continue;
 
@@ -289,11 +315,17 @@ void PacketListModel::setDisplayedFrameMark(bool set)
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
     emit layoutAboutToBeChanged();
 #endif
-    foreach (PacketListRecord *record, visible_rows_) {
+    // Marking doesn't depend on the order, so walk the frames rather than
+    // the rows.
+    int row = 0;
+    for (uint32_t num = 1; num <= frame_count_ && row < visible_count_; num++) {
+        if (!visible_frames_.testBit(num))
+            continue;
+        row++;
         if (set) {
-            cf_mark_frame(cap_file_, record->frameData());
+            cf_mark_frame(cap_file_, frameAt(num));
         } else {
-            cf_unmark_frame(cap_file_, record->frameData());
+            cf_unmark_frame(cap_file_, frameAt(num));
         }
     }
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -315,11 +347,7 @@ void PacketListModel::toggleFrameIgnore(const QModelIndexList &indeces)
         if (! index.isValid())
             continue;
 
-        PacketListRecord *record = static_cast<PacketListRecord*>(index.internalPointer());
-        if (!record)
-            continue;
-
-        frame_data *fdata = record->frameData();
+        frame_data *fdata = static_cast<frame_data*>(index.internalPointer());
         if (!fdata)
             continue;
 
@@ -338,11 +366,15 @@ void PacketListModel::setDisplayedFrameIgnore(bool set)
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
     emit layoutAboutToBeChanged();
 #endif
-    foreach (PacketListRecord *record, visible_rows_) {
+    int row = 0;
+    for (uint32_t num = 1; num <= frame_count_ && row < visible_count_; num++) {
+        if (!visible_frames_.testBit(num))
+            continue;
+        row++;
         if (set) {
-            cf_ignore_frame(cap_file_, record->frameData());
+            cf_ignore_frame(cap_file_, frameAt(num));
         } else {
-            cf_unignore_frame(cap_file_, record->frameData());
+            cf_unignore_frame(cap_file_, frameAt(num));
         }
     }
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -357,10 +389,7 @@ void PacketListModel::toggleFrameRefTime(const QModelIndex &rt_index)
 {
     if (!cap_file_ || !rt_index.isValid()) return;
 
-    PacketListRecord *record = static_cast<PacketListRecord*>(rt_index.internalPointer());
-    if (!record) return;
-
-    frame_data *fdata = record->frameData();
+    frame_data *fdata = static_cast<frame_data*>(rt_index.internalPointer());
     if (!fdata) return;
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -377,7 +406,7 @@ void PacketListModel::toggleFrameRefTime(const QModelIndex &rt_index)
     if (!fdata->ref_time && !fdata->passed_dfilter) {
         cap_file_->displayed_count--;
     }
-    record->resetColumns(&cap_file_->cinfo);
+    PacketListRecord::resetColumns(&cap_file_->cinfo);
     emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
 }
 
@@ -387,8 +416,8 @@ void PacketListModel::unsetAllFrameRefTime()
 
     /* XXX: we might need a progressbar here */
 
-    foreach (PacketListRecord *record, physical_rows_) {
-        frame_data *fdata = record->frameData();
+    for (uint32_t num = 1; num <= frame_count_; num++) {
+        frame_data *fdata = frameAt(num);
         if (fdata->ref_time) {
             fdata->ref_time = 0;
         }
@@ -412,10 +441,9 @@ void PacketListModel::addFrameComment(const QModelIndexList &indices, const QByt
     for (const auto &index : indices) {
         if (!index.isValid()) continue;
 
-        PacketListRecord *record = static_cast<PacketListRecord*>(index.internalPointer());
-        if (!record) continue;
-
-        fdata = record->frameData();
+        fdata = static_cast<frame_data*>(index.internalPointer());
+        if (!fdata) continue;
+        PacketListRecord record(fdata);
         wtap_block_t pkt_block = cf_get_packet_block(cap_file_, fdata);
         wtap_block_add_string_option(pkt_block, OPT_COMMENT, comment.data(), comment.size());
 
@@ -439,8 +467,8 @@ void PacketListModel::addFrameComment(const QModelIndexList &indices, const QByt
         // and time shifts ("frame.time_relative", "frame.offset_shift", etc.)
         // If there were, then we'd need to reset data for all frames instead
         // of just the frames changed.
-        record->invalidateColorized();
-        record->invalidateRecord();
+        record.invalidateColorized();
+        record.invalidateRecord();
         emit dataChanged(index.sibling(index.row(), 0), index.sibling(index.row(), sectionMax),
                 QVector<int>() << Qt::BackgroundRole << Qt::ForegroundRole << Qt::DisplayRole);
     }
@@ -454,10 +482,9 @@ void PacketListModel::setFrameComment(const QModelIndex &index, const QByteArray
 
     if (!index.isValid()) return;
 
-    PacketListRecord *record = static_cast<PacketListRecord*>(index.internalPointer());
-    if (!record) return;
-
-    fdata = record->frameData();
+    fdata = static_cast<frame_data*>(index.internalPointer());
+    if (!fdata) return;
+    PacketListRecord record(fdata);
 
     wtap_block_t pkt_block = cf_get_packet_block(cap_file_, fdata);
     if (comment.isEmpty()) {
@@ -471,8 +498,8 @@ void PacketListModel::setFrameComment(const QModelIndex &index, const QByteArray
         cf_set_modified_block(cap_file_, fdata, pkt_block);
     }
 
-    record->invalidateColorized();
-    record->invalidateRecord();
+    record.invalidateColorized();
+    record.invalidateRecord();
     emit dataChanged(index.sibling(index.row(), 0), index.sibling(index.row(), sectionMax),
             QVector<int>() << Qt::BackgroundRole << Qt::ForegroundRole << Qt::DisplayRole);
 }
@@ -486,10 +513,9 @@ void PacketListModel::deleteFrameComments(const QModelIndexList &indices)
     for (const auto &index : indices) {
         if (!index.isValid()) continue;
 
-        PacketListRecord *record = static_cast<PacketListRecord*>(index.internalPointer());
-        if (!record) continue;
-
-        fdata = record->frameData();
+        fdata = static_cast<frame_data*>(index.internalPointer());
+        if (!fdata) continue;
+        PacketListRecord record(fdata);
         wtap_block_t pkt_block = cf_get_packet_block(cap_file_, fdata);
         unsigned n_comments = wtap_block_count_option(pkt_block, OPT_COMMENT);
 
@@ -502,8 +528,8 @@ void PacketListModel::deleteFrameComments(const QModelIndexList &indices)
                 expert_update_comment_count(cap_file_->packet_comment_count);
             }
 
-            record->invalidateColorized();
-            record->invalidateRecord();
+            record.invalidateColorized();
+            record.invalidateRecord();
             emit dataChanged(index.sibling(index.row(), 0), index.sibling(index.row(), sectionMax),
                     QVector<int>() << Qt::BackgroundRole << Qt::ForegroundRole << Qt::DisplayRole);
         }
@@ -518,8 +544,8 @@ void PacketListModel::deleteAllFrameComments()
 
     /* XXX: we might need a progressbar here */
 
-    foreach (PacketListRecord *record, physical_rows_) {
-        frame_data *fdata = record->frameData();
+    for (uint32_t num = 1; num <= frame_count_; num++) {
+        frame_data *fdata = frameAt(num);
         wtap_block_t pkt_block = cf_get_packet_block(cap_file_, fdata);
         unsigned n_comments = wtap_block_count_option(pkt_block, OPT_COMMENT);
 
@@ -529,8 +555,9 @@ void PacketListModel::deleteAllFrameComments()
             }
             cf_set_modified_block(cap_file_, fdata, pkt_block);
 
-            record->invalidateColorized();
-            record->invalidateRecord();
+            PacketListRecord record(fdata);
+            record.invalidateColorized();
+            record.invalidateRecord();
             row = packetNumberToRow(fdata->num);
             if (row > -1) {
                 emit dataChanged(index(row, 0), index(row, sectionMax),
@@ -565,10 +592,10 @@ QElapsedTimer busy_timer_;
 const int busy_timeout_ = 65; // ms, approximately 15 fps
 void PacketListModel::sort(int column, Qt::SortOrder order)
 {
-    if (!cap_file_ || visible_rows_.count() < 1) return;
+    if (!cap_file_ || visible_count_ < 1) return;
     if (column < 0) return;
 
-    if (physical_rows_.count() < 1)
+    if (frame_count_ < 1)
         return;
 
     sort_column_ = column;
@@ -578,27 +605,6 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
 
     QString col_title = get_column_title(column);
 
-    if (text_sort_column_ >= 0 && (unsigned)visible_rows_.count() > prefs.gui_packet_list_cached_rows_max) {
-        /* Column not based on frame data but by column text that requires
-         * dissection, so to sort in a reasonable amount of time the column
-         * text needs to be cached.
-         */
-        /* If the sort is being triggered because the columns were already
-         * sorted and the filter is being cleared (or changed to something
-         * else with more rows than fit in the cache), then the temporary
-         * message will be immediately overwritten with the standard capture
-         * statistics by the packets_bar_update() call after thawing the rows.
-         * It will still blink yellow, and the user will get the message if
-         * they then click on the header file (wondering why it didn't sort.)
-         */
-        if (col_title.isEmpty()) {
-            col_title = tr("Column");
-        }
-        QString temp_msg = tr("%1 can only be sorted with %2 or fewer visible rows; increase cache size in Layout preferences").arg(col_title).arg(prefs.gui_packet_list_cached_rows_max);
-        mainApp->pushStatus(MainApplication::TemporaryStatus, temp_msg);
-        return;
-    }
-
     /* If we are currently in the middle of reading the capture file, don't
      * sort. PacketList::captureFileReadFinished invalidates all the cached
      * column strings and then tries to sort again.
@@ -629,7 +635,7 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
      * comparisons, some comparisons are faster than others.) Better to
      * overestimate?
      */
-    exp_comps_ = log2(visible_rows_.count()) * visible_rows_.count();
+    exp_comps_ = log2(visible_count_) * visible_count_;
     progress_frame_ = nullptr;
     if (qobject_cast<MainWindow *>(mainApp->mainWindow())) {
         MainWindow *mw = qobject_cast<MainWindow *>(mainApp->mainWindow());
@@ -643,24 +649,33 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
 
     busy_timer_.start();
     sort_column_is_numeric_ = isNumericColumn(sort_column_);
-    QVector<PacketListRecord *> sorted_visible_rows_ = visible_rows_;
+    QVector<uint32_t> sorted_frames;
+    if (sorted_) {
+        sorted_frames = sorted_frames_;
+    } else {
+        sorted_frames.reserve(visible_count_);
+        for (uint32_t num = 1; num <= frame_count_ && sorted_frames.count() < visible_count_; num++) {
+            if (visible_frames_.testBit(num)) {
+                sorted_frames << num;
+            }
+        }
+    }
     try {
-        std::sort(sorted_visible_rows_.begin(), sorted_visible_rows_.end(), recordLessThan);
+        if (text_sort_column_ >= 0) {
+            // Column not based on frame data but by column text that
+            // requires dissection.
+            sortByColumnText(sorted_frames);
+        } else {
+            std::sort(sorted_frames.begin(), sorted_frames.end(), recordLessThan);
+        }
 
         beginResetModel();
-        visible_rows_.resize(0);
-        number_to_row_.fill(0);
-        foreach (PacketListRecord *record, sorted_visible_rows_) {
-            frame_data *fdata = record->frameData();
-
-            if (fdata->passed_dfilter || fdata->ref_time) {
-                visible_rows_ << record;
-                if (number_to_row_.size() <= (int)fdata->num) {
-                    number_to_row_.resize(fdata->num + 10000);
-                }
-                number_to_row_[fdata->num] = static_cast<int>(visible_rows_.count());
-            }
+        sorted_frames_ = sorted_frames;
+        number_to_row_.fill(0, frame_count_ + 1);
+        for (int row = 0; row < sorted_frames_.count(); row++) {
+            number_to_row_[sorted_frames_[row]] = row + 1;
         }
+        sorted_ = true;
         endResetModel();
     } catch (const SortAbort& e) {
         mainApp->pushStatus(MainApplication::TemporaryStatus, e.what());
@@ -760,18 +775,41 @@ bool PacketListModel::isNumericColumn(int column)
     return true;
 }
 
-bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
+bool PacketListModel::recordLessThan(uint32_t num1, uint32_t num2)
 {
     int cmp_val = 0;
     comps_++;
 
+    PacketListRecord r1(frame_data_sequence_find(sort_cap_file_->provider.frames, num1));
+    PacketListRecord r2(frame_data_sequence_find(sort_cap_file_->provider.frames, num2));
+
     // Wherein we try to cram the logic of packet_list_compare_records,
     // _packet_list_compare_records, and packet_list_compare_custom from
     // gtk/packet_list_store.c into one function
 
+    sortBusy(static_cast<int>(comps_/exp_comps_ * 100));
+    if (sort_column_ < 0) {
+        // No column.
+        cmp_val = frame_data_compare(sort_cap_file_->epan, r1.frameData(), r2.frameData(), COL_NUMBER);
+    } else {
+        // Column comes directly from frame data
+        cmp_val = frame_data_compare(sort_cap_file_->epan, r1.frameData(), r2.frameData(), sort_cap_file_->cinfo.columns[sort_column_].col_fmt);
+    }
+
+    if (sort_order_ == Qt::AscendingOrder) {
+        return cmp_val < 0;
+    } else {
+        return cmp_val > 0;
+    }
+}
+
+// Update the progress bar and process events if it's been a while, and bail
+// out if the user asked us to stop. Only call this from the GUI thread.
+void PacketListModel::sortBusy(int percent)
+{
     if (busy_timer_.elapsed() > busy_timeout_) {
         if (progress_frame_) {
-            progress_frame_->setValue(static_cast<int>(comps_/exp_comps_ * 100));
+            progress_frame_->setValue(percent);
         }
         // What's the least amount of processing that we can do which will draw
         // the busy indicator?
@@ -781,64 +819,177 @@ bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
         }
         busy_timer_.restart();
     }
-    if (sort_column_ < 0) {
-        // No column.
-        cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
-    } else if (text_sort_column_ < 0) {
-        // Column comes directly from frame data
-        cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), sort_cap_file_->cinfo.columns[sort_column_].col_fmt);
-    } else  {
-        QString r1String = r1->columnString(sort_cap_file_, sort_column_);
-        QString r2String = r2->columnString(sort_cap_file_, sort_column_);
-        // XXX: The naive string comparison compares Unicode code points.
-        // Proper collation is more expensive
-        cmp_val = r1String.compare(r2String);
-        if (cmp_val != 0 && sort_column_is_numeric_) {
-            // Custom column with numeric data (or something like a port number).
-            // Attempt to convert to numbers.
-            // XXX This is slow. Can we avoid doing this? Perhaps the actual
-            // values used for sorting should be cached too as QVariant[List].
-            // If so, we could consider using QCollatorSortKeys or similar
-            // for strings as well.
-            bool ok_r1, ok_r2;
-            double num_r1 = parseNumericColumn(r1String, &ok_r1);
-            double num_r2 = parseNumericColumn(r2String, &ok_r2);
+}
+
+namespace {
+
+// The sort key for one row when sorting by column text. The text itself
+// lives in a shared pool so that the keys stay small and fixed-size.
+struct ColumnSortKey {
+    size_t text_offset;
+    uint32_t text_len;
+    uint32_t frame_num;
+    double number;      // NaN if the column isn't numeric or didn't parse
+};
+
+// Compares keys without touching any shared state other than the (read-only)
+// text pool, so it can be used from several threads at once. Once the sort
+// is cancelled it considers everything equal so that the workers finish
+// quickly.
+class ColumnSortKeyLessThan
+{
+public:
+    ColumnSortKeyLessThan(const char *pool, bool numeric, Qt::SortOrder order,
+                          const std::atomic<bool> *cancelled) :
+        pool_(pool), numeric_(numeric), ascending_(order == Qt::AscendingOrder),
+        cancelled_(cancelled) {}
+
+    bool operator()(const ColumnSortKey &k1, const ColumnSortKey &k2) const
+    {
+        if (cancelled_->load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        // Comparing UTF-8 bytes orders by Unicode code point.
+        // XXX: Proper collation is more expensive
+        int cmp_val = memcmp(pool_ + k1.text_offset, pool_ + k2.text_offset,
+                             qMin(k1.text_len, k2.text_len));
+        if (cmp_val == 0 && k1.text_len != k2.text_len) {
+            cmp_val = k1.text_len < k2.text_len ? -1 : 1;
+        }
+
+        if (cmp_val != 0 && numeric_) {
+            // Custom column with numeric data (or something like a port
+            // number).
+            bool ok_r1 = !std::isnan(k1.number);
+            bool ok_r2 = !std::isnan(k2.number);
 
             if (!ok_r1 && !ok_r2) {
                 cmp_val = 0;
-            } else if (!ok_r1 || (ok_r2 && num_r1 < num_r2)) {
+            } else if (!ok_r1 || (ok_r2 && k1.number < k2.number)) {
                 // either r1 is invalid (and sort it before others) or both
                 // r1 and r2 are valid (sort normally)
                 cmp_val = -1;
-            } else if (!ok_r2 || (num_r1 > num_r2)) {
+            } else if (!ok_r2 || (k1.number > k2.number)) {
                 cmp_val = 1;
             }
         }
 
         if (cmp_val == 0) {
-            // All else being equal, compare column numbers.
-            cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
+            // All else being equal, compare frame numbers.
+            cmp_val = k1.frame_num < k2.frame_num ? -1 : (k1.frame_num > k2.frame_num ? 1 : 0);
         }
-    }
 
-    if (sort_order_ == Qt::AscendingOrder) {
-        return cmp_val < 0;
-    } else {
-        return cmp_val > 0;
+        return ascending_ ? cmp_val < 0 : cmp_val > 0;
     }
-}
 
-// Parses a field as a double. Handle values with suffixes ("12ms"), negative
-// values ("-1.23") and fields with multiple occurrences ("1,2"). Marks values
-// that do not contain any numeric value ("Unknown") as invalid.
-double PacketListModel::parseNumericColumn(const QString &val, bool *ok)
+private:
+    const char *pool_;
+    bool numeric_;
+    bool ascending_;
+    const std::atomic<bool> *cancelled_;
+};
+
+// Below this many rows the threads aren't worth it.
+const qsizetype parallel_sort_min_rows_ = 65536;
+
+} // namespace
+
+// Sort by a column that needs dissection. Dissection isn't reentrant, so we
+// first pull the column text (and, for numeric columns, its value) for every
+// row into a key array on this thread; that's also the part that can take a
+// while on a big capture, so it reports progress and can be stopped. The keys
+// are then sorted in chunks on the thread pool and the chunks merged pairwise.
+// Nothing here depends on the column text cache, so any number of rows can
+// be sorted.
+void PacketListModel::sortByColumnText(QVector<uint32_t> &frames)
 {
-    QByteArray ba = val.toUtf8();
-    const char *strval = ba.constData();
-    char *end = NULL;
-    double num = g_ascii_strtod(strval, &end);
-    *ok = strval != end;
-    return num;
+    qsizetype count = frames.count();
+    std::vector<char> pool;
+    QVector<ColumnSortKey> keys;
+    keys.reserve(count);
+
+    for (qsizetype i = 0; i < count; i++) {
+        PacketListRecord record(frame_data_sequence_find(sort_cap_file_->provider.frames, frames[i]));
+        QByteArray text = record.columnString(sort_cap_file_, sort_column_).toUtf8();
+        ColumnSortKey key;
+
+        key.text_offset = pool.size();
+        key.text_len = static_cast<uint32_t>(text.size());
+        key.frame_num = frames[i];
+        key.number = std::numeric_limits<double>::quiet_NaN();
+        if (sort_column_is_numeric_) {
+            // Handle values with suffixes ("12ms"), negative values ("-1.23")
+            // and fields with multiple occurrences ("1,2"). Values that do
+            // not contain any numeric value ("Unknown") stay NaN.
+            const char *strval = text.constData();
+            char *end = NULL;
+            double num = g_ascii_strtod(strval, &end);
+            if (end != strval) {
+                key.number = num;
+            }
+        }
+        pool.insert(pool.end(), text.constData(), text.constData() + text.size());
+        keys << key;
+
+        // Dissection is most of the work, so give it most of the bar.
+        sortBusy(static_cast<int>(i * 90 / count));
+    }
+
+    std::atomic<bool> cancelled(false);
+    ColumnSortKeyLessThan lessThan(pool.data(), sort_column_is_numeric_, sort_order_, &cancelled);
+    ColumnSortKey *src = keys.data();
+    QVector<ColumnSortKey> buffer(count);
+    ColumnSortKey *dst = buffer.data();
+
+    int chunks = count < parallel_sort_min_rows_ ? 1 : qMax(1, QThread::idealThreadCount());
+    QVector<qsizetype> bounds;
+    for (int c = 0; c <= chunks; c++) {
+        bounds << count * c / chunks;
+    }
+
+    // Wait for a batch of jobs, keeping the UI alive. If the user stops us,
+    // tell the workers and wait for them to wind down before bailing out.
+    auto waitForJobs = [&cancelled](QList<QFuture<void>> &jobs, int percent) {
+        for (QFuture<void> &job : jobs) {
+            while (!job.isFinished()) {
+                try {
+                    sortBusy(percent);
+                } catch (const SortAbort &) {
+                    cancelled = true;
+                }
+                QThread::msleep(5);
+            }
+        }
+        jobs.clear();
+        if (cancelled) {
+            throw SortAbort("Sorting aborted");
+        }
+    };
+
+    QList<QFuture<void>> jobs;
+    for (int c = 0; c < chunks; c++) {
+        qsizetype lo = bounds[c], hi = bounds[c + 1];
+        jobs << QtConcurrent::run([=]() { std::sort(src + lo, src + hi, lessThan); });
+    }
+    waitForJobs(jobs, 90);
+
+    int percent = 90;
+    for (int width = 1; width < chunks; width *= 2) {
+        for (int c = 0; c < chunks; c += 2 * width) {
+            qsizetype lo = bounds[c];
+            qsizetype mid = bounds[qMin(c + width, chunks)];
+            qsizetype hi = bounds[qMin(c + 2 * width, chunks)];
+            jobs << QtConcurrent::run([=]() { std::merge(src + lo, src + mid, src + mid, src + hi, dst + lo, lessThan); });
+        }
+        percent += (100 - percent) / 2;
+        waitForJobs(jobs, percent);
+        std::swap(src, dst);
+    }
+
+    for (qsizetype i = 0; i < count; i++) {
+        frames[i] = src[i].frame_num;
+    }
 }
 
 // ::data is const so we have to make changes here.
@@ -846,18 +997,19 @@ void PacketListModel::emitItemHeightChanged(const QModelIndex &ih_index)
 {
     if (!ih_index.isValid()) return;
 
-    PacketListRecord *record = static_cast<PacketListRecord*>(ih_index.internalPointer());
-    if (!record) return;
+    frame_data *fdata = static_cast<frame_data*>(ih_index.internalPointer());
+    if (!fdata) return;
 
-    if (record->lineCount() > max_line_count_) {
-        max_line_count_ = record->lineCount();
+    PacketListRecord record(fdata);
+    if (record.lineCount() > max_line_count_) {
+        max_line_count_ = record.lineCount();
         emit itemHeightChanged(ih_index);
     }
 }
 
 int PacketListModel::rowCount(const QModelIndex &) const
 {
-    return static_cast<int>(visible_rows_.count());
+    return visible_count_;
 }
 
 int PacketListModel::columnCount(const QModelIndex &) const
@@ -870,12 +1022,10 @@ QVariant PacketListModel::data(const QModelIndex &d_index, int role) const
     if (!d_index.isValid())
         return QVariant();
 
-    PacketListRecord *record = static_cast<PacketListRecord*>(d_index.internalPointer());
-    if (!record)
-        return QVariant();
-    const frame_data *fdata = record->frameData();
+    frame_data *fdata = static_cast<frame_data*>(d_index.internalPointer());
     if (!fdata)
         return QVariant();
+    PacketListRecord record(fdata);
 
     switch (role) {
     case Qt::TextAlignmentRole:
@@ -926,12 +1076,12 @@ QVariant PacketListModel::data(const QModelIndex &d_index, int role) const
     case Qt::DisplayRole:
     {
         int column = d_index.column();
-        QString column_string = record->columnString(cap_file_, column, true);
+        QString column_string = record.columnString(cap_file_, column, true);
         // We don't know an item's sizeHint until we fetch its text here.
         // Assume each line count is 1. If the line count changes, emit
         // itemHeightChanged which triggers another redraw (including a
         // fetch of SizeHintRole and DisplayRole) in the next event loop.
-        if (column == 0 && record->lineCountChanged() && record->lineCount() > max_line_count_) {
+        if (column == 0 && record.lineCountChanged() && record.lineCount() > max_line_count_) {
             emit maxLineCountChanged(d_index);
         }
         return column_string;
@@ -974,21 +1124,22 @@ QVariant PacketListModel::headerData(int section, Qt::Orientation orientation,
 
 void PacketListModel::flushVisibleRows()
 {
-    int pos = static_cast<int>(visible_rows_.count());
-
-    if (new_visible_rows_.count() > 0) {
-        beginInsertRows(QModelIndex(), pos, pos + static_cast<int>(new_visible_rows_.count()));
-        foreach (PacketListRecord *record, new_visible_rows_) {
-            frame_data *fdata = record->frameData();
-
-            visible_rows_ << record;
-            if (static_cast<unsigned int>(number_to_row_.size()) <= fdata->num) {
-                number_to_row_.resize(fdata->num + 10000);
+    int pos = visible_count_;
+
+    if (pending_count_ > 0) {
+        beginInsertRows(QModelIndex(), pos, pos + pending_count_ - 1);
+        if (sorted_) {
+            // New packets go at the end of a sorted list, as before.
+            number_to_row_.resize(frame_count_ + 1);
+            for (int row = pos; row < pos + pending_count_; row++) {
+                uint32_t num = static_cast<uint32_t>(visible_frames_.select(row));
+                sorted_frames_ << num;
+                number_to_row_[num] = row + 1;
             }
-            number_to_row_[fdata->num] = static_cast<int>(visible_rows_.count());
         }
+        visible_count_ += pending_count_;
+        pending_count_ = 0;
         endInsertRows();
-        new_visible_rows_.resize(0);
     }
 }
 
@@ -1008,13 +1159,13 @@ void PacketListModel::dissectIdle(bool reset)
 
     int first = idle_dissection_row_;
     while (idle_dissection_timer_->elapsed() < idle_dissection_interval_
-           && idle_dissection_row_ < physical_rows_.count()) {
+           && idle_dissection_row_ < static_cast<int>(frame_count_)) {
         ensureRowColorized(idle_dissection_row_);
         idle_dissection_row_++;
 //        if (idle_dissection_row_ % 1000 == 0) qDebug() << "=di row" << idle_dissection_row_;
     }
 
-    if (idle_dissection_row_ < physical_rows_.count()) {
+    if (idle_dissection_row_ < static_cast<int>(frame_count_)) {
         QTimer::singleShot(0, this, [=]() { dissectIdle(); });
     } else {
         idle_dissection_timer_->invalidate();
@@ -1028,7 +1179,6 @@ void PacketListModel::dissectIdle(bool reset)
 // line counts?
 int PacketListModel::appendPacket(frame_data *fdata)
 {
-    PacketListRecord *record = new PacketListRecord(fdata);
     qsizetype pos = -1;
 
 #ifdef DEBUG_PACKET_LIST_MODEL
@@ -1037,19 +1187,23 @@ int PacketListModel::appendPacket(frame_data *fdata)
     }
 #endif
 
-    physical_rows_ << record;
+    // Frames are appended in order, so the frame store already has
+    // everything else we need.
+    frame_count_ = fdata->num;
+    bool visible = fdata->passed_dfilter || fdata->ref_time;
+    visible_frames_.setBit(fdata->num, visible);
 
-    if (fdata->passed_dfilter || fdata->ref_time) {
-        new_visible_rows_ << record;
-        if (new_visible_rows_.count() < 2) {
+    if (visible) {
+        pending_count_++;
+        if (pending_count_ < 2) {
             // This is the first queued packet. Schedule an insertion for
             // the next UI update.
             QTimer::singleShot(0, this, &PacketListModel::flushVisibleRows);
         }
-        pos = static_cast<int>( visible_rows_.count() + new_visible_rows_.count() ) - 1;
+        pos = visible_count_ + pending_count_ - 1;
     }
 
-    emit packetAppended(cap_file_, fdata, physical_rows_.size() - 1);
+    emit packetAppended(cap_file_, fdata, frame_count_ - 1);
 
     return static_cast<int>(pos);
 }
@@ -1062,23 +1216,21 @@ frame_data *PacketListModel::getRowFdata(QModelIndex idx) const
 }
 
 frame_data *PacketListModel::getRowFdata(int row) const {
-    if (row < 0 || row >= visible_rows_.count())
+    if (row < 0 || row >= visible_count_)
         return NULL;
-    PacketListRecord *record = visible_rows_[row];
-    if (!record)
-        return NULL;
-    return record->frameData();
+    if (sorted_)
+        return frameAt(sorted_frames_[row]);
+    return frameAt(static_cast<uint32_t>(visible_frames_.select(row)));
 }
 
 void PacketListModel::ensureRowColorized(int row)
 {
-    if (row < 0 || row >= visible_rows_.count())
-        return;
-    PacketListRecord *record = visible_rows_[row];
-    if (!record)
+    frame_data *fdata = getRowFdata(row);
+    if (!fdata)
         return;
-    if (!record->colorized()) {
-        record->ensureColorized(cap_file_);
+    PacketListRecord record(fdata);
+    if (!record.colorized()) {
+        record.ensureColorized(cap_file_);
     }
 }
 
@@ -24,6 +24,8 @@
 
 #include "packet_list_record.h"
 
+#include <ui/qt/utils/rank_select_bitmap.h>
+
 #include "cfile.h"
 
 class QElapsedTimer;
@@ -96,11 +98,25 @@ public slots:
 private:
     capture_file *cap_file_;
     QList<QString> col_names_;
-    QVector<PacketListRecord *> physical_rows_;
-    QVector<PacketListRecord *> visible_rows_;
-    QVector<PacketListRecord *> new_visible_rows_;
+
+    // Rows aren't stored as objects. Frame n is the nth entry in the capture
+    // file's frame_data_sequence, and bit n of visible_frames_ says whether it
+    // is displayed. In frame order, row r is the frame with the rth set bit
+    // (select) and a frame's row is the number of set bits before it (rank).
+    // After a sort, sorted_frames_ holds the frame number for each row and
+    // number_to_row_ the (1-based) reverse mapping.
+    uint32_t frame_count_;
+    RankSelectBitmap visible_frames_;
+    // Rows the view knows about. Displayed frames beyond this are waiting for
+    // flushVisibleRows().
+    int visible_count_;
+    int pending_count_;
+    bool sorted_;
+    QVector<uint32_t> sorted_frames_;
     QVector<int> number_to_row_;
 
+    frame_data *frameAt(uint32_t num) const;
+
     int max_row_height_; // px
     int max_line_count_;
 
@@ -109,8 +125,9 @@ private:
     static int text_sort_column_;
     static Qt::SortOrder sort_order_;
     static capture_file *sort_cap_file_;
-    static bool recordLessThan(PacketListRecord *r1, PacketListRecord *r2);
-    static double parseNumericColumn(const QString &val, bool *ok);
+    static bool recordLessThan(uint32_t num1, uint32_t num2);
+    static void sortByColumnText(QVector<uint32_t> &frames);
+    static void sortBusy(int percent);
 
     static bool stop_flag_;
     static ProgressFrame *progress_frame_;
@@ -24,23 +24,34 @@
 
 #include <QStringList>
 
-QCache<uint32_t, QStringList> PacketListRecord::col_text_cache_(500);
+QCache<uint32_t, PacketListRecord::ColumnText> PacketListRecord::col_text_cache_(500);
 QMap<int, int> PacketListRecord::cinfo_column_;
-unsigned PacketListRecord::rows_color_ver_ = 1;
-
-PacketListRecord::PacketListRecord(frame_data *frameData) :
-    fdata_(frameData),
-    lines_(1),
-    line_count_changed_(false),
-    color_ver_(0),
-    colorized_(false),
-    conv_index_(0),
-    read_failed_(false)
+RankSelectBitmap PacketListRecord::colorized_frames_;
+RankSelectBitmap PacketListRecord::read_failed_frames_;
+
+unsigned int PacketListRecord::conversation() const
+{
+    ColumnText *col_text = col_text_cache_.object(fdata_->num);
+    return col_text ? col_text->conv_index : 0;
+}
+
+int PacketListRecord::lineCount() const
+{
+    ColumnText *col_text = col_text_cache_.object(fdata_->num);
+    return col_text ? col_text->lines : 1;
+}
+
+bool PacketListRecord::lineCountChanged() const
 {
+    ColumnText *col_text = col_text_cache_.object(fdata_->num);
+    return col_text ? col_text->line_count_changed : false;
 }
 
-PacketListRecord::~PacketListRecord()
+void PacketListRecord::clearAllRecords()
 {
+    col_text_cache_.clear();
+    colorized_frames_.clear();
+    read_failed_frames_.clear();
 }
 
 void PacketListRecord::ensureColorized(capture_file *cap_file)
@@ -52,7 +63,7 @@ void PacketListRecord::ensureColorized(capture_file *cap_file)
         return;
     }
 
-    bool dissect_color = !colorized_ || ( color_ver_ != rows_color_ver_ );
+    bool dissect_color = !colorized();
     if (dissect_color) {
         /* Dissect columns only if it won't evict anything from cache */
         bool dissect_columns = col_text_cache_.totalCost() < col_text_cache_.maxCost();
@@ -76,17 +87,17 @@ const QString PacketListRecord::columnString(capture_file *cap_file, int column,
     // have the ensureColorized() method to ensure that the record is
     // properly colorized?
     //
-    bool dissect_color = ( colorized && !colorized_ ) || ( color_ver_ != rows_color_ver_ );
-    QStringList *col_text = nullptr;
+    bool dissect_color = colorized && !this->colorized();
+    ColumnText *col_text = nullptr;
     if (!dissect_color) {
         col_text = col_text_cache_.object(fdata_->num);
     }
-    if (col_text == nullptr || column >= col_text->count() || col_text->at(column).isNull()) {
+    if (col_text == nullptr || column >= col_text->strings.count() || col_text->strings.at(column).isNull()) {
         dissect(cap_file, true, dissect_color);
         col_text = col_text_cache_.object(fdata_->num);
     }
 
-    return col_text ? col_text->at(column) : QString();
+    return col_text ? col_text->strings.at(column) : QString();
 }
 
 void PacketListRecord::resetColumns(column_info *cinfo)
@@ -126,13 +137,15 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_columns, boo
 
     wtap_rec_init(&rec);
     ws_buffer_init(&buf, 1514);
-    if (read_failed_) {
-        read_failed_ = !cf_read_record_no_alert(cap_file, fdata_, &rec, &buf);
+    bool read_failed;
+    if (read_failed_frames_.testBit(fdata_->num)) {
+        read_failed = !cf_read_record_no_alert(cap_file, fdata_, &rec, &buf);
     } else {
-        read_failed_ = !cf_read_record(cap_file, fdata_, &rec, &buf);
+        read_failed = !cf_read_record(cap_file, fdata_, &rec, &buf);
     }
+    read_failed_frames_.setBit(fdata_->num, read_failed);
 
-    if (read_failed_) {
+    if (read_failed) {
         /*
          * Error reading the record.
          *
@@ -146,11 +159,11 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_columns, boo
         if (dissect_columns) {
             col_fill_in_error(cinfo, fdata_, false, false /* fill_fd_columns */);
 
-            cacheColumnStrings(cinfo);
+            cacheColumnStrings(cinfo, 0);
         }
         if (dissect_color) {
             fdata_->color_filter = NULL;
-            colorized_ = true;
+            colorized_frames_.setBit(fdata_->num);
         }
         ws_buffer_free(&buf);
         wtap_rec_cleanup(&rec);
@@ -193,37 +206,41 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_columns, boo
                      frame_tvbuff_new_buffer(&cap_file->provider, fdata_, &buf),
                      fdata_, cinfo);
 
+    struct conversation * conv = find_conversation_pinfo_ro(&edt.pi, 0);
+    unsigned int conv_index = ! conv ? 0 : conv->conv_index;
+
     if (dissect_columns) {
         /* "Stringify" non frame_data vals */
         epan_dissect_fill_in_columns(&edt, false, false /* fill_fd_columns */);
-        cacheColumnStrings(cinfo);
+        cacheColumnStrings(cinfo, conv_index);
+    } else {
+        ColumnText *col_text = col_text_cache_.object(fdata_->num);
+        if (col_text) {
+            col_text->conv_index = conv_index;
+        }
     }
 
     if (dissect_color) {
-        colorized_ = true;
-        color_ver_ = rows_color_ver_;
+        colorized_frames_.setBit(fdata_->num);
     }
 
-    struct conversation * conv = find_conversation_pinfo_ro(&edt.pi, 0);
-
-    conv_index_ = ! conv ? 0 : conv->conv_index;
-
     epan_dissect_cleanup(&edt);
     ws_buffer_free(&buf);
     wtap_rec_cleanup(&rec);
 }
 
-void PacketListRecord::cacheColumnStrings(column_info *cinfo)
+void PacketListRecord::cacheColumnStrings(column_info *cinfo, unsigned int conv_index)
 {
     // packet_list_store.c:packet_list_change_record(PacketList *packet_list, PacketListRecord *record, int col, column_info *cinfo)
     if (!cinfo) {
         return;
     }
 
-    QStringList *col_text = new QStringList();
+    ColumnText *col_text = new ColumnText();
 
-    lines_ = 1;
-    line_count_changed_ = false;
+    col_text->lines = 1;
+    col_text->line_count_changed = false;
+    col_text->conv_index = conv_index;
 
     for (int column = 0; column < cinfo->num_cols; ++column) {
         int col_lines = 1;
@@ -235,11 +252,11 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
         }
 
         col_str = QString(get_column_text(cinfo, column));
-        *col_text << col_str;
+        col_text->strings << col_str;
         col_lines = static_cast<int>(col_str.count('\n'));
-        if (col_lines > lines_) {
-            lines_ = col_lines;
-            line_count_changed_ = true;
+        if (col_lines > col_text->lines) {
+            col_text->lines = col_lines;
+            col_text->line_count_changed = true;
         }
     }
 
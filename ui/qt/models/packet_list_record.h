@@ -17,19 +17,29 @@
 #include <epan/column.h>
 #include <epan/packet.h>
 
+#include <ui/qt/utils/rank_select_bitmap.h>
+
 #include <QByteArray>
 #include <QCache>
 #include <QList>
+#include <QStringList>
 #include <QVariant>
 
 struct conversation;
 struct _GStringChunk;
 
+/*
+ * A lightweight handle for one frame in the packet list. Records aren't
+ * stored anywhere; the model creates one on the stack when it needs to get at
+ * a frame's column text or colorization. Everything that has to outlive the
+ * handle is kept in shared, per-file state: column text (along with the line
+ * count and conversation that come out of the same dissection) in a bounded
+ * cache, and the colorized and read-failed flags in per-frame bitmaps.
+ */
 class PacketListRecord
 {
 public:
-    PacketListRecord(frame_data *frameData);
-    virtual ~PacketListRecord();
+    PacketListRecord(frame_data *frameData) : fdata_(frameData) {}
 
     // Ensure that the record is colorized.
     void ensureColorized(capture_file *cap_file);
@@ -38,12 +48,13 @@ public:
     frame_data *frameData() const { return fdata_; }
     // packet_list->col_to_text in gtk/packet_list_store.c
     static int textColumn(int column) { return cinfo_column_.value(column, -1); }
-    bool colorized() { return colorized_ && (color_ver_ == rows_color_ver_); }
-    unsigned int conversation() { return conv_index_; }
+    bool colorized() const { return colorized_frames_.testBit(fdata_->num); }
+    // The conversation found when the columns were last dissected, or 0.
+    unsigned int conversation() const;
 
     int columnTextSize(const char *str);
 
-    void invalidateColorized() { colorized_ = false; }
+    void invalidateColorized() { colorized_frames_.setBit(fdata_->num, false); }
     void invalidateRecord() { col_text_cache_.remove(fdata_->num); }
     static void invalidateAllRecords() { col_text_cache_.clear(); }
     /* In Qt 6, QCache maxCost is a qsizetype, but the QAbstractItemModel
@@ -51,32 +62,36 @@ public:
      */
     static void setMaxCache(int cost) { col_text_cache_.setMaxCost(cost); }
     static void resetColumns(column_info *cinfo);
-    static void resetColorization() { rows_color_ver_++; }
+    static void resetColorization() { colorized_frames_.clearBits(); }
+    // Forget everything about every frame, e.g. when the file is closed.
+    static void clearAllRecords();
 
-    inline int lineCount() { return lines_; }
-    inline int lineCountChanged() { return line_count_changed_; }
+    int lineCount() const;
+    bool lineCountChanged() const;
 
 private:
-    /** The column text for some columns */
-    static QCache<uint32_t, QStringList> col_text_cache_;
+    struct ColumnText {
+        QStringList strings;
+        int lines;
+        bool line_count_changed;
+        /** Conversation. Used by RelatedPacketDelegate */
+        unsigned int conv_index;
+    };
 
-    frame_data *fdata_;
-    int lines_;
-    bool line_count_changed_;
+    /** The column text for some columns */
+    static QCache<uint32_t, ColumnText> col_text_cache_;
     static QMap<int, int> cinfo_column_;
 
-    /** Has this record been colorized? */
-    static unsigned int rows_color_ver_;
-    unsigned int color_ver_;
-    bool colorized_;
-
-    /** Conversation. Used by RelatedPacketDelegate */
-    unsigned int conv_index_;
+    /** Frames that have been colorized since the last resetColorization(),
+     *  indexed by frame number */
+    static RankSelectBitmap colorized_frames_;
+    /** Frames we couldn't read the last time we tried */
+    static RankSelectBitmap read_failed_frames_;
 
-    bool read_failed_;
+    frame_data *fdata_;
 
     void dissect(capture_file *cap_file, bool dissect_columns, bool dissect_color = false);
-    void cacheColumnStrings(column_info *cinfo);
+    void cacheColumnStrings(column_info *cinfo, unsigned int conv_index);
 };
 
 #endif // PACKET_LIST_RECORD_H
@@ -79,11 +79,11 @@ void RelatedPacketDelegate::paint(QPainter *painter, const QStyleOptionViewItem
         last_frame = (int) conv_->last_frame;
     }
 
-    const frame_data *fd;
-    PacketListRecord *record = static_cast<PacketListRecord*>(index.internalPointer());
-    if (!record || (fd = record->frameData()) == NULL) {
+    frame_data *fd = static_cast<frame_data*>(index.internalPointer());
+    if (fd == NULL) {
         return;
     }
+    PacketListRecord record(fd);
 
     ct_conversation_trace_type_t conversation_trace_type = CT_NONE;
     ft_framenum_type_t related_frame_type =
@@ -94,7 +94,7 @@ void RelatedPacketDelegate::paint(QPainter *painter, const QStyleOptionViewItem
             conversation_trace_type = CT_STARTING;
         } else if (fd->num > setup_frame && fd->num < last_frame) {
             conversation_trace_type =
-                conv_->conv_index == record->conversation() ?  CT_CONTINUING : CT_BYPASSING;
+                conv_->conv_index == record.conversation() ?  CT_CONTINUING : CT_BYPASSING;
         } else if (fd->num == last_frame) {
             conversation_trace_type = CT_ENDING;
         }
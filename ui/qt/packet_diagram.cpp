@@ -174,7 +174,14 @@ public:
                        .arg(finfo_->headerInfo().abbreviation)
                        .arg(finfo_->toString()));
             setData(Qt::UserRole, VariantPointer<field_info>::asQVariant(finfo_->fieldInfo()));
-            representation_ = fi->rep->representation;
+            proto_item_render_label(fi);
+            if (fi->rep) {
+                representation_ = fi->rep->representation;
+            } else {
+                char label_str[ITEM_LABEL_LENGTH];
+                proto_item_fill_label(fi, label_str);
+                representation_ = label_str;
+            }
         } else {
             setToolTip(QObject::tr("Gap in dissection"));
         }
@@ -0,0 +1,178 @@
+/* test_qtui.cpp
+ * Unit tests for the Qt UI helpers that don't need a UI
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include <ui/qt/utils/rank_select_bitmap.h>
+
+#include <QVector>
+
+/*
+ * Check rank() and select() at every position against a plain copy of
+ * the bits.
+ */
+static void
+check_rank_select(const RankSelectBitmap &bitmap, const QVector<bool> &bits)
+{
+    qsizetype ones = 0;
+
+    g_assert_cmpint(bitmap.size(), ==, bits.size());
+    for (qsizetype pos = 0; pos < bits.size(); pos++) {
+        g_assert_cmpint(bitmap.testBit(pos), ==, bits[pos]);
+        g_assert_cmpint(bitmap.rank(pos), ==, ones);
+        if (bits[pos]) {
+            g_assert_cmpint(bitmap.select(ones), ==, pos);
+            ones++;
+        }
+    }
+    g_assert_cmpint(bitmap.rank(bits.size()), ==, ones);
+    g_assert_cmpint(bitmap.rank(bits.size() + 1), ==, ones);
+    g_assert_cmpint(bitmap.count(), ==, ones);
+    g_assert_cmpint(bitmap.select(ones), ==, -1);
+    g_assert_cmpint(bitmap.select(-1), ==, -1);
+}
+
+static void
+test_rank_select_empty(void)
+{
+    RankSelectBitmap bitmap;
+
+    check_rank_select(bitmap, QVector<bool>());
+    g_assert_cmpint(bitmap.rank(-1), ==, 0);
+    g_assert_false(bitmap.testBit(0));
+
+    /* Bits that are all clear, up to a word and a block boundary */
+    for (qsizetype size : { 1, 64, 512, 513 }) {
+        bitmap.clear();
+        for (qsizetype pos = 0; pos < size; pos++) {
+            bitmap.append(false);
+        }
+        check_rank_select(bitmap, QVector<bool>(size, false));
+    }
+}
+
+/*
+ * Sizes just around the ends of a 64-bit word and of a block of 512 bits,
+ * so that the last word is full, partly used or holds a single bit.
+ */
+static const qsizetype rank_select_sizes[] = {
+    1, 63, 64, 65, 127, 128, 129, 511, 512, 513, 1023, 1024, 1025, 1500,
+};
+
+static void
+test_rank_select_full(void)
+{
+    for (qsizetype size : rank_select_sizes) {
+        RankSelectBitmap bitmap;
+
+        for (qsizetype pos = 0; pos < size; pos++) {
+            bitmap.append(true);
+        }
+        check_rank_select(bitmap, QVector<bool>(size, true));
+        g_assert_cmpint(bitmap.select(size - 1), ==, size - 1);
+    }
+}
+
+static void
+test_rank_select_pattern(void)
+{
+    for (qsizetype size : rank_select_sizes) {
+        RankSelectBitmap bitmap;
+        QVector<bool> bits;
+        guint32 seed = 1;
+
+        bitmap.reserve(size);
+        for (qsizetype pos = 0; pos < size; pos++) {
+            seed = seed * 1103515245 + 12345;
+            /* Set the bits on either side of each word boundary */
+            bool value = (seed >> 16) % 3 == 0 || pos % 64 == 0 || pos % 64 == 63;
+            bitmap.append(value);
+            bits.append(value);
+        }
+        check_rank_select(bitmap, bits);
+
+        /* Changing bits in the middle updates the counts after them */
+        for (qsizetype pos : { 0, 63, 64, 511, 512, 700 }) {
+            if (pos < size) {
+                bitmap.setBit(pos, !bits[pos]);
+                bits[pos] = !bits[pos];
+                check_rank_select(bitmap, bits);
+            }
+        }
+
+        /* Appending after a change in the middle */
+        bitmap.setBit(0, !bits[0]);
+        bits[0] = !bits[0];
+        for (int i = 0; i < 600; i++) {
+            bitmap.append(i % 5 == 0);
+            bits.append(i % 5 == 0);
+        }
+        check_rank_select(bitmap, bits);
+
+        bitmap.clearBits();
+        check_rank_select(bitmap, QVector<bool>(bits.size(), false));
+    }
+}
+
+static void
+test_rank_select_set_bit_grows(void)
+{
+    RankSelectBitmap bitmap;
+    QVector<bool> bits(1030, false);
+
+    bitmap.setBit(1029);
+    bits[1029] = true;
+    check_rank_select(bitmap, bits);
+
+    bitmap.setBit(5);
+    bits[5] = true;
+    bitmap.setBit(1029, false);
+    bits[1029] = false;
+    check_rank_select(bitmap, bits);
+}
+
+/*
+ * The packet list's use: bit n stands for frame n, so bit 0 (the
+ * nonexistent frame 0) is never set, rank() of the frame number is the
+ * row and select() of the row is the frame number.
+ */
+static void
+test_rank_select_frames(void)
+{
+    RankSelectBitmap visible;
+
+    visible.append(false);
+    for (guint32 frame = 1; frame <= 1000; frame++) {
+        visible.append(frame % 4 != 0);
+    }
+
+    g_assert_cmpint(visible.rank(1), ==, 0);
+    g_assert_cmpint(visible.select(0), ==, 1);
+    g_assert_cmpint(visible.rank(5), ==, 3);
+    g_assert_cmpint(visible.select(3), ==, 5);
+    g_assert_cmpint(visible.count(), ==, 750);
+    g_assert_cmpint(visible.select(749), ==, 999);
+}
+
+int main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/rank_select_bitmap/empty", test_rank_select_empty);
+    g_test_add_func("/rank_select_bitmap/full", test_rank_select_full);
+    g_test_add_func("/rank_select_bitmap/pattern", test_rank_select_pattern);
+    g_test_add_func("/rank_select_bitmap/set_bit_grows", test_rank_select_set_bit_grows);
+    g_test_add_func("/rank_select_bitmap/frames", test_rank_select_frames);
+
+    return g_test_run();
+}
+
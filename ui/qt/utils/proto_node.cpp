@@ -67,6 +67,7 @@ QString ProtoNode::labelText() const
     }
 
     QString label;
+    proto_item_render_label(fi);
     /* was a free format label produced? */
     if (fi->rep) {
         label = fi->rep->representation;
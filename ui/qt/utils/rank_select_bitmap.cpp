@@ -0,0 +1,199 @@
+/* rank_select_bitmap.cpp
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <ui/qt/utils/rank_select_bitmap.h>
+
+#include <QtAlgorithms>
+
+RankSelectBitmap::RankSelectBitmap() :
+    stale_block_(0),
+    size_(0)
+{
+}
+
+void RankSelectBitmap::clear()
+{
+    words_.clear();
+    block_ranks_.clear();
+    stale_block_ = 0;
+    size_ = 0;
+}
+
+void RankSelectBitmap::reserve(qsizetype bits)
+{
+    qsizetype words = (bits + word_bits_ - 1) / word_bits_;
+    words_.reserve(words);
+    block_ranks_.reserve((words + block_words_ - 1) / block_words_);
+}
+
+qsizetype RankSelectBitmap::count() const
+{
+    if (words_.isEmpty()) {
+        return 0;
+    }
+    return rank(size_);
+}
+
+void RankSelectBitmap::append(bool value)
+{
+    qsizetype word = size_ / word_bits_;
+
+    if (word == words_.size()) {
+        if (word % block_words_ == 0) {
+            // Starting a new block. If everything before it is up to date,
+            // this one's count is cheap to get.
+            qsizetype block = word / block_words_;
+            quint32 before = 0;
+            if (block > 0 && stale_block_ >= block) {
+                before = block_ranks_[block - 1];
+                for (qsizetype i = word - block_words_; i < word; i++) {
+                    before += qPopulationCount(words_[i]);
+                }
+            }
+            block_ranks_.append(before);
+            if (stale_block_ >= block) {
+                stale_block_ = block + 1;
+            }
+        }
+        words_.append(0);
+    }
+
+    if (value) {
+        words_[word] |= Q_UINT64_C(1) << (size_ % word_bits_);
+    }
+    size_++;
+}
+
+void RankSelectBitmap::setBit(qsizetype pos, bool value)
+{
+    while (pos >= size_) {
+        append(false);
+    }
+
+    quint64 mask = Q_UINT64_C(1) << (pos % word_bits_);
+    quint64 &word = words_[pos / word_bits_];
+    if (((word & mask) != 0) == value) {
+        return;
+    }
+    if (value) {
+        word |= mask;
+    } else {
+        word &= ~mask;
+    }
+
+    // Counts for the blocks after this one are now off by one.
+    qsizetype block = pos / word_bits_ / block_words_;
+    if (block + 1 < stale_block_) {
+        stale_block_ = block + 1;
+    }
+}
+
+bool RankSelectBitmap::testBit(qsizetype pos) const
+{
+    if (pos < 0 || pos >= size_) {
+        return false;
+    }
+    return (words_[pos / word_bits_] >> (pos % word_bits_)) & 1;
+}
+
+void RankSelectBitmap::clearBits()
+{
+    words_.fill(0);
+    block_ranks_.fill(0);
+    stale_block_ = block_ranks_.size();
+}
+
+void RankSelectBitmap::updateBlockRanks() const
+{
+    qsizetype blocks = block_ranks_.size();
+
+    if (stale_block_ >= blocks) {
+        return;
+    }
+
+    qsizetype block = stale_block_ > 0 ? stale_block_ : 1;
+    if (stale_block_ == 0 && blocks > 0) {
+        block_ranks_[0] = 0;
+    }
+    for (; block < blocks; block++) {
+        quint32 ones = block_ranks_[block - 1];
+        for (qsizetype i = (block - 1) * block_words_; i < block * block_words_; i++) {
+            ones += qPopulationCount(words_[i]);
+        }
+        block_ranks_[block] = ones;
+    }
+    stale_block_ = blocks;
+}
+
+qsizetype RankSelectBitmap::rank(qsizetype pos) const
+{
+    if (pos > size_) {
+        pos = size_;
+    }
+    if (pos <= 0) {
+        return 0;
+    }
+
+    updateBlockRanks();
+
+    qsizetype word = pos / word_bits_;
+    qsizetype block = word / block_words_;
+    qsizetype ones = 0;
+
+    // pos can be one past the last word when size_ is a multiple of 64.
+    if (block < block_ranks_.size()) {
+        ones = block_ranks_[block];
+    } else {
+        block = block_ranks_.size() - 1;
+        ones = block_ranks_[block];
+    }
+    for (qsizetype i = block * block_words_; i < word && i < words_.size(); i++) {
+        ones += qPopulationCount(words_[i]);
+    }
+    if (pos % word_bits_ && word < words_.size()) {
+        quint64 mask = (Q_UINT64_C(1) << (pos % word_bits_)) - 1;
+        ones += qPopulationCount(words_[word] & mask);
+    }
+    return ones;
+}
+
+qsizetype RankSelectBitmap::select(qsizetype rank) const
+{
+    if (rank < 0 || block_ranks_.isEmpty()) {
+        return -1;
+    }
+
+    updateBlockRanks();
+
+    // Find the last block that starts at or before the wanted bit.
+    qsizetype lo = 0, hi = block_ranks_.size() - 1;
+    while (lo < hi) {
+        qsizetype mid = lo + (hi - lo + 1) / 2;
+        if (block_ranks_[mid] <= rank) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    qsizetype remaining = rank - block_ranks_[lo];
+    qsizetype end = qMin((lo + 1) * block_words_, static_cast<qsizetype>(words_.size()));
+    for (qsizetype i = lo * block_words_; i < end; i++) {
+        quint64 word = words_[i];
+        qsizetype ones = qPopulationCount(word);
+        if (remaining < ones) {
+            while (remaining-- > 0) {
+                word &= word - 1;
+            }
+            return i * word_bits_ + qCountTrailingZeroBits(word);
+        }
+        remaining -= ones;
+    }
+    return -1;
+}
@@ -0,0 +1,67 @@
+/** @file
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef RANK_SELECT_BITMAP_H
+#define RANK_SELECT_BITMAP_H
+
+#include <QVector>
+
+/**
+ * @brief A growable bitmap that can count the set bits before a position
+ * (rank) and find the position of the nth set bit (select).
+ *
+ * The packet list uses this to map between frame numbers and visible rows
+ * without keeping a per-row table: bit n is set if frame n is visible (bit
+ * 0, for the nonexistent frame 0, is always clear), rank() turns a frame
+ * number into a row and select() turns a row into a frame number.
+ *
+ * A running count of set bits is kept every 512 bits, which costs about 6%
+ * on top of the bitmap itself. Appending keeps the counts up to date;
+ * changing a bit in the middle marks them stale from that point on and they
+ * are recomputed on the next rank() or select().
+ */
+class RankSelectBitmap
+{
+public:
+    RankSelectBitmap();
+
+    void clear();
+    void reserve(qsizetype bits);
+
+    qsizetype size() const { return size_; }
+    /** The total number of set bits. */
+    qsizetype count() const;
+
+    void append(bool value);
+    /** Set or clear a bit, growing the bitmap if needed. */
+    void setBit(qsizetype pos, bool value = true);
+    bool testBit(qsizetype pos) const;
+    /** Clear every bit without changing the size. */
+    void clearBits();
+
+    /** The number of set bits in [0, pos). */
+    qsizetype rank(qsizetype pos) const;
+    /** The position of the set bit with the given rank, or -1. */
+    qsizetype select(qsizetype rank) const;
+
+private:
+    static const int word_bits_ = 64;
+    static const int block_words_ = 8;
+
+    QVector<quint64> words_;
+    // Set bits before the start of each block.
+    mutable QVector<quint32> block_ranks_;
+    // The first block whose entry in block_ranks_ may be wrong.
+    mutable qsizetype stale_block_;
+    qsizetype size_;
+
+    void updateBlockRanks() const;
+};
+
+#endif // RANK_SELECT_BITMAP_H
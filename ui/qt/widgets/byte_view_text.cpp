@@ -14,8 +14,6 @@
 
 #include <wsutil/str_util.h>
 
-#include <wsutil/utf8_entities.h>
-
 #include <ui/qt/utils/color_utils.h>
 #include "main_application.h"
 #include "ui/recent.h"
@@ -425,10 +423,6 @@ void ByteViewText::drawLine(QPainter *painter, const int offset, const int row_y
     int max_tvb_pos = qMin(offset + row_width_, tvb_len) - 1;
     QList<QTextLayout::FormatRange> fmt_list;
 
-    static const char hexchars[16] = {
-        '0', '1', '2', '3', '4', '5', '6', '7',
-        '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
-
     QString line;
     HighlightMode offset_mode = ModeOffsetNormal;
 
@@ -445,64 +439,58 @@ void ByteViewText::drawLine(QPainter *painter, const int offset, const int row_y
         int ascii_start = static_cast<int>(line.length()) + DataPrinter::hexChars() + 3;
         // Extra hover space before and after each byte.
         int slop = em_width_ / 2;
-        unsigned char c;
+        hex_dump_bytes_fmt bytes_fmt;
+
+        switch (recent.gui_bytes_view) {
+        case BYTES_HEX:
+            bytes_fmt = HEXDUMP_BYTES_HEX;
+            break;
+        case BYTES_BITS:
+            /* XXX, bitmask */
+            bytes_fmt = HEXDUMP_BYTES_BITS;
+            break;
+        case BYTES_DEC:
+            bytes_fmt = HEXDUMP_BYTES_DEC;
+            break;
+        case BYTES_OCT:
+            bytes_fmt = HEXDUMP_BYTES_OCT;
+            break;
+        default:
+            ws_assert_not_reached();
+        }
+        int byte_chars = static_cast<int>(hex_dump_byte_chars(bytes_fmt));
+
+        // Format the whole row at once, inserting a space every
+        // separator_interval_ bytes, and append it in one go.
+        char hex_buf[HEXDUMP_BYTES_PER_LINE * 10];
+        char *hex_end = hex_buf;
+        for (int tvb_pos = offset; tvb_pos <= max_tvb_pos; tvb_pos += separator_interval_) {
+            if (tvb_pos != offset) {
+                *hex_end++ = ' ';
+            }
+            hex_end = hex_dump_format_bytes(hex_end, reinterpret_cast<const uint8_t *>(data_.constData()) + tvb_pos,
+                                            qMin(separator_interval_, max_tvb_pos + 1 - tvb_pos), bytes_fmt);
+        }
+        int hex_start = static_cast<int>(line.length());
+        line += QString::fromLatin1(hex_buf, static_cast<int>(hex_end - hex_buf));
 
         if (build_x_pos) {
             x_pos_to_column_ += QVector<int>().fill(-1, slop);
         }
 
-        for (int tvb_pos = offset; tvb_pos <= max_tvb_pos; tvb_pos++) {
-            line += ' ';
-            /* insert a space every separator_interval_ bytes */
-            if ((tvb_pos != offset) && ((tvb_pos % separator_interval_) == 0)) {
-                line += ' ';
-                x_pos_to_column_ += QVector<int>().fill(tvb_pos - offset - 1, em_width_);
-            }
+        for (int col = 0; col <= max_tvb_pos - offset; col++) {
+            // Index just past this byte's digits.
+            int byte_end = hex_start + (col + 1) * (byte_chars + 1) + col / separator_interval_;
 
-            switch (recent.gui_bytes_view) {
-            case BYTES_HEX:
-                line += hexchars[(data_[tvb_pos] & 0xf0) >> 4];
-                line += hexchars[data_[tvb_pos] & 0x0f];
-                break;
-            case BYTES_BITS:
-                /* XXX, bitmask */
-                for (int j = 7; j >= 0; j--) {
-                    line += (data_[tvb_pos] & (1 << j)) ? '1' : '0';
-                }
-                break;
-            case BYTES_DEC:
-                c = data_[tvb_pos];
-                line += c < 100 ? ' ' : hexchars[c / 100];
-                line += c < 10 ? ' ' : hexchars[(c / 10) % 10];
-                line += hexchars[c % 10];
-                break;
-            case BYTES_OCT:
-                line += hexchars[(data_[tvb_pos] & 0xc0) >> 6];
-                line += hexchars[(data_[tvb_pos] & 0x38) >> 3];
-                line += hexchars[data_[tvb_pos] & 0x07];
-                break;
-            }
             if (build_x_pos) {
-                x_pos_to_column_ += QVector<int>().fill(tvb_pos - offset, stringWidth(line) - x_pos_to_column_.size() + slop);
-            }
-            if (tvb_pos == hovered_byte_offset_ || tvb_pos == marked_byte_offset_) {
-                int ho_len;
-                switch (recent.gui_bytes_view) {
-                case BYTES_HEX:
-                    ho_len = 2;
-                    break;
-                case BYTES_BITS:
-                    ho_len = 8;
-                    break;
-                case BYTES_DEC:
-                case BYTES_OCT:
-                    ho_len = 3;
-                    break;
-                default:
-                    ws_assert_not_reached();
+                if (col != 0 && (col % separator_interval_) == 0) {
+                    x_pos_to_column_ += QVector<int>().fill(col - 1, em_width_);
                 }
-                QRect ho_rect = painter->boundingRect(QRect(), Qt::AlignHCenter|Qt::AlignVCenter, line.right(ho_len));
-                ho_rect.moveRight(stringWidth(line));
+                x_pos_to_column_ += QVector<int>().fill(col, stringWidth(line.left(byte_end)) - x_pos_to_column_.size() + slop);
+            }
+            if (offset + col == hovered_byte_offset_ || offset + col == marked_byte_offset_) {
+                QRect ho_rect = painter->boundingRect(QRect(), Qt::AlignHCenter|Qt::AlignVCenter, line.mid(byte_end - byte_chars, byte_chars));
+                ho_rect.moveRight(stringWidth(line.left(byte_end)));
                 ho_rect.moveTop(row_y);
                 hover_outlines_.append(ho_rect);
             }
@@ -521,53 +509,56 @@ void ByteViewText::drawLine(QPainter *painter, const int offset, const int row_y
 
     // ASCII
     if (show_ascii_) {
-        bool in_non_printable = false;
+        hex_dump_enc char_enc = HEXDUMP_ENC_ASCII;
         int np_start = 0;
         int np_len = 0;
-        char c;
-
-        for (int tvb_pos = offset; tvb_pos <= max_tvb_pos; tvb_pos++) {
-            /* insert a space every separator_interval_ bytes */
-            if ((tvb_pos != offset) && ((tvb_pos % separator_interval_) == 0)) {
-                line += ' ';
-                if (build_x_pos) {
-                    x_pos_to_column_ += QVector<int>().fill(tvb_pos - offset - 1, em_width_ / 2);
-                }
-            }
 
-            if (recent.gui_bytes_encoding != BYTES_ENC_EBCDIC && encoding_ == PACKET_CHAR_ENC_CHAR_ASCII) {
-                c = data_[tvb_pos];
-            } else {
-                c = EBCDIC_to_ASCII1(data_[tvb_pos]);
+        if (recent.gui_bytes_encoding == BYTES_ENC_EBCDIC || encoding_ != PACKET_CHAR_ENC_CHAR_ASCII) {
+            char_enc = HEXDUMP_ENC_EBCDIC;
+        }
+
+        // Non-printable characters are shown as a middle dot, which is
+        // 0xb7 in ISO 8859-1.
+        const char non_printable = '\xb7';
+        char ascii_buf[HEXDUMP_BYTES_PER_LINE * 2];
+        char *ascii_end = ascii_buf;
+        for (int tvb_pos = offset; tvb_pos <= max_tvb_pos; tvb_pos += separator_interval_) {
+            if (tvb_pos != offset) {
+                *ascii_end++ = ' ';
             }
+            ascii_end = hex_dump_format_chars(ascii_end, reinterpret_cast<const uint8_t *>(data_.constData()) + tvb_pos,
+                                              qMin(separator_interval_, max_tvb_pos + 1 - tvb_pos), char_enc, non_printable);
+        }
+        int chars_start = static_cast<int>(line.length());
+        line += QString::fromLatin1(ascii_buf, static_cast<int>(ascii_end - ascii_buf));
 
-            if (g_ascii_isprint(c)) {
-                line += c;
-                if (in_non_printable) {
-                    in_non_printable = false;
-                    addAsciiFormatRange(fmt_list, np_start, np_len, offset, max_tvb_pos, ModeNonPrintable);
-                }
-            } else {
-                line += UTF8_MIDDLE_DOT;
-                if (!in_non_printable) {
-                    in_non_printable = true;
-                    np_start = tvb_pos;
-                    np_len = 1;
-                } else {
-                    np_len++;
+        for (int col = 0; col <= max_tvb_pos - offset; col++) {
+            // Index of this byte's character.
+            int char_pos = col + col / separator_interval_;
+
+            if (ascii_buf[char_pos] == non_printable) {
+                if (np_len == 0) {
+                    np_start = offset + col;
                 }
+                np_len++;
+            } else if (np_len > 0) {
+                addAsciiFormatRange(fmt_list, np_start, np_len, offset, max_tvb_pos, ModeNonPrintable);
+                np_len = 0;
             }
             if (build_x_pos) {
-                x_pos_to_column_ += QVector<int>().fill(tvb_pos - offset, stringWidth(line) - x_pos_to_column_.size());
+                if (col != 0 && (col % separator_interval_) == 0) {
+                    x_pos_to_column_ += QVector<int>().fill(col - 1, em_width_ / 2);
+                }
+                x_pos_to_column_ += QVector<int>().fill(col, stringWidth(line.left(chars_start + char_pos + 1)) - x_pos_to_column_.size());
             }
-            if (tvb_pos == hovered_byte_offset_ || tvb_pos == marked_byte_offset_) {
-                QRect ho_rect = painter->boundingRect(QRect(), 0, line.right(1));
-                ho_rect.moveRight(stringWidth(line));
+            if (offset + col == hovered_byte_offset_ || offset + col == marked_byte_offset_) {
+                QRect ho_rect = painter->boundingRect(QRect(), 0, line.mid(chars_start + char_pos, 1));
+                ho_rect.moveRight(stringWidth(line.left(chars_start + char_pos + 1)));
                 ho_rect.moveTop(row_y);
                 hover_outlines_.append(ho_rect);
             }
         }
-        if (in_non_printable) {
+        if (np_len > 0) {
             addAsciiFormatRange(fmt_list, np_start, np_len, offset, max_tvb_pos, ModeNonPrintable);
         }
         addAsciiFormatRange(fmt_list, proto_start_, proto_len_, offset, max_tvb_pos, ModeProtocol);
@@ -0,0 +1,232 @@
+/* test_ui.c
+ * Unit tests for the UI helpers that don't need a UI
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include <string.h>
+
+#include <epan/epan_test_fixture.h>
+#include <epan/proto.h>
+#include <wsutil/wslog.h>
+
+#include "ui/io_graph_item.h"
+
+static int proto_iogtest = -1;
+static int hf_iogtest_uint = -1;
+static int hf_iogtest_int = -1;
+static int hf_iogtest_double = -1;
+static int hf_iogtest_time = -1;
+
+/*
+ * One tapped frame: the interval it falls into at the finest interval,
+ * and the values of the field in it. Frames are tapped in order, but
+ * their intervals needn't be (timestamps can be out of order).
+ */
+typedef struct {
+    int      idx;
+    uint32_t frame;
+    int      num_values;
+    int64_t  values[2];
+} iog_sample_t;
+
+#define IOG_NUM_ITEMS 24
+
+static const iog_sample_t iog_samples[] = {
+    {  0,  1, 1, {  5 } },
+    {  0,  2, 1, {  9 } },
+    {  1,  3, 1, {  9 } },      /* same maximum as the interval before */
+    {  2,  4, 0, {  0 } },      /* doesn't have the field */
+    {  3,  5, 2, { -3, 12 } },
+    {  5,  6, 1, { -3 } },      /* same minimum as an earlier interval */
+    {  1,  7, 1, { 20 } },      /* out of order */
+    {  7,  8, 1, {  0 } },
+    {  8,  9, 1, {  7 } },
+    {  8, 10, 1, {  7 } },
+    { 11, 11, 1, { -8 } },
+    { 12, 12, 2, {  4, 4 } },
+    { 13, 13, 1, { 15 } },
+    { 17, 14, 1, { 15 } },
+    { 16, 15, 1, {  1 } },
+    { 18, 16, 0, {  0 } },
+    { 19, 17, 1, { 30 } },
+    { 23, 18, 1, { -8 } },
+    { 22, 19, 1, { 30 } },
+};
+
+/*
+ * Tap a sample into an item with update_io_graph_item(), from a tree
+ * holding the sample's values of the field. The values are offset and
+ * scaled so that they are valid for, and exact in, each field type.
+ */
+static void
+iog_add_sample(io_graph_item_t *items, int idx, const iog_sample_t *sample, int hf_index)
+{
+    frame_data fd;
+    epan_dissect_t edt;
+
+    memset(&fd, 0, sizeof(fd));
+    fd.num = sample->frame;
+    fd.pkt_len = 60 + sample->frame;
+    memset(&edt, 0, sizeof(edt));
+    edt.pi.num = sample->frame;
+    edt.pi.fd = &fd;
+    edt.pi.pool = wmem_allocator_new(WMEM_ALLOCATOR_SIMPLE);
+    edt.tree = proto_tree_create_root(&edt.pi);
+    proto_tree_prime_with_hfid(edt.tree, hf_index);
+
+    for (int i = 0; i < sample->num_values; i++) {
+        int64_t value = sample->values[i];
+
+        switch (proto_registrar_get_ftype(hf_index)) {
+        case FT_UINT32:
+            proto_tree_add_uint(edt.tree, hf_index, NULL, 0, 0, (uint32_t)(value + 100));
+            break;
+        case FT_INT32:
+            proto_tree_add_int(edt.tree, hf_index, NULL, 0, 0, (int32_t)value);
+            break;
+        case FT_DOUBLE:
+            proto_tree_add_double(edt.tree, hf_index, NULL, 0, 0, value * 0.25);
+            break;
+        case FT_RELATIVE_TIME:
+        {
+            /* milliseconds */
+            nstime_t new_time = NSTIME_INIT_SECS_MSECS(0, (int)(value + 100));
+
+            proto_tree_add_time(edt.tree, hf_index, NULL, 0, 0, &new_time);
+            break;
+        }
+        default:
+            g_assert_not_reached();
+        }
+    }
+
+    /* Frames without the field aren't counted. */
+    g_assert_true(update_io_graph_item(items, idx, &edt.pi, &edt, hf_index, IOG_ITEM_UNIT_CALC_SUM, 1000) ==
+                  (sample->num_values > 0));
+
+    proto_tree_free(edt.tree);
+    wmem_destroy_allocator(edt.pi.pool);
+}
+
+/*
+ * Merging the items tapped at the finest interval into a coarser one must
+ * give the same items as tapping at the coarser interval.
+ */
+static void
+test_merge_io_graph_item(gconstpointer data)
+{
+    const int hf_index = *(const int *)data;
+    static const int factors[] = { 1, 2, 3, 4, 5, 12, IOG_NUM_ITEMS };
+    static const io_graph_item_unit_t units[] = {
+        IOG_ITEM_UNIT_CALC_SUM,
+        IOG_ITEM_UNIT_CALC_MAX,
+        IOG_ITEM_UNIT_CALC_MIN,
+        IOG_ITEM_UNIT_CALC_AVERAGE,
+        IOG_ITEM_UNIT_CALC_FRAMES,
+        IOG_ITEM_UNIT_CALC_FIELDS,
+    };
+    io_graph_item_t fine[IOG_NUM_ITEMS];
+    io_graph_item_t tapped[IOG_NUM_ITEMS];
+    io_graph_item_t merged[IOG_NUM_ITEMS];
+
+    reset_io_graph_items(fine, IOG_NUM_ITEMS, hf_index);
+    for (size_t i = 0; i < G_N_ELEMENTS(iog_samples); i++) {
+        iog_add_sample(fine, iog_samples[i].idx, &iog_samples[i], hf_index);
+    }
+
+    for (size_t f = 0; f < G_N_ELEMENTS(factors); f++) {
+        int factor = factors[f];
+        int num_items = (IOG_NUM_ITEMS - 1) / factor + 1;
+
+        reset_io_graph_items(tapped, IOG_NUM_ITEMS, hf_index);
+        for (size_t i = 0; i < G_N_ELEMENTS(iog_samples); i++) {
+            iog_add_sample(tapped, iog_samples[i].idx / factor, &iog_samples[i], hf_index);
+        }
+
+        for (size_t u = 0; u < G_N_ELEMENTS(units); u++) {
+            reset_io_graph_items(merged, IOG_NUM_ITEMS, hf_index);
+            for (int i = 0; i < IOG_NUM_ITEMS; i++) {
+                merge_io_graph_item(&merged[i / factor], &fine[i], hf_index, units[u]);
+            }
+
+            for (int i = 0; i < num_items; i++) {
+                g_assert_cmpuint(merged[i].frames, ==, tapped[i].frames);
+                g_assert_cmpuint(merged[i].bytes, ==, tapped[i].bytes);
+                g_assert_cmpuint(merged[i].fields, ==, tapped[i].fields);
+                g_assert_cmpuint(merged[i].first_frame_in_invl, ==, tapped[i].first_frame_in_invl);
+                g_assert_cmpuint(merged[i].last_frame_in_invl, ==, tapped[i].last_frame_in_invl);
+                if (tapped[i].fields) {
+                    g_assert_cmpuint(merged[i].min_frame_in_invl, ==, tapped[i].min_frame_in_invl);
+                    g_assert_cmpuint(merged[i].max_frame_in_invl, ==, tapped[i].max_frame_in_invl);
+                }
+                g_assert_cmpfloat(get_io_graph_item(merged, units[u], i, hf_index, NULL, 1000 * factor, num_items - 1),
+                                  ==,
+                                  get_io_graph_item(tapped, units[u], i, hf_index, NULL, 1000 * factor, num_items - 1));
+            }
+        }
+    }
+}
+
+static void
+register_iogtest(void)
+{
+    static hf_register_info hf[] = {
+        { &hf_iogtest_uint,
+          { "Unsigned", "iogtest.uint", FT_UINT32, BASE_DEC, NULL, 0x0, NULL, HFILL }},
+        { &hf_iogtest_int,
+          { "Signed", "iogtest.int", FT_INT32, BASE_DEC, NULL, 0x0, NULL, HFILL }},
+        { &hf_iogtest_double,
+          { "Double", "iogtest.double", FT_DOUBLE, BASE_NONE, NULL, 0x0, NULL, HFILL }},
+        { &hf_iogtest_time,
+          { "Time", "iogtest.time", FT_RELATIVE_TIME, BASE_NONE, NULL, 0x0, NULL, HFILL }},
+    };
+
+    proto_iogtest = proto_register_protocol("IO Graph Test", "IOGTEST", "iogtest");
+    proto_register_field_array(proto_iogtest, hf, G_N_ELEMENTS(hf));
+}
+
+int main(int argc, char **argv)
+{
+    int ret;
+
+    ws_log_init("test_ui", NULL);
+
+    g_test_init(&argc, &argv, NULL);
+
+    if (!epan_test_fixture_init(argv[0], register_iogtest)) {
+        return 1;
+    }
+
+    g_test_add_data_func("/io_graph_item/merge/uint", &hf_iogtest_uint, test_merge_io_graph_item);
+    g_test_add_data_func("/io_graph_item/merge/int", &hf_iogtest_int, test_merge_io_graph_item);
+    g_test_add_data_func("/io_graph_item/merge/double", &hf_iogtest_double, test_merge_io_graph_item);
+    g_test_add_data_func("/io_graph_item/merge/time", &hf_iogtest_time, test_merge_io_graph_item);
+
+    ret = g_test_run();
+
+    epan_test_fixture_cleanup();
+
+    return ret;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
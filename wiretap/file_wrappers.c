@@ -204,6 +204,11 @@ struct wtap_reader {
     /* fast seeking */
     GPtrArray *fast_seek;
     void *fast_seek_cur;
+
+    /* read-only mapping of an uncompressed file, for file_map_bytes() */
+    GMappedFile *map;           /* current mapping, or NULL */
+    GPtrArray *old_maps;        /* earlier, smaller mappings still referenced */
+    bool map_failed;            /* true if we couldn't map the file */
 };
 
 /* Current read offset within a buffer. */
@@ -1717,6 +1722,95 @@ file_iscompressed(FILE_T stream)
     return stream->is_compressed;
 }
 
+/*
+ * Return a pointer to len bytes at offset within the file, or NULL if
+ * that's not possible, in which case the caller must read the data.
+ *
+ * This only works for uncompressed regular files; the pointer points
+ * into a read-only memory mapping of the file, and remains valid until
+ * the file is closed.  The data must already have been determined to
+ * be in the file, e.g. by having read the header of the block that
+ * contains it; we only use this to avoid copying packet data.
+ *
+ * If the file has grown past the end of the mapping, e.g. because it's
+ * being written by a capture process, it's remapped if it has at least
+ * doubled in size since the last time it was mapped; the old mapping
+ * is kept, as pointers into it might still be in use.
+ *
+ * If the file has shrunk so that the data is no longer all in it, NULL
+ * is returned, and the caller's read gets the short read error.
+ */
+const uint8_t *
+file_map_bytes(FILE_T file, int64_t offset, size_t len)
+{
+#ifdef _WIN32
+    /*
+     * A mapped file can't be renamed or deleted on Windows, and
+     * we do that to files we have open when saving over them.
+     */
+    (void)file;
+    (void)offset;
+    (void)len;
+    return NULL;
+#else
+    ws_statb64 statb;
+    int64_t map_off;
+    GMappedFile *map;
+
+    if (file->map_failed || file->compression != UNCOMPRESSED ||
+        file->seek_pending || file->fd == -1)
+        return NULL;
+
+    /*
+     * We're doing raw i/o, so offsets in the data map one-to-one to
+     * offsets in the file; find the file offset of the current position
+     * the same way we do when adding a fast seek point.
+     */
+    map_off = file->raw_pos - file->out.avail - file->in.avail +
+        (offset - file->pos);
+    if (map_off < 0 || len > (uint64_t)(INT64_MAX - map_off))
+        return NULL;
+
+    /*
+     * Check the file's current size even if the data is within the
+     * mapping; if the file has been truncated since we mapped it,
+     * e.g. a ring buffer file being reused, touching the pages past
+     * the new end of the file would get us a SIGBUS rather than a
+     * read error, so let the caller read it instead.
+     */
+    if (ws_fstat64(file->fd, &statb) == -1 || !S_ISREG(statb.st_mode)) {
+        file->map_failed = true;
+        return NULL;
+    }
+    if ((uint64_t)map_off + len > (uint64_t)statb.st_size)
+        return NULL;
+
+    if (file->map == NULL ||
+        (uint64_t)map_off + len > g_mapped_file_get_length(file->map)) {
+        if (file->map != NULL &&
+            (uint64_t)statb.st_size < 2 * g_mapped_file_get_length(file->map))
+            return NULL;
+        map = g_mapped_file_new_from_fd(file->fd, FALSE, NULL);
+        if (map == NULL || g_mapped_file_get_contents(map) == NULL) {
+            /* Empty files can't be mapped; neither can some others. */
+            if (map != NULL)
+                g_mapped_file_unref(map);
+            file->map_failed = true;
+            return NULL;
+        }
+        if (file->map != NULL) {
+            if (file->old_maps == NULL)
+                file->old_maps = g_ptr_array_new_with_free_func((GDestroyNotify)g_mapped_file_unref);
+            g_ptr_array_add(file->old_maps, file->map);
+        }
+        file->map = map;
+        if ((uint64_t)map_off + len > g_mapped_file_get_length(map))
+            return NULL;
+    }
+    return (const uint8_t *)g_mapped_file_get_contents(file->map) + map_off;
+#endif
+}
+
 /* Returns a wtap compression type. If we don't know the compression type,
  * return WTAP_UNCOMPRESSED, but if our compression state is temporarily
  * UNKNOWN because we need to reread compression headers, return the last
@@ -2028,6 +2122,10 @@ file_close(FILE_T file)
         g_free(file->in.buf);
     }
     g_free(file->fast_seek_cur);
+    if (file->map != NULL)
+        g_mapped_file_unref(file->map);
+    if (file->old_maps != NULL)
+        g_ptr_array_free(file->old_maps, true);
     file->err = 0;
     file->err_info = NULL;
     g_free(file);
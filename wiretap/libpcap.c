@@ -1008,10 +1008,18 @@ libpcap_read_packet(wtap *wth, FILE_T fh, wtap_rec *rec,
 	rec->rec_header.packet_header.len = orig_size;
 
 	/*
-	 * Read the packet data.
+	 * Read the packet data, unless this is a sequential read and our
+	 * caller only wants the record metadata, and we don't need the
+	 * data to fill that in.
 	 */
-	if (!wtap_read_packet_bytes(fh, buf, packet_size, err, err_info))
-		return false;	/* failed */
+	if (fh == wth->fh && wth->skip_packet_data &&
+	    !pcap_read_post_process_needs_data(wth->file_encap, libpcap->byte_swapped)) {
+		if (!wtap_read_bytes(fh, NULL, packet_size, err, err_info))
+			return false;	/* failed */
+	} else {
+		if (!wtap_read_packet_bytes(fh, buf, packet_size, err, err_info))
+			return false;	/* failed */
+	}
 
 	pcap_read_post_process(is_nokia, wth->file_encap, rec,
 	    ws_buffer_start_ptr(buf), libpcap->byte_swapped, libpcap->fcs_len);
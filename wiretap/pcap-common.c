@@ -2585,6 +2585,36 @@ pcap_fixup_len(wtap_rec *rec, const uint8_t *pd)
 	}
 }
 
+/*
+ * Returns true if pcap_read_post_process() looks at, or modifies, the
+ * packet data for this encapsulation, so that a reader can't skip over
+ * the data even if its caller doesn't want it.
+ */
+bool
+pcap_read_post_process_needs_data(int wtap_encap, bool bytes_swapped)
+{
+	switch (wtap_encap) {
+
+	case WTAP_ENCAP_ATM_PDUS:
+		/* The traffic type is guessed from the packet contents. */
+		return true;
+
+	case WTAP_ENCAP_USB_LINUX_MMAPPED:
+		/* The on-the-network length may be fixed up from the data. */
+		return true;
+
+	case WTAP_ENCAP_SLL:
+	case WTAP_ENCAP_SLL2:
+	case WTAP_ENCAP_USB_LINUX:
+	case WTAP_ENCAP_NFLOG:
+	case WTAP_ENCAP_PFLOG:
+		return bytes_swapped;
+
+	default:
+		return false;
+	}
+}
+
 void
 pcap_read_post_process(bool is_nokia, int wtap_encap,
     wtap_rec *rec, uint8_t *pd, bool bytes_swapped, int fcs_len)
@@ -24,6 +24,8 @@ extern int pcap_process_pseudo_header(FILE_T fh, bool is_nokia,
     int wtap_encap, unsigned packet_size, wtap_rec *rec,
     int *err, char **err_info);
 
+extern bool pcap_read_post_process_needs_data(int wtap_encap, bool bytes_swapped);
+
 extern void pcap_read_post_process(bool is_nokia, int wtap_encap,
     wtap_rec *rec, uint8_t *pd, bool bytes_swapped, int fcs_len);
 
@@ -48,6 +48,13 @@ pcapng_read(wtap *wth, wtap_rec *rec, Buffer *buf, int *err,
 static bool
 pcapng_seek_read(wtap *wth, int64_t seek_off,
                  wtap_rec *rec, Buffer *buf, int *err, char **err_info);
+static bool
+pcapng_seek_read_mapped(wtap *wth, int64_t seek_off,
+                        wtap_rec *rec, Buffer *buf, const uint8_t **data,
+                        int *err, char **err_info);
+static bool
+pcapng_index_records(wtap *wth, unsigned num_threads, GArray *records,
+                     int *err, char **err_info);
 static void
 pcapng_close(wtap *wth);
 
@@ -2312,17 +2319,32 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh,
     /* Add the time stamp offset. */
     wblock->rec->ts.secs = (time_t)(wblock->rec->ts.secs + iface_info.tsoffset);
 
-    /* "(Enhanced) Packet Block" read capture data */
-    if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
-                                packet.cap_len - pseudo_header_len, err, err_info))
-        return false;
-    block_read += packet.cap_len - pseudo_header_len;
-
-    /* jump over potential padding bytes at end of the packet data */
-    if (padding != 0) {
-        if (!wtap_read_bytes(fh, NULL, padding, err, err_info))
+    if (wblock->skip_packet_data &&
+        !pcap_read_post_process_needs_data(iface_info.wtap_encap, section_info->byte_swapped)) {
+        /* Our caller doesn't want the data; skip it and the padding at once. */
+        if (!wtap_read_bytes(fh, NULL, packet.cap_len - pseudo_header_len + padding, err, err_info))
+            return false;
+        block_read += packet.cap_len - pseudo_header_len + padding;
+    } else if (wblock->map_packet_data &&
+               !pcap_read_post_process_needs_data(iface_info.wtap_encap, section_info->byte_swapped) &&
+               (wblock->packet_data = file_map_bytes(fh, file_tell(fh), packet.cap_len - pseudo_header_len)) != NULL) {
+        /* Our caller can use the data in place; seek past it and the padding. */
+        if (file_seek(fh, packet.cap_len - pseudo_header_len + padding, SEEK_CUR, err) == -1)
             return false;
-        block_read += padding;
+        block_read += packet.cap_len - pseudo_header_len + padding;
+    } else {
+        /* "(Enhanced) Packet Block" read capture data */
+        if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
+                                    packet.cap_len - pseudo_header_len, err, err_info))
+            return false;
+        block_read += packet.cap_len - pseudo_header_len;
+
+        /* jump over potential padding bytes at end of the packet data */
+        if (padding != 0) {
+            if (!wtap_read_bytes(fh, NULL, padding, err, err_info))
+                return false;
+            block_read += padding;
+        }
     }
 
     /* FCS length default */
@@ -2496,15 +2518,28 @@ pcapng_read_simple_packet_block(FILE_T fh, pcapng_block_header_t *bh,
 
     memset((void *)&wblock->rec->rec_header.packet_header.pseudo_header, 0, sizeof(union wtap_pseudo_header));
 
-    /* "Simple Packet Block" read capture data */
-    if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
-                                simple_packet.cap_len, err, err_info))
-        return false;
-
-    /* jump over potential padding bytes at end of the packet data */
-    if ((simple_packet.cap_len % 4) != 0) {
-        if (!wtap_read_bytes(fh, NULL, 4 - (simple_packet.cap_len % 4), err, err_info))
+    if (wblock->skip_packet_data &&
+        !pcap_read_post_process_needs_data(iface_info.wtap_encap, section_info->byte_swapped)) {
+        /* Our caller doesn't want the data; skip it and the padding at once. */
+        if (!wtap_read_bytes(fh, NULL, WS_ROUNDUP_4(simple_packet.cap_len), err, err_info))
+            return false;
+    } else if (wblock->map_packet_data &&
+               !pcap_read_post_process_needs_data(iface_info.wtap_encap, section_info->byte_swapped) &&
+               (wblock->packet_data = file_map_bytes(fh, file_tell(fh), simple_packet.cap_len)) != NULL) {
+        /* Our caller can use the data in place; seek past it and the padding. */
+        if (file_seek(fh, WS_ROUNDUP_4(simple_packet.cap_len), SEEK_CUR, err) == -1)
             return false;
+    } else {
+        /* "Simple Packet Block" read capture data */
+        if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
+                                    simple_packet.cap_len, err, err_info))
+            return false;
+
+        /* jump over potential padding bytes at end of the packet data */
+        if ((simple_packet.cap_len % 4) != 0) {
+            if (!wtap_read_bytes(fh, NULL, 4 - (simple_packet.cap_len % 4), err, err_info))
+                return false;
+        }
     }
 
     pcap_read_post_process(false, iface_info.wtap_encap,
@@ -3947,6 +3982,9 @@ pcapng_open(wtap *wth, int *err, char **err_info)
     /* we don't expect any packet blocks yet */
     wblock.frame_buffer = NULL;
     wblock.rec = NULL;
+    wblock.skip_packet_data = false;
+    wblock.map_packet_data = false;
+    wblock.packet_data = NULL;
 
     switch (pcapng_read_section_header_block(wth->fh, &bh, &first_section,
                                              &wblock, err, err_info)) {
@@ -4031,6 +4069,8 @@ pcapng_open(wtap *wth, int *err, char **err_info)
 
     wth->subtype_read = pcapng_read;
     wth->subtype_seek_read = pcapng_seek_read;
+    wth->subtype_seek_read_mapped = pcapng_seek_read_mapped;
+    wth->subtype_index_records = pcapng_index_records;
     wth->subtype_close = pcapng_close;
     wth->file_type_subtype = pcapng_file_type_subtype;
 
@@ -4132,6 +4172,9 @@ pcapng_read(wtap *wth, wtap_rec *rec, Buffer *buf, int *err,
 
     wblock.frame_buffer  = buf;
     wblock.rec = rec;
+    wblock.skip_packet_data = wth->skip_packet_data;
+    wblock.map_packet_data = false;
+    wblock.packet_data = NULL;
 
     /* read next block */
     while (1) {
@@ -4180,11 +4223,461 @@ pcapng_read(wtap *wth, wtap_rec *rec, Buffer *buf, int *err,
     return true;
 }
 
-/* classic wtap: seek to file position and read packet */
+/*
+ * Indexing the records in a file.
+ *
+ * Block boundaries can only be found by following the chain of block
+ * total lengths from the beginning of the file, but doing so only
+ * requires looking at a few bytes of each block.  We map the file,
+ * split it into chunks, and have a thread per chunk find the first
+ * offset in the chunk at which a chain of plausible blocks starts
+ * and follow that chain to the end of the chunk, saving the fixed
+ * part of each EPB.
+ *
+ * We then stitch the chains together by following the real chain from
+ * the beginning of the file; it normally lands on a block in the next
+ * chunk's chain, in which case the rest of that chain is the real one
+ * as well, and if a thread happened to start on something that merely
+ * looked like a chain of blocks, that only costs us a sequential walk
+ * of that chunk.
+ *
+ * Finally, we go through the blocks in order; EPBs without options are
+ * indexed from their fixed part, and all other blocks are read and
+ * processed just as pcapng_read() would do.
+ */
+#define PCAPNG_SCAN_MIN_CHUNK_SIZE      (4*1024*1024)
+#define PCAPNG_SCAN_CHUNKS_PER_THREAD   4
+#define PCAPNG_SCAN_SYNC_BLOCKS         4
+
+typedef struct {
+    int64_t offset;             /* offset of the block in the file */
+    uint32_t type;              /* block type, in host byte order */
+    uint32_t total_length;      /* block total length, rounded up to a multiple of 4 */
+    bool byte_swapped;          /* true if the block's section isn't in our byte order */
+    pcapng_enhanced_packet_block_t epb; /* for EPBs, the fixed part, in host byte order */
+} pcapng_scanned_block_t;
+
+typedef struct {
+    const uint8_t *data;        /* the mapped file */
+    int64_t file_size;
+    int64_t start;              /* offset of the start of this chunk */
+    int64_t end;                /* offset of the end of this chunk */
+    bool byte_swapped;          /* byte order of the first section */
+    GArray *blocks;             /* the chain of pcapng_scanned_block_t's found */
+} pcapng_scan_chunk_t;
+
+/*
+ * If there's a complete block at the given offset, with matching
+ * block total lengths, in a section with the given byte order, fill
+ * in *block with its description and return true.
+ */
 static bool
-pcapng_seek_read(wtap *wth, int64_t seek_off,
-                 wtap_rec *rec, Buffer *buf,
-                 int *err, char **err_info)
+pcapng_scan_block(const uint8_t *data, int64_t file_size, int64_t offset,
+                  bool byte_swapped, pcapng_scanned_block_t *block)
+{
+    pcapng_block_header_t bh;
+    uint32_t magic;
+    uint32_t block_total_length;
+
+    if (file_size - offset < (int64_t)MIN_BLOCK_SIZE)
+        return false;
+    memcpy(&bh, data + offset, sizeof bh);
+
+    if (bh.block_type == BLOCK_TYPE_SHB) {
+        /* An SHB defines the byte order of its own section. */
+        if (file_size - offset < (int64_t)MIN_SHB_SIZE)
+            return false;
+        memcpy(&magic, data + offset + sizeof bh, sizeof magic);
+        if (magic == 0x1A2B3C4D)
+            byte_swapped = false;
+        else if (magic == 0x4D3C2B1A)
+            byte_swapped = true;
+        else
+            return false;
+    }
+    if (byte_swapped) {
+        bh.block_type         = GUINT32_SWAP_LE_BE(bh.block_type);
+        bh.block_total_length = GUINT32_SWAP_LE_BE(bh.block_total_length);
+    }
+    bh.block_total_length = ROUND_TO_4BYTE(bh.block_total_length);
+    if (bh.block_total_length < MIN_BLOCK_SIZE ||
+        bh.block_total_length > MAX_BLOCK_SIZE ||
+        bh.block_total_length > file_size - offset)
+        return false;
+
+    memcpy(&block_total_length,
+           data + offset + bh.block_total_length - sizeof block_total_length,
+           sizeof block_total_length);
+    if (byte_swapped)
+        block_total_length = GUINT32_SWAP_LE_BE(block_total_length);
+    if (ROUND_TO_4BYTE(block_total_length) != bh.block_total_length)
+        return false;
+
+    block->offset = offset;
+    block->type = bh.block_type;
+    block->total_length = bh.block_total_length;
+    block->byte_swapped = byte_swapped;
+    if (bh.block_type == BLOCK_TYPE_EPB &&
+        bh.block_total_length >= MIN_EPB_SIZE) {
+        memcpy(&block->epb, data + offset + sizeof bh, sizeof block->epb);
+        if (byte_swapped) {
+            block->epb.interface_id   = GUINT32_SWAP_LE_BE(block->epb.interface_id);
+            block->epb.timestamp_high = GUINT32_SWAP_LE_BE(block->epb.timestamp_high);
+            block->epb.timestamp_low  = GUINT32_SWAP_LE_BE(block->epb.timestamp_low);
+            block->epb.captured_len   = GUINT32_SWAP_LE_BE(block->epb.captured_len);
+            block->epb.packet_len     = GUINT32_SWAP_LE_BE(block->epb.packet_len);
+        }
+    }
+    return true;
+}
+
+/*
+ * Is this a block type that's likely to appear in a file?  Used to
+ * avoid starting a chain of blocks on random packet data.
+ */
+static bool
+pcapng_scan_known_block_type(uint32_t block_type)
+{
+    return block_type == BLOCK_TYPE_SHB ||
+           (block_type >= BLOCK_TYPE_IDB && block_type <= BLOCK_TYPE_DSB) ||
+           (block_type >= BLOCK_TYPE_SYSDIG_MI && block_type <= BLOCK_TYPE_SYSDIG_EVF_V2_LARGE) ||
+           block_type == BLOCK_TYPE_CB_COPY ||
+           block_type == BLOCK_TYPE_CB_NO_COPY;
+}
+
+/*
+ * Does a chain of plausible blocks, in a section with the given byte
+ * order, start at the given offset?
+ */
+static bool
+pcapng_scan_sync(const pcapng_scan_chunk_t *chunk, int64_t offset,
+                 bool byte_swapped)
+{
+    pcapng_scanned_block_t block;
+
+    for (unsigned i = 0; i < PCAPNG_SCAN_SYNC_BLOCKS; i++) {
+        if (offset == chunk->file_size)
+            return true;
+        if (!pcapng_scan_block(chunk->data, chunk->file_size, offset,
+                               byte_swapped, &block) ||
+            !pcapng_scan_known_block_type(block.type))
+            return false;
+        offset += block.total_length;
+        byte_swapped = block.byte_swapped;
+    }
+    return true;
+}
+
+/* Thread pool function: find the chain of blocks in a chunk. */
+static void
+pcapng_scan_chunk(void *data, void *user_data _U_)
+{
+    pcapng_scan_chunk_t *chunk = (pcapng_scan_chunk_t *)data;
+    pcapng_scanned_block_t block;
+    bool byte_swapped = chunk->byte_swapped;
+    int64_t offset;
+
+    /* All blocks start on a 4-byte boundary. */
+    for (offset = (chunk->start + 3) & ~(int64_t)3; offset < chunk->end; offset += 4) {
+        if (pcapng_scan_sync(chunk, offset, byte_swapped))
+            break;
+        if (pcapng_scan_sync(chunk, offset, !byte_swapped)) {
+            byte_swapped = !byte_swapped;
+            break;
+        }
+    }
+
+    while (offset < chunk->end &&
+           pcapng_scan_block(chunk->data, chunk->file_size, offset,
+                             byte_swapped, &block)) {
+        g_array_append_val(chunk->blocks, block);
+        offset += block.total_length;
+        byte_swapped = block.byte_swapped;
+    }
+}
+
+/*
+ * If the block at the given offset, in a section with the given byte
+ * order, is in the chain found for a chunk, return its index in *indexp.
+ */
+static bool
+pcapng_scan_find(const pcapng_scan_chunk_t *chunk, int64_t offset,
+                 bool byte_swapped, unsigned *indexp)
+{
+    unsigned low = 0, high = chunk->blocks->len;
+
+    while (low < high) {
+        unsigned mid = low + (high - low) / 2;
+        const pcapng_scanned_block_t *block =
+            &g_array_index(chunk->blocks, pcapng_scanned_block_t, mid);
+
+        if (block->offset < offset) {
+            low = mid + 1;
+        } else if (block->offset > offset) {
+            high = mid;
+        } else {
+            if (block->type != BLOCK_TYPE_SHB &&
+                block->byte_swapped != byte_swapped)
+                return false;
+            *indexp = mid;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Fill in an index entry for an EPB from its fixed part, if that's all
+ * it takes, i.e. if it has no options; return false if the block has
+ * to be read.
+ */
+static bool
+pcapng_index_epb(const section_info_t *section_info,
+                 const pcapng_scanned_block_t *block,
+                 wtap_record_index_entry *entry)
+{
+    const interface_info_t *iface_info;
+    uint64_t ts;
+
+    if (block->type != BLOCK_TYPE_EPB || block->total_length < MIN_EPB_SIZE)
+        return false;
+    if (block->epb.captured_len > block->total_length - MIN_EPB_SIZE ||
+        ROUND_TO_4BYTE(block->epb.captured_len) != block->total_length - MIN_EPB_SIZE)
+        return false;
+    if (block->epb.interface_id >= section_info->interfaces->len)
+        return false;
+    iface_info = &g_array_index(section_info->interfaces, interface_info_t,
+                                block->epb.interface_id);
+
+    /*
+     * Pseudo-headers, and post-processing that looks at the data,
+     * can change the lengths.
+     */
+    if (block->epb.captured_len > wtap_max_snaplen_for_encap(iface_info->wtap_encap) ||
+        wtap_encap_requires_phdr(iface_info->wtap_encap) ||
+        pcap_read_post_process_needs_data(iface_info->wtap_encap, section_info->byte_swapped) ||
+        iface_info->time_units_per_second == 0)
+        return false;
+
+    /* This must match pcapng_read_packet_block(). */
+    ts = (((uint64_t)block->epb.timestamp_high) << 32) | ((uint64_t)block->epb.timestamp_low);
+    entry->file_off = block->offset;
+    entry->ts.secs = (time_t)(ts / iface_info->time_units_per_second);
+    entry->ts.nsecs = (int)(((ts % iface_info->time_units_per_second) * 1000000000) / iface_info->time_units_per_second);
+    entry->ts.secs = (time_t)(entry->ts.secs + iface_info->tsoffset);
+    entry->rec_type = REC_TYPE_PACKET;
+    entry->presence_flags = WTAP_HAS_TS|WTAP_HAS_CAP_LEN|WTAP_HAS_INTERFACE_ID|WTAP_HAS_SECTION_NUMBER;
+    entry->tsprec = iface_info->tsprecision;
+    entry->pkt_encap = iface_info->wtap_encap;
+    entry->caplen = block->epb.captured_len;
+    entry->len = block->epb.packet_len;
+    entry->interface_id = block->epb.interface_id;
+    entry->block = NULL;
+    return true;
+}
+
+static bool
+pcapng_index_records(wtap *wth, unsigned num_threads, GArray *records,
+                     int *err, char **err_info)
+{
+    pcapng_t *pcapng = (pcapng_t *)wth->priv;
+    section_info_t *current_section, new_section;
+    wtapng_block_t wblock;
+    wtap_record_index_entry entry;
+    wtap_rec rec;
+    Buffer buf;
+    ws_statb64 statb;
+    const uint8_t *data;
+    int64_t file_size, offset, data_offset;
+    unsigned num_chunks, i, k, pos;
+    pcapng_scan_chunk_t *chunks;
+    GThreadPool *pool = NULL;
+    GArray *blocks;
+    pcapng_scanned_block_t block;
+    bool byte_swapped;
+    bool ok = true;
+
+    *err = 0;
+    *err_info = NULL;
+
+    if (file_fstat(wth->fh, &statb, err) == -1) {
+        *err = 0;
+        return false;
+    }
+    file_size = statb.st_size;
+    if (file_size <= 0)
+        return false;
+#if SIZE_MAX < INT64_MAX
+    if (file_size > (int64_t)SIZE_MAX)
+        return false;
+#endif
+    data = file_map_bytes(wth->fh, 0, (size_t)file_size);
+    if (data == NULL)
+        return false;
+
+    /*
+     * Split the file into chunks, a few per thread so that a chunk
+     * with more small blocks doesn't hold up everything else.
+     */
+    if (num_threads == 0)
+        num_threads = 1;
+    num_chunks = num_threads * PCAPNG_SCAN_CHUNKS_PER_THREAD;
+    if ((int64_t)num_chunks > file_size / PCAPNG_SCAN_MIN_CHUNK_SIZE)
+        num_chunks = (unsigned)MAX(file_size / PCAPNG_SCAN_MIN_CHUNK_SIZE, 1);
+    chunks = g_new0(pcapng_scan_chunk_t, num_chunks);
+    for (i = 0; i < num_chunks; i++) {
+        chunks[i].data = data;
+        chunks[i].file_size = file_size;
+        chunks[i].start = file_size / num_chunks * i;
+        chunks[i].end = (i == num_chunks - 1) ? file_size : file_size / num_chunks * (i + 1);
+        chunks[i].byte_swapped = g_array_index(pcapng->sections, section_info_t, 0).byte_swapped;
+        chunks[i].blocks = g_array_new(false, false, sizeof(pcapng_scanned_block_t));
+    }
+    if (num_chunks > 1)
+        pool = g_thread_pool_new(pcapng_scan_chunk, NULL, (int)num_threads, true, NULL);
+    if (pool != NULL) {
+        for (i = 0; i < num_chunks; i++)
+            g_thread_pool_push(pool, &chunks[i], NULL);
+        g_thread_pool_free(pool, false, true);
+    } else {
+        for (i = 0; i < num_chunks; i++)
+            pcapng_scan_chunk(&chunks[i], NULL);
+    }
+
+    /*
+     * Stitch the chains together, starting with the SHB at the
+     * beginning of the file.
+     */
+    blocks = g_array_new(false, false, sizeof(pcapng_scanned_block_t));
+    offset = 0;
+    byte_swapped = chunks[0].byte_swapped;
+    k = 0;
+    while (offset < file_size) {
+        while (offset >= chunks[k].end)
+            k++;
+        if (pcapng_scan_find(&chunks[k], offset, byte_swapped, &pos)) {
+            /* We're on this chunk's chain; the rest of it is ours. */
+            g_array_append_vals(blocks,
+                                &g_array_index(chunks[k].blocks, pcapng_scanned_block_t, pos),
+                                chunks[k].blocks->len - pos);
+            block = g_array_index(blocks, pcapng_scanned_block_t, blocks->len - 1);
+        } else {
+            if (!pcapng_scan_block(data, file_size, offset, byte_swapped, &block)) {
+                /* Leave whatever this is to pcapng_read(). */
+                break;
+            }
+            g_array_append_val(blocks, block);
+        }
+        offset = block.offset + block.total_length;
+        byte_swapped = block.byte_swapped;
+    }
+    for (i = 0; i < num_chunks; i++)
+        g_array_free(chunks[i].blocks, true);
+    g_free(chunks);
+
+    /*
+     * Now go through the blocks we haven't already read.
+     */
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 0);
+    wblock.frame_buffer = &buf;
+    wblock.rec = &rec;
+    wblock.skip_packet_data = true;
+    wblock.map_packet_data = false;
+    wblock.packet_data = NULL;
+    offset = file_tell(wth->fh);
+    for (i = 0; i < blocks->len; i++) {
+        const pcapng_scanned_block_t *bp = &g_array_index(blocks, pcapng_scanned_block_t, i);
+
+        if (bp->offset < offset)
+            continue;
+
+        current_section = &g_array_index(pcapng->sections, section_info_t,
+                                         pcapng->current_section_number);
+        if (pcapng_index_epb(current_section, bp, &entry)) {
+            entry.section_number = pcapng->current_section_number;
+            g_array_append_val(records, entry);
+            offset = bp->offset + bp->total_length;
+            continue;
+        }
+
+        /* Read anything else the way pcapng_read() does. */
+        if (file_seek(wth->fh, bp->offset, SEEK_SET, err) == -1) {
+            ok = false;
+            break;
+        }
+        data_offset = bp->offset;
+        rec.presence_flags = 0;
+        nstime_set_zero(&rec.ts);
+        rec.rec_header.packet_header.pkt_encap = wth->file_encap;
+        rec.tsprec = wth->file_tsprec;
+        rec.section_number = 0;
+        if (!pcapng_read_block(wth, wth->fh, pcapng, current_section,
+                               &new_section, &wblock, err, err_info)) {
+            wtap_block_unref(wblock.block);
+            if (*err == 0)
+                *err = WTAP_ERR_SHORT_READ;
+            ok = false;
+            break;
+        }
+        offset = file_tell(wth->fh);
+        if (offset != bp->offset + bp->total_length) {
+            /* This isn't the block we found. */
+            wtap_block_unref(wblock.block);
+            *err = WTAP_ERR_BAD_FILE;
+            *err_info = ws_strdup_printf("pcapng: block at offset %" PRId64 " doesn't end at offset %" PRId64,
+                                        bp->offset, bp->offset + bp->total_length);
+            ok = false;
+            break;
+        }
+        if (wblock.internal) {
+            pcapng_process_internal_block(wth, pcapng, current_section, new_section, &wblock, &data_offset);
+            continue;
+        }
+
+        entry.file_off = bp->offset;
+        entry.ts = rec.ts;
+        entry.rec_type = rec.rec_type;
+        entry.presence_flags = rec.presence_flags | WTAP_HAS_SECTION_NUMBER;
+        entry.tsprec = rec.tsprec;
+        entry.section_number = pcapng->current_section_number;
+        if (rec.rec_type == REC_TYPE_PACKET) {
+            entry.pkt_encap = rec.rec_header.packet_header.pkt_encap;
+            entry.caplen = rec.rec_header.packet_header.caplen;
+            entry.len = rec.rec_header.packet_header.len;
+            entry.interface_id = rec.rec_header.packet_header.interface_id;
+        } else {
+            entry.pkt_encap = WTAP_ENCAP_UNKNOWN;
+            entry.caplen = 0;
+            entry.len = 0;
+            entry.interface_id = 0;
+        }
+        /* The entry takes over the record's options. */
+        entry.block = rec.block;
+        rec.block = NULL;
+        g_array_append_val(records, entry);
+    }
+    wtap_rec_cleanup(&rec);
+    ws_buffer_free(&buf);
+    g_array_free(blocks, true);
+
+    /*
+     * Carry on reading sequentially after the last block we indexed.
+     */
+    if (ok && file_seek(wth->fh, offset, SEEK_SET, err) == -1)
+        ok = false;
+    return ok;
+}
+
+/*
+ * Seek to file position and read packet; if data is non-null, our
+ * caller will accept a pointer to the packet data in a mapping of
+ * the file, if we can supply one, rather than a copy in buf.
+ */
+static bool
+pcapng_seek_read_block(wtap *wth, int64_t seek_off,
+                       wtap_rec *rec, Buffer *buf, const uint8_t **data,
+                       int *err, char **err_info)
 {
     pcapng_t *pcapng = (pcapng_t *)wth->priv;
     section_info_t *section_info, new_section;
@@ -4230,6 +4723,9 @@ pcapng_seek_read(wtap *wth, int64_t seek_off,
 
     wblock.frame_buffer = buf;
     wblock.rec = rec;
+    wblock.skip_packet_data = false;
+    wblock.map_packet_data = data != NULL;
+    wblock.packet_data = NULL;
 
     /* read the block */
     if (!pcapng_read_block(wth, wth->random_fh, pcapng, section_info,
@@ -4253,9 +4749,30 @@ pcapng_seek_read(wtap *wth, int64_t seek_off,
     rec->presence_flags |= WTAP_HAS_SECTION_NUMBER;
     rec->section_number = section_number;
 
+    if (data != NULL)
+        *data = wblock.packet_data;
+
     return true;
 }
 
+/* classic wtap: seek to file position and read packet */
+static bool
+pcapng_seek_read(wtap *wth, int64_t seek_off,
+                 wtap_rec *rec, Buffer *buf,
+                 int *err, char **err_info)
+{
+    return pcapng_seek_read_block(wth, seek_off, rec, buf, NULL, err, err_info);
+}
+
+/* seek to file position and read packet, leaving the data in place if possible */
+static bool
+pcapng_seek_read_mapped(wtap *wth, int64_t seek_off,
+                        wtap_rec *rec, Buffer *buf, const uint8_t **data,
+                        int *err, char **err_info)
+{
+    return pcapng_seek_read_block(wth, seek_off, rec, buf, data, err, err_info);
+}
+
 /* classic wtap: close capture file */
 static void
 pcapng_close(wtap *wth)
@@ -68,6 +68,9 @@ typedef struct wtapng_block_s {
     wtap_block_t block;
     wtap_rec     *rec;
     Buffer       *frame_buffer;
+    bool         skip_packet_data; /* true if packet data needn't be read into frame_buffer */
+    bool         map_packet_data;  /* true if packet data may be returned in place in packet_data */
+    const uint8_t *packet_data;    /* packet data in a mapping of the file, or NULL if in frame_buffer */
 } wtapng_block_t;
 
 /* Section data in private struct */
@@ -0,0 +1,416 @@
+/* test_wiretap.c
+ * Unit tests for reading capture files with wiretap
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include <wiretap/wtap.h>
+#include <wsutil/buffer.h>
+#include <wsutil/nstime.h>
+
+/*
+ * The capture files to read are given on the command line.
+ */
+
+/* A record as returned by wtap_read(). */
+typedef struct {
+    int64_t   offset;
+    unsigned  rec_type;
+    uint32_t  presence_flags;
+    unsigned  section_number;
+    nstime_t  ts;
+    int       tsprec;
+    uint32_t  caplen;
+    uint32_t  len;
+    int       pkt_encap;
+    uint32_t  interface_id;
+    unsigned  num_comments;
+    uint8_t  *data;
+    size_t    data_len;
+} test_record;
+
+static void
+test_record_clear(void *data)
+{
+    g_free(((test_record *)data)->data);
+}
+
+static wtap *
+open_capture(const char *path)
+{
+    wtap *wth;
+    int err;
+    char *err_info;
+
+    wth = wtap_open_offline(path, WTAP_TYPE_AUTO, &err, &err_info, true);
+    if (wth == NULL)
+        g_error("Can't open %s: %s (%s)", path, wtap_strerror(err),
+                err_info != NULL ? err_info : "");
+    return wth;
+}
+
+/* The number of bytes of data that go with the record. */
+static size_t
+record_data_len(const wtap_rec *rec, Buffer *buf)
+{
+    if (rec->rec_type == REC_TYPE_PACKET)
+        return rec->rec_header.packet_header.caplen;
+    return ws_buffer_length(buf);
+}
+
+static void
+save_record(GArray *records, int64_t offset, const wtap_rec *rec,
+            const uint8_t *data, size_t data_len)
+{
+    test_record record;
+
+    memset(&record, 0, sizeof record);
+    record.offset = offset;
+    record.rec_type = rec->rec_type;
+    record.presence_flags = rec->presence_flags;
+    record.section_number = rec->section_number;
+    record.ts = rec->ts;
+    record.tsprec = rec->tsprec;
+    if (rec->rec_type == REC_TYPE_PACKET) {
+        record.caplen = rec->rec_header.packet_header.caplen;
+        record.len = rec->rec_header.packet_header.len;
+        record.pkt_encap = rec->rec_header.packet_header.pkt_encap;
+        record.interface_id = rec->rec_header.packet_header.interface_id;
+    }
+    if (rec->block != NULL)
+        record.num_comments = wtap_block_count_option(rec->block, OPT_COMMENT);
+    record.data = g_memdup2(data, data_len);
+    record.data_len = data_len;
+    g_array_append_val(records, record);
+}
+
+/*
+ * Read all the records in a file with wtap_read(), so that other ways
+ * of reading them can be compared with it.
+ */
+static GArray *
+read_records(wtap *wth)
+{
+    GArray *records;
+    wtap_rec rec;
+    Buffer buf;
+    int64_t offset;
+    int err;
+    char *err_info;
+
+    records = g_array_new(false, false, sizeof(test_record));
+    g_array_set_clear_func(records, test_record_clear);
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 1514);
+    while (wtap_read(wth, &rec, &buf, &err, &err_info, &offset)) {
+        save_record(records, offset, &rec, ws_buffer_start_ptr(&buf),
+                    record_data_len(&rec, &buf));
+        wtap_rec_reset(&rec);
+    }
+    g_assert_cmpint(err, ==, 0);
+    wtap_rec_cleanup(&rec);
+    ws_buffer_free(&buf);
+    return records;
+}
+
+static void
+check_record(const test_record *expected, const wtap_rec *rec,
+             const uint8_t *data, size_t data_len)
+{
+    g_assert_cmpuint(rec->rec_type, ==, expected->rec_type);
+    g_assert_cmphex(rec->presence_flags, ==, expected->presence_flags);
+    if (rec->presence_flags & WTAP_HAS_TS) {
+        g_assert_cmpint(nstime_cmp(&rec->ts, &expected->ts), ==, 0);
+        g_assert_cmpint(rec->tsprec, ==, expected->tsprec);
+    }
+    if (rec->rec_type == REC_TYPE_PACKET) {
+        g_assert_cmpuint(rec->rec_header.packet_header.caplen, ==, expected->caplen);
+        g_assert_cmpuint(rec->rec_header.packet_header.len, ==, expected->len);
+        g_assert_cmpint(rec->rec_header.packet_header.pkt_encap, ==, expected->pkt_encap);
+        if (rec->presence_flags & WTAP_HAS_INTERFACE_ID)
+            g_assert_cmpuint(rec->rec_header.packet_header.interface_id, ==, expected->interface_id);
+    }
+    g_assert_cmpmem(data, data_len, expected->data, expected->data_len);
+}
+
+/*
+ * wtap_seek_read() and wtap_seek_read_mapped() return the same records,
+ * with the same data, as wtap_read(), in any order.
+ */
+static void
+test_seek_read_mapped(const void *user_data)
+{
+    const char *path = (const char *)user_data;
+    wtap *wth;
+    GArray *records;
+    wtap_rec rec;
+    Buffer buf;
+    const uint8_t *data;
+    unsigned i, pass, mapped = 0;
+    int err;
+    char *err_info;
+
+    wth = open_capture(path);
+    records = read_records(wth);
+    g_assert_cmpuint(records->len, >, 0);
+
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 1514);
+    for (pass = 0; pass < 2; pass++) {
+        for (i = 0; i < records->len; i++) {
+            /* Read forwards, then backwards. */
+            const test_record *expected = &g_array_index(records, test_record,
+                                                         pass == 0 ? i : records->len - 1 - i);
+
+            g_assert_true(wtap_seek_read(wth, expected->offset, &rec, &buf, &err, &err_info));
+            check_record(expected, &rec, ws_buffer_start_ptr(&buf), record_data_len(&rec, &buf));
+            wtap_rec_reset(&rec);
+
+            data = NULL;
+            g_assert_true(wtap_seek_read_mapped(wth, expected->offset, &rec, &buf, &data, &err, &err_info));
+            g_assert_nonnull(data);
+            if (data != ws_buffer_start_ptr(&buf))
+                mapped++;
+            check_record(expected, &rec, data,
+                         rec.rec_type == REC_TYPE_PACKET ? rec.rec_header.packet_header.caplen : ws_buffer_length(&buf));
+            wtap_rec_reset(&rec);
+        }
+    }
+
+#ifndef _WIN32
+    /* Uncompressed pcapng files are read in place. */
+    if (wtap_file_type_subtype(wth) == wtap_pcapng_file_type_subtype() &&
+        wtap_get_compression_type(wth) == WTAP_UNCOMPRESSED)
+        g_assert_cmpuint(mapped, >, 0);
+#else
+    g_assert_cmpuint(mapped, ==, 0);
+#endif
+
+    wtap_rec_cleanup(&rec);
+    ws_buffer_free(&buf);
+    g_array_free(records, true);
+    wtap_close(wth);
+}
+
+/*
+ * wtap_index_records(), followed by wtap_read() for anything it didn't
+ * index, finds the same records, with the same metadata, as wtap_read()
+ * on its own.
+ */
+static void
+test_index_records(const void *user_data)
+{
+    const char *path = (const char *)user_data;
+    static const unsigned num_threads[] = { 1, 2, 4, 16 };
+    wtap *wth;
+    GArray *records, *index;
+    wtap_rec rec;
+    Buffer buf;
+    int64_t offset;
+    unsigned i, n;
+    int err;
+    char *err_info;
+
+    wth = open_capture(path);
+    records = read_records(wth);
+    wtap_close(wth);
+
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 1514);
+    for (n = 0; n < G_N_ELEMENTS(num_threads); n++) {
+        wth = open_capture(path);
+        index = wtap_index_records(wth, num_threads[n], &err, &err_info);
+        g_assert_cmpint(err, ==, 0);
+        if (index == NULL) {
+            /* Only uncompressed pcapng files can be indexed. */
+            g_assert_false(wtap_file_type_subtype(wth) == wtap_pcapng_file_type_subtype() &&
+                           wtap_get_compression_type(wth) == WTAP_UNCOMPRESSED);
+            i = 0;
+        } else {
+            g_assert_cmpuint(index->len, <=, records->len);
+            for (i = 0; i < index->len; i++) {
+                const wtap_record_index_entry *entry = &g_array_index(index, wtap_record_index_entry, i);
+                const test_record *expected = &g_array_index(records, test_record, i);
+
+                g_assert_cmpint(entry->file_off, ==, expected->offset);
+                g_assert_cmpuint(entry->rec_type, ==, expected->rec_type);
+                g_assert_cmphex(entry->presence_flags, ==, expected->presence_flags);
+                if (entry->presence_flags & WTAP_HAS_TS) {
+                    g_assert_cmpint(nstime_cmp(&entry->ts, &expected->ts), ==, 0);
+                    g_assert_cmpint(entry->tsprec, ==, expected->tsprec);
+                }
+                if (entry->presence_flags & WTAP_HAS_SECTION_NUMBER)
+                    g_assert_cmpuint(entry->section_number, ==, expected->section_number);
+                if (entry->rec_type == REC_TYPE_PACKET) {
+                    g_assert_cmpuint(entry->caplen, ==, expected->caplen);
+                    g_assert_cmpuint(entry->len, ==, expected->len);
+                    g_assert_cmpint(entry->pkt_encap, ==, expected->pkt_encap);
+                    if (entry->presence_flags & WTAP_HAS_INTERFACE_ID)
+                        g_assert_cmpuint(entry->interface_id, ==, expected->interface_id);
+                }
+                g_assert_cmpuint(entry->block != NULL ? wtap_block_count_option(entry->block, OPT_COMMENT) : 0,
+                                 ==, expected->num_comments);
+            }
+            g_array_free(index, true);
+        }
+
+        /* wtap_read() carries on after the indexed records. */
+        while (wtap_read(wth, &rec, &buf, &err, &err_info, &offset)) {
+            const test_record *expected;
+
+            g_assert_cmpuint(i, <, records->len);
+            expected = &g_array_index(records, test_record, i++);
+            g_assert_cmpint(offset, ==, expected->offset);
+            check_record(expected, &rec, ws_buffer_start_ptr(&buf), record_data_len(&rec, &buf));
+            wtap_rec_reset(&rec);
+        }
+        g_assert_cmpint(err, ==, 0);
+        g_assert_cmpuint(i, ==, records->len);
+        wtap_close(wth);
+    }
+    wtap_rec_cleanup(&rec);
+    ws_buffer_free(&buf);
+    g_array_free(records, true);
+}
+
+#ifndef _WIN32
+/*
+ * A file that's truncated while it's open, e.g. a ring buffer file
+ * that's being reused, gives a read error rather than a crash when
+ * the records that are no longer there are read.
+ */
+static void
+test_seek_read_mapped_truncated(const void *user_data)
+{
+    const char *path = (const char *)user_data;
+    char *contents, *tmp_path;
+    size_t length;
+    int fd;
+    wtap *wth;
+    GArray *records;
+    const test_record *first, *last;
+    wtap_rec rec;
+    Buffer buf;
+    const uint8_t *data;
+    int err;
+    char *err_info;
+
+    g_assert_true(g_file_get_contents(path, &contents, &length, NULL));
+    fd = g_file_open_tmp("test_wiretap-XXXXXX.pcapng", &tmp_path, NULL);
+    g_assert_cmpint(fd, !=, -1);
+    close(fd);
+    g_assert_true(g_file_set_contents(tmp_path, contents, length, NULL));
+    g_free(contents);
+
+    wth = open_capture(tmp_path);
+    records = read_records(wth);
+    g_assert_cmpuint(records->len, >, 1);
+    first = &g_array_index(records, test_record, 0);
+    last = &g_array_index(records, test_record, records->len - 1);
+    if (last->offset - first->offset < 65536 || last->rec_type != REC_TYPE_PACKET) {
+        g_test_skip("No packet far enough from the start of the file");
+        g_array_free(records, true);
+        wtap_close(wth);
+        g_unlink(tmp_path);
+        g_free(tmp_path);
+        return;
+    }
+
+    /* Map the file. */
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 1514);
+    data = NULL;
+    g_assert_true(wtap_seek_read_mapped(wth, last->offset, &rec, &buf, &data, &err, &err_info));
+    check_record(last, &rec, data, last->data_len);
+    wtap_rec_reset(&rec);
+
+    /* Cut the file off just after the header of the last record. */
+    g_assert_cmpint(truncate(tmp_path, last->offset + 28), ==, 0);
+
+    /*
+     * The records before that can still be read; reading the first
+     * one also moves the read buffer away from the end of the file,
+     * so the last one is read from the file again.
+     */
+    data = NULL;
+    g_assert_true(wtap_seek_read_mapped(wth, first->offset, &rec, &buf, &data, &err, &err_info));
+    check_record(first, &rec, data, first->data_len);
+    wtap_rec_reset(&rec);
+
+    data = NULL;
+    g_assert_false(wtap_seek_read_mapped(wth, last->offset, &rec, &buf, &data, &err, &err_info));
+    g_assert_cmpint(err, !=, 0);
+    g_free(err_info);
+    wtap_rec_reset(&rec);
+
+    wtap_rec_cleanup(&rec);
+    ws_buffer_free(&buf);
+    g_array_free(records, true);
+    wtap_close(wth);
+    g_unlink(tmp_path);
+    g_free(tmp_path);
+}
+#endif
+
+int
+main(int argc, char **argv)
+{
+    int i, ret;
+
+    g_test_init(&argc, &argv, NULL);
+
+    wtap_init(false);
+
+    for (i = 1; i < argc; i++) {
+        char *basename = g_path_get_basename(argv[i]);
+        char *name;
+
+        name = g_strdup_printf("/wtap_seek_read/mapped/%s", basename);
+        g_test_add_data_func(name, argv[i], test_seek_read_mapped);
+        g_free(name);
+        name = g_strdup_printf("/wtap_index_records/%s", basename);
+        g_test_add_data_func(name, argv[i], test_index_records);
+        g_free(name);
+#ifndef _WIN32
+        if (!g_str_has_suffix(basename, ".gz")) {
+            name = g_strdup_printf("/wtap_seek_read/mapped_truncated/%s", basename);
+            g_test_add_data_func(name, argv[i], test_seek_read_mapped_truncated);
+            g_free(name);
+        }
+#endif
+        g_free(basename);
+    }
+
+    ret = g_test_run();
+
+    wtap_cleanup();
+
+    return ret;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
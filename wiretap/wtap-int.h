@@ -30,6 +30,10 @@ typedef bool (*subtype_read_func)(struct wtap*, wtap_rec *,
                                       Buffer *, int *, char **, int64_t *);
 typedef bool (*subtype_seek_read_func)(struct wtap*, int64_t, wtap_rec *,
                                            Buffer *, int *, char **);
+typedef bool (*subtype_seek_read_mapped_func)(struct wtap*, int64_t, wtap_rec *,
+                                           Buffer *, const uint8_t **, int *, char **);
+typedef bool (*subtype_index_records_func)(struct wtap*, unsigned, GArray *,
+                                           int *, char **);
 
 /**
  * Struct holding data of the currently read file.
@@ -55,6 +59,8 @@ struct wtap {
 
     subtype_read_func           subtype_read;
     subtype_seek_read_func      subtype_seek_read;
+    subtype_seek_read_mapped_func subtype_seek_read_mapped; /**< NULL if the file type can't return data in place */
+    subtype_index_records_func  subtype_index_records;  /**< NULL if the file type can't be indexed */
     void                        (*subtype_sequential_close)(struct wtap*);
     void                        (*subtype_close)(struct wtap*);
     int                         file_encap;    /* per-file, for those
@@ -77,6 +83,7 @@ struct wtap {
     wtap_new_ipv6_callback_t    add_new_ipv6;
     wtap_new_secrets_callback_t add_new_secrets;
     GPtrArray                   *fast_seek;
+    bool                        skip_packet_data;       /**< true if sequential reads needn't fill in the packet data */
 };
 
 struct wtap_dumper;
@@ -1689,6 +1689,12 @@ void wtap_set_cb_new_secrets(wtap *wth, wtap_new_secrets_callback_t add_new_secr
 	}
 }
 
+void
+wtap_set_skip_packet_data(wtap *wth, bool skip)
+{
+	wth->skip_packet_data = skip;
+}
+
 void
 wtapng_process_dsb(wtap *wth, wtap_block_t dsb)
 {
@@ -1913,10 +1919,42 @@ wtap_rec_generate_idb(const wtap_rec *rec)
 	return wtap_generate_idb(rec->rec_header.packet_header.pkt_encap, tsprec, 0);
 }
 
-bool
-wtap_seek_read(wtap *wth, int64_t seek_off, wtap_rec *rec, Buffer *buf,
-    int *err, char **err_info)
+static void
+wtap_record_index_entry_clear(void *data)
+{
+	wtap_record_index_entry *entry = (wtap_record_index_entry *)data;
+
+	wtap_block_unref(entry->block);
+}
+
+GArray *
+wtap_index_records(wtap *wth, unsigned num_threads, int *err,
+    char **err_info)
+{
+	GArray *records;
+
+	*err = 0;
+	*err_info = NULL;
+	if (wth->subtype_index_records == NULL || wth->random_fh == NULL)
+		return NULL;
+
+	records = g_array_new(false, false, sizeof(wtap_record_index_entry));
+	g_array_set_clear_func(records, wtap_record_index_entry_clear);
+	if (!wth->subtype_index_records(wth, num_threads, records, err,
+	    err_info) && *err == 0) {
+		/* This file can't be indexed. */
+		g_array_free(records, true);
+		return NULL;
+	}
+	return records;
+}
+
+static bool
+wtap_seek_read_internal(wtap *wth, int64_t seek_off, wtap_rec *rec, Buffer *buf,
+    const uint8_t **data, int *err, char **err_info)
 {
+	bool ok;
+
 	/*
 	 * Initialize the record to default values.
 	 */
@@ -1925,7 +1963,13 @@ wtap_seek_read(wtap *wth, int64_t seek_off, wtap_rec *rec, Buffer *buf,
 
 	*err = 0;
 	*err_info = NULL;
-	if (!wth->subtype_seek_read(wth, seek_off, rec, buf, err, err_info)) {
+	if (data != NULL && wth->subtype_seek_read_mapped != NULL) {
+		*data = NULL;
+		ok = wth->subtype_seek_read_mapped(wth, seek_off, rec, buf, data,
+		    err, err_info);
+	} else
+		ok = wth->subtype_seek_read(wth, seek_off, rec, buf, err, err_info);
+	if (!ok) {
 		if (rec->block != NULL) {
 			/*
 			 * Unreference any block created for this record.
@@ -1950,9 +1994,25 @@ wtap_seek_read(wtap *wth, int64_t seek_off, wtap_rec *rec, Buffer *buf,
 		ws_assert(rec->rec_header.packet_header.pkt_encap != WTAP_ENCAP_NONE);
 	}
 
+	if (data != NULL && *data == NULL)
+		*data = ws_buffer_start_ptr(buf);
 	return true;
 }
 
+bool
+wtap_seek_read(wtap *wth, int64_t seek_off, wtap_rec *rec, Buffer *buf,
+    int *err, char **err_info)
+{
+	return wtap_seek_read_internal(wth, seek_off, rec, buf, NULL, err, err_info);
+}
+
+bool
+wtap_seek_read_mapped(wtap *wth, int64_t seek_off, wtap_rec *rec, Buffer *buf,
+    const uint8_t **data, int *err, char **err_info)
+{
+	return wtap_seek_read_internal(wth, seek_off, rec, buf, data, err, err_info);
+}
+
 static bool
 wtap_full_file_read_file(wtap *wth, FILE_T fh, wtap_rec *rec, Buffer *buf, int *err, char **err_info)
 {
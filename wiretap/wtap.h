@@ -1891,6 +1891,17 @@ typedef void (*wtap_new_secrets_callback_t)(uint32_t secrets_type, const void *s
 WS_DLL_PUBLIC
 void wtap_set_cb_new_secrets(wtap *wth, wtap_new_secrets_callback_t add_new_secrets);
 
+/**
+ * Tell wiretap whether the caller of wtap_read() needs the packet data,
+ * or only the record metadata (time stamps, lengths, encapsulation,
+ * interface ID, options). If skip is true, file types that support it
+ * skip over the packet data rather than reading it into the Buffer,
+ * which is then left empty; other file types ignore this.
+ * wtap_seek_read() always reads the packet data.
+ */
+WS_DLL_PUBLIC
+void wtap_set_skip_packet_data(wtap *wth, bool skip);
+
 /** Read the next record in the file, filling in *phdr and *buf.
  *
  * @wth a wtap * returned by a call that opened a file for reading.
@@ -1910,6 +1921,55 @@ WS_DLL_PUBLIC
 bool wtap_read(wtap *wth, wtap_rec *rec, Buffer *buf, int *err,
     char **err_info, int64_t *offset);
 
+/**
+ * Metadata for one record, as returned by wtap_index_records().
+ */
+typedef struct wtap_record_index_entry {
+    int64_t   file_off;          /**< offset to pass to wtap_seek_read() */
+    nstime_t  ts;                /**< time stamp, if WTAP_HAS_TS is set */
+    unsigned  rec_type;          /**< REC_TYPE_ value */
+    uint32_t  presence_flags;    /**< WTAP_HAS_ flags */
+    int       tsprec;            /**< WTAP_TSPREC_ value */
+    unsigned  section_number;    /**< section number, if WTAP_HAS_SECTION_NUMBER is set */
+    int       pkt_encap;         /**< for packets, the WTAP_ENCAP_ type */
+    uint32_t  caplen;            /**< for packets, the captured length */
+    uint32_t  len;               /**< for packets, the length on the network */
+    uint32_t  interface_id;      /**< for packets, if WTAP_HAS_INTERFACE_ID is set */
+    wtap_block_t block;          /**< the record's options, or NULL if it has none */
+} wtap_record_index_entry;
+
+/** Read the metadata of the remaining records in a capture file without
+ * reading their data, as calls to wtap_read() with packet data skipped
+ * would, using up to num_threads threads to find the records.
+ *
+ * Blocks processed internally by wiretap, such as interface descriptions,
+ * name resolution and decryption secrets blocks, are processed in file
+ * order, so the corresponding callbacks are called as they would be by
+ * wtap_read(), but before the metadata of any of the records is returned
+ * rather than interleaved with it.
+ *
+ * Records are indexed up to the first data that doesn't look like a
+ * valid record, or the end of the file; afterwards, wtap_read() carries
+ * on from there, returning any records that weren't indexed or reporting
+ * the error at that point.
+ *
+ * This requires a file opened for random access.
+ *
+ * @wth a wtap * returned by a call that opened a file for reading.
+ * @param num_threads the maximum number of threads to use.
+ * @param err a positive "errno" value, or a negative number indicating
+ * the type of error, if reading failed.
+ * @param err_info for some errors, a string giving more details of
+ * the error
+ * @return NULL, with *err set to 0, if the file type, or this file,
+ * doesn't support this; otherwise, an array of wtap_record_index_entry,
+ * to be freed with g_array_free(), which releases the entries' blocks,
+ * containing the records read so far if *err is non-zero.
+ */
+WS_DLL_PUBLIC
+GArray *wtap_index_records(wtap *wth, unsigned num_threads, int *err,
+    char **err_info);
+
 /** Read the record at a specified offset in a capture file, filling in
  * *phdr and *buf.
  *
@@ -1930,6 +1990,31 @@ WS_DLL_PUBLIC
 bool wtap_seek_read(wtap *wth, int64_t seek_off, wtap_rec *rec,
     Buffer *buf, int *err, char **err_info);
 
+/** Read the record at a specified offset in a capture file, as
+ * wtap_seek_read() does, but without copying the packet data if
+ * the file type and file allow it.
+ *
+ * @wth a wtap * returned by a call that opened a file for random-access
+ * reading.
+ * @seek_off a int64_t giving an offset value returned by a previous
+ * wtap_read() call.
+ * @rec a pointer to a struct wtap_rec, filled in with information
+ * about the record.
+ * @buf a pointer to a Buffer, filled in with data from the record if
+ * it can't be returned in place.
+ * @data set to point to the record's data; that's either a pointer
+ * into a read-only memory mapping of the file, valid until the file
+ * is closed, or the start of buf.
+ * @param err a positive "errno" value, or a negative number indicating
+ * the type of error, if the read failed.
+ * @param err_info for some errors, a string giving more details of
+ * the error
+ * @return true on success, false on failure.
+ */
+WS_DLL_PUBLIC
+bool wtap_seek_read_mapped(wtap *wth, int64_t seek_off, wtap_rec *rec,
+    Buffer *buf, const uint8_t **data, int *err, char **err_info);
+
 /*** initialize a wtap_rec structure ***/
 WS_DLL_PUBLIC
 void wtap_rec_init(wtap_rec *rec);
@@ -16,6 +16,12 @@
 #include "config.h"
 
 #include <wsutil/crc32.h>
+#include <wsutil/pint.h>
+
+#ifdef HAVE_SSE4_2
+#include "ws_cpuid.h"
+#endif
+#include "crc32_int.h"
 
 #ifdef HAVE_ZLIBNG
 #include <zlib-ng.h>
@@ -361,6 +367,92 @@ static const uint32_t crc32_5D6DCB[] =
 		0x0098206c, 0x00c54da7, 0x0022fbfa, 0x007f9631
 };
 
+/*
+ * Slicing-by-8 tables for the table-driven CRCs: slice8[k][i] is the
+ * CRC of byte i followed by k zero bytes, so that 8 bytes of input
+ * can be folded in per iteration with independent table lookups
+ * instead of 8 dependent ones. They are derived from the 256-entry
+ * tables above the first time they are needed.
+ */
+static uint32_t crc32c_slice8[8][256];
+#if !defined (HAVE_ZLIB) && !defined (HAVE_ZLIBNG)
+static uint32_t crc32_ccitt_slice8[8][256];
+#endif
+#ifdef HAVE_SSE4_2
+static bool crc32c_use_sse42;
+#endif
+
+static void
+crc32_slice8_fill(uint32_t slice8[8][256], const uint32_t *table)
+{
+	unsigned i, k;
+
+	for (i = 0; i < 256; i++)
+		slice8[0][i] = table[i];
+	for (k = 1; k < 8; k++) {
+		for (i = 0; i < 256; i++) {
+			uint32_t c = slice8[k - 1][i];
+			slice8[k][i] = (c >> 8) ^ table[c & 0xFF];
+		}
+	}
+}
+
+static void
+crc32_init(void)
+{
+	static gsize initialized = 0;
+
+	if (g_once_init_enter(&initialized)) {
+		crc32_slice8_fill(crc32c_slice8, crc32c_table);
+#if !defined (HAVE_ZLIB) && !defined (HAVE_ZLIBNG)
+		crc32_slice8_fill(crc32_ccitt_slice8, crc32_ccitt_table);
+#endif
+#ifdef HAVE_SSE4_2
+		crc32c_use_sse42 = ws_cpuid_sse42() != 0;
+#endif
+		g_once_init_leave(&initialized, 1);
+	}
+}
+
+/*
+ * Reflected CRC using slicing-by-8; same result as applying
+ * CRC32_ACCUMULATE() with slice8[0] to every byte.
+ */
+static uint32_t
+crc32_slice8_accumulate(uint32_t slice8[8][256], const uint8_t *p, size_t len, uint32_t crc)
+{
+	while (len >= 8) {
+		uint32_t lo = pletoh32(p) ^ crc;
+		uint32_t hi = pletoh32(p + 4);
+
+		crc = slice8[7][lo & 0xFF] ^
+		      slice8[6][(lo >> 8) & 0xFF] ^
+		      slice8[5][(lo >> 16) & 0xFF] ^
+		      slice8[4][lo >> 24] ^
+		      slice8[3][hi & 0xFF] ^
+		      slice8[2][(hi >> 8) & 0xFF] ^
+		      slice8[1][(hi >> 16) & 0xFF] ^
+		      slice8[0][hi >> 24];
+		p += 8;
+		len -= 8;
+	}
+	while (len-- > 0)
+		CRC32_ACCUMULATE(crc, *p++, slice8[0]);
+
+	return crc;
+}
+
+static uint32_t
+crc32c_accumulate(const uint8_t *p, size_t len, uint32_t crc)
+{
+	crc32_init();
+#ifdef HAVE_SSE4_2
+	if (crc32c_use_sse42)
+		return crc32c_sse42_calculate_no_swap(p, len, crc);
+#endif
+	return crc32_slice8_accumulate(crc32c_slice8, p, len, crc);
+}
+
 uint32_t
 crc32c_table_lookup (unsigned char pos)
 {
@@ -376,23 +468,20 @@ crc32_ccitt_table_lookup (unsigned char pos)
 uint32_t
 crc32c_calculate(const void *buf, int len, uint32_t crc)
 {
-	const uint8_t *p = (const uint8_t *)buf;
+	if (len <= 0)
+		return crc;
 	crc = CRC32C_SWAP(crc);
-	while (len-- > 0) {
-		CRC32C(crc, *p++);
-	}
+	crc = crc32c_accumulate((const uint8_t *)buf, len, crc);
 	return CRC32C_SWAP(crc);
 }
 
 uint32_t
 crc32c_calculate_no_swap(const void *buf, int len, uint32_t crc)
 {
-	const uint8_t *p = (const uint8_t *)buf;
-	while (len-- > 0) {
-		CRC32C(crc, *p++);
-	}
+	if (len <= 0)
+		return crc;
 
-	return crc;
+	return crc32c_accumulate((const uint8_t *)buf, len, crc);
 }
 
 uint32_t
@@ -411,11 +500,10 @@ crc32_ccitt_seed(const uint8_t *buf, unsigned len, uint32_t seed)
 	return (unsigned)crc32(~seed, buf, len);
 #endif
 #else
-	unsigned i;
-	uint32_t crc32 = seed;
+	uint32_t crc32;
 
-	for (i = 0; i < len; i++)
-		CRC32_ACCUMULATE(crc32, buf[i], crc32_ccitt_table);
+	crc32_init();
+	crc32 = crc32_slice8_accumulate(crc32_ccitt_slice8, buf, len, seed);
 
 	return ( ~crc32 );
 #endif
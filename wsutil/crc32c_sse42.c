@@ -0,0 +1,95 @@
+/* crc32c_sse42.c
+ * CRC32C using the SSE4.2 crc32 instruction
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_SSE4_2
+
+#include <glib.h>
+#include <string.h>
+
+#include <nmmintrin.h>
+
+#include "crc32_int.h"
+
+/*
+ * The crc32 instruction implements the reflected Castagnoli polynomial
+ * with no pre- or post-inversion, i.e. exactly what CRC32_ACCUMULATE()
+ * does with crc32c_table, so the result can be used interchangeably
+ * with the table-driven code.
+ */
+uint32_t
+crc32c_sse42_calculate_no_swap(const uint8_t *buf, size_t len, uint32_t crc)
+{
+	const uint8_t *p = buf;
+
+	/* Align so that the wide loads below don't straddle cache lines. */
+	while (len > 0 && ((uintptr_t)p & 7) != 0) {
+		crc = _mm_crc32_u8(crc, *p++);
+		len--;
+	}
+
+#if defined(__x86_64__) || defined(_M_X64)
+	{
+		uint64_t crc64 = crc;
+		uint64_t v;
+
+		while (len >= 32) {
+			memcpy(&v, p, 8);
+			crc64 = _mm_crc32_u64(crc64, v);
+			memcpy(&v, p + 8, 8);
+			crc64 = _mm_crc32_u64(crc64, v);
+			memcpy(&v, p + 16, 8);
+			crc64 = _mm_crc32_u64(crc64, v);
+			memcpy(&v, p + 24, 8);
+			crc64 = _mm_crc32_u64(crc64, v);
+			p += 32;
+			len -= 32;
+		}
+		while (len >= 8) {
+			memcpy(&v, p, 8);
+			crc64 = _mm_crc32_u64(crc64, v);
+			p += 8;
+			len -= 8;
+		}
+		crc = (uint32_t)crc64;
+	}
+#endif
+
+	while (len >= 4) {
+		uint32_t v;
+
+		memcpy(&v, p, 4);
+		crc = _mm_crc32_u32(crc, v);
+		p += 4;
+		len -= 4;
+	}
+	while (len > 0) {
+		crc = _mm_crc32_u8(crc, *p++);
+		len--;
+	}
+
+	return crc;
+}
+
+#endif /* HAVE_SSE4_2 */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
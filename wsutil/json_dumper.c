@@ -20,6 +20,7 @@
 #include <math.h>
 
 #include <wsutil/array.h>
+#include <wsutil/to_str.h>
 #include <wsutil/wslog.h>
 
 /*
@@ -128,23 +129,42 @@ json_puts_string(const json_dumper *dumper, const char *str, bool dot_to_undersc
     };
 
     jd_putc(dumper, '"');
-    for (int i = 0; str[i]; i++) {
-        if ((unsigned)str[i] < 0x20) {
+    /*
+     * Write runs of characters that need no escaping with a single call,
+     * rather than one putc per character; most member names and values
+     * don't need escaping at all.
+     */
+    size_t run_start = 0;
+    size_t i;
+    for (i = 0; str[i]; i++) {
+        unsigned char c = (unsigned char)str[i];
+        if (c >= 0x20 && c != '\\' && c != '"' && c != '/' &&
+                !(dot_to_underscore && c == '.')) {
+            continue;
+        }
+        if (c == '/' && (i == 0 || str[i - 1] != '<')) {
+            continue;
+        }
+        if (i > run_start) {
+            jd_puts_len(dumper, str + run_start, i - run_start);
+        }
+        run_start = i + 1;
+        if (c < 0x20) {
             jd_putc(dumper, '\\');
-            jd_puts(dumper, json_cntrl[(unsigned)str[i]]);
-        } else if (i > 0 && str[i - 1] == '<' && str[i] == '/') {
+            jd_puts(dumper, json_cntrl[c]);
+        } else if (c == '/') {
             // Convert </script> to <\/script> to avoid breaking web pages.
             jd_puts(dumper, "\\/");
+        } else if (c == '.') {
+            jd_putc(dumper, '_');
         } else {
-            if (str[i] == '\\' || str[i] == '"') {
-                jd_putc(dumper, '\\');
-            }
-            if (dot_to_underscore && str[i] == '.')
-                jd_putc(dumper, '_');
-            else
-                jd_putc(dumper, str[i]);
+            jd_putc(dumper, '\\');
+            jd_putc(dumper, c);
         }
     }
+    if (i > run_start) {
+        jd_puts_len(dumper, str + run_start, i - run_start);
+    }
     jd_putc(dumper, '"');
 }
 
@@ -606,6 +626,46 @@ json_dumper_value_double(json_dumper *dumper, double value)
     dumper->state[dumper->current_depth] = JSON_DUMPER_TYPE_VALUE;
 }
 
+void
+json_dumper_value_int64(json_dumper *dumper, int64_t value)
+{
+    if (!json_dumper_check_previous_error(dumper)) {
+        return;
+    }
+
+    if (!json_dumper_setting_value_ok(dumper)) {
+        return;
+    }
+
+    prepare_token(dumper);
+    char buffer[24];
+    char *end = buffer + sizeof(buffer);
+    char *start = int64_to_str_back(end, value);
+    jd_puts_len(dumper, start, end - start);
+
+    dumper->state[dumper->current_depth] = JSON_DUMPER_TYPE_VALUE;
+}
+
+void
+json_dumper_value_uint64(json_dumper *dumper, uint64_t value)
+{
+    if (!json_dumper_check_previous_error(dumper)) {
+        return;
+    }
+
+    if (!json_dumper_setting_value_ok(dumper)) {
+        return;
+    }
+
+    prepare_token(dumper);
+    char buffer[24];
+    char *end = buffer + sizeof(buffer);
+    char *start = uint64_to_str_back(end, value);
+    jd_puts_len(dumper, start, end - start);
+
+    dumper->state[dumper->current_depth] = JSON_DUMPER_TYPE_VALUE;
+}
+
 void
 json_dumper_value_va_list(json_dumper *dumper, const char *format, va_list ap)
 {
@@ -89,6 +89,15 @@ json_dumper_value_string(json_dumper *dumper, const char *value);
 WS_DLL_PUBLIC void
 json_dumper_value_double(json_dumper *dumper, double value);
 
+/**
+ * Dump an integer as a JSON number, without going through printf.
+ */
+WS_DLL_PUBLIC void
+json_dumper_value_int64(json_dumper *dumper, int64_t value);
+
+WS_DLL_PUBLIC void
+json_dumper_value_uint64(json_dumper *dumper, uint64_t value);
+
 /**
  * Dump number, "true", "false" or "null" values.
  */
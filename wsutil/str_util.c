@@ -1455,6 +1455,108 @@ EBCDIC_to_ASCII1(uint8_t c)
     return EBCDIC_translate_ASCII[c];
 }
 
+/* "000102...feff": the two hex digits of every byte value, so that a
+ * byte can be formatted with a single two character copy. */
+#define HEX_DIGIT_PAIRS_ROW(h) \
+    h "0" h "1" h "2" h "3" h "4" h "5" h "6" h "7" \
+    h "8" h "9" h "a" h "b" h "c" h "d" h "e" h "f"
+
+static const char hex_digit_pairs[] =
+    HEX_DIGIT_PAIRS_ROW("0") HEX_DIGIT_PAIRS_ROW("1") HEX_DIGIT_PAIRS_ROW("2") HEX_DIGIT_PAIRS_ROW("3")
+    HEX_DIGIT_PAIRS_ROW("4") HEX_DIGIT_PAIRS_ROW("5") HEX_DIGIT_PAIRS_ROW("6") HEX_DIGIT_PAIRS_ROW("7")
+    HEX_DIGIT_PAIRS_ROW("8") HEX_DIGIT_PAIRS_ROW("9") HEX_DIGIT_PAIRS_ROW("a") HEX_DIGIT_PAIRS_ROW("b")
+    HEX_DIGIT_PAIRS_ROW("c") HEX_DIGIT_PAIRS_ROW("d") HEX_DIGIT_PAIRS_ROW("e") HEX_DIGIT_PAIRS_ROW("f");
+
+/* The binary digits of every nibble value. */
+static const char bin_digit_quads[16][4] = {
+    "0000", "0001", "0010", "0011", "0100", "0101", "0110", "0111",
+    "1000", "1001", "1010", "1011", "1100", "1101", "1110", "1111"
+};
+
+unsigned
+hex_dump_byte_chars(hex_dump_bytes_fmt fmt)
+{
+    switch (fmt) {
+    case HEXDUMP_BYTES_BITS:
+        return 8;
+    case HEXDUMP_BYTES_DEC:
+    case HEXDUMP_BYTES_OCT:
+        return 3;
+    case HEXDUMP_BYTES_HEX:
+    default:
+        return 2;
+    }
+}
+
+char *
+hex_dump_format_bytes(char *buf, const uint8_t *cp, unsigned length,
+                      hex_dump_bytes_fmt fmt)
+{
+    unsigned i;
+    uint8_t c;
+
+    switch (fmt) {
+    case HEXDUMP_BYTES_BITS:
+        for (i = 0; i < length; i++) {
+            *buf++ = ' ';
+            memcpy(buf, bin_digit_quads[cp[i] >> 4], 4);
+            memcpy(buf + 4, bin_digit_quads[cp[i] & 0xf], 4);
+            buf += 8;
+        }
+        break;
+    case HEXDUMP_BYTES_DEC:
+        for (i = 0; i < length; i++) {
+            c = cp[i];
+            buf[0] = ' ';
+            buf[1] = c < 100 ? ' ' : '0' + c / 100;
+            buf[2] = c < 10 ? ' ' : '0' + (c / 10) % 10;
+            buf[3] = '0' + c % 10;
+            buf += 4;
+        }
+        break;
+    case HEXDUMP_BYTES_OCT:
+        for (i = 0; i < length; i++) {
+            c = cp[i];
+            buf[0] = ' ';
+            buf[1] = '0' + (c >> 6);
+            buf[2] = '0' + ((c >> 3) & 7);
+            buf[3] = '0' + (c & 7);
+            buf += 4;
+        }
+        break;
+    case HEXDUMP_BYTES_HEX:
+    default:
+        for (i = 0; i < length; i++) {
+            *buf++ = ' ';
+            memcpy(buf, &hex_digit_pairs[cp[i] * 2], 2);
+            buf += 2;
+        }
+        break;
+    }
+    return buf;
+}
+
+char *
+hex_dump_format_chars(char *buf, const uint8_t *cp, unsigned length,
+                      hex_dump_enc encoding, char nonprint)
+{
+    unsigned i;
+    uint8_t c;
+
+    if (encoding == HEXDUMP_ENC_EBCDIC) {
+        for (i = 0; i < length; i++) {
+            c = EBCDIC_translate_ASCII[cp[i]];
+            *buf++ = ((c >= ' ') && (c < 0x7f)) ? (char)c : nonprint;
+        }
+    } else {
+        for (i = 0; i < length; i++) {
+            c = cp[i];
+            *buf++ = ((c >= ' ') && (c < 0x7f)) ? (char)c : nonprint;
+        }
+    }
+    return buf;
+}
+
 /*
  * This routine is based on a routine created by Dan Lasley
  * <DLASLEY@PROMUS.com>.
@@ -1462,21 +1564,47 @@ EBCDIC_to_ASCII1(uint8_t c)
  * It was modified for Wireshark by Gilbert Ramirez and others.
  */
 
-#define MAX_OFFSET_LEN   8       /* max length of hex offset of bytes */
-#define BYTES_PER_LINE  16      /* max byte values printed on a line */
-#define HEX_DUMP_LEN    (BYTES_PER_LINE*3)
+#define HEX_DUMP_LEN    (HEXDUMP_BYTES_PER_LINE*3)
                                 /* max number of characters hex dump takes -
                                    2 digits plus trailing blank */
-#define DATA_DUMP_LEN   (HEX_DUMP_LEN + 2 + 2 + BYTES_PER_LINE)
-                                /* number of characters those bytes take;
-                                   3 characters per byte of hex dump,
-                                   2 blanks separating hex from ASCII,
-                                   2 optional ASCII dump delimiters,
-                                   1 character per byte of ASCII dump */
-#define MAX_LINE_LEN    (MAX_OFFSET_LEN + 2 + DATA_DUMP_LEN)
-                                /* number of characters per line;
-                                   offset, 2 blanks separating offset
-                                   from data dump, data dump */
+
+unsigned
+hex_dump_line(char *line, unsigned offset, unsigned offset_digits,
+              const uint8_t *cp, unsigned length,
+              hex_dump_enc encoding, unsigned ascii_option)
+{
+    char     *p = line;
+    unsigned  i;
+
+    if (length > HEXDUMP_BYTES_PER_LINE)
+        length = HEXDUMP_BYTES_PER_LINE;
+
+    for (i = offset_digits; i > 0; i--) {
+        *p++ = hex_digit_pairs[((offset >> ((i - 1) * 4)) & 0xF) * 2 + 1];
+    }
+    *p++ = ' ';
+    *p++ = ' ';
+
+    for (i = 0; i < length; i++) {
+        memcpy(p, &hex_digit_pairs[cp[i] * 2], 2);
+        p[2] = ' ';
+        p += 3;
+    }
+    /* Pad a short last line so that the ASCII dump lines up, and
+     * separate it from the hex dump with 2 blanks. */
+    memset(p, ' ', HEX_DUMP_LEN - length * 3 + 2);
+    p += HEX_DUMP_LEN - length * 3 + 2;
+
+    if (ascii_option != HEXDUMP_ASCII_EXCLUDE) {
+        if (ascii_option == HEXDUMP_ASCII_DELIMIT)
+            *p++ = '|';
+        p = hex_dump_format_chars(p, cp, length, encoding, '.');
+        if (ascii_option == HEXDUMP_ASCII_DELIMIT)
+            *p++ = '|';
+    }
+    *p = '\0';
+    return (unsigned)(p - line);
+}
 
 bool
 hex_dump_buffer(bool (*print_line)(void *, const char *), void *fp,
@@ -1484,14 +1612,9 @@ hex_dump_buffer(bool (*print_line)(void *, const char *), void *fp,
                                     hex_dump_enc encoding,
                                     unsigned ascii_option)
 {
-    register unsigned int ad, i, j, k, l;
-    unsigned char         c;
-    char                  line[MAX_LINE_LEN + 1];
-    unsigned int          use_digits;
-
-    static char binhex[16] = {
-        '0', '1', '2', '3', '4', '5', '6', '7',
-        '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+    unsigned int ad;
+    char         line[HEXDUMP_LINE_BUF_SIZE];
+    unsigned int use_digits;
 
     /*
      * How many of the leading digits of the offset will we supply?
@@ -1509,58 +1632,11 @@ hex_dump_buffer(bool (*print_line)(void *, const char *), void *fp,
     else
         use_digits = 4; /* we'll supply 4 digits */
 
-    ad = 0;
-    i = 0;
-    j = 0;
-    k = 0;
-    while (i < length) {
-        if ((i & 15) == 0) {
-            /*
-             * Start of a new line.
-             */
-            j = 0;
-            l = use_digits;
-            do {
-                l--;
-                c = (ad >> (l*4)) & 0xF;
-                line[j++] = binhex[c];
-            } while (l != 0);
-            line[j++] = ' ';
-            line[j++] = ' ';
-            memset(line+j, ' ', DATA_DUMP_LEN);
-
-            /*
-             * Offset in line of ASCII dump.
-             */
-            k = j + HEX_DUMP_LEN + 2;
-            if (ascii_option == HEXDUMP_ASCII_DELIMIT)
-                line[k++] = '|';
-        }
-        c = *cp++;
-        line[j++] = binhex[c>>4];
-        line[j++] = binhex[c&0xf];
-        j++;
-        if (ascii_option != HEXDUMP_ASCII_EXCLUDE ) {
-            if (encoding == HEXDUMP_ENC_EBCDIC) {
-                c = EBCDIC_to_ASCII1(c);
-            }
-            line[k++] = ((c >= ' ') && (c < 0x7f)) ? c : '.';
-        }
-        i++;
-        if (((i & 15) == 0) || (i == length)) {
-            /*
-             * We'll be starting a new line, or
-             * we're finished printing this buffer;
-             * dump out the line we've constructed,
-             * and advance the offset.
-             */
-            if (ascii_option == HEXDUMP_ASCII_DELIMIT)
-                line[k++] = '|';
-            line[k] = '\0';
-            if (!print_line(fp, line))
-                return false;
-            ad += 16;
-        }
+    for (ad = 0; ad < length; ad += HEXDUMP_BYTES_PER_LINE) {
+        hex_dump_line(line, ad, use_digits, cp + ad, length - ad,
+                      encoding, ascii_option);
+        if (!print_line(fp, line))
+            return false;
     }
     return true;
 }
@@ -442,6 +442,69 @@ bool hex_dump_buffer(bool (*print_line)(void *, const char *), void *fp,
                                     hex_dump_enc encoding,
                                     unsigned ascii_option);
 
+/* Number of bytes on each line of a hex dump */
+#define HEXDUMP_BYTES_PER_LINE  16
+
+/* Size of a buffer that can hold any line from hex_dump_line(),
+ * including the terminating NUL: up to 8 offset digits, 2 blanks,
+ * 3 characters per byte of hex, 2 blanks, 2 optional ASCII delimiters
+ * and 1 character per byte of ASCII. */
+#define HEXDUMP_LINE_BUF_SIZE   (8 + 2 + HEXDUMP_BYTES_PER_LINE*3 + 2 + 2 + HEXDUMP_BYTES_PER_LINE + 1)
+
+/**
+ * Format one line of hex_dump_buffer() output.
+ *
+ * @param line Buffer of at least HEXDUMP_LINE_BUF_SIZE characters.
+ * @param offset Offset of the first byte, printed at the start of the line.
+ * @param offset_digits Number of hex digits of the offset to print (4-8).
+ * @param cp The bytes to dump.
+ * @param length Number of bytes; at most HEXDUMP_BYTES_PER_LINE are used.
+ * @param encoding Character encoding of the ASCII part.
+ * @param ascii_option One of HEXDUMP_ASCII_INCLUDE, _DELIMIT or _EXCLUDE.
+ * @return The length of the NUL-terminated line.
+ */
+WS_DLL_PUBLIC
+unsigned hex_dump_line(char *line, unsigned offset, unsigned offset_digits,
+                                    const uint8_t *cp, unsigned length,
+                                    hex_dump_enc encoding,
+                                    unsigned ascii_option);
+
+/* How to show each byte in the data part of a hex dump */
+typedef enum {
+    HEXDUMP_BYTES_HEX     = 0, /* 2 hexadecimal digits */
+    HEXDUMP_BYTES_BITS    = 1, /* 8 binary digits */
+    HEXDUMP_BYTES_DEC     = 2, /* 3 decimal digits, blank padded */
+    HEXDUMP_BYTES_OCT     = 3  /* 3 octal digits */
+} hex_dump_bytes_fmt;
+
+/** Number of characters hex_dump_format_bytes() uses for each byte,
+ * not counting the blank before it. */
+WS_DLL_PUBLIC
+unsigned hex_dump_byte_chars(hex_dump_bytes_fmt fmt);
+
+/**
+ * Format bytes as in the data part of a hex dump, each preceded by
+ * a blank. The output is not NUL-terminated.
+ *
+ * @param buf Buffer with room for length * (1 + hex_dump_byte_chars(fmt))
+ *            characters.
+ * @return A pointer just past the last character written.
+ */
+WS_DLL_PUBLIC
+char *hex_dump_format_bytes(char *buf, const uint8_t *cp, unsigned length,
+                                    hex_dump_bytes_fmt fmt);
+
+/**
+ * Format bytes as in the ASCII part of a hex dump, one character per
+ * byte. Bytes that aren't printable (after translating from EBCDIC, if
+ * requested) are shown as nonprint. The output is not NUL-terminated.
+ *
+ * @return A pointer just past the last character written.
+ */
+WS_DLL_PUBLIC
+char *hex_dump_format_chars(char *buf, const uint8_t *cp, unsigned length,
+                                    hex_dump_enc encoding, char nonprint);
+
 /* To pass one of two strings, singular or plural */
 #define plurality(d,s,p) ((d) == 1 ? (s) : (p))
 
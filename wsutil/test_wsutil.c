@@ -9,10 +9,12 @@
 #include "config.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <glib.h>
 #include <wsutil/utf8_entities.h>
 #include <wsutil/time_util.h>
 #include <wsutil/to_str.h>
+#include <wsutil/json_dumper.h>
 
 #include "inet_addr.h"
 
@@ -251,6 +253,82 @@ static void test_format_text(void)
 
 }
 
+static bool hex_dump_append_line(void *data, const char *line)
+{
+    g_string_append_printf((GString *)data, "%s\n", line);
+    return true;
+}
+
+static void test_hex_dump(void)
+{
+    const unsigned char data[] = "Hello, world!\r\n\x00\x01\xfe\xff";
+    GString *out = g_string_new(NULL);
+    char line[HEXDUMP_LINE_BUF_SIZE];
+
+    hex_dump_buffer(hex_dump_append_line, out, data, sizeof(data) - 1,
+                    HEXDUMP_ENC_ASCII, HEXDUMP_ASCII_INCLUDE);
+    g_assert_cmpstr(out->str, ==,
+        "0000  48 65 6c 6c 6f 2c 20 77 6f 72 6c 64 21 0d 0a 00   Hello, world!...\n"
+        "0010  01 fe ff                                          ...\n");
+
+    g_string_truncate(out, 0);
+    hex_dump_buffer(hex_dump_append_line, out, data, 3,
+                    HEXDUMP_ENC_ASCII, HEXDUMP_ASCII_DELIMIT);
+    g_assert_cmpstr(out->str, ==,
+        "0000  48 65 6c                                          |Hel|\n");
+
+    g_string_truncate(out, 0);
+    hex_dump_buffer(hex_dump_append_line, out, data, 3,
+                    HEXDUMP_ENC_ASCII, HEXDUMP_ASCII_EXCLUDE);
+    g_assert_cmpstr(out->str, ==,
+        "0000  48 65 6c                                          \n");
+
+    /* "Hello" in EBCDIC */
+    g_string_truncate(out, 0);
+    hex_dump_buffer(hex_dump_append_line, out, (const unsigned char *)"\xc8\x85\x93\x93\x96", 5,
+                    HEXDUMP_ENC_EBCDIC, HEXDUMP_ASCII_INCLUDE);
+    g_assert_cmpstr(out->str, ==,
+        "0000  c8 85 93 93 96                                    Hello\n");
+
+    g_string_free(out, TRUE);
+
+    /* Long buffers get more offset digits. */
+    g_assert_cmpuint(hex_dump_line(line, 0x12340, 5, data, 1, HEXDUMP_ENC_ASCII, HEXDUMP_ASCII_INCLUDE), ==, 5 + 2 + 48 + 2 + 1);
+    g_assert_cmpstr(line, ==,
+        "12340  48                                                H");
+}
+
+static void test_hex_dump_format_bytes(void)
+{
+    const uint8_t data[] = { 0x00, 0x07, 0x64, 0xff };
+    char buf[64];
+    char *end;
+
+    end = hex_dump_format_bytes(buf, data, sizeof(data), HEXDUMP_BYTES_HEX);
+    *end = '\0';
+    g_assert_cmpstr(buf, ==, " 00 07 64 ff");
+    g_assert_cmpuint(hex_dump_byte_chars(HEXDUMP_BYTES_HEX), ==, 2);
+
+    end = hex_dump_format_bytes(buf, data, sizeof(data), HEXDUMP_BYTES_BITS);
+    *end = '\0';
+    g_assert_cmpstr(buf, ==, " 00000000 00000111 01100100 11111111");
+    g_assert_cmpuint(hex_dump_byte_chars(HEXDUMP_BYTES_BITS), ==, 8);
+
+    end = hex_dump_format_bytes(buf, data, sizeof(data), HEXDUMP_BYTES_DEC);
+    *end = '\0';
+    g_assert_cmpstr(buf, ==, "   0   7 100 255");
+    g_assert_cmpuint(hex_dump_byte_chars(HEXDUMP_BYTES_DEC), ==, 3);
+
+    end = hex_dump_format_bytes(buf, data, sizeof(data), HEXDUMP_BYTES_OCT);
+    *end = '\0';
+    g_assert_cmpstr(buf, ==, " 000 007 144 377");
+    g_assert_cmpuint(hex_dump_byte_chars(HEXDUMP_BYTES_OCT), ==, 3);
+
+    end = hex_dump_format_chars(buf, (const uint8_t *)"A\x01z\x7f ", 5, HEXDUMP_ENC_ASCII, '.');
+    *end = '\0';
+    g_assert_cmpstr(buf, ==, "A.z. ");
+}
+
 #define RESOURCE_USAGE_START get_resource_usage(&start_utime, &start_stime)
 
 #define RESOURCE_USAGE_END \
@@ -836,6 +914,157 @@ static void test_getopt_opterr1(void)
     g_test_trap_assert_stderr("/bin/ls: unrecognized option: z\n");
 }
 
+static void test_json_dumper_escape(void)
+{
+    json_dumper dumper = {
+        .output_string = g_string_new(NULL),
+        .flags = JSON_DUMPER_DOT_TO_UNDERSCORE,
+    };
+
+    json_dumper_begin_object(&dumper);
+    json_dumper_set_member_name(&dumper, "ip.src");
+    json_dumper_value_string(&dumper, "a\"b\\c\n\x01</script>/.");
+    json_dumper_end_object(&dumper);
+    g_assert_true(json_dumper_finish(&dumper));
+    g_assert_cmpstr(dumper.output_string->str, ==,
+                    "{\"ip_src\":\"a\\\"b\\\\c\\n\\u0001<\\/script>/.\"}");
+    g_string_free(dumper.output_string, TRUE);
+}
+
+static void test_json_dumper_integers(void)
+{
+    json_dumper dumper = {
+        .output_string = g_string_new(NULL),
+    };
+
+    json_dumper_begin_array(&dumper);
+    json_dumper_value_int64(&dumper, 0);
+    json_dumper_value_int64(&dumper, -42);
+    json_dumper_value_uint64(&dumper, UINT64_MAX);
+    json_dumper_end_array(&dumper);
+    g_assert_true(json_dumper_finish(&dumper));
+    g_assert_cmpstr(dumper.output_string->str, ==,
+                    "[0,-42,18446744073709551615]");
+    g_string_free(dumper.output_string, TRUE);
+}
+
+#include "crc32.h"
+
+/* Bit-at-a-time reference implementation of a reflected CRC-32. */
+static uint32_t crc32_reflected_reference(uint32_t poly, const uint8_t *buf, size_t len, uint32_t crc)
+{
+    while (len-- > 0) {
+        crc ^= *buf++;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ ((crc & 1) ? poly : 0);
+    }
+    return crc;
+}
+
+#define CRC32C_POLY_REFLECTED       0x82F63B78
+#define CRC32_CCITT_POLY_REFLECTED  0xEDB88320
+
+static void test_crc32c_vectors(void)
+{
+    uint8_t buf[32];
+
+    /* RFC 3720, Appendix B.4 */
+    memset(buf, 0, sizeof buf);
+    g_assert_cmphex(~crc32c_calculate_no_swap(buf, sizeof buf, CRC32C_PRELOAD), ==, 0x8A9136AA);
+    memset(buf, 0xFF, sizeof buf);
+    g_assert_cmphex(~crc32c_calculate_no_swap(buf, sizeof buf, CRC32C_PRELOAD), ==, 0x62A8AB43);
+    for (unsigned i = 0; i < sizeof buf; i++)
+        buf[i] = i;
+    g_assert_cmphex(~crc32c_calculate_no_swap(buf, sizeof buf, CRC32C_PRELOAD), ==, 0x46DD794E);
+
+    g_assert_cmphex(~crc32c_calculate_no_swap("123456789", 9, CRC32C_PRELOAD), ==, 0xE3069283);
+    g_assert_cmphex(crc32c_calculate_no_swap(buf, 0, 0x12345678), ==, 0x12345678);
+    g_assert_cmphex(crc32c_calculate_no_swap(buf, -1, 0x12345678), ==, 0x12345678);
+}
+
+static void test_crc32c_lengths(void)
+{
+    uint8_t buf[1024 + 16];
+    GRand *rand = g_rand_new_with_seed(0x3720);
+
+    for (unsigned i = 0; i < sizeof buf; i++)
+        buf[i] = g_rand_int(rand);
+
+    /* Every alignment and every length up to the size of the wide
+     * loops, then a sample of longer ones, fed in one or two pieces. */
+    for (size_t off = 0; off < 16; off++) {
+        for (size_t len = 0; len < 1024; len += (len < 80 ? 1 : 37)) {
+            uint32_t seed = g_rand_int(rand);
+            uint32_t want = crc32_reflected_reference(CRC32C_POLY_REFLECTED, buf + off, len, seed);
+            size_t split = len / 3;
+
+            g_assert_cmphex(crc32c_calculate_no_swap(buf + off, (int)len, seed), ==, want);
+            g_assert_cmphex(crc32c_calculate_no_swap(buf + off + split, (int)(len - split),
+                            crc32c_calculate_no_swap(buf + off, (int)split, seed)), ==, want);
+            g_assert_cmphex(crc32c_calculate(buf + off, (int)len, CRC32C_SWAP(seed)), ==, CRC32C_SWAP(want));
+        }
+    }
+
+    g_rand_free(rand);
+}
+
+static void test_crc32_ccitt(void)
+{
+    uint8_t buf[1024 + 16];
+    GRand *rand = g_rand_new_with_seed(0x04C11DB7);
+
+    g_assert_cmphex(crc32_ccitt((const uint8_t *)"123456789", 9), ==, 0xCBF43926);
+
+    for (unsigned i = 0; i < sizeof buf; i++)
+        buf[i] = g_rand_int(rand);
+
+    for (size_t off = 0; off < 16; off++) {
+        for (size_t len = 0; len < 1024; len += (len < 80 ? 1 : 37)) {
+            uint32_t seed = g_rand_int(rand);
+            uint32_t want = ~crc32_reflected_reference(CRC32_CCITT_POLY_REFLECTED, buf + off, len, seed);
+
+            g_assert_cmphex(crc32_ccitt_seed(buf + off, (unsigned)len, seed), ==, want);
+        }
+    }
+
+    g_rand_free(rand);
+}
+
+static void test_crc32_perf(void)
+{
+#define CRC_BUF_SIZE  (64 * 1024)
+#define CRC_LOOP_COUNT 4096
+    uint8_t            *buf;
+    uint32_t            crc;
+    int                 i;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+    double              mbytes = (double)CRC_BUF_SIZE * CRC_LOOP_COUNT / (1024 * 1024);
+
+    buf = g_malloc(CRC_BUF_SIZE);
+    for (i = 0; i < CRC_BUF_SIZE; i++)
+        buf[i] = (uint8_t)(i * 31);
+
+    crc = CRC32C_PRELOAD;
+    RESOURCE_USAGE_START;
+    for (i = 0; i < CRC_LOOP_COUNT; i++)
+        crc = crc32c_calculate_no_swap(buf, CRC_BUF_SIZE, crc);
+    RESOURCE_USAGE_END;
+    g_test_maximized_result(mbytes * 1000.0 / (utime_ms + stime_ms),
+        "crc32c_calculate_no_swap(): %.0f MiB/s (crc %08x)",
+        mbytes * 1000.0 / (utime_ms + stime_ms), crc);
+
+    crc = CRC32_CCITT_SEED;
+    RESOURCE_USAGE_START;
+    for (i = 0; i < CRC_LOOP_COUNT; i++)
+        crc = crc32_ccitt_seed(buf, CRC_BUF_SIZE, crc);
+    RESOURCE_USAGE_END;
+    g_test_maximized_result(mbytes * 1000.0 / (utime_ms + stime_ms),
+        "crc32_ccitt_seed(): %.0f MiB/s (crc %08x)",
+        mbytes * 1000.0 / (utime_ms + stime_ms), crc);
+
+    g_free(buf);
+}
+
 int main(int argc, char **argv)
 {
     int ret;
@@ -855,6 +1084,8 @@ int main(int argc, char **argv)
     g_test_add_func("/str_util/strsplit", test_strsplit);
     g_test_add_func("/str_util/str_ascii", test_str_ascii);
     g_test_add_func("/str_util/format_text", test_format_text);
+    g_test_add_func("/str_util/hex_dump", test_hex_dump);
+    g_test_add_func("/str_util/hex_dump_format_bytes", test_hex_dump_format_bytes);
 
     if (g_test_perf()) {
         g_test_add_func("/str_util/format_text_perf", test_format_text_perf);
@@ -881,11 +1112,22 @@ int main(int argc, char **argv)
 
     g_test_add_func("/nstime/from_iso8601", test_nstime_from_iso8601);
 
+    g_test_add_func("/json_dumper/escape", test_json_dumper_escape);
+    g_test_add_func("/json_dumper/integers", test_json_dumper_integers);
+
     g_test_add_func("/ws_getopt/basic1", test_getopt_long_basic1);
     g_test_add_func("/ws_getopt/basic2", test_getopt_long_basic2);
     g_test_add_func("/ws_getopt/optional1", test_getopt_optional_argument1);
     g_test_add_func("/ws_getopt/opterr1", test_getopt_opterr1);
 
+    g_test_add_func("/crc32/crc32c_vectors", test_crc32c_vectors);
+    g_test_add_func("/crc32/crc32c_lengths", test_crc32c_lengths);
+    g_test_add_func("/crc32/crc32_ccitt", test_crc32_ccitt);
+
+    if (g_test_perf()) {
+        g_test_add_func("/crc32/perf", test_crc32_perf);
+    }
+
     ret = g_test_run();
 
     return ret;
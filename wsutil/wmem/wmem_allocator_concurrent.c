@@ -0,0 +1,350 @@
+/* wmem_allocator_concurrent.c
+ * Wireshark Memory Manager Concurrent Allocator
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "wmem_core.h"
+#include "wmem_allocator.h"
+#include "wmem_allocator_concurrent.h"
+
+/* AUTHOR'S NOTE:
+ *
+ * The other allocators all assume that a pool is only ever touched by one
+ * thread at a time. That is fine for the packet scope (each dissection thread
+ * can have its own) but not for the file scope, which conversation tables,
+ * reassembly and friends share between every packet of the capture.
+ *
+ * Wrapping a block allocator in a mutex would serialize every dissector that
+ * allocates file-scoped memory, so this allocator instead gives each thread
+ * its own private BLOCK pool (a "magazine") that it can allocate from without
+ * taking any locks. Each chunk is prefixed by a small header recording the
+ * magazine it came from:
+ *
+ *  - A thread freeing or reallocating memory from its own magazine goes
+ *    straight to the underlying block allocator.
+ *  - A thread freeing memory that belongs to some other thread's magazine
+ *    pushes the chunk onto that magazine's "remote free" list instead. The
+ *    owner drains that list the next time it allocates, so the block
+ *    allocator itself is still only ever touched by its owning thread.
+ *  - Reallocating another thread's chunk is done as alloc + copy + remote free.
+ *
+ * Each thread remembers the last (allocator, magazine) pair it used in
+ * thread-local storage, so the common case costs one TLS lookup and a compare
+ * on top of the block allocator. The magazine list itself is protected by a
+ * mutex that is only taken the first time a thread touches the pool.
+ *
+ * The producer functions (free_all, gc and cleanup) walk every magazine, and
+ * like the scope transitions that call them they must only be used while no
+ * other thread is using the pool.
+ */
+
+#define WMEM_ALIGN_AMOUNT (2 * sizeof (size_t))
+#define WMEM_ALIGN_SIZE(SIZE) ((~(WMEM_ALIGN_AMOUNT-1)) & \
+        ((SIZE) + (WMEM_ALIGN_AMOUNT-1)))
+
+struct _wmem_concurrent_magazine_t;
+
+typedef struct _wmem_concurrent_chunk_t {
+    union {
+        /* while the chunk is allocated */
+        struct _wmem_concurrent_magazine_t *magazine;
+        /* while the chunk is waiting on a remote free list */
+        struct _wmem_concurrent_chunk_t    *next;
+    } u;
+    size_t len;
+} wmem_concurrent_chunk_t;
+
+#define WMEM_CHUNK_HEADER_SIZE WMEM_ALIGN_SIZE(sizeof(wmem_concurrent_chunk_t))
+
+#define WMEM_CHUNK_TO_DATA(CHUNK) ((void*)((uint8_t*)(CHUNK) + WMEM_CHUNK_HEADER_SIZE))
+#define WMEM_DATA_TO_CHUNK(DATA) ((wmem_concurrent_chunk_t*)((uint8_t*)(DATA) - WMEM_CHUNK_HEADER_SIZE))
+
+typedef struct _wmem_concurrent_magazine_t {
+    wmem_allocator_t                   *pool;
+    GThread                            *owner;
+
+    GMutex                              remote_lock;
+    wmem_concurrent_chunk_t            *remote_frees;
+
+    struct _wmem_concurrent_magazine_t *next;
+} wmem_concurrent_magazine_t;
+
+typedef struct _wmem_concurrent_allocator_t {
+    GMutex                      lock;
+    wmem_concurrent_magazine_t *magazines;
+    unsigned                    id;
+} wmem_concurrent_allocator_t;
+
+/* The magazine the current thread last used, and the allocator it belongs to.
+ * Allocators are identified by a never-reused id rather than by address so
+ * that a cache entry left over from a destroyed pool can't match a new pool
+ * that happens to be allocated at the same address. */
+typedef struct _wmem_concurrent_cache_t {
+    unsigned                    allocator_id;
+    wmem_concurrent_magazine_t *magazine;
+} wmem_concurrent_cache_t;
+
+static GPrivate magazine_cache = G_PRIVATE_INIT(g_free);
+static int      next_allocator_id = 1;
+
+static wmem_concurrent_magazine_t *
+wmem_concurrent_get_magazine_slow(wmem_concurrent_allocator_t *allocator,
+        wmem_concurrent_cache_t *cache)
+{
+    wmem_concurrent_magazine_t *magazine;
+    GThread                    *self;
+
+    self = g_thread_self();
+
+    g_mutex_lock(&allocator->lock);
+    for (magazine = allocator->magazines; magazine; magazine = magazine->next) {
+        if (magazine->owner == self) {
+            break;
+        }
+    }
+    if (magazine == NULL) {
+        magazine = g_new0(wmem_concurrent_magazine_t, 1);
+        magazine->pool  = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+        magazine->owner = self;
+        g_mutex_init(&magazine->remote_lock);
+        magazine->next = allocator->magazines;
+        allocator->magazines = magazine;
+    }
+    g_mutex_unlock(&allocator->lock);
+
+    if (cache == NULL) {
+        cache = g_new(wmem_concurrent_cache_t, 1);
+        g_private_set(&magazine_cache, cache);
+    }
+    cache->allocator_id = allocator->id;
+    cache->magazine     = magazine;
+
+    return magazine;
+}
+
+static inline wmem_concurrent_magazine_t *
+wmem_concurrent_get_magazine(wmem_concurrent_allocator_t *allocator)
+{
+    wmem_concurrent_cache_t *cache;
+
+    cache = (wmem_concurrent_cache_t*) g_private_get(&magazine_cache);
+
+    if (G_LIKELY(cache != NULL && cache->allocator_id == allocator->id)) {
+        return cache->magazine;
+    }
+
+    return wmem_concurrent_get_magazine_slow(allocator, cache);
+}
+
+/* Returns true if the current thread owns the given magazine. Unlike
+ * wmem_concurrent_get_magazine this never creates a magazine, so threads that
+ * only ever free memory into the pool don't get one of their own. */
+static inline bool
+wmem_concurrent_is_local(wmem_concurrent_allocator_t *allocator,
+        wmem_concurrent_magazine_t *magazine)
+{
+    wmem_concurrent_cache_t *cache;
+
+    cache = (wmem_concurrent_cache_t*) g_private_get(&magazine_cache);
+
+    if (G_LIKELY(cache != NULL && cache->allocator_id == allocator->id)) {
+        return cache->magazine == magazine;
+    }
+
+    return magazine->owner == g_thread_self();
+}
+
+static void
+wmem_concurrent_drain(wmem_concurrent_magazine_t *magazine)
+{
+    wmem_concurrent_chunk_t *chunk, *next;
+
+    g_mutex_lock(&magazine->remote_lock);
+    chunk = magazine->remote_frees;
+    g_atomic_pointer_set(&magazine->remote_frees, NULL);
+    g_mutex_unlock(&magazine->remote_lock);
+
+    while (chunk) {
+        next = chunk->u.next;
+        wmem_free(magazine->pool, chunk);
+        chunk = next;
+    }
+}
+
+static void
+wmem_concurrent_remote_free(wmem_concurrent_magazine_t *magazine,
+        wmem_concurrent_chunk_t *chunk)
+{
+    g_mutex_lock(&magazine->remote_lock);
+    chunk->u.next = magazine->remote_frees;
+    g_atomic_pointer_set(&magazine->remote_frees, chunk);
+    g_mutex_unlock(&magazine->remote_lock);
+}
+
+static void *
+wmem_concurrent_alloc(void *private_data, const size_t size)
+{
+    wmem_concurrent_allocator_t *allocator;
+    wmem_concurrent_magazine_t  *magazine;
+    wmem_concurrent_chunk_t     *chunk;
+
+    allocator = (wmem_concurrent_allocator_t*) private_data;
+    magazine  = wmem_concurrent_get_magazine(allocator);
+
+    if (G_UNLIKELY(g_atomic_pointer_get(&magazine->remote_frees) != NULL)) {
+        wmem_concurrent_drain(magazine);
+    }
+
+    chunk = (wmem_concurrent_chunk_t*) wmem_alloc(magazine->pool,
+            WMEM_CHUNK_HEADER_SIZE + size);
+    chunk->u.magazine = magazine;
+    chunk->len        = size;
+
+    return WMEM_CHUNK_TO_DATA(chunk);
+}
+
+static void
+wmem_concurrent_free(void *private_data, void *ptr)
+{
+    wmem_concurrent_allocator_t *allocator;
+    wmem_concurrent_magazine_t  *magazine;
+    wmem_concurrent_chunk_t     *chunk;
+
+    allocator = (wmem_concurrent_allocator_t*) private_data;
+    chunk     = WMEM_DATA_TO_CHUNK(ptr);
+    magazine  = chunk->u.magazine;
+
+    if (wmem_concurrent_is_local(allocator, magazine)) {
+        wmem_free(magazine->pool, chunk);
+    }
+    else {
+        wmem_concurrent_remote_free(magazine, chunk);
+    }
+}
+
+static void *
+wmem_concurrent_realloc(void *private_data, void *ptr, const size_t size)
+{
+    wmem_concurrent_allocator_t *allocator;
+    wmem_concurrent_magazine_t  *magazine;
+    wmem_concurrent_chunk_t     *chunk;
+    void                        *newptr;
+
+    allocator = (wmem_concurrent_allocator_t*) private_data;
+    chunk     = WMEM_DATA_TO_CHUNK(ptr);
+    magazine  = chunk->u.magazine;
+
+    if (wmem_concurrent_is_local(allocator, magazine)) {
+        chunk = (wmem_concurrent_chunk_t*) wmem_realloc(magazine->pool, chunk,
+                WMEM_CHUNK_HEADER_SIZE + size);
+        chunk->len = size;
+        return WMEM_CHUNK_TO_DATA(chunk);
+    }
+
+    /* Someone else's chunk: move it into our own magazine. */
+    newptr = wmem_concurrent_alloc(private_data, size);
+    memcpy(newptr, ptr, MIN(size, chunk->len));
+    wmem_concurrent_remote_free(magazine, chunk);
+
+    return newptr;
+}
+
+static void
+wmem_concurrent_free_all(void *private_data)
+{
+    wmem_concurrent_allocator_t *allocator;
+    wmem_concurrent_magazine_t  *magazine;
+
+    allocator = (wmem_concurrent_allocator_t*) private_data;
+
+    g_mutex_lock(&allocator->lock);
+    for (magazine = allocator->magazines; magazine; magazine = magazine->next) {
+        /* anything still waiting to be freed goes away with the rest */
+        g_atomic_pointer_set(&magazine->remote_frees, NULL);
+        wmem_free_all(magazine->pool);
+    }
+    g_mutex_unlock(&allocator->lock);
+}
+
+static void
+wmem_concurrent_gc(void *private_data)
+{
+    wmem_concurrent_allocator_t *allocator;
+    wmem_concurrent_magazine_t  *magazine;
+
+    allocator = (wmem_concurrent_allocator_t*) private_data;
+
+    g_mutex_lock(&allocator->lock);
+    for (magazine = allocator->magazines; magazine; magazine = magazine->next) {
+        wmem_concurrent_drain(magazine);
+        wmem_gc(magazine->pool);
+    }
+    g_mutex_unlock(&allocator->lock);
+}
+
+static void
+wmem_concurrent_allocator_cleanup(void *private_data)
+{
+    wmem_concurrent_allocator_t *allocator;
+    wmem_concurrent_magazine_t  *magazine, *next;
+
+    allocator = (wmem_concurrent_allocator_t*) private_data;
+
+    magazine = allocator->magazines;
+    while (magazine) {
+        next = magazine->next;
+        wmem_destroy_allocator(magazine->pool);
+        g_mutex_clear(&magazine->remote_lock);
+        g_free(magazine);
+        magazine = next;
+    }
+
+    g_mutex_clear(&allocator->lock);
+    wmem_free(NULL, allocator);
+}
+
+void
+wmem_concurrent_allocator_init(wmem_allocator_t *allocator)
+{
+    wmem_concurrent_allocator_t *concurrent_allocator;
+
+    concurrent_allocator = wmem_new(NULL, wmem_concurrent_allocator_t);
+
+    allocator->walloc   = &wmem_concurrent_alloc;
+    allocator->wrealloc = &wmem_concurrent_realloc;
+    allocator->wfree    = &wmem_concurrent_free;
+
+    allocator->free_all = &wmem_concurrent_free_all;
+    allocator->gc       = &wmem_concurrent_gc;
+    allocator->cleanup  = &wmem_concurrent_allocator_cleanup;
+
+    allocator->private_data = (void*) concurrent_allocator;
+
+    g_mutex_init(&concurrent_allocator->lock);
+    concurrent_allocator->magazines = NULL;
+    concurrent_allocator->id = (unsigned) g_atomic_int_add(&next_allocator_id, 1);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
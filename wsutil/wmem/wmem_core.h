@@ -57,11 +57,17 @@ typedef enum _wmem_allocator_type_t {
                 memory usage via things like canaries and scrubbing freed
                 memory. Valgrind is the better choice on platforms that support
                 it. */
-    WMEM_ALLOCATOR_BLOCK_FAST /**< A block allocator like WMEM_ALLOCATOR_BLOCK
+    WMEM_ALLOCATOR_BLOCK_FAST, /**< A block allocator like WMEM_ALLOCATOR_BLOCK
                 but even faster by tracking absolutely minimal metadata and
                 making 'free' a no-op. Useful only for very short-lived scopes
                 where there's no reason to free individual allocations because
                 the next free_all is always just around the corner. */
+    WMEM_ALLOCATOR_CONCURRENT /**< An allocator that may be used from several
+                threads at once. Each thread allocates from its own private
+                block allocator without locking; memory freed by a thread other
+                than the one that allocated it is handed back to the owner.
+                wmem_free_all(), wmem_gc() and wmem_destroy_allocator() must
+                still only be called while no other thread is using the pool. */
 } wmem_allocator_type_t;
 
 /** Allocate the requested amount of memory in the given pool.
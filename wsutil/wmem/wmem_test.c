@@ -19,6 +19,7 @@
 #include "wmem_allocator.h"
 #include "wmem_allocator_block.h"
 #include "wmem_allocator_block_fast.h"
+#include "wmem_allocator_concurrent.h"
 #include "wmem_allocator_simple.h"
 #include "wmem_allocator_strict.h"
 
@@ -57,6 +58,9 @@ wmem_allocator_force_new(const wmem_allocator_type_t type)
         case WMEM_ALLOCATOR_STRICT:
             wmem_strict_allocator_init(allocator);
             break;
+        case WMEM_ALLOCATOR_CONCURRENT:
+            wmem_concurrent_allocator_init(allocator);
+            break;
         default:
             g_assert_not_reached();
             /* This is necessary to squelch MSVC errors; is there
@@ -369,6 +373,186 @@ wmem_test_allocator_strict(void)
     wmem_test_allocator_jumbo(WMEM_ALLOCATOR_STRICT, &wmem_strict_check_canaries);
 }
 
+static void
+wmem_test_allocator_concurrent(void)
+{
+    wmem_test_allocator(WMEM_ALLOCATOR_CONCURRENT, NULL,
+            MAX_SIMULTANEOUS_ALLOCS*64);
+    wmem_test_allocator_jumbo(WMEM_ALLOCATOR_CONCURRENT, NULL);
+}
+
+/* Multi-threaded tests for the concurrent allocator. Each thread runs the same
+ * sort of random alloc/realloc/free workload as wmem_test_allocator, filling
+ * its memory with a per-thread tag byte and checking it is intact before every
+ * realloc or free. Some chunks are also handed to the next thread over a
+ * queue, so that memory gets freed and reallocated by threads other than the
+ * one that allocated it. */
+#define MT_THREADS       4
+#define MT_HANDOFF_LEN   64
+
+typedef struct {
+    wmem_allocator_t *allocator;
+    GAsyncQueue      *inbound;
+    GAsyncQueue      *outbound;
+    GMutex           *lock;
+    unsigned          iterations;
+    uint8_t           tag;
+} wmem_test_thread_t;
+
+static void
+wmem_test_check_tag(const uint8_t *ptr, size_t len, uint8_t tag)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        if (ptr[i] != tag) {
+            g_error("chunk %p corrupted at offset %zu (0x%02x != 0x%02x)",
+                    (const void *)ptr, i, ptr[i], tag);
+        }
+    }
+}
+
+/* Frees a chunk that was allocated by another thread, sometimes growing it
+ * (and so moving it into our own magazine) first. */
+static void
+wmem_test_release_handoff(wmem_allocator_t *allocator, uint8_t *ptr,
+        bool grow)
+{
+    wmem_test_check_tag(ptr, MT_HANDOFF_LEN, ptr[0]);
+    if (grow) {
+        ptr = (uint8_t *)wmem_realloc(allocator, ptr, 2*MT_HANDOFF_LEN);
+        wmem_test_check_tag(ptr, MT_HANDOFF_LEN, ptr[0]);
+    }
+    wmem_free(allocator, ptr);
+}
+
+static void *
+wmem_test_concurrent_worker(void *data)
+{
+    wmem_test_thread_t *td = (wmem_test_thread_t *)data;
+    uint8_t            *ptrs[MAX_SIMULTANEOUS_ALLOCS];
+    size_t              lens[MAX_SIMULTANEOUS_ALLOCS];
+    GRand              *rand;
+    uint8_t            *ptr;
+    unsigned            i;
+    int                 idx;
+
+    /* g_test_rand_* share one generator between all threads */
+    rand = g_rand_new_with_seed(g_test_rand_int() ^ td->tag);
+
+    memset(ptrs, 0, sizeof(ptrs));
+
+    for (i = 0; i < td->iterations; i++) {
+        idx = g_rand_int_range(rand, 0, MAX_SIMULTANEOUS_ALLOCS);
+
+        if (ptrs[idx] == NULL) {
+            lens[idx] = g_rand_int_range(rand, 1, MAX_ALLOC_SIZE / 16);
+            ptrs[idx] = (uint8_t *)wmem_alloc(td->allocator, lens[idx]);
+            memset(ptrs[idx], td->tag, lens[idx]);
+        }
+        else {
+            wmem_test_check_tag(ptrs[idx], lens[idx], td->tag);
+
+            switch (g_rand_int_range(rand, 0, 3)) {
+                case 0:
+                    lens[idx] = g_rand_int_range(rand, 1, MAX_ALLOC_SIZE / 16);
+                    ptrs[idx] = (uint8_t *)wmem_realloc(td->allocator,
+                            ptrs[idx], lens[idx]);
+                    memset(ptrs[idx], td->tag, lens[idx]);
+                    break;
+                case 1:
+                    wmem_free(td->allocator, ptrs[idx]);
+                    ptrs[idx] = NULL;
+                    break;
+                default:
+                    ptr = (uint8_t *)wmem_alloc(td->allocator, MT_HANDOFF_LEN);
+                    memset(ptr, td->tag, MT_HANDOFF_LEN);
+                    g_async_queue_push(td->outbound, ptr);
+                    break;
+            }
+        }
+
+        while ((ptr = (uint8_t *)g_async_queue_try_pop(td->inbound)) != NULL) {
+            wmem_test_release_handoff(td->allocator, ptr, g_rand_boolean(rand));
+        }
+    }
+
+    for (idx = 0; idx < MAX_SIMULTANEOUS_ALLOCS; idx++) {
+        if (ptrs[idx]) {
+            wmem_test_check_tag(ptrs[idx], lens[idx], td->tag);
+            wmem_free(td->allocator, ptrs[idx]);
+        }
+    }
+
+    g_rand_free(rand);
+
+    return NULL;
+}
+
+static void
+wmem_test_allocator_concurrent_threads(void)
+{
+    wmem_allocator_t   *allocator;
+    wmem_test_thread_t  td[MT_THREADS];
+    GThread            *threads[MT_THREADS];
+    GAsyncQueue        *queues[MT_THREADS];
+    void               *ptr;
+    int                 i, round;
+
+    allocator = wmem_allocator_force_new(WMEM_ALLOCATOR_CONCURRENT);
+
+    for (i = 0; i < MT_THREADS; i++) {
+        queues[i] = g_async_queue_new();
+    }
+
+    /* Run twice so the second round reuses the magazines (and any stale
+     * thread-local state) left behind by the first. */
+    for (round = 0; round < 2; round++) {
+        for (i = 0; i < MT_THREADS; i++) {
+            td[i].allocator  = allocator;
+            td[i].inbound    = queues[i];
+            td[i].outbound   = queues[(i + 1) % MT_THREADS];
+            td[i].lock       = NULL;
+            td[i].iterations = MAX_SIMULTANEOUS_ALLOCS*32;
+            td[i].tag        = (uint8_t)(0x11 * (i + 1));
+            threads[i] = g_thread_new("wmem_test", wmem_test_concurrent_worker, &td[i]);
+        }
+        for (i = 0; i < MT_THREADS; i++) {
+            g_thread_join(threads[i]);
+        }
+
+        /* Whatever is left in the queues is freed by this thread, which
+         * never allocated anything and so doesn't own a magazine. */
+        for (i = 0; i < MT_THREADS; i++) {
+            while ((ptr = g_async_queue_try_pop(queues[i])) != NULL) {
+                wmem_test_release_handoff(allocator, (uint8_t *)ptr, false);
+            }
+        }
+
+        wmem_gc(allocator);
+    }
+
+    /* Leave some memory outstanding from several threads for free_all */
+    for (i = 0; i < MT_THREADS; i++) {
+        td[i].iterations = MAX_SIMULTANEOUS_ALLOCS;
+        threads[i] = g_thread_new("wmem_test", wmem_test_concurrent_worker, &td[i]);
+        g_thread_join(threads[i]);
+    }
+    for (i = 0; i < MT_THREADS; i++) {
+        while ((ptr = g_async_queue_try_pop(queues[i])) != NULL) {
+            wmem_test_check_tag((uint8_t *)ptr, MT_HANDOFF_LEN, ((uint8_t *)ptr)[0]);
+        }
+    }
+    wmem_free_all(allocator);
+    wmem_gc(allocator);
+
+    for (i = 0; i < MT_THREADS; i++) {
+        g_async_queue_unref(queues[i]);
+    }
+
+    wmem_destroy_allocator(allocator);
+}
+
 /* UTILITY TESTING FUNCTIONS (/wmem/utils/) */
 
 static void
@@ -628,6 +812,93 @@ wmem_test_stringperf(void)
     g_free(str_ptr);
 }
 
+/* A file-scope-like workload: mostly small allocations, with each thread
+ * keeping a window of recent ones alive and freeing the oldest as it goes. */
+#define PERF_WINDOW 64
+
+static void *
+wmem_test_contended_worker(void *data)
+{
+    wmem_test_thread_t *td = (wmem_test_thread_t *)data;
+    void               *window[PERF_WINDOW];
+    unsigned            i;
+
+    memset(window, 0, sizeof(window));
+
+    for (i = 0; i < td->iterations; i++) {
+        if (td->lock) g_mutex_lock(td->lock);
+        wmem_free(td->allocator, window[i % PERF_WINDOW]);
+        window[i % PERF_WINDOW] = wmem_alloc(td->allocator, 16 + (i % 241));
+        if (td->lock) g_mutex_unlock(td->lock);
+    }
+
+    for (i = 0; i < PERF_WINDOW; i++) {
+        if (td->lock) g_mutex_lock(td->lock);
+        wmem_free(td->allocator, window[i]);
+        if (td->lock) g_mutex_unlock(td->lock);
+    }
+
+    return NULL;
+}
+
+static double
+wmem_test_contended_run(wmem_allocator_type_t type, bool locked, int nthreads)
+{
+    wmem_allocator_t   *allocator;
+    wmem_test_thread_t  td[MT_THREADS];
+    GThread            *threads[MT_THREADS];
+    GMutex              lock;
+    int64_t             start;
+    double              elapsed_ms;
+    int                 i;
+
+    allocator = wmem_allocator_force_new(type);
+    g_mutex_init(&lock);
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < nthreads; i++) {
+        td[i].allocator  = allocator;
+        td[i].inbound    = NULL;
+        td[i].outbound   = NULL;
+        td[i].lock       = locked ? &lock : NULL;
+        td[i].iterations = (1 * 1000 * 1000) / nthreads;
+        td[i].tag        = (uint8_t)(i + 1);
+        threads[i] = g_thread_new("wmem_perf", wmem_test_contended_worker, &td[i]);
+    }
+    for (i = 0; i < nthreads; i++) {
+        g_thread_join(threads[i]);
+    }
+    elapsed_ms = (g_get_monotonic_time() - start) / 1000.0;
+
+    g_mutex_clear(&lock);
+    wmem_destroy_allocator(allocator);
+
+    return elapsed_ms;
+}
+
+/* NOTE: You have to run "wmem_test -m perf" to run the performance tests. */
+static void
+wmem_test_allocator_contended(void)
+{
+    double elapsed_ms;
+
+    elapsed_ms = wmem_test_contended_run(WMEM_ALLOCATOR_BLOCK, false, 1);
+    g_test_minimized_result(elapsed_ms,
+        "block, 1 thread: %.3f ms", elapsed_ms);
+
+    elapsed_ms = wmem_test_contended_run(WMEM_ALLOCATOR_CONCURRENT, false, 1);
+    g_test_minimized_result(elapsed_ms,
+        "concurrent, 1 thread: %.3f ms", elapsed_ms);
+
+    elapsed_ms = wmem_test_contended_run(WMEM_ALLOCATOR_BLOCK, true, MT_THREADS);
+    g_test_minimized_result(elapsed_ms,
+        "block + mutex, %d threads: %.3f ms", MT_THREADS, elapsed_ms);
+
+    elapsed_ms = wmem_test_contended_run(WMEM_ALLOCATOR_CONCURRENT, false, MT_THREADS);
+    g_test_minimized_result(elapsed_ms,
+        "concurrent, %d threads: %.3f ms", MT_THREADS, elapsed_ms);
+}
+
 /* DATA STRUCTURE TESTING FUNCTIONS (/wmem/datastruct/) */
 
 static void
@@ -1456,6 +1727,8 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/allocator/blk_fast",  wmem_test_allocator_block_fast);
     g_test_add_func("/wmem/allocator/simple",    wmem_test_allocator_simple);
     g_test_add_func("/wmem/allocator/strict",    wmem_test_allocator_strict);
+    g_test_add_func("/wmem/allocator/concurrent", wmem_test_allocator_concurrent);
+    g_test_add_func("/wmem/allocator/concurrent/threads", wmem_test_allocator_concurrent_threads);
     g_test_add_func("/wmem/allocator/callbacks", wmem_test_allocator_callbacks);
 
     g_test_add_func("/wmem/utils/misc",    wmem_test_miscutls);
@@ -1463,6 +1736,7 @@ main(int argc, char **argv)
 
     if (g_test_perf()) {
         g_test_add_func("/wmem/utils/stringperf", wmem_test_stringperf);
+        g_test_add_func("/wmem/allocator/contended", wmem_test_allocator_contended);
     }
 
     g_test_add_func("/wmem/datastruct/array",  wmem_test_array);
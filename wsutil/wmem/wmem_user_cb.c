@@ -22,6 +22,12 @@ typedef struct _wmem_user_cb_container_t {
     unsigned                          id;
 } wmem_user_cb_container_t;
 
+/* Callbacks may be registered on a WMEM_ALLOCATOR_CONCURRENT pool by several
+ * threads at once, so the lists are protected by a (rarely contended) lock.
+ * Calling the callbacks happens on free_all and destroy, when the pool is
+ * required to be quiescent anyway. */
+static GMutex callback_lock;
+
 void
 wmem_call_callbacks(wmem_allocator_t *allocator, wmem_cb_event_t event)
 {
@@ -61,10 +67,13 @@ wmem_register_callback(wmem_allocator_t *allocator,
 
     container->cb        = callback;
     container->user_data = user_data;
+
+    g_mutex_lock(&callback_lock);
     container->next      = allocator->callbacks;
     container->id        = next_id++;
 
     allocator->callbacks = container;
+    g_mutex_unlock(&callback_lock);
 
     return container->id;
 }
@@ -74,6 +83,8 @@ wmem_unregister_callback(wmem_allocator_t *allocator, unsigned id)
 {
     wmem_user_cb_container_t **prev, *cur;
 
+    g_mutex_lock(&callback_lock);
+
     prev = &(allocator->callbacks);
     cur  = allocator->callbacks;
 
@@ -81,13 +92,16 @@ wmem_unregister_callback(wmem_allocator_t *allocator, unsigned id)
 
         if (cur->id == id) {
             *prev = cur->next;
-            wmem_free(NULL, cur);
-            return;
+            break;
         }
 
         prev = &(cur->next);
         cur  = cur->next;
     }
+
+    g_mutex_unlock(&callback_lock);
+
+    wmem_free(NULL, cur);
 }
 
 /*